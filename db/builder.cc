@@ -20,6 +20,7 @@
 #include "db/merge_helper.h"
 #include "db/table_cache.h"
 #include "db/version_edit.h"
+#include "db/version_set.h"
 #include "monitoring/iostats_context_imp.h"
 #include "monitoring/thread_status_util.h"
 #include "rocksdb/db.h"
@@ -48,17 +49,23 @@ TableBuilder* NewTableBuilder(
     WritableFileWriter* file, const CompressionType compression_type,
     const CompressionOptions& compression_opts, int level,
     const std::string* compression_dict, const bool skip_filters,
-    const uint64_t creation_time, const uint64_t oldest_key_time) {
+    const uint64_t creation_time, const uint64_t oldest_key_time,
+    const VersionStorageInfo* vstorage) {
   assert((column_family_id ==
           TablePropertiesCollectorFactory::Context::kUnknownColumnFamily) ==
          column_family_name.empty());
-  return ioptions.table_factory->NewTableBuilder(
-      TableBuilderOptions(ioptions, moptions, internal_comparator,
-                          int_tbl_prop_collector_factories, compression_type,
-                          compression_opts, compression_dict, skip_filters,
-                          column_family_name, level, creation_time,
-                          oldest_key_time),
-      column_family_id, file);
+  TableBuilderOptions table_builder_options(
+      ioptions, moptions, internal_comparator, int_tbl_prop_collector_factories,
+      compression_type, compression_opts, compression_dict, skip_filters,
+      column_family_name, level, creation_time, oldest_key_time);
+  if (vstorage != nullptr) {
+    table_builder_options.base_level = vstorage->base_level();
+    for (int i = 0; i < vstorage->num_levels(); i++) {
+      table_builder_options.level_bytes.push_back(vstorage->NumLevelBytes(i));
+    }
+  }
+  return ioptions.table_factory->NewTableBuilder(table_builder_options,
+                                                 column_family_id, file);
 }
 
 Status BuildTable(
@@ -77,7 +84,8 @@ Status BuildTable(
     InternalStats* internal_stats, TableFileCreationReason reason,
     EventLogger* event_logger, int job_id, const Env::IOPriority io_priority,
     TableProperties* table_properties, int level, const uint64_t creation_time,
-    const uint64_t oldest_key_time, Env::WriteLifeTimeHint write_hint) {
+    const uint64_t oldest_key_time, Env::WriteLifeTimeHint write_hint,
+    const VersionStorageInfo* vstorage) {
   assert((column_family_id ==
           TablePropertiesCollectorFactory::Context::kUnknownColumnFamily) ==
          column_family_name.empty());
@@ -128,7 +136,7 @@ Status BuildTable(
           int_tbl_prop_collector_factories, column_family_id,
           column_family_name, file_writer.get(), compression, compression_opts,
           level, nullptr /* compression_dict */, false /* skip_filters */,
-          creation_time, oldest_key_time);
+          creation_time, oldest_key_time, vstorage);
     }
 
     MergeHelper merge(env, internal_comparator.user_comparator(),
@@ -33,6 +33,7 @@ class SnapshotChecker;
 class TableCache;
 class VersionEdit;
 class TableBuilder;
+class VersionStorageInfo;
 class WritableFileWriter;
 class InternalStats;
 class InternalIterator;
@@ -52,7 +53,8 @@ TableBuilder* NewTableBuilder(
     const CompressionOptions& compression_opts, int level,
     const std::string* compression_dict = nullptr,
     const bool skip_filters = false, const uint64_t creation_time = 0,
-    const uint64_t oldest_key_time = 0);
+    const uint64_t oldest_key_time = 0,
+    const VersionStorageInfo* vstorage = nullptr);
 
 // Build a Table file from the contents of *iter.  The generated file
 // will be named according to number specified in meta. On success, the rest of
@@ -62,6 +64,8 @@ TableBuilder* NewTableBuilder(
 //
 // @param column_family_name Name of the column family that is also identified
 //    by column_family_id, or empty string if unknown.
+// @param vstorage The version the table is added to, if known. Passed to
+//    NewTableBuilder().
 extern Status BuildTable(
     const std::string& dbname, Env* env, const ImmutableCFOptions& options,
     const MutableCFOptions& mutable_cf_options, const EnvOptions& env_options,
@@ -80,6 +84,7 @@ extern Status BuildTable(
     const Env::IOPriority io_priority = Env::IO_HIGH,
     TableProperties* table_properties = nullptr, int level = -1,
     const uint64_t creation_time = 0, const uint64_t oldest_key_time = 0,
-    Env::WriteLifeTimeHint write_hint = Env::WLTH_NOT_SET);
+    Env::WriteLifeTimeHint write_hint = Env::WLTH_NOT_SET,
+    const VersionStorageInfo* vstorage = nullptr);
 
 }  // namespace rocksdb
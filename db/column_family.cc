@@ -233,6 +233,18 @@ ColumnFamilyOptions SanitizeOptions(const ImmutableDBOptions& db_options,
     result.memtable_prefix_bloom_size_ratio = 0;
   }
 
+  if (result.memtable_protection_bytes_per_key != 0) {
+    if (result.inplace_update_support) {
+      // In-place updates would overwrite values under their checksums
+      ROCKS_LOG_WARN(db_options.info_log.get(),
+                     "memtable_protection_bytes_per_key is not supported with "
+                     "inplace_update_support");
+      result.memtable_protection_bytes_per_key = 0;
+    } else {
+      result.memtable_protection_bytes_per_key = 4;
+    }
+  }
+
   if (!result.prefix_extractor) {
     assert(result.memtable_factory);
     Slice name = result.memtable_factory->Name();
@@ -411,7 +423,10 @@ ColumnFamilyData::ColumnFamilyData(
       dropped_(false),
       internal_comparator_(cf_options.comparator),
       initial_cf_options_(SanitizeOptions(db_options, cf_options)),
-      ioptions_(db_options, initial_cf_options_),
+      ioptions_(db_options, initial_cf_options_,
+                initial_cf_options_.row_cache_size > 0
+                    ? NewLRUCache(initial_cf_options_.row_cache_size)
+                    : db_options.row_cache),
       mutable_cf_options_(initial_cf_options_),
       is_delete_range_supported_(
           cf_options.table_factory->IsDeleteRangeSupported()),
@@ -430,6 +445,8 @@ ColumnFamilyData::ColumnFamilyData(
       queued_for_flush_(false),
       queued_for_compaction_(false),
       prev_compaction_needed_bytes_(0),
+      prev_l0_delay_trigger_count_(0),
+      enable_write_stall_pacing_(db_options.enable_write_stall_pacing),
       allow_2pc_(db_options.allow_2pc),
       last_memtable_id_(0) {
   Ref();
@@ -441,6 +458,10 @@ ColumnFamilyData::ColumnFamilyData(
   if (_dummy_versions != nullptr) {
     internal_stats_.reset(
         new InternalStats(ioptions_.num_levels, db_options.env, this));
+    if (db_options.enable_per_column_family_write_stall) {
+      write_stall_controller_.reset(new WriteController(
+          column_family_set_->write_controller_->max_delayed_write_rate()));
+    }
     table_cache_.reset(new TableCache(ioptions_, env_options, _table_cache));
     if (ioptions_.compaction_style == kCompactionStyleLevel) {
       compaction_picker_.reset(
@@ -545,6 +566,7 @@ void ColumnFamilyData::SetDropped() {
   assert(id_ != 0);
   dropped_ = true;
   write_controller_token_.reset();
+  shared_compaction_pressure_token_.reset();
 
   // remove from column_family_set
   column_family_set_->RemoveColumnFamily(this);
@@ -676,6 +698,67 @@ int GetL0ThresholdSpeedupCompaction(int level0_file_num_compaction_trigger,
     return static_cast<int>(res);
   }
 }
+
+// Returns a score between 0 and 1 of how far the column family is predicted
+// to be on its way from the point where compactions are sped up to the
+// slowdown condition. The L0 file count and the compaction debt are
+// extrapolated by one more step of their change since the previous
+// recalculation, i.e. of what flushes added minus what compactions removed.
+double GetWriteStallPacingScore(int num_l0_files, int prev_num_l0_files,
+                                uint64_t compaction_needed_bytes,
+                                uint64_t prev_compaction_needed_bytes,
+                                const MutableCFOptions& mutable_cf_options) {
+  double score = 0.0;
+  if (mutable_cf_options.level0_slowdown_writes_trigger >= 0) {
+    const int l0_start = GetL0ThresholdSpeedupCompaction(
+        mutable_cf_options.level0_file_num_compaction_trigger,
+        mutable_cf_options.level0_slowdown_writes_trigger);
+    const int l0_end = mutable_cf_options.level0_slowdown_writes_trigger;
+    const int predicted_l0_files =
+        num_l0_files + std::max(0, num_l0_files - prev_num_l0_files);
+    if (l0_start < l0_end && predicted_l0_files > l0_start) {
+      score = static_cast<double>(predicted_l0_files - l0_start) /
+              (l0_end - l0_start);
+    }
+  }
+  const uint64_t soft_limit =
+      mutable_cf_options.soft_pending_compaction_bytes_limit;
+  if (soft_limit > 0) {
+    const uint64_t bytes_start = soft_limit / 2;
+    uint64_t predicted_bytes = compaction_needed_bytes;
+    // Ignore prev_compaction_needed_bytes = 0 for the same reason as in
+    // SetupDelay().
+    if (prev_compaction_needed_bytes > 0 &&
+        compaction_needed_bytes > prev_compaction_needed_bytes) {
+      predicted_bytes += compaction_needed_bytes - prev_compaction_needed_bytes;
+    }
+    if (predicted_bytes > bytes_start) {
+      score = std::max(score,
+                       static_cast<double>(predicted_bytes - bytes_start) /
+                           static_cast<double>(soft_limit - bytes_start));
+    }
+  }
+  return std::min(score, 1.0);
+}
+
+// Paces writes ahead of the slowdown condition. The rate goes down linearly
+// with the pacing score, to kNearStopSlowdownRatio of the max delayed write
+// rate when the slowdown condition is predicted to be hit, so SetupDelay()
+// takes over from there without a jump. It goes back up at most by
+// kDelayRecoverSlowdownRatio per recalculation.
+std::unique_ptr<WriteControllerToken> SetupPacing(
+    WriteController* write_controller, double pacing_score) {
+  uint64_t write_rate = static_cast<uint64_t>(
+      static_cast<double>(write_controller->max_delayed_write_rate()) *
+      (1.0 - pacing_score * (1.0 - kNearStopSlowdownRatio)));
+  if (write_controller->NeedsDelay()) {
+    uint64_t max_increased_rate = static_cast<uint64_t>(
+        static_cast<double>(write_controller->delayed_write_rate()) *
+        kDelayRecoverSlowdownRatio);
+    write_rate = std::min(write_rate, max_increased_rate);
+  }
+  return write_controller->GetDelayToken(write_rate);
+}
 }  // namespace
 
 std::pair<WriteStallCondition, ColumnFamilyData::WriteStallCause>
@@ -718,7 +801,9 @@ WriteStallCondition ColumnFamilyData::RecalculateWriteStallConditions(
   auto write_stall_condition = WriteStallCondition::kNormal;
   if (current_ != nullptr) {
     auto* vstorage = current_->storage_info();
-    auto write_controller = column_family_set_->write_controller_;
+    auto write_controller = write_stall_controller_ != nullptr
+                                ? write_stall_controller_.get()
+                                : column_family_set_->write_controller_;
     uint64_t compaction_needed_bytes =
         vstorage->estimated_compaction_needed_bytes();
 
@@ -824,7 +909,24 @@ WriteStallCondition ColumnFamilyData::RecalculateWriteStallConditions(
           write_controller->delayed_write_rate());
     } else {
       assert(write_stall_condition == WriteStallCondition::kNormal);
-      if (vstorage->l0_delay_trigger_count() >=
+      double pacing_score = 0.0;
+      if (enable_write_stall_pacing_ &&
+          !mutable_cf_options.disable_auto_compactions) {
+        pacing_score = GetWriteStallPacingScore(
+            vstorage->l0_delay_trigger_count(), prev_l0_delay_trigger_count_,
+            compaction_needed_bytes, prev_compaction_needed_bytes_,
+            mutable_cf_options);
+      }
+      if (pacing_score > 0.0) {
+        write_controller_token_ =
+            SetupPacing(write_controller, pacing_score);
+        ROCKS_LOG_INFO(
+            ioptions_.info_log,
+            "[%s] Pacing writes because we have %d level-0 files and "
+            "estimated pending compaction bytes %" PRIu64 " rate %" PRIu64,
+            name_.c_str(), vstorage->l0_delay_trigger_count(),
+            compaction_needed_bytes, write_controller->delayed_write_rate());
+      } else if (vstorage->l0_delay_trigger_count() >=
           GetL0ThresholdSpeedupCompaction(
               mutable_cf_options.level0_file_num_compaction_trigger,
               mutable_cf_options.level0_slowdown_writes_trigger)) {
@@ -856,8 +958,8 @@ WriteStallCondition ColumnFamilyData::RecalculateWriteStallConditions(
       }
       // If the DB recovers from delay conditions, we reward with reducing
       // double the slowdown ratio. This is to balance the long term slowdown
-      // increase signal.
-      if (needed_delay) {
+      // increase signal. Paced writes ramp up in SetupPacing() instead.
+      if (needed_delay && pacing_score == 0.0) {
         uint64_t write_rate = write_controller->delayed_write_rate();
         write_controller->set_delayed_write_rate(static_cast<uint64_t>(
             static_cast<double>(write_rate) * kDelayRecoverSlowdownRatio));
@@ -870,6 +972,19 @@ WriteStallCondition ColumnFamilyData::RecalculateWriteStallConditions(
       }
     }
     prev_compaction_needed_bytes_ = compaction_needed_bytes;
+    prev_l0_delay_trigger_count_ = vstorage->l0_delay_trigger_count();
+
+    // Compaction threads are shared, so they are sped up for every column
+    // family that is stalled or under compaction pressure. This also tells
+    // writers that some column family may be stalled.
+    if (write_stall_controller_ != nullptr) {
+      if (!write_stall_controller_->NeedSpeedupCompaction()) {
+        shared_compaction_pressure_token_.reset();
+      } else if (shared_compaction_pressure_token_ == nullptr) {
+        shared_compaction_pressure_token_ =
+            column_family_set_->write_controller_->GetCompactionPressureToken();
+      }
+    }
   }
   return write_stall_condition;
 }
@@ -1028,21 +1143,23 @@ SuperVersion* ColumnFamilyData::GetThreadLocalSuperVersion(
     InstrumentedMutex* db_mutex) {
   // The SuperVersion is cached in thread local storage to avoid acquiring
   // mutex when SuperVersion does not change since the last use. When a new
-  // SuperVersion is installed, the compaction or flush thread cleans up
-  // cached SuperVersion in all existing thread local storage. To avoid
-  // acquiring mutex for this operation, we use atomic Swap() on the thread
-  // local pointer to guarantee exclusive access. If the thread local pointer
-  // is being used while a new SuperVersion is installed, the cached
-  // SuperVersion can become stale. In that case, the background thread would
-  // have swapped in kSVObsolete. We re-check the value at when returning
-  // SuperVersion back to thread local, with an atomic compare and swap.
-  // The superversion will need to be released if detected to be stale.
+  // SuperVersion is installed, the compaction or flush thread replaces the
+  // cached SuperVersion in all existing thread local storage with the new
+  // one, holding a reference to it for each thread, so that threads do not
+  // need the mutex to get the new one either. To avoid acquiring mutex for
+  // this operation, we use atomic Swap() on the thread local pointer to
+  // guarantee exclusive access. If the thread local pointer is being used
+  // while a new SuperVersion is installed, the SuperVersion in use becomes
+  // stale, and the background thread would have put the new one in its
+  // place. We re-check the value at when returning SuperVersion back to
+  // thread local, with an atomic compare and swap. The superversion will
+  // need to be released if detected to be stale.
   void* ptr = local_sv_->Swap(SuperVersion::kSVInUse);
   // Invariant:
-  // (1) Scrape (always) installs kSVObsolete in ThreadLocal storage
+  // (1) Replace never installs kSVInUse in ThreadLocal storage
   // (2) the Swap above (always) installs kSVInUse, ThreadLocal storage
   // should only keep kSVInUse before ReturnThreadLocalSuperVersion call
-  // (if no Scrape happens).
+  // (if no Replace happens).
   assert(ptr != SuperVersion::kSVInUse);
   SuperVersion* sv = static_cast<SuperVersion*>(ptr);
   if (sv == SuperVersion::kSVObsolete ||
@@ -1079,10 +1196,11 @@ bool ColumnFamilyData::ReturnThreadLocalSuperVersion(SuperVersion* sv) {
     // SuperVersion is still current.
     return true;
   } else {
-    // ThreadLocal scrape happened in the process of this GetImpl call (after
-    // thread local Swap() at the beginning and before CompareAndSwap()).
-    // This means the SuperVersion it holds is obsolete.
-    assert(expected == SuperVersion::kSVObsolete);
+    // ThreadLocal replace happened in the process of this GetImpl call
+    // (after thread local Swap() at the beginning and before
+    // CompareAndSwap()). This means the SuperVersion it holds is obsolete,
+    // and the thread local storage already holds the new one.
+    assert(expected != SuperVersion::kSVInUse);
   }
   return false;
 }
@@ -1132,12 +1250,15 @@ void ColumnFamilyData::InstallSuperVersion(
 }
 
 void ColumnFamilyData::ResetThreadLocalSuperVersions() {
-  autovector<void*> sv_ptrs;
-  local_sv_->Scrape(&sv_ptrs, SuperVersion::kSVObsolete);
-  for (auto ptr : sv_ptrs) {
-    assert(ptr);
+  // Every thread that has used a SuperVersion gets super_version_ in its
+  // place, with a reference of its own. Threads that never read from this
+  // column family get nothing.
+  SuperVersion* new_sv = super_version_;
+  local_sv_->Replace(new_sv, [new_sv](void* ptr) {
+    new_sv->Ref();
     if (ptr == SuperVersion::kSVInUse) {
-      continue;
+      // The thread releases the SuperVersion in use when it returns it
+      return;
     }
     auto sv = static_cast<SuperVersion*>(ptr);
     bool was_last_ref __attribute__((__unused__));
@@ -1146,7 +1267,7 @@ void ColumnFamilyData::ResetThreadLocalSuperVersions() {
     // ResetThreadLocalSuperVersions() is called before
     // unref'ing super_version_.
     assert(!was_last_ref);
-  }
+  });
 }
 
 #ifndef ROCKSDB_LITE
@@ -342,6 +342,9 @@ class ColumnFamilyData {
   void InstallSuperVersion(SuperVersionContext* sv_context,
                            InstrumentedMutex* db_mutex);
 
+  // Replaces the SuperVersions cached in thread local storage with
+  // super_version_.
+  // REQUIRES: DB mutex held
   void ResetThreadLocalSuperVersions();
 
   // Protected by DB mutex
@@ -369,6 +372,13 @@ class ColumnFamilyData {
   WriteStallCondition RecalculateWriteStallConditions(
       const MutableCFOptions& mutable_cf_options);
 
+  // The write controller of this column family alone if
+  // enable_per_column_family_write_stall is set, nullptr otherwise.
+  // Protected by DB mutex
+  WriteController* write_stall_controller() {
+    return write_stall_controller_.get();
+  }
+
   void set_initialized() { initialized_.store(true); }
 
   bool initialized() const { return initialized_.load(); }
@@ -450,7 +460,14 @@ class ColumnFamilyData {
 
   ColumnFamilySet* column_family_set_;
 
+  // Only set with enable_per_column_family_write_stall. The stop and delay
+  // tokens of this column family are then taken from it, and
+  // shared_compaction_pressure_token_ is held on the DB wide controller as
+  // long as it asks for faster compactions.
+  std::unique_ptr<WriteController> write_stall_controller_;
+
   std::unique_ptr<WriteControllerToken> write_controller_token_;
+  std::unique_ptr<WriteControllerToken> shared_compaction_pressure_token_;
 
   // If true --> this ColumnFamily is currently present in DBImpl::flush_queue_
   bool queued_for_flush_;
@@ -460,6 +477,10 @@ class ColumnFamilyData {
   bool queued_for_compaction_;
 
   uint64_t prev_compaction_needed_bytes_;
+  int prev_l0_delay_trigger_count_;
+
+  // if writes are paced ahead of the slowdown conditions
+  bool enable_write_stall_pacing_;
 
   // if the database was opened with 2pc enabled
   bool allow_2pc_;
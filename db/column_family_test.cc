@@ -2662,6 +2662,153 @@ TEST_P(ColumnFamilyTest, WriteStallSingleColumnFamily) {
   ASSERT_EQ(kBaseRate / 1.25, GetDbDelayedWriteRate());
 }
 
+TEST_P(ColumnFamilyTest, PerColumnFamilyWriteStall) {
+  db_options_.enable_per_column_family_write_stall = true;
+
+  Open();
+  CreateColumnFamilies({"one"});
+  ColumnFamilyData* cfd =
+      static_cast<ColumnFamilyHandleImpl*>(db_->DefaultColumnFamily())->cfd();
+  WriteController* cf_write_controller = cfd->write_stall_controller();
+  ASSERT_TRUE(cf_write_controller != nullptr);
+
+  VersionStorageInfo* vstorage = cfd->current()->storage_info();
+
+  MutableCFOptions mutable_cf_options(column_family_options_);
+  mutable_cf_options.level0_slowdown_writes_trigger = 20;
+  mutable_cf_options.level0_stop_writes_trigger = 10000;
+  mutable_cf_options.disable_auto_compactions = false;
+
+  WriteOptions write_options;
+  write_options.no_slowdown = true;
+
+  vstorage->set_l0_delay_trigger_count(10000);
+  cfd->RecalculateWriteStallConditions(mutable_cf_options);
+  ASSERT_TRUE(cf_write_controller->IsStopped());
+  ASSERT_TRUE(!IsDbWriteStopped());
+  ASSERT_TRUE(dbfull()->TEST_write_controler().NeedSpeedupCompaction());
+  ASSERT_TRUE(
+      db_->Put(write_options, handles_[0], "foo", "bar").IsIncomplete());
+  ASSERT_OK(db_->Put(write_options, handles_[1], "foo", "bar"));
+
+  vstorage->set_l0_delay_trigger_count(20);
+  cfd->RecalculateWriteStallConditions(mutable_cf_options);
+  ASSERT_TRUE(!cf_write_controller->IsStopped());
+  ASSERT_TRUE(cf_write_controller->NeedsDelay());
+  ASSERT_TRUE(!dbfull()->TEST_write_controler().NeedsDelay());
+  ASSERT_OK(db_->Put(write_options, handles_[1], "foo", "bar"));
+
+  vstorage->set_l0_delay_trigger_count(0);
+  cfd->RecalculateWriteStallConditions(mutable_cf_options);
+  ASSERT_TRUE(!cf_write_controller->NeedsDelay());
+  ASSERT_TRUE(!dbfull()->TEST_write_controler().NeedSpeedupCompaction());
+  ASSERT_OK(db_->Put(write_options, handles_[0], "foo", "bar"));
+  ASSERT_EQ("bar", Get(0, "foo"));
+  ASSERT_EQ("bar", Get(1, "foo"));
+}
+
+TEST_P(ColumnFamilyTest, WriteStallPacingSingleColumnFamily) {
+  const uint64_t kBaseRate = 800000u;
+  db_options_.delayed_write_rate = kBaseRate;
+  db_options_.max_background_compactions = 6;
+  db_options_.enable_write_stall_pacing = true;
+
+  Open({"default"});
+  ColumnFamilyData* cfd =
+      static_cast<ColumnFamilyHandleImpl*>(db_->DefaultColumnFamily())->cfd();
+
+  VersionStorageInfo* vstorage = cfd->current()->storage_info();
+
+  MutableCFOptions mutable_cf_options(column_family_options_);
+
+  // Speed up threshold = min(4 * 2, 4 + (36 - 4)/4) = 8
+  mutable_cf_options.level0_file_num_compaction_trigger = 4;
+  mutable_cf_options.level0_slowdown_writes_trigger = 36;
+  mutable_cf_options.level0_stop_writes_trigger = 50;
+  // Pacing starts at 200 / 2 = 100
+  mutable_cf_options.soft_pending_compaction_bytes_limit = 200;
+  mutable_cf_options.hard_pending_compaction_bytes_limit = 2000;
+  mutable_cf_options.disable_auto_compactions = false;
+
+  // Predicted 4 + 4 = 8 files
+  vstorage->set_l0_delay_trigger_count(4);
+  cfd->RecalculateWriteStallConditions(mutable_cf_options);
+  ASSERT_TRUE(!IsDbWriteStopped());
+  ASSERT_TRUE(!dbfull()->TEST_write_controler().NeedsDelay());
+
+  // Predicted 8 + 4 = 12 files
+  vstorage->set_l0_delay_trigger_count(8);
+  cfd->RecalculateWriteStallConditions(mutable_cf_options);
+  ASSERT_TRUE(!IsDbWriteStopped());
+  ASSERT_TRUE(dbfull()->TEST_write_controler().NeedsDelay());
+  ASSERT_EQ(754285u, GetDbDelayedWriteRate());
+  ASSERT_EQ(6, dbfull()->TEST_BGCompactionsAllowed());
+
+  // L0 does not grow any more
+  vstorage->set_l0_delay_trigger_count(8);
+  cfd->RecalculateWriteStallConditions(mutable_cf_options);
+  ASSERT_TRUE(!IsDbWriteStopped());
+  ASSERT_TRUE(!dbfull()->TEST_write_controler().NeedsDelay());
+  ASSERT_EQ(6, dbfull()->TEST_BGCompactionsAllowed());
+
+  // Predicted 22 + 14 = 36 files, the slowdown trigger
+  vstorage->set_l0_delay_trigger_count(22);
+  cfd->RecalculateWriteStallConditions(mutable_cf_options);
+  ASSERT_TRUE(!IsDbWriteStopped());
+  ASSERT_TRUE(dbfull()->TEST_write_controler().NeedsDelay());
+  ASSERT_EQ(kBaseRate * 6 / 10, GetDbDelayedWriteRate());
+
+  // Predicted 22 files, half way. The rate only goes up by 1.4x at a time.
+  vstorage->set_l0_delay_trigger_count(22);
+  cfd->RecalculateWriteStallConditions(mutable_cf_options);
+  ASSERT_TRUE(dbfull()->TEST_write_controler().NeedsDelay());
+  ASSERT_EQ(kBaseRate * 8 / 10, GetDbDelayedWriteRate());
+
+  vstorage->set_l0_delay_trigger_count(8);
+  cfd->RecalculateWriteStallConditions(mutable_cf_options);
+  ASSERT_TRUE(!dbfull()->TEST_write_controler().NeedsDelay());
+
+  vstorage->set_l0_delay_trigger_count(22);
+  cfd->RecalculateWriteStallConditions(mutable_cf_options);
+  ASSERT_EQ(kBaseRate * 6 / 10, GetDbDelayedWriteRate());
+  vstorage->set_l0_delay_trigger_count(22);
+  cfd->RecalculateWriteStallConditions(mutable_cf_options);
+  ASSERT_EQ(kBaseRate * 8 / 10, GetDbDelayedWriteRate());
+
+  // Hitting the slowdown trigger continues from the paced rate.
+  vstorage->set_l0_delay_trigger_count(36);
+  cfd->RecalculateWriteStallConditions(mutable_cf_options);
+  ASSERT_TRUE(!IsDbWriteStopped());
+  ASSERT_TRUE(dbfull()->TEST_write_controler().NeedsDelay());
+  ASSERT_EQ(kBaseRate * 8 / 10, GetDbDelayedWriteRate());
+
+  vstorage->set_l0_delay_trigger_count(0);
+  cfd->RecalculateWriteStallConditions(mutable_cf_options);
+  ASSERT_TRUE(!IsDbWriteStopped());
+  ASSERT_TRUE(!dbfull()->TEST_write_controler().NeedsDelay());
+
+  // Pending compaction bytes past half of the soft limit are paced as well.
+  dbfull()->TEST_write_controler().set_delayed_write_rate(kBaseRate);
+  vstorage->TEST_set_estimated_compaction_needed_bytes(150);
+  cfd->RecalculateWriteStallConditions(mutable_cf_options);
+  ASSERT_TRUE(!IsDbWriteStopped());
+  ASSERT_TRUE(dbfull()->TEST_write_controler().NeedsDelay());
+  ASSERT_EQ(kBaseRate * 8 / 10, GetDbDelayedWriteRate());
+
+  vstorage->TEST_set_estimated_compaction_needed_bytes(90);
+  cfd->RecalculateWriteStallConditions(mutable_cf_options);
+  ASSERT_TRUE(!IsDbWriteStopped());
+  ASSERT_TRUE(!dbfull()->TEST_write_controler().NeedsDelay());
+
+  // No pacing without auto compactions.
+  mutable_cf_options.disable_auto_compactions = true;
+  vstorage->set_l0_delay_trigger_count(30);
+  vstorage->TEST_set_estimated_compaction_needed_bytes(190);
+  cfd->RecalculateWriteStallConditions(mutable_cf_options);
+  ASSERT_TRUE(!IsDbWriteStopped());
+  ASSERT_TRUE(!dbfull()->TEST_write_controler().NeedsDelay());
+}
+
 TEST_P(ColumnFamilyTest, CompactionSpeedupSingleColumnFamily) {
   db_options_.max_background_compactions = 6;
   Open({"default"});
@@ -1494,7 +1494,8 @@ Status CompactionJob::OpenCompactionOutputFile(
       sub_compact->compaction->output_compression(),
       sub_compact->compaction->output_compression_opts(),
       sub_compact->compaction->output_level(), &sub_compact->compression_dict,
-      skip_filters, output_file_creation_time));
+      skip_filters, output_file_creation_time, 0 /* oldest_key_time */,
+      sub_compact->compaction->input_version()->storage_info()));
   LogFlush(db_options_.info_log);
   return s;
 }
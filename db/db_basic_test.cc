@@ -760,6 +760,83 @@ TEST_F(DBBasicTest, MultiGetSimple) {
   } while (ChangeCompactOptions());
 }
 
+TEST_F(DBBasicTest, MultiGetBatched) {
+  Options options = CurrentOptions();
+  options.statistics = rocksdb::CreateDBStatistics();
+  options.merge_operator = MergeOperators::CreateStringAppendOperator();
+  options.disable_auto_compactions = true;
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 4096;
+  table_options.filter_policy.reset(NewBloomFilterPolicy(10, false));
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  CreateAndReopenWithCF({"pikachu"}, options);
+
+  // Bottom level
+  for (int i = 0; i < 1000; ++i) {
+    ASSERT_OK(Put(1, Key(i), "base" + ToString(i)));
+  }
+  ASSERT_OK(Flush(1));
+  MoveFilesToLevel(2, 1);
+  // Two overlapping L0 files, and the memtable
+  for (int i = 0; i < 1000; i += 3) {
+    ASSERT_OK(Put(1, Key(i), "l0a" + ToString(i)));
+  }
+  ASSERT_OK(Delete(1, Key(1)));
+  ASSERT_OK(Flush(1));
+  for (int i = 0; i < 1000; i += 5) {
+    ASSERT_OK(Merge(1, Key(i), "m" + ToString(i)));
+  }
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), handles_[1], Key(500), Key(510)));
+  ASSERT_OK(Flush(1));
+  ASSERT_OK(Put(1, Key(7), "mem"));
+
+  // Unsorted, with duplicates, and with keys of another column family
+  std::vector<std::string> key_strs;
+  std::vector<ColumnFamilyHandle*> cfs;
+  for (int i = 999; i >= 0; i -= 2) {
+    key_strs.push_back(Key(i));
+    cfs.push_back(handles_[1]);
+  }
+  key_strs.push_back(Key(2));
+  cfs.push_back(handles_[1]);
+  key_strs.push_back(Key(2));
+  cfs.push_back(handles_[1]);
+  key_strs.push_back(Key(4));
+  cfs.push_back(handles_[0]);
+  key_strs.push_back(Key(1000));
+  cfs.push_back(handles_[1]);
+  std::vector<Slice> keys(key_strs.begin(), key_strs.end());
+
+  for (auto* snapshot : {static_cast<const Snapshot*>(nullptr),
+                         db_->GetSnapshot()}) {
+    ReadOptions ro;
+    ro.snapshot = snapshot;
+    std::vector<std::string> values;
+    uint64_t block_reads_before =
+        TestGetTickerCount(options, BLOCK_CACHE_DATA_HIT) +
+        TestGetTickerCount(options, BLOCK_CACHE_DATA_MISS);
+    std::vector<Status> statuses = db_->MultiGet(ro, cfs, keys, &values);
+    uint64_t block_reads = TestGetTickerCount(options, BLOCK_CACHE_DATA_HIT) +
+                           TestGetTickerCount(options, BLOCK_CACHE_DATA_MISS) -
+                           block_reads_before;
+    ASSERT_EQ(keys.size(), statuses.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+      std::string value;
+      Status s = db_->Get(ro, cfs[i], keys[i], &value);
+      ASSERT_EQ(s.ToString(), statuses[i].ToString()) << key_strs[i];
+      if (s.ok()) {
+        ASSERT_EQ(value, values[i]) << key_strs[i];
+      }
+    }
+    ASSERT_EQ("mem", values[(999 - 7) / 2]);
+    // A data block holds dozens of keys and is read once for all of them.
+    ASSERT_LT(block_reads, keys.size() / 4);
+    if (snapshot != nullptr) {
+      db_->ReleaseSnapshot(snapshot);
+    }
+  }
+}
+
 TEST_F(DBBasicTest, MultiGetEmpty) {
   do {
     CreateAndReopenWithCF({"pikachu"}, CurrentOptions());
@@ -569,6 +569,82 @@ TEST_F(DBBloomFilterTest, BloomFilterReverseCompatibility) {
   }
 }
 
+TEST_F(DBBloomFilterTest, SplitBlockFilter) {
+  Options options = CurrentOptions();
+  options.statistics = rocksdb::CreateDBStatistics();
+  BlockBasedTableOptions table_options;
+  table_options.filter_policy.reset(NewBloomFilterPolicy(10, false, true));
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  const int kNumKeys = 1000;
+  for (int i = 0; i < kNumKeys; i += 2) {
+    ASSERT_OK(Put(Key(i), Key(i)));
+  }
+  ASSERT_OK(Flush());
+
+  std::vector<std::string> key_strs;
+  for (int i = 0; i < kNumKeys; i++) {
+    key_strs.push_back(Key(i));
+  }
+  std::vector<Slice> keys(key_strs.begin(), key_strs.end());
+  std::vector<std::string> values;
+  std::vector<Status> statuses = db_->MultiGet(ReadOptions(), keys, &values);
+  for (int i = 0; i < kNumKeys; i++) {
+    if (i % 2 == 0) {
+      ASSERT_OK(statuses[i]);
+      ASSERT_EQ(Key(i), values[i]);
+    } else {
+      ASSERT_TRUE(statuses[i].IsNotFound());
+    }
+  }
+  // Most of the missing keys are filtered out
+  ASSERT_GT(TestGetTickerCount(options, BLOOM_FILTER_USEFUL),
+            static_cast<uint64_t>(kNumKeys / 2 * 9 / 10));
+  uint64_t useful = TestGetTickerCount(options, BLOOM_FILTER_USEFUL);
+  ASSERT_EQ("NOT_FOUND", Get(Key(1)));
+  ASSERT_EQ(Key(2), Get(Key(2)));
+
+  // A full filter policy can read the split block filters
+  table_options.filter_policy.reset(NewBloomFilterPolicy(10, false));
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  Reopen(options);
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ(i % 2 == 0 ? Key(i) : "NOT_FOUND", Get(Key(i)));
+  }
+  ASSERT_GT(TestGetTickerCount(options, BLOOM_FILTER_USEFUL), useful);
+}
+
+TEST_F(DBBloomFilterTest, XorFilter) {
+  for (bool partition_filters : {false, true}) {
+    Options options = CurrentOptions();
+    options.statistics = rocksdb::CreateDBStatistics();
+    BlockBasedTableOptions table_options;
+    if (partition_filters) {
+      table_options.partition_filters = true;
+      table_options.index_type =
+          BlockBasedTableOptions::IndexType::kTwoLevelIndexSearch;
+      table_options.metadata_block_size = 256;
+    }
+    table_options.filter_policy.reset(NewXorFilterPolicy(10));
+    options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+    DestroyAndReopen(options);
+
+    const int kNumKeys = 2000;
+    for (int i = 0; i < kNumKeys; i += 2) {
+      ASSERT_OK(Put(Key(i), Key(i)));
+    }
+    ASSERT_OK(Flush());
+
+    for (int i = 0; i < kNumKeys; i++) {
+      ASSERT_EQ(i % 2 == 0 ? Key(i) : "NOT_FOUND", Get(Key(i)));
+    }
+    // 8-bit fingerprints let through about 1 / 256 of the missing keys
+    ASSERT_GT(TestGetTickerCount(options, BLOOM_FILTER_USEFUL),
+              static_cast<uint64_t>(kNumKeys / 2 * 95 / 100));
+  }
+}
+
 namespace {
 // A wrapped bloom over default FilterPolicy
 class WrappedBloom : public FilterPolicy {
@@ -1571,6 +1647,66 @@ TEST_F(DBBloomFilterTest, DynamicBloomFilterOptions) {
   }
 }
 
+TEST_F(DBBloomFilterTest, LevelAdaptiveBloomFilter) {
+  Options options = CurrentOptions();
+  options.num_levels = 7;
+  options.level_compaction_dynamic_level_bytes = true;
+  options.disable_auto_compactions = true;
+  BlockBasedTableOptions table_options;
+  table_options.filter_policy.reset(NewLevelAdaptiveBloomFilterPolicy(10));
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  // Bits per key of the filters, by number of keys of the table
+  auto get_filter_bits = [&]() {
+    std::map<uint64_t, double> filter_bits;
+    TablePropertiesCollection props;
+    EXPECT_OK(db_->GetPropertiesOfAllTables(&props));
+    for (auto& table : props) {
+      filter_bits[table.second->num_entries] =
+          8.0 * table.second->filter_size / table.second->num_entries;
+    }
+    return filter_bits;
+  };
+
+  // The last level is written first, as the deepest level, and gets ~9 bits
+  // per key
+  const int kNumKeys = 10000;
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_OK(Put(Key(i), "val"));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ("0,0,0,0,0,0,1", FilesPerLevel());
+
+  // L0 is only one level above the base level, which is the last level, so
+  // L0 files get ~14 bits per key. The first one is sized by the level
+  // multiplier, the second by the actual size of L0.
+  for (int num_keys : {1000, 500}) {
+    for (int i = 0; i < num_keys; i++) {
+      ASSERT_OK(Put(Key(i), "val"));
+    }
+    ASSERT_OK(Flush());
+  }
+  ASSERT_EQ("2,0,0,0,0,0,1", FilesPerLevel());
+  auto filter_bits = get_filter_bits();
+  ASSERT_EQ(3U, filter_bits.size());
+  ASSERT_LT(filter_bits[kNumKeys], 10);
+  ASSERT_GT(filter_bits[1000], 1.3 * filter_bits[kNumKeys]);
+  ASSERT_LT(filter_bits[1000], 20);
+  ASSERT_GT(filter_bits[500], 1.3 * filter_bits[kNumKeys]);
+  ASSERT_LT(filter_bits[500], 20);
+
+  // Filters built with the adaptive policy are readable by the plain one
+  table_options.filter_policy.reset(NewBloomFilterPolicy(10, false));
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  Reopen(options);
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ("val", Get(Key(i)));
+  }
+  ASSERT_EQ("NOT_FOUND", Get(Key(kNumKeys)));
+}
+
 #endif  // ROCKSDB_LITE
 
 }  // namespace rocksdb
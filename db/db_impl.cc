@@ -169,6 +169,7 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
           static_cast<int64_t>(mutable_db_options_.delayed_write_rate / 8),
           kDefaultLowPriThrottledRate))),
       last_batch_group_size_(0),
+      write_buffer_flush_requested_(false),
       unscheduled_flushes_(0),
       unscheduled_compactions_(0),
       bg_bottom_compaction_scheduled_(0),
@@ -230,6 +231,12 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
                                    : mutable_db_options_.max_open_files - 10;
   table_cache_ = NewLRUCache(table_cache_size,
                              immutable_db_options_.table_cache_numshardbits);
+  // With seq_per_batch_, writes can become visible when they are committed,
+  // without the memtable inserts that invalidate the hot key cache
+  if (immutable_db_options_.hot_key_cache_size > 0 && !seq_per_batch_) {
+    hot_key_cache_.reset(
+        new HotKeyCache(immutable_db_options_.hot_key_cache_size));
+  }
 
   versions_.reset(new VersionSet(dbname_, &immutable_db_options_, env_options_,
                                  table_cache_.get(), write_buffer_manager_,
@@ -321,6 +328,11 @@ void DBImpl::CancelAllBackgroundWork(bool wait) {
 }
 
 Status DBImpl::CloseHelper() {
+  // Stop being asked for memtables to flush. Never registered if the DB
+  // failed to open.
+  if (write_buffer_manager_->cost_based_flush()) {
+    write_buffer_manager_->UnregisterFlushCandidateSource(this);
+  }
   // CancelAllBackgroundWork called with false means we just set the shutdown
   // marker. After this we do a variant of the waiting and unschedule work
   // (to consider: moving all the waiting into CancelAllBackgroundWork(true))
@@ -673,6 +685,12 @@ Status DBImpl::SetDBOptions(
 
       write_controller_.set_max_delayed_write_rate(
           new_options.delayed_write_rate);
+      if (immutable_db_options_.enable_per_column_family_write_stall) {
+        for (auto cfd : *versions_->GetColumnFamilySet()) {
+          cfd->write_stall_controller()->set_max_delayed_write_rate(
+              new_options.delayed_write_rate);
+        }
+      }
       table_cache_.get()->SetCapacity(new_options.max_open_files == -1
                                           ? TableCache::kInfiniteCapacity
                                           : new_options.max_open_files - 10);
@@ -1080,6 +1098,44 @@ Status DBImpl::GetImpl(const ReadOptions& read_options,
     }
   }
 
+  // Values changed by compaction filters, or dropped with the files FIFO
+  // compaction deletes, would not invalidate the cache. Other tiers may have
+  // to skip the values it has.
+  const bool use_hot_key_cache =
+      hot_key_cache_ != nullptr && callback == nullptr &&
+      is_blob_index == nullptr && !read_options.ignore_range_deletions &&
+      read_options.read_tier == kReadAllTier &&
+      cfd->ioptions()->compaction_style != kCompactionStyleFIFO &&
+      cfd->ioptions()->compaction_filter == nullptr &&
+      cfd->ioptions()->compaction_filter_factory == nullptr;
+  uint64_t hot_key_cache_epoch = 0;
+  if (use_hot_key_cache) {
+    hot_key_cache_epoch = hot_key_cache_->GetEpoch();
+    SequenceNumber hot_key_snapshot =
+        read_options.snapshot != nullptr
+            ? reinterpret_cast<const SnapshotImpl*>(read_options.snapshot)
+                  ->number_
+            : kMaxSequenceNumber;
+    bool found = false;
+    if (hot_key_cache_->Lookup(cfd->GetID(), key, hot_key_snapshot,
+                               pinnable_val, &found)) {
+      RecordTick(stats_, HOT_KEY_CACHE_HIT);
+      RecordTick(stats_, NUMBER_KEYS_READ);
+      if (!found) {
+        return Status::NotFound();
+      }
+      if (value_found != nullptr) {
+        *value_found = true;
+      }
+      size_t size = pinnable_val->size();
+      RecordTick(stats_, BYTES_READ, size);
+      MeasureTime(stats_, BYTES_PER_READ, size);
+      PERF_COUNTER_ADD(get_read_bytes, size);
+      return Status::OK();
+    }
+    RecordTick(stats_, HOT_KEY_CACHE_MISS);
+  }
+
   // Acquire SuperVersion
   SuperVersion* sv = GetAndRefSuperVersion(cfd);
 
@@ -1163,6 +1219,17 @@ Status DBImpl::GetImpl(const ReadOptions& read_options,
   {
     PERF_TIMER_GUARD(get_post_process_time);
 
+    // Only the latest values are cached. If a newer SuperVersion was
+    // installed, writes up to snapshot may have gone to a memtable that sv
+    // does not have.
+    if (use_hot_key_cache && read_options.snapshot == nullptr &&
+        (s.ok() || s.IsNotFound()) &&
+        sv->version_number == cfd->GetSuperVersionNumber()) {
+      Slice value(*pinnable_val);
+      hot_key_cache_->Insert(cfd->GetID(), key, snapshot, hot_key_cache_epoch,
+                             s.ok() ? &value : nullptr);
+    }
+
     ReturnAndCleanupSuperVersion(cfd, sv);
 
     RecordTick(stats_, NUMBER_KEYS_READ);
@@ -1214,14 +1281,19 @@ std::vector<Status> DBImpl::MultiGet(
   }
   mutex_.Unlock();
 
-  // Contain a list of merge operations if merge occurs.
-  MergeContext merge_context;
-
   // Note: this always resizes the values array
   size_t num_keys = keys.size();
   std::vector<Status> stat_list(num_keys);
   values->resize(num_keys);
 
+  // Contain a list of merge operations for each key if merge occurs.
+  std::vector<MergeContext> merge_contexts(num_keys);
+  std::vector<std::unique_ptr<LookupKey>> lkeys(num_keys);
+  std::vector<std::unique_ptr<RangeDelAggregator>> range_del_aggs(num_keys);
+  // Indexes of the keys not found in the memtables, which are looked up in
+  // the SST files of their column family together
+  std::unordered_map<uint32_t, std::vector<size_t>> keys_to_read;
+
   // Keep track of bytes that we read for statistics-recording later
   uint64_t bytes_read = 0;
   PERF_TIMER_STOP(get_snapshot_time);
@@ -1232,14 +1304,16 @@ std::vector<Status> DBImpl::MultiGet(
   // merge_operands will contain the sequence of merges in the latter case.
   size_t num_found = 0;
   for (size_t i = 0; i < num_keys; ++i) {
-    merge_context.Clear();
+    MergeContext& merge_context = merge_contexts[i];
     Status& s = stat_list[i];
     std::string* value = &(*values)[i];
 
-    LookupKey lkey(keys[i], snapshot);
+    lkeys[i].reset(new LookupKey(keys[i], snapshot));
+    LookupKey& lkey = *lkeys[i];
     auto cfh = reinterpret_cast<ColumnFamilyHandleImpl*>(column_family[i]);
-    RangeDelAggregator range_del_agg(cfh->cfd()->internal_comparator(),
-                                     snapshot);
+    range_del_aggs[i].reset(new RangeDelAggregator(
+        cfh->cfd()->internal_comparator(), snapshot));
+    RangeDelAggregator& range_del_agg = *range_del_aggs[i];
     auto mgd_iter = multiget_cf_data.find(cfh->cfd()->GetID());
     assert(mgd_iter != multiget_cf_data.end());
     auto mgd = mgd_iter->second;
@@ -1260,20 +1334,51 @@ std::vector<Status> DBImpl::MultiGet(
       }
     }
     if (!done) {
-      PinnableSlice pinnable_val;
-      PERF_TIMER_GUARD(get_from_output_files_time);
-      super_version->current->Get(read_options, lkey, &pinnable_val, &s,
-                                  &merge_context, &range_del_agg);
-      value->assign(pinnable_val.data(), pinnable_val.size());
-      RecordTick(stats_, MEMTABLE_MISS);
-    }
-
-    if (s.ok()) {
+      keys_to_read[cfh->cfd()->GetID()].push_back(i);
+    } else if (s.ok()) {
       bytes_read += value->size();
       num_found++;
     }
   }
 
+  for (auto& cf_keys : keys_to_read) {
+    PERF_TIMER_GUARD(get_from_output_files_time);
+    auto mgd = multiget_cf_data[cf_keys.first];
+    std::vector<size_t>& indexes = cf_keys.second;
+    const Comparator* ucmp = mgd->cfd->user_comparator();
+    std::stable_sort(indexes.begin(), indexes.end(),
+                     [&](size_t a, size_t b) {
+                       return ucmp->Compare(keys[a], keys[b]) < 0;
+                     });
+    std::vector<PinnableSlice> pinnable_vals(indexes.size());
+    std::vector<LookupKey*> batch_keys;
+    std::vector<PinnableSlice*> batch_values;
+    std::vector<Status*> batch_statuses;
+    std::vector<MergeContext*> batch_merge_contexts;
+    std::vector<RangeDelAggregator*> batch_range_del_aggs;
+    for (size_t j = 0; j < indexes.size(); ++j) {
+      size_t i = indexes[j];
+      batch_keys.push_back(lkeys[i].get());
+      batch_values.push_back(&pinnable_vals[j]);
+      batch_statuses.push_back(&stat_list[i]);
+      batch_merge_contexts.push_back(&merge_contexts[i]);
+      batch_range_del_aggs.push_back(range_del_aggs[i].get());
+    }
+    mgd->super_version->current->MultiGet(
+        read_options, batch_keys, batch_values, batch_statuses,
+        batch_merge_contexts, batch_range_del_aggs);
+    RecordTick(stats_, MEMTABLE_MISS, indexes.size());
+    for (size_t j = 0; j < indexes.size(); ++j) {
+      size_t i = indexes[j];
+      std::string* value = &(*values)[i];
+      value->assign(pinnable_vals[j].data(), pinnable_vals[j].size());
+      if (stat_list[i].ok()) {
+        bytes_read += value->size();
+        num_found++;
+      }
+    }
+  }
+
   // Post processing (decrement reference counts and record statistics)
   PERF_TIMER_GUARD(get_post_process_time);
   autovector<SuperVersion*> superversions_to_delete;
@@ -1638,8 +1743,11 @@ ArenaWrappedDBIter* DBImpl::NewIteratorImpl(const ReadOptions& read_options,
                                             SequenceNumber snapshot,
                                             ReadCallback* read_callback,
                                             bool allow_blob,
-                                            bool allow_refresh) {
-  SuperVersion* sv = cfd->GetReferencedSuperVersion(&mutex_);
+                                            bool allow_refresh,
+                                            SuperVersion* sv) {
+  if (sv == nullptr) {
+    sv = cfd->GetReferencedSuperVersion(&mutex_);
+  }
 
   // Try to generate a DB iterator tree in continuous memory area to be
   // cache friendly. Here is an example of result:
@@ -1746,6 +1854,106 @@ Status DBImpl::NewIterators(
   return Status::OK();
 }
 
+namespace {
+// Storage of the iterate bounds of an iterator returned by
+// NewParallelIterators(), which must outlive the iterator
+struct ParallelIteratorBounds {
+  std::string lower;
+  std::string upper;
+  Slice lower_slice;
+  Slice upper_slice;
+};
+
+void DeleteParallelIteratorBounds(void* arg1, void* /*arg2*/) {
+  delete reinterpret_cast<ParallelIteratorBounds*>(arg1);
+}
+}  // namespace
+
+Status DBImpl::NewParallelIterators(const ReadOptions& read_options,
+                                    ColumnFamilyHandle* column_family,
+                                    const RangePtr& range,
+                                    size_t num_iterators,
+                                    std::vector<Iterator*>* iterators) {
+  if (read_options.managed) {
+    return Status::NotSupported("Managed iterator is not supported anymore.");
+  }
+  if (read_options.read_tier == kPersistedTier) {
+    return Status::NotSupported(
+        "ReadTier::kPersistedData is not yet supported in iterators.");
+  }
+  if (read_options.tailing) {
+    return Status::NotSupported("Tailing iterators cannot be split.");
+  }
+  if (num_iterators == 0) {
+    return Status::InvalidArgument("num_iterators must be positive");
+  }
+  iterators->clear();
+  auto* cfd = reinterpret_cast<ColumnFamilyHandleImpl*>(column_family)->cfd();
+  const Comparator* ucmp = cfd->user_comparator();
+  // The range is narrowed by the iterate bounds, if those are narrower
+  const Slice* begin = range.start;
+  if (read_options.iterate_lower_bound != nullptr &&
+      (begin == nullptr ||
+       ucmp->Compare(*read_options.iterate_lower_bound, *begin) > 0)) {
+    begin = read_options.iterate_lower_bound;
+  }
+  const Slice* end = range.limit;
+  if (read_options.iterate_upper_bound != nullptr &&
+      (end == nullptr ||
+       ucmp->Compare(*read_options.iterate_upper_bound, *end) < 0)) {
+    end = read_options.iterate_upper_bound;
+  }
+
+  // Note: no need to consider the special case of
+  // last_seq_same_as_publish_seq_==false as in NewIterators()
+  auto snapshot = read_options.snapshot != nullptr
+                      ? read_options.snapshot->GetSequenceNumber()
+                      : versions_->LastSequence();
+  // All the parts read from this super version, so that none of them can miss
+  // keys the others see at the snapshot, whatever flushes and compactions run
+  // in between. Each part holds a reference to it.
+  SuperVersion* sv = cfd->GetReferencedSuperVersion(&mutex_);
+  std::vector<std::string> split_keys;
+  sv->current->storage_info()->GetSplitKeys(begin, end, num_iterators,
+                                            &split_keys);
+  iterators->reserve(split_keys.size() + 1);
+  for (size_t i = 0; i <= split_keys.size(); i++) {
+    auto* bounds = new ParallelIteratorBounds();
+    ReadOptions part_options = read_options;
+    part_options.iterate_lower_bound = nullptr;
+    part_options.iterate_upper_bound = nullptr;
+    if (i > 0) {
+      bounds->lower = split_keys[i - 1];
+      bounds->lower_slice = bounds->lower;
+      part_options.iterate_lower_bound = &bounds->lower_slice;
+    } else if (begin != nullptr) {
+      bounds->lower = begin->ToString();
+      bounds->lower_slice = bounds->lower;
+      part_options.iterate_lower_bound = &bounds->lower_slice;
+    }
+    if (i < split_keys.size()) {
+      bounds->upper = split_keys[i];
+      bounds->upper_slice = bounds->upper;
+      part_options.iterate_upper_bound = &bounds->upper_slice;
+    } else if (end != nullptr) {
+      bounds->upper = end->ToString();
+      bounds->upper_slice = bounds->upper;
+      part_options.iterate_upper_bound = &bounds->upper_slice;
+    }
+    if (i > 0) {
+      sv->Ref();
+    }
+    // Refresh() would move a part to a newer super version than the others
+    Iterator* iter = NewIteratorImpl(part_options, cfd, snapshot,
+                                     nullptr /* read_callback */,
+                                     false /* allow_blob */,
+                                     false /* allow_refresh */, sv);
+    iter->RegisterCleanup(&DeleteParallelIteratorBounds, bounds, nullptr);
+    iterators->push_back(iter);
+  }
+  return Status::OK();
+}
+
 const Snapshot* DBImpl::GetSnapshot() { return GetSnapshotImpl(false); }
 
 #ifndef ROCKSDB_LITE
@@ -2239,6 +2447,9 @@ Status DBImpl::DeleteFile(std::string name) {
       InstallSuperVersionAndScheduleWork(
           cfd, &job_context.superversion_contexts[0],
           *cfd->GetLatestMutableCFOptions(), FlushReason::kDeleteFiles);
+      if (hot_key_cache_ != nullptr) {
+        hot_key_cache_->InvalidateAll(versions_->LastSequence());
+      }
     }
     FindObsoleteFiles(&job_context, false);
   }  // lock released here
@@ -2324,6 +2535,9 @@ Status DBImpl::DeleteFilesInRanges(ColumnFamilyHandle* column_family,
       InstallSuperVersionAndScheduleWork(
           cfd, &job_context.superversion_contexts[0],
           *cfd->GetLatestMutableCFOptions(), FlushReason::kDeleteFiles);
+      if (hot_key_cache_ != nullptr) {
+        hot_key_cache_->InvalidateAll(versions_->LastSequence());
+      }
     }
     for (auto* deleted_file : deleted_files) {
       deleted_file->being_compacted = false;
@@ -3005,6 +3219,9 @@ Status DBImpl::IngestExternalFile(
     if (status.ok()) {
       InstallSuperVersionAndScheduleWork(cfd, &sv_context, *mutable_cf_options,
                                          FlushReason::kExternalFileIngestion);
+      if (hot_key_cache_ != nullptr) {
+        hot_key_cache_->InvalidateAll(versions_->LastSequence());
+      }
     }
 
     // Resume writes to the DB
@@ -27,6 +27,7 @@
 #include "db/event_helpers.h"
 #include "db/flush_job.h"
 #include "db/flush_scheduler.h"
+#include "db/hot_key_cache.h"
 #include "db/internal_stats.h"
 #include "db/log_writer.h"
 #include "db/logs_with_prep_tracker.h"
@@ -71,7 +72,7 @@ struct JobContext;
 struct ExternalSstFileInfo;
 struct MemTableInfo;
 
-class DBImpl : public DB {
+class DBImpl : public DB, public WriteBufferManager::FlushCandidateSource {
  public:
   DBImpl(const DBOptions& options, const std::string& dbname,
          const bool seq_per_batch = false, const bool batch_per_txn = true);
@@ -151,12 +152,21 @@ class DBImpl : public DB {
       const ReadOptions& options,
       const std::vector<ColumnFamilyHandle*>& column_families,
       std::vector<Iterator*>* iterators) override;
+  virtual Status NewParallelIterators(const ReadOptions& options,
+                                      ColumnFamilyHandle* column_family,
+                                      const RangePtr& range,
+                                      size_t num_iterators,
+                                      std::vector<Iterator*>* iterators)
+      override;
+  // If sv is not null, the iterator reads from it and takes over the caller's
+  // reference to it, instead of referencing the current super version.
   ArenaWrappedDBIter* NewIteratorImpl(const ReadOptions& options,
                                       ColumnFamilyData* cfd,
                                       SequenceNumber snapshot,
                                       ReadCallback* read_callback,
                                       bool allow_blob = false,
-                                      bool allow_refresh = true);
+                                      bool allow_refresh = true,
+                                      SuperVersion* sv = nullptr);
 
   virtual const Snapshot* GetSnapshot() override;
   virtual void ReleaseSnapshot(const Snapshot* snapshot) override;
@@ -351,6 +361,9 @@ class DBImpl : public DB {
   // being detected.
   const Snapshot* GetSnapshotForWriteConflictBoundary();
 
+  // nullptr if DBOptions::hot_key_cache_size is 0
+  HotKeyCache* hot_key_cache() const { return hot_key_cache_.get(); }
+
   // checks if all live files exist on file system and that their file sizes
   // match to our in-memory records
   virtual Status CheckConsistency();
@@ -908,6 +921,12 @@ class DBImpl : public DB {
   Status ThrottleLowPriWritesIfNeeded(const WriteOptions& write_options,
                                       WriteBatch* my_batch);
 
+  // Delays or stops a write to column families that are stalled on their
+  // own, before it joins the write queue.
+  // REQUIRES: enable_per_column_family_write_stall
+  Status DelayWriteForColumnFamilies(const WriteOptions& write_options,
+                                     WriteBatch* my_batch);
+
   Status ScheduleFlushes(WriteContext* context);
 
   Status SwitchMemtable(ColumnFamilyData* cfd, WriteContext* context,
@@ -930,16 +949,32 @@ class DBImpl : public DB {
   // REQUIRES: mutex locked
   Status HandleWriteBufferFull(WriteContext* write_context);
 
+  // WriteBufferManager::FlushCandidateSource. REQUIRES: mutex not locked
+  void GetWriteBufferFlushCandidates(
+      std::vector<WriteBufferManager::FlushCandidate>* candidates) override;
+  void RequestWriteBufferFlush(uint32_t column_family_id) override;
+
+  // Switches the memtables that RequestWriteBufferFlush() could not switch
+  // because a write was in progress. Called by writers once they are done.
+  // REQUIRES: mutex not locked, this thread is not in the write queue
+  void SwitchRequestedMemTables();
+
   // REQUIRES: mutex locked
   Status PreprocessWrite(const WriteOptions& write_options, bool* need_log_sync,
                          WriteContext* write_context);
 
+  // If the group has more than one batch, only the header is merged into
+  // tmp_batch, and wal_parts is set to the header followed by the entries of
+  // each batch, which are written to the WAL without being copied.
   WriteBatch* MergeBatch(const WriteThread::WriteGroup& write_group,
                          WriteBatch* tmp_batch, size_t* write_with_wal,
-                         WriteBatch** to_be_cached_state);
+                         WriteBatch** to_be_cached_state,
+                         std::vector<Slice>* wal_parts);
 
-  Status WriteToWAL(const WriteBatch& merged_batch, log::Writer* log_writer,
-                    uint64_t* log_used, uint64_t* log_size);
+  Status WriteToWAL(const WriteBatch& merged_batch,
+                    const std::vector<Slice>& wal_parts,
+                    log::Writer* log_writer, uint64_t* log_used,
+                    uint64_t* log_size);
 
   Status WriteToWAL(const WriteThread::WriteGroup& write_group,
                     log::Writer* log_writer, uint64_t* log_used,
@@ -1037,6 +1072,9 @@ class DBImpl : public DB {
   // table_cache_ provides its own synchronization
   std::shared_ptr<Cache> table_cache_;
 
+  // Latest values of recently read keys. Provides its own synchronization.
+  std::unique_ptr<HotKeyCache> hot_key_cache_;
+
   // Lock over the persistent DB state.  Non-nullptr iff successfully acquired.
   FileLock* db_lock_;
 
@@ -1208,6 +1246,10 @@ class DBImpl : public DB {
 
   FlushScheduler flush_scheduler_;
 
+  // Set by RequestWriteBufferFlush() before it tries to enter the write
+  // queue, so the writer that holds it switches the memtable on its way out.
+  std::atomic<bool> write_buffer_flush_requested_;
+
   SnapshotList snapshots_;
 
   // For each background job, pending_outputs_ keeps the current file number at
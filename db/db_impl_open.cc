@@ -15,9 +15,12 @@
 
 #include "db/builder.h"
 #include "db/error_handler.h"
+#include "db/write_batch_internal.h"
 #include "options/options_helper.h"
 #include "rocksdb/wal_filter.h"
 #include "table/block_based_table_factory.h"
+#include "util/compression.h"
+#include "util/mutexlock.h"
 #include "util/rate_limiter.h"
 #include "util/sst_file_manager_impl.h"
 #include "util/sync_point.h"
@@ -209,8 +212,158 @@ static Status ValidateOptions(
     return Status::InvalidArgument("keep_log_file_num must be greater than 0");
   }
 
+  if (db_options.wal_compression != kNoCompression) {
+    if (!CompressionTypeSupported(db_options.wal_compression)) {
+      return Status::InvalidArgument(
+          "wal_compression is not linked with the binary: " +
+          CompressionTypeToString(db_options.wal_compression));
+    }
+    if (db_options.recycle_log_file_num > 0) {
+      return Status::NotSupported(
+          "WAL compression (wal_compression) is not supported together with "
+          "log file recycling (recycle_log_file_num). ");
+    }
+  }
+
   return Status::OK();
 }
+
+// Inserts recovered WAL write batches into the memtables on a pool of
+// threads while the recovering thread keeps reading the log. Batches are
+// applied with concurrent memtable inserts; since every entry carries its
+// own sequence number, the order in which the workers apply them does not
+// matter. The recovering thread calls Drain() whenever it needs the
+// memtables quiescent, i.e. before flushing them, before inserting a batch
+// itself and at the end of each log.
+//
+// Batches that fail halfway cannot be taken back out of the memtables, so
+// only batches that the recovering thread has fully decoded, and that hold
+// no merges, are scheduled.
+class WalReplayPool {
+ public:
+  struct Result {
+    Status status;
+    SequenceNumber next_sequence = 0;
+    bool has_valid_writes = false;
+    size_t record_size = 0;
+  };
+
+  WalReplayPool(ColumnFamilySet* column_family_set,
+                FlushScheduler* flush_scheduler, DB* db, int num_threads,
+                size_t max_pending_bytes)
+      : column_family_set_(column_family_set),
+        flush_scheduler_(flush_scheduler),
+        db_(db),
+        max_pending_bytes_(max_pending_bytes),
+        cv_(&mu_),
+        next_task_(0),
+        completed_tasks_(0),
+        pending_bytes_(0),
+        shutdown_(false) {
+    for (int i = 0; i < num_threads; i++) {
+      threads_.emplace_back(&WalReplayPool::BGWork, this);
+    }
+  }
+
+  ~WalReplayPool() {
+    {
+      MutexLock l(&mu_);
+      shutdown_ = true;
+      cv_.SignalAll();
+    }
+    for (auto& t : threads_) {
+      t.join();
+    }
+  }
+
+  // Hands *batch over to the pool; *batch is left empty. Blocks while the
+  // batches not yet inserted exceed max_pending_bytes, which bounds both the
+  // memory held by the pool and how far a memtable can grow past its flush
+  // trigger before the recovering thread notices.
+  void Schedule(WriteBatch* batch, uint64_t log_number, size_t record_size) {
+    std::unique_ptr<Task> task(new Task());
+    task->batch = std::move(*batch);
+    task->log_number = log_number;
+    task->result.record_size = record_size;
+    MutexLock l(&mu_);
+    while (pending_bytes_ > max_pending_bytes_) {
+      cv_.Wait();
+    }
+    pending_bytes_ += record_size;
+    tasks_.push_back(std::move(task));
+    cv_.SignalAll();
+  }
+
+  // Waits until every scheduled batch has been inserted and returns their
+  // results in scheduling order.
+  void Drain(std::vector<Result>* results) {
+    MutexLock l(&mu_);
+    while (completed_tasks_ < tasks_.size()) {
+      cv_.Wait();
+    }
+    results->clear();
+    results->reserve(tasks_.size());
+    for (auto& task : tasks_) {
+      results->push_back(task->result);
+    }
+    tasks_.clear();
+    next_task_ = 0;
+    completed_tasks_ = 0;
+  }
+
+ private:
+  struct Task {
+    WriteBatch batch;
+    uint64_t log_number = 0;
+    Result result;
+  };
+
+  void BGWork() {
+    // ColumnFamilyMemTablesImpl caches the current column family, so every
+    // worker needs its own.
+    ColumnFamilyMemTablesImpl column_family_memtables(column_family_set_);
+    while (true) {
+      Task* task;
+      {
+        MutexLock l(&mu_);
+        while (!shutdown_ && next_task_ >= tasks_.size()) {
+          cv_.Wait();
+        }
+        if (shutdown_) {
+          return;
+        }
+        task = tasks_[next_task_++].get();
+      }
+      // If column family was not found, it might mean that the WAL write
+      // batch references to the column family that was dropped after the
+      // insert. Same as the single-threaded replay, ignore the update.
+      task->result.status = WriteBatchInternal::InsertInto(
+          &task->batch, &column_family_memtables, flush_scheduler_, true,
+          task->log_number, db_, true /* concurrent_memtable_writes */,
+          &task->result.next_sequence, &task->result.has_valid_writes);
+      {
+        MutexLock l(&mu_);
+        completed_tasks_++;
+        pending_bytes_ -= task->result.record_size;
+        cv_.SignalAll();
+      }
+    }
+  }
+
+  ColumnFamilySet* const column_family_set_;
+  FlushScheduler* const flush_scheduler_;
+  DB* const db_;
+  const size_t max_pending_bytes_;
+  port::Mutex mu_;
+  port::CondVar cv_;
+  // Batches scheduled since the last Drain(), in scheduling order.
+  std::vector<std::unique_ptr<Task>> tasks_;
+  size_t next_task_;
+  size_t completed_tasks_;
+  size_t pending_bytes_;
+  bool shutdown_;
+  std::vector<port::Thread> threads_;
+};
 } // namespace
 Status DBImpl::NewDB() {
   VersionEdit new_db;
@@ -532,6 +685,38 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& log_numbers,
   bool stop_replay_for_corruption = false;
   bool flushed = false;
   uint64_t corrupted_log_number = kMaxSequenceNumber;
+  // 2PC recovery rebuilds prepared transactions from the WAL, which has to
+  // happen in log order on a single thread.
+  // Memtables that do not support concurrent inserts are rejected together
+  // with allow_concurrent_memtable_write when the DB is opened, but check
+  // again here, since the workers would corrupt them.
+  bool concurrent_inserts_supported = true;
+  for (auto cfd : *versions_->GetColumnFamilySet()) {
+    if (cfd->ioptions()->inplace_update_support ||
+        !cfd->ioptions()->memtable_factory->IsInsertConcurrentlySupported()) {
+      concurrent_inserts_supported = false;
+    }
+  }
+  std::unique_ptr<WalReplayPool> replay_pool;
+  if (immutable_db_options_.max_wal_recovery_threads > 1 &&
+      immutable_db_options_.allow_concurrent_memtable_write &&
+      concurrent_inserts_supported && !immutable_db_options_.allow_2pc &&
+      !seq_per_batch_) {
+    // Let the recovering thread run ahead of the workers by a fraction of
+    // the smallest write buffer, so that memtables do not grow much past
+    // write_buffer_size before they get flushed.
+    const size_t kMaxPendingBytes = 16 << 20;
+    size_t max_pending_bytes = kMaxPendingBytes;
+    for (auto cfd : *versions_->GetColumnFamilySet()) {
+      max_pending_bytes =
+          std::min(max_pending_bytes,
+                   cfd->GetLatestMutableCFOptions()->write_buffer_size / 4);
+    }
+    replay_pool.reset(new WalReplayPool(
+        versions_->GetColumnFamilySet(), &flush_scheduler_, this,
+        immutable_db_options_.max_wal_recovery_threads, max_pending_bytes));
+  }
+  std::vector<WalReplayPool::Result> replay_results;
   for (auto log_number : log_numbers) {
     if (log_number < versions_->min_log_number_to_keep_2pc()) {
       ROCKS_LOG_INFO(immutable_db_options_.info_log,
@@ -601,6 +786,52 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& log_numbers,
                        &reporter, true /*checksum*/, 0 /*initial_offset*/,
                        log_number);
 
+    // Flushes the memtables that filled up while replaying this log. We can
+    // do this because this is called before client has access to the DB and
+    // there is only a single thread operating on DB (any replay workers are
+    // drained before this is called).
+    auto flush_scheduled_memtables = [&]() {
+      ColumnFamilyData* cfd;
+      while ((cfd = flush_scheduler_.TakeNextColumnFamily()) != nullptr) {
+        cfd->Unref();
+        // If this asserts, it means that InsertInto failed in
+        // filtering updates to already-flushed column families
+        assert(cfd->GetLogNumber() <= log_number);
+        auto iter = version_edits.find(cfd->GetID());
+        assert(iter != version_edits.end());
+        VersionEdit* edit = &iter->second;
+        Status s = WriteLevel0TableForRecovery(job_id, cfd, cfd->mem(), edit);
+        if (!s.ok()) {
+          return s;
+        }
+        flushed = true;
+
+        cfd->CreateNewMemtable(*cfd->GetLatestMutableCFOptions(),
+                               *next_sequence);
+      }
+      return Status::OK();
+    };
+
+    // Waits for the replay workers and applies their results in log order.
+    // Sets *has_valid_writes if any of the batches wrote to a memtable.
+    //
+    // The batches were fully decoded before they were scheduled, so unlike
+    // the single-threaded replay, a worker does not fail on a corrupted
+    // record. Anything a worker does fail on may already be followed by
+    // later batches in the memtables, so the error fails the recovery
+    // whatever the WALRecoveryMode.
+    auto drain_replay_pool = [&](bool* has_valid_writes) {
+      replay_pool->Drain(&replay_results);
+      for (auto& result : replay_results) {
+        if (!result.status.ok()) {
+          return result.status;
+        }
+        *next_sequence = result.next_sequence;
+        *has_valid_writes |= result.has_valid_writes;
+      }
+      return Status::OK();
+    };
+
     // Determine if we should tolerate incomplete records at the tail end of the
     // Read all the records and add to a memtable
     std::string scratch;
@@ -711,6 +942,40 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& log_numbers,
       }
 #endif  // ROCKSDB_LITE
 
+      if (replay_pool) {
+        // Decode the batch here, so that a corrupted record is found before
+        // any batch after it is handed to the workers.
+        bool scheduled = false;
+        if (WriteBatchInternal::CheckContents(&batch).ok() &&
+            !batch.HasMerge()) {
+          replay_pool->Schedule(&batch, log_number, record.size());
+          scheduled = true;
+        }
+        // Unless a worker filled up a memtable, which has to be flushed
+        // before more work is handed out, go on reading.
+        if (scheduled && (read_only || flush_scheduler_.Empty())) {
+          continue;
+        }
+        // Otherwise wait for the workers. A batch that was not scheduled is
+        // then inserted below: merges do not support concurrent memtable
+        // inserts, and a corrupted batch has to be reported, and the records
+        // after it held back, exactly as in the single-threaded replay.
+        bool has_valid_writes = false;
+        status = drain_replay_pool(&has_valid_writes);
+        if (!status.ok()) {
+          return status;
+        }
+        if (has_valid_writes && !read_only) {
+          status = flush_scheduled_memtables();
+          if (!status.ok()) {
+            return status;
+          }
+        }
+        if (scheduled) {
+          continue;
+        }
+      }
+
       // If column family was not found, it might mean that the WAL write
       // batch references to the column family that was dropped after the
       // insert. We don't want to fail the whole write batch in that case --
@@ -730,28 +995,27 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& log_numbers,
       }
 
       if (has_valid_writes && !read_only) {
-        // we can do this because this is called before client has access to the
-        // DB and there is only a single thread operating on DB
-        ColumnFamilyData* cfd;
-
-        while ((cfd = flush_scheduler_.TakeNextColumnFamily()) != nullptr) {
-          cfd->Unref();
-          // If this asserts, it means that InsertInto failed in
-          // filtering updates to already-flushed column families
-          assert(cfd->GetLogNumber() <= log_number);
-          auto iter = version_edits.find(cfd->GetID());
-          assert(iter != version_edits.end());
-          VersionEdit* edit = &iter->second;
-          status = WriteLevel0TableForRecovery(job_id, cfd, cfd->mem(), edit);
-          if (!status.ok()) {
-            // Reflect errors immediately so that conditions like full
-            // file-systems cause the DB::Open() to fail.
-            return status;
-          }
-          flushed = true;
+        status = flush_scheduled_memtables();
+        if (!status.ok()) {
+          // Reflect errors immediately so that conditions like full
+          // file-systems cause the DB::Open() to fail.
+          return status;
+        }
+      }
+    }
 
-          cfd->CreateNewMemtable(*cfd->GetLatestMutableCFOptions(),
-                                 *next_sequence);
+    if (replay_pool) {
+      // Every batch still in flight comes before the record, if any, that
+      // stopped the replay of this log.
+      bool has_valid_writes = false;
+      Status s = drain_replay_pool(&has_valid_writes);
+      if (!s.ok()) {
+        return s;
+      }
+      if (status.ok() && has_valid_writes && !read_only) {
+        status = flush_scheduled_memtables();
+        if (!status.ok()) {
+          return status;
         }
       }
     }
@@ -1093,9 +1357,12 @@ Status DBImpl::Open(const DBOptions& db_options, const std::string& dbname,
             new log::Writer(
                 std::move(file_writer), new_log_number,
                 impl->immutable_db_options_.recycle_log_file_num > 0,
-                impl->immutable_db_options_.manual_wal_flush));
+                impl->immutable_db_options_.manual_wal_flush,
+                impl->immutable_db_options_.wal_compression));
+        s = impl->logs_.back().writer->AddCompressionTypeRecord();
       }
-
+    }
+    if (s.ok()) {
       // set column family handles
       for (auto cf : column_families) {
         auto cfd =
@@ -1185,6 +1452,10 @@ Status DBImpl::Open(const DBOptions& db_options, const std::string& dbname,
   }
   impl->mutex_.Unlock();
 
+  if (s.ok() && impl->write_buffer_manager_->cost_based_flush()) {
+    impl->write_buffer_manager_->RegisterFlushCandidateSource(impl);
+  }
+
 #ifndef ROCKSDB_LITE
   auto sfm = static_cast<SstFileManagerImpl*>(
       impl->immutable_db_options_.sst_file_manager.get());
@@ -12,6 +12,7 @@
 #define __STDC_FORMAT_MACROS
 #endif
 #include <inttypes.h>
+#include <algorithm>
 #include "db/error_handler.h"
 #include "db/event_helpers.h"
 #include "monitoring/perf_context_imp.h"
@@ -19,6 +20,21 @@
 #include "util/sync_point.h"
 
 namespace rocksdb {
+
+namespace {
+// Verifies the entry checksums of a protected batch before it is logged. A
+// batch that does not match them fails like a batch whose callback failed,
+// so it is neither logged nor inserted. Returns false if the writer failed.
+bool VerifyBatchChecksums(WriteThread::Writer* writer) {
+  if (writer->callback_status.ok() &&
+      WriteBatchInternal::HasProtectionInfo(writer->batch)) {
+    writer->callback_status =
+        WriteBatchInternal::VerifyChecksums(writer->batch);
+  }
+  return writer->callback_status.ok();
+}
+}  // namespace
+
 // Convenience methods
 Status DBImpl::Put(const WriteOptions& o, ColumnFamilyHandle* column_family,
                    const Slice& key, const Slice& val) {
@@ -99,6 +115,13 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
          disable_memtable);
 
   Status status;
+  if (immutable_db_options_.enable_per_column_family_write_stall &&
+      !disable_memtable) {
+    status = DelayWriteForColumnFamilies(write_options, my_batch);
+    if (!status.ok()) {
+      return status;
+    }
+  }
   if (write_options.low_pri) {
     status = ThrottleLowPriWritesIfNeeded(write_options, my_batch);
     if (!status.ok()) {
@@ -112,8 +135,10 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
   }
 
   if (immutable_db_options_.enable_pipelined_write) {
-    return PipelinedWriteImpl(write_options, my_batch, callback, log_used,
-                              log_ref, disable_memtable, seq_used);
+    status = PipelinedWriteImpl(write_options, my_batch, callback, log_used,
+                                log_ref, disable_memtable, seq_used);
+    SwitchRequestedMemTables();
+    return status;
   }
 
   PERF_TIMER_GUARD(write_pre_and_post_process_time);
@@ -177,6 +202,7 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
       *seq_used = w.sequence;
     }
     // write is complete and leader has updated sequence
+    SwitchRequestedMemTables();
     return w.FinalStatus();
   }
   // else we are the leader of the write batch group
@@ -241,7 +267,7 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
     size_t valid_batches = 0;
     size_t total_byte_size = 0;
     for (auto* writer : write_group) {
-      if (!writer->CallbackFailed()) {
+      if (VerifyBatchChecksums(writer)) {
         valid_batches += writer->batch_cnt;
         if (writer->ShouldWriteToMemtable()) {
           total_count += WriteBatchInternal::Count(writer->batch);
@@ -407,6 +433,7 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
     MemTableInsertStatusCheck(w.status);
     write_thread_.ExitAsBatchGroupLeader(write_group, status);
   }
+  SwitchRequestedMemTables();
 
   if (status.ok()) {
     status = w.FinalStatus();
@@ -452,7 +479,7 @@ Status DBImpl::PipelinedWriteImpl(const WriteOptions& write_options,
     if (w.status.ok()) {
       SequenceNumber next_sequence = current_sequence;
       for (auto writer : wal_write_group) {
-        if (writer->CheckCallback(this)) {
+        if (writer->CheckCallback(this) && VerifyBatchChecksums(writer)) {
           if (writer->ShouldWriteToMemtable()) {
             writer->sequence = next_sequence;
             size_t count = WriteBatchInternal::Count(writer->batch);
@@ -518,6 +545,7 @@ Status DBImpl::PipelinedWriteImpl(const WriteOptions& write_options,
           &flush_scheduler_, write_options.ignore_missing_column_families,
           0 /*log_number*/, this, false /*concurrent_memtable_writes*/,
           seq_per_batch_, batch_per_txn_);
+      MemTableInsertStatusCheck(memtable_write_group.status);
       versions_->SetLastSequence(memtable_write_group.last_sequence);
       write_thread_.ExitAsMemTableWriter(&w, memtable_write_group);
     }
@@ -582,7 +610,7 @@ Status DBImpl::WriteImplWALOnly(const WriteOptions& write_options,
 
   size_t total_byte_size = 0;
   for (auto* writer : write_group) {
-    if (writer->CheckCallback(this)) {
+    if (writer->CheckCallback(this) && VerifyBatchChecksums(writer)) {
       total_byte_size = WriteBatchInternal::AppendedByteSize(
           total_byte_size, WriteBatchInternal::ByteSize(writer->batch));
     }
@@ -781,9 +809,11 @@ Status DBImpl::PreprocessWrite(const WriteOptions& write_options,
 
 WriteBatch* DBImpl::MergeBatch(const WriteThread::WriteGroup& write_group,
                                WriteBatch* tmp_batch, size_t* write_with_wal,
-                               WriteBatch** to_be_cached_state) {
+                               WriteBatch** to_be_cached_state,
+                               std::vector<Slice>* wal_parts) {
   assert(write_with_wal != nullptr);
   assert(tmp_batch != nullptr);
+  assert(wal_parts != nullptr && wal_parts->empty());
   assert(*to_be_cached_state == nullptr);
   WriteBatch* merged_batch = nullptr;
   *write_with_wal = 0;
@@ -798,16 +828,28 @@ WriteBatch* DBImpl::MergeBatch(const WriteThread::WriteGroup& write_group,
     if (WriteBatchInternal::IsLatestPersistentState(merged_batch)) {
       *to_be_cached_state = merged_batch;
     }
+    if (WriteBatchInternal::HasValueReferences(merged_batch)) {
+      // The values the batch references are written to the WAL from where
+      // they are.
+      WriteBatchInternal::AppendContentParts(
+          merged_batch, 0, WriteBatchInternal::Contents(merged_batch).size(),
+          wal_parts);
+    }
     *write_with_wal = 1;
   } else {
-    // WAL needs all of the batches flattened into a single batch.
-    // We could avoid copying here with an iov-like AddRecord
-    // interface
+    // WAL needs all of the batches flattened into a single record. Only
+    // their header is merged, the entries are written from the batches
+    // themselves.
     merged_batch = tmp_batch;
+    assert(WriteBatchInternal::ByteSize(merged_batch) ==
+           WriteBatchInternal::kHeader);
+    wal_parts->reserve(write_group.size + 1);
+    // Placeholder for the header, which is final only after the loop
+    wal_parts->emplace_back();
     for (auto writer : write_group) {
       if (!writer->CallbackFailed()) {
-        WriteBatchInternal::Append(merged_batch, writer->batch,
-                                   /*WAL_only*/ true);
+        WriteBatchInternal::AppendByReference(merged_batch, writer->batch,
+                                              wal_parts, /*WAL_only*/ true);
         if (WriteBatchInternal::IsLatestPersistentState(writer->batch)) {
           // We only need to cache the last of such write batch
           *to_be_cached_state = writer->batch;
@@ -815,6 +857,7 @@ WriteBatch* DBImpl::MergeBatch(const WriteThread::WriteGroup& write_group,
         (*write_with_wal)++;
       }
     }
+    (*wal_parts)[0] = WriteBatchInternal::Contents(merged_batch);
   }
   return merged_batch;
 }
@@ -822,11 +865,23 @@ WriteBatch* DBImpl::MergeBatch(const WriteThread::WriteGroup& write_group,
 // When two_write_queues_ is disabled, this function is called from the only
 // write thread. Otherwise this must be called holding log_write_mutex_.
 Status DBImpl::WriteToWAL(const WriteBatch& merged_batch,
+                          const std::vector<Slice>& wal_parts,
                           log::Writer* log_writer, uint64_t* log_used,
                           uint64_t* log_size) {
   assert(log_size != nullptr);
-  Slice log_entry = WriteBatchInternal::Contents(&merged_batch);
-  *log_size = log_entry.size();
+  Slice contents = WriteBatchInternal::Contents(&merged_batch);
+  SliceParts log_entry(&contents, 1);
+  if (!wal_parts.empty()) {
+    // The record is made of wal_parts, starting with the header of
+    // merged_batch
+    assert(wal_parts[0].data() == contents.data());
+    log_entry =
+        SliceParts(wal_parts.data(), static_cast<int>(wal_parts.size()));
+  }
+  *log_size = 0;
+  for (int i = 0; i < log_entry.num_parts; ++i) {
+    *log_size += log_entry.parts[i].size();
+  }
   // When two_write_queues_ WriteToWAL has to be protected from concurretn calls
   // from the two queues anyway and log_write_mutex_ is already held. Otherwise
   // if manual_wal_flush_ is enabled we need to protect log_writer->AddRecord
@@ -845,10 +900,10 @@ Status DBImpl::WriteToWAL(const WriteBatch& merged_batch,
   if (log_used != nullptr) {
     *log_used = logfile_number_;
   }
-  total_log_size_ += log_entry.size();
+  total_log_size_ += *log_size;
   // TODO(myabandeh): it might be unsafe to access alive_log_files_.back() here
   // since alive_log_files_ might be modified concurrently
-  alive_log_files_.back().AddSize(log_entry.size());
+  alive_log_files_.back().AddSize(*log_size);
   log_empty_ = false;
   return status;
 }
@@ -863,8 +918,10 @@ Status DBImpl::WriteToWAL(const WriteThread::WriteGroup& write_group,
   // Same holds for all in the batch group
   size_t write_with_wal = 0;
   WriteBatch* to_be_cached_state = nullptr;
-  WriteBatch* merged_batch = MergeBatch(write_group, &tmp_batch_,
-                                        &write_with_wal, &to_be_cached_state);
+  std::vector<Slice> wal_parts;
+  WriteBatch* merged_batch =
+      MergeBatch(write_group, &tmp_batch_, &write_with_wal,
+                 &to_be_cached_state, &wal_parts);
   if (merged_batch == write_group.leader->batch) {
     write_group.leader->log_used = logfile_number_;
   } else if (write_with_wal > 1) {
@@ -876,7 +933,8 @@ Status DBImpl::WriteToWAL(const WriteThread::WriteGroup& write_group,
   WriteBatchInternal::SetSequence(merged_batch, sequence);
 
   uint64_t log_size;
-  status = WriteToWAL(*merged_batch, log_writer, log_used, &log_size);
+  status = WriteToWAL(*merged_batch, wal_parts, log_writer, log_used,
+                      &log_size);
   if (to_be_cached_state) {
     cached_recoverable_state_ = *to_be_cached_state;
       cached_recoverable_state_empty_ = false;
@@ -933,8 +991,9 @@ Status DBImpl::ConcurrentWriteToWAL(const WriteThread::WriteGroup& write_group,
   WriteBatch tmp_batch;
   size_t write_with_wal = 0;
   WriteBatch* to_be_cached_state = nullptr;
-  WriteBatch* merged_batch =
-      MergeBatch(write_group, &tmp_batch, &write_with_wal, &to_be_cached_state);
+  std::vector<Slice> wal_parts;
+  WriteBatch* merged_batch = MergeBatch(write_group, &tmp_batch, &write_with_wal,
+                                        &to_be_cached_state, &wal_parts);
 
   // We need to lock log_write_mutex_ since logs_ and alive_log_files might be
   // pushed back concurrently
@@ -952,7 +1011,8 @@ Status DBImpl::ConcurrentWriteToWAL(const WriteThread::WriteGroup& write_group,
 
   log::Writer* log_writer = logs_.back().writer;
   uint64_t log_size;
-  status = WriteToWAL(*merged_batch, log_writer, log_used, &log_size);
+  status = WriteToWAL(*merged_batch, wal_parts, log_writer, log_used,
+                      &log_size);
   if (to_be_cached_state) {
     cached_recoverable_state_ = *to_be_cached_state;
       cached_recoverable_state_empty_ = false;
@@ -1098,6 +1158,18 @@ Status DBImpl::HandleWriteBufferFull(WriteContext* write_context) {
       "using %" PRIu64 " bytes out of a total of %" PRIu64 ".",
       write_buffer_manager_->memory_usage(),
       write_buffer_manager_->buffer_size());
+  if (write_buffer_manager_->cost_based_flush()) {
+    // If flushes are already scheduled in this DB, switching their memtables
+    // in ScheduleFlushes() is going to free memory without asking for more.
+    if (flush_scheduler_.Empty()) {
+      // The write buffer manager locks the mutex of every DB sharing it,
+      // including this one.
+      mutex_.Unlock();
+      write_buffer_manager_->RequestFlushOfBestCandidate();
+      mutex_.Lock();
+    }
+    return status;
+  }
   // no need to refcount because drop is happening in write thread, so can't
   // happen while we're in the write thread
   ColumnFamilyData* cfd_picked = nullptr;
@@ -1129,6 +1201,101 @@ Status DBImpl::HandleWriteBufferFull(WriteContext* write_context) {
   return status;
 }
 
+void DBImpl::GetWriteBufferFlushCandidates(
+    std::vector<WriteBufferManager::FlushCandidate>* candidates) {
+  InstrumentedMutexLock l(&mutex_);
+  int64_t now = 0;
+  if (!env_->GetCurrentTime(&now).ok()) {
+    now = 0;
+  }
+  uint64_t oldest_log_to_keep = port::kMaxUint64;
+  for (auto cfd : *versions_->GetColumnFamilySet()) {
+    if (!cfd->IsDropped() &&
+        (!cfd->mem()->IsEmpty() || cfd->imm()->NumNotFlushed() > 0)) {
+      oldest_log_to_keep = std::min(oldest_log_to_keep, cfd->OldestLogToKeep());
+    }
+  }
+  for (auto cfd : *versions_->GetColumnFamilySet()) {
+    MemTable* mem = cfd->mem();
+    if (cfd->IsDropped() || mem->IsEmpty() || mem->IsFlushPending()) {
+      continue;
+    }
+    WriteBufferManager::FlushCandidate candidate;
+    candidate.source = this;
+    candidate.column_family_id = cfd->GetID();
+    candidate.memory_usage = mem->ApproximateMemoryUsage();
+    uint64_t oldest_key_time = mem->ApproximateOldestKeyTime();
+    if (oldest_key_time < static_cast<uint64_t>(now)) {
+      candidate.age_seconds = static_cast<uint64_t>(now) - oldest_key_time;
+    }
+    // Immutable memtables of the column family keep older WALs alive anyway
+    candidate.pins_oldest_wal = cfd->imm()->NumNotFlushed() == 0 &&
+                                cfd->OldestLogToKeep() <= oldest_log_to_keep;
+    candidates->push_back(candidate);
+  }
+}
+
+void DBImpl::RequestWriteBufferFlush(uint32_t column_family_id) {
+  WriteContext write_context;
+  InstrumentedMutexLock l(&mutex_);
+  auto cfd =
+      versions_->GetColumnFamilySet()->GetColumnFamily(column_family_id);
+  if (cfd == nullptr || cfd->IsDropped() || cfd->mem()->IsEmpty()) {
+    return;
+  }
+  ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                 "[%s] Write buffer manager requested flush of memtable "
+                 "using %" ROCKSDB_PRIszt " bytes.",
+                 cfd->GetName().c_str(), cfd->mem()->ApproximateMemoryUsage());
+  // Set before trying to enter the write queue: if a writer holds it, the
+  // writer sees the flag once it has left the queue.
+  write_buffer_flush_requested_.store(true);
+  WriteThread::Writer w;
+  if (!write_thread_.TryEnterUnbatched(&w, &mutex_)) {
+    // A write is in progress, possibly the one that asked for this flush.
+    // It switches the memtable in PreprocessWrite() or once it is done.
+    if (cfd->mem()->MarkFlushScheduledIfNotScheduled()) {
+      flush_scheduler_.ScheduleFlush(cfd);
+    }
+    return;
+  }
+  // Nothing can be written to this DB, so the memtable is switched right
+  // away, as in FlushMemTable(). Waiting for a write here could deadlock
+  // with the writers of the other DBs sharing the write buffer manager.
+  Status s = Status::Incomplete();
+  if (!cfd->IsDropped() && !cfd->mem()->IsEmpty()) {
+    s = SwitchMemtable(cfd, &write_context, FlushReason::kWriteBufferFull);
+  }
+  write_thread_.ExitUnbatched(&w);
+  if (s.ok()) {
+    cfd->imm()->FlushRequested();
+    SchedulePendingFlush(cfd, FlushReason::kWriteBufferFull);
+    MaybeScheduleFlushOrCompaction();
+  }
+}
+
+void DBImpl::SwitchRequestedMemTables() {
+  if (!write_buffer_flush_requested_.load() ||
+      !write_buffer_flush_requested_.exchange(false)) {
+    return;
+  }
+  WriteContext write_context;
+  InstrumentedMutexLock l(&mutex_);
+  if (flush_scheduler_.Empty()) {
+    return;
+  }
+  WriteThread::Writer w;
+  write_thread_.EnterUnbatched(&w, &mutex_);
+  Status s = ScheduleFlushes(&write_context);
+  write_thread_.ExitUnbatched(&w);
+  if (!s.ok()) {
+    ROCKS_LOG_WARN(immutable_db_options_.info_log,
+                   "Failed to switch memtables requested by the write buffer "
+                   "manager: %s",
+                   s.ToString().c_str());
+  }
+}
+
 uint64_t DBImpl::GetMaxTotalWalSize() const {
   mutex_.AssertHeld();
   return mutable_db_options_.max_total_wal_size == 0
@@ -1188,6 +1355,128 @@ Status DBImpl::DelayWrite(uint64_t num_bytes,
   return error_handler_.GetBGError();
 }
 
+namespace {
+// Collects the ids of the column families a write batch writes to.
+class ColumnFamilyIdCollector : public WriteBatch::Handler {
+ public:
+  Status PutCF(uint32_t column_family_id, const Slice& /*key*/,
+               const Slice& /*value*/) override {
+    return Add(column_family_id);
+  }
+  Status DeleteCF(uint32_t column_family_id, const Slice& /*key*/) override {
+    return Add(column_family_id);
+  }
+  Status SingleDeleteCF(uint32_t column_family_id,
+                        const Slice& /*key*/) override {
+    return Add(column_family_id);
+  }
+  Status DeleteRangeCF(uint32_t column_family_id, const Slice& /*begin_key*/,
+                       const Slice& /*end_key*/) override {
+    return Add(column_family_id);
+  }
+  Status MergeCF(uint32_t column_family_id, const Slice& /*key*/,
+                 const Slice& /*value*/) override {
+    return Add(column_family_id);
+  }
+  Status PutBlobIndexCF(uint32_t column_family_id, const Slice& /*key*/,
+                        const Slice& /*value*/) override {
+    return Add(column_family_id);
+  }
+  Status MarkBeginPrepare(bool) override { return Status::OK(); }
+  Status MarkEndPrepare(const Slice&) override { return Status::OK(); }
+  Status MarkNoop(bool) override { return Status::OK(); }
+  Status MarkRollback(const Slice&) override { return Status::OK(); }
+  Status MarkCommit(const Slice&) override { return Status::OK(); }
+
+  const autovector<uint32_t>& column_family_ids() const {
+    return column_family_ids_;
+  }
+
+ private:
+  Status Add(uint32_t column_family_id) {
+    if (std::find(column_family_ids_.begin(), column_family_ids_.end(),
+                  column_family_id) == column_family_ids_.end()) {
+      column_family_ids_.push_back(column_family_id);
+    }
+    return Status::OK();
+  }
+
+  autovector<uint32_t> column_family_ids_;
+};
+}  // namespace
+
+Status DBImpl::DelayWriteForColumnFamilies(const WriteOptions& write_options,
+                                           WriteBatch* my_batch) {
+  assert(immutable_db_options_.enable_per_column_family_write_stall);
+  // A column family that is stopped or delayed always holds a compaction
+  // pressure token on write_controller_, so most writes can skip parsing
+  // the batch.
+  if (!write_controller_.NeedSpeedupCompaction()) {
+    return Status::OK();
+  }
+  ColumnFamilyIdCollector collector;
+  Status s = my_batch->Iterate(&collector);
+  if (!s.ok()) {
+    return s;
+  }
+
+  PERF_TIMER_GUARD(write_delay_time);
+  uint64_t time_delayed = 0;
+  bool delayed = false;
+  {
+    StopWatch sw(env_, stats_, WRITE_STALL, &time_delayed);
+    InstrumentedMutexLock l(&mutex_);
+    for (uint32_t column_family_id : collector.column_family_ids()) {
+      auto cfd =
+          versions_->GetColumnFamilySet()->GetColumnFamily(column_family_id);
+      if (cfd == nullptr || cfd->IsDropped()) {
+        // The write fails or is ignored later on.
+        continue;
+      }
+      WriteController* write_controller = cfd->write_stall_controller();
+      assert(write_controller != nullptr);
+      if (!write_controller->IsStopped() && !write_controller->NeedsDelay()) {
+        continue;
+      }
+      uint64_t delay = write_controller->GetDelay(
+          env_, WriteBatchInternal::ByteSize(my_batch));
+      if (write_options.no_slowdown &&
+          (delay > 0 || write_controller->IsStopped())) {
+        return Status::Incomplete();
+      }
+      cfd->Ref();
+      if (delay > 0) {
+        TEST_SYNC_POINT("DBImpl::DelayWriteForColumnFamilies:Sleep");
+        mutex_.Unlock();
+        // Same as in DelayWrite()
+        const uint64_t kDelayInterval = 1000;
+        uint64_t stall_end = env_->NowMicros() + delay;
+        while (write_controller->NeedsDelay() &&
+               env_->NowMicros() < stall_end) {
+          delayed = true;
+          env_->SleepForMicroseconds(kDelayInterval);
+        }
+        mutex_.Lock();
+      }
+      while (!error_handler_.IsDBStopped() && !cfd->IsDropped() &&
+             write_controller->IsStopped()) {
+        delayed = true;
+        TEST_SYNC_POINT("DBImpl::DelayWriteForColumnFamilies:Wait");
+        bg_cv_.Wait();
+      }
+      if (cfd->Unref()) {
+        delete cfd;
+      }
+    }
+  }
+  if (delayed) {
+    default_cf_internal_stats_->AddDBStats(InternalStats::WRITE_STALL_MICROS,
+                                           time_delayed);
+    RecordTick(stats_, STALL_MICROS, time_delayed);
+  }
+  return Status::OK();
+}
+
 Status DBImpl::ThrottleLowPriWritesIfNeeded(const WriteOptions& write_options,
                                             WriteBatch* my_batch) {
   assert(write_options.low_pri);
@@ -1211,8 +1500,8 @@ Status DBImpl::ThrottleLowPriWritesIfNeeded(const WriteOptions& write_options,
       // progress.
       PERF_TIMER_GUARD(write_delay_time);
       write_controller_.low_pri_rate_limiter()->Request(
-          my_batch->GetDataSize(), Env::IO_HIGH, nullptr /* stats */,
-          RateLimiter::OpType::kWrite);
+          WriteBatchInternal::ByteSize(my_batch), Env::IO_HIGH,
+          nullptr /* stats */, RateLimiter::OpType::kWrite);
     }
   }
   return Status::OK();
@@ -1348,7 +1637,13 @@ Status DBImpl::SwitchMemtable(ColumnFamilyData* cfd, WriteContext* context,
             new WritableFileWriter(std::move(lfile), opt_env_opt));
         new_log = new log::Writer(
             std::move(file_writer), new_log_number,
-            immutable_db_options_.recycle_log_file_num > 0, manual_wal_flush_);
+            immutable_db_options_.recycle_log_file_num > 0, manual_wal_flush_,
+            immutable_db_options_.wal_compression);
+        s = new_log->AddCompressionTypeRecord();
+        if (!s.ok()) {
+          delete new_log;
+          new_log = nullptr;
+        }
       }
     }
 
@@ -61,6 +61,10 @@ class ArenaWrappedDBIter : public Iterator {
   virtual void Seek(const Slice& target) override;
   virtual void SeekForPrev(const Slice& target) override;
   virtual void Next() override;
+  virtual size_t NextBatch(
+      size_t max_entries, size_t max_bytes,
+      const std::function<bool(const Slice& key, const Slice& value)>&
+          callback) override;
   virtual void Prev() override;
   virtual Slice key() const override;
   virtual Slice value() const override;
@@ -2437,6 +2437,166 @@ TEST_P(DBIteratorTest, SeekBackwardAfterOutOfUpperBound) {
   ASSERT_EQ("a", it->key().ToString());
 }
 
+TEST_P(DBIteratorTest, NextBatch) {
+  // Spread the keys over a few L0 files and the memtable, with some of them
+  // deleted or overwritten
+  for (int i = 0; i < 100; i++) {
+    ASSERT_OK(Put(Key(i), "v1"));
+    if (i % 25 == 24) {
+      ASSERT_OK(Flush());
+    }
+  }
+  for (int i = 0; i < 100; i += 10) {
+    ASSERT_OK(Delete(Key(i)));
+  }
+  for (int i = 5; i < 100; i += 10) {
+    ASSERT_OK(Put(Key(i), "v2"));
+  }
+
+  std::unique_ptr<Iterator> iter(NewIterator(ReadOptions()));
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+  auto collect = [&](const Slice& key, const Slice& value) {
+    keys.push_back(key.ToString());
+    values.push_back(value.ToString());
+    return true;
+  };
+
+  iter->SeekToFirst();
+  ASSERT_EQ(7U, iter->NextBatch(7, port::kMaxSizet, collect));
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ(Key(8), iter->key().ToString());
+  // Each entry is 9 + 2 bytes, so the limit is reached on the third one
+  ASSERT_EQ(3U, iter->NextBatch(100, 25, collect));
+  ASSERT_EQ(Key(12), iter->key().ToString());
+  // Stops without passing the entry the callback rejects
+  ASSERT_EQ(3U, iter->NextBatch(
+                   100, port::kMaxSizet,
+                   [&](const Slice& key, const Slice& value) {
+                     return key.compare(Key(15)) < 0 && collect(key, value);
+                   }));
+  ASSERT_EQ(Key(15), iter->key().ToString());
+  ASSERT_EQ(77U, iter->NextBatch(100, port::kMaxSizet, collect));
+  ASSERT_FALSE(iter->Valid());
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(0U, iter->NextBatch(100, port::kMaxSizet, collect));
+
+  ASSERT_EQ(90U, keys.size());
+  for (size_t i = 0, k = 0; i < keys.size(); i++, k++) {
+    if (k % 10 == 0) {
+      k++;
+    }
+    ASSERT_EQ(Key(static_cast<int>(k)), keys[i]);
+    ASSERT_EQ(k % 10 == 5 ? "v2" : "v1", values[i]);
+  }
+}
+
+TEST_P(DBIteratorTest, ParallelIterators) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  DestroyAndReopen(options);
+  // Ten L0 files of 100 keys each, with disjoint key ranges
+  Random rnd(301);
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_OK(Put(Key(i), RandomString(&rnd, 100)));
+    if (i % 100 == 99) {
+      ASSERT_OK(Flush());
+    }
+  }
+  const Snapshot* snapshot = db_->GetSnapshot();
+  ASSERT_OK(Put(Key(1000), "after snapshot"));
+
+  auto check = [&](const Slice* begin, const Slice* end, size_t n,
+                   int first_key, int last_key, size_t expected_parts) {
+    ReadOptions ro;
+    ro.snapshot = snapshot;
+    std::vector<Iterator*> iters;
+    ASSERT_OK(db_->NewParallelIterators(ro, db_->DefaultColumnFamily(),
+                                        RangePtr(begin, end), n, &iters));
+    ASSERT_EQ(expected_parts, iters.size());
+    int next_key = first_key;
+    for (auto* iter : iters) {
+      int part_keys = 0;
+      for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+        ASSERT_EQ(Key(next_key), iter->key().ToString());
+        next_key++;
+        part_keys++;
+      }
+      ASSERT_OK(iter->status());
+      // The parts are balanced to within a file
+      ASSERT_GE(part_keys, (last_key - first_key) / static_cast<int>(n) - 100);
+      ASSERT_LE(part_keys, (last_key - first_key) / static_cast<int>(n) + 100);
+      delete iter;
+    }
+    ASSERT_EQ(last_key, next_key);
+  };
+
+  check(nullptr, nullptr, 4, 0, 1000, 4);
+  std::string begin = Key(150);
+  std::string end = Key(750);
+  Slice begin_slice = begin;
+  Slice end_slice = end;
+  check(&begin_slice, &end_slice, 3, 150, 750, 3);
+  check(&begin_slice, nullptr, 1, 150, 1000, 1);
+  // There are not enough files for more parts
+  std::vector<Iterator*> iters;
+  ASSERT_OK(db_->NewParallelIterators(ReadOptions(), db_->DefaultColumnFamily(),
+                                      RangePtr(), 20, &iters));
+  ASSERT_EQ(10U, iters.size());
+  for (auto* iter : iters) {
+    delete iter;
+  }
+
+  // The iterate bounds narrow the range
+  std::string lower = Key(250);
+  std::string upper = Key(550);
+  Slice lower_slice = lower;
+  Slice upper_slice = upper;
+  {
+    ReadOptions ro;
+    ro.snapshot = snapshot;
+    ro.iterate_lower_bound = &lower_slice;
+    ro.iterate_upper_bound = &upper_slice;
+    ASSERT_OK(db_->NewParallelIterators(ro, db_->DefaultColumnFamily(),
+                                        RangePtr(&begin_slice, &end_slice), 2,
+                                        &iters));
+    ASSERT_EQ(2U, iters.size());
+    int next_key = 250;
+    for (auto* iter : iters) {
+      for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+        ASSERT_EQ(Key(next_key), iter->key().ToString());
+        next_key++;
+      }
+      ASSERT_OK(iter->status());
+      delete iter;
+    }
+    ASSERT_EQ(550, next_key);
+  }
+
+  // Without a snapshot, all the parts read the files of when they were
+  // created, even after a compaction replaced them
+  ASSERT_OK(db_->NewParallelIterators(ReadOptions(), db_->DefaultColumnFamily(),
+                                      RangePtr(), 4, &iters));
+  ASSERT_EQ(4U, iters.size());
+  db_->ReleaseSnapshot(snapshot);
+  for (int i = 0; i < 1000; i += 2) {
+    ASSERT_OK(Delete(Key(i)));
+  }
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ(0, NumTableFilesAtLevel(0));
+  int next_key = 0;
+  for (auto* iter : iters) {
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      ASSERT_EQ(Key(next_key), iter->key().ToString());
+      next_key++;
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_TRUE(iter->Refresh().IsNotSupported());
+    delete iter;
+  }
+  ASSERT_EQ(1001, next_key);
+}
+
 INSTANTIATE_TEST_CASE_P(DBIteratorTestInstance, DBIteratorTest,
                         testing::Values(true, false));
 
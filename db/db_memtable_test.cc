@@ -3,14 +3,17 @@
 //  COPYING file in the root directory) and Apache 2.0 License
 //  (found in the LICENSE.Apache file in the root directory).
 
+#include <algorithm>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "db/db_test_util.h"
 #include "db/memtable.h"
 #include "port/stack_trace.h"
 #include "rocksdb/memtablerep.h"
 #include "rocksdb/slice_transform.h"
+#include "table/scoped_arena_iterator.h"
 
 namespace rocksdb {
 
@@ -205,6 +208,169 @@ TEST_F(DBMemTableTest, DuplicateSeq) {
   delete mem;
 }
 
+TEST_F(DBMemTableTest, AdaptiveRadixTreeRep) {
+  Options options;
+  options.memtable_factory.reset(new ARTRepFactory());
+  InternalKeyComparator cmp(BytewiseComparator());
+  ImmutableCFOptions ioptions(options);
+  WriteBufferManager wb(options.db_write_buffer_size);
+  MemTable* mem = new MemTable(cmp, ioptions, MutableCFOptions(options), &wb,
+                               kMaxSequenceNumber, 0 /* column_family_id */);
+
+  // Short keys over a small alphabet, so that many are prefixes of each
+  // other, and some contain the bytes the keys are encoded with.
+  const char kAlphabet[] = {'\0', '\x01', 'a', 'b', '\xff'};
+  Random rnd(301);
+  std::vector<std::string> expected;
+  SequenceNumber seq = 1;
+  for (int i = 0; i < 3000; i++) {
+    std::string user_key;
+    int len = rnd.Uniform(6);
+    for (int j = 0; j < len; j++) {
+      user_key.push_back(kAlphabet[rnd.Uniform(sizeof(kAlphabet))]);
+    }
+    ValueType type = rnd.OneIn(2) ? kTypeValue : kTypeMerge;
+    ASSERT_TRUE(mem->Add(seq, type, user_key, "v" + ToString(seq)));
+    ASSERT_FALSE(mem->Add(seq, type, user_key, "v" + ToString(seq)));
+    expected.push_back(InternalKey(user_key, seq, type).Encode().ToString());
+    seq++;
+  }
+  std::sort(expected.begin(), expected.end(),
+            [&cmp](const std::string& a, const std::string& b) {
+              return cmp.Compare(a, b) < 0;
+            });
+
+  Arena arena;
+  {
+    ScopedArenaIterator iter(mem->NewIterator(ReadOptions(), &arena));
+    size_t i = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next(), i++) {
+      ASSERT_LT(i, expected.size());
+      ASSERT_EQ(expected[i], iter->key().ToString());
+    }
+    ASSERT_EQ(expected.size(), i);
+    for (iter->SeekToLast(); iter->Valid(); iter->Prev()) {
+      ASSERT_GT(i, 0);
+      ASSERT_EQ(expected[--i], iter->key().ToString());
+    }
+    ASSERT_EQ(0, i);
+
+    for (int k = 0; k < 1000; k++) {
+      std::string user_key;
+      int len = rnd.Uniform(6);
+      for (int j = 0; j < len; j++) {
+        user_key.push_back(kAlphabet[rnd.Uniform(sizeof(kAlphabet))]);
+      }
+      std::string target =
+          InternalKey(user_key, rnd.Uniform(static_cast<int>(seq) + 1),
+                      kValueTypeForSeek)
+              .Encode()
+              .ToString();
+      auto lower = std::lower_bound(
+          expected.begin(), expected.end(), target,
+          [&cmp](const std::string& a, const std::string& b) {
+            return cmp.Compare(a, b) < 0;
+          });
+      iter->Seek(target);
+      if (lower == expected.end()) {
+        ASSERT_FALSE(iter->Valid());
+      } else {
+        ASSERT_TRUE(iter->Valid());
+        ASSERT_EQ(*lower, iter->key().ToString());
+      }
+      auto upper = std::upper_bound(
+          expected.begin(), expected.end(), target,
+          [&cmp](const std::string& a, const std::string& b) {
+            return cmp.Compare(a, b) < 0;
+          });
+      iter->SeekForPrev(target);
+      if (upper == expected.begin()) {
+        ASSERT_FALSE(iter->Valid());
+      } else {
+        ASSERT_TRUE(iter->Valid());
+        ASSERT_EQ(*(upper - 1), iter->key().ToString());
+      }
+    }
+  }
+  delete mem;
+
+  // Concurrent inserts
+  options.allow_concurrent_memtable_write = true;
+  ioptions = ImmutableCFOptions(options);
+  mem = new MemTable(cmp, ioptions, MutableCFOptions(options), &wb,
+                     kMaxSequenceNumber, 0 /* column_family_id */);
+  const int kNumThreads = 4;
+  const int kNumKeysPerThread = 5000;
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([mem, t]() {
+      MemTablePostProcessInfo post_process_info;
+      Random thread_rnd(t);
+      for (int i = 0; i < kNumKeysPerThread; i++) {
+        std::string user_key = ToString(thread_rnd.Next());
+        ASSERT_TRUE(mem->Add(t * kNumKeysPerThread + i + 1, kTypeValue,
+                             user_key, "v", true, &post_process_info));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  {
+    ScopedArenaIterator iter(mem->NewIterator(ReadOptions(), &arena));
+    int count = 0;
+    std::string prev;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next(), count++) {
+      if (count > 0) {
+        ASSERT_LT(cmp.Compare(prev, iter->key()), 0);
+      }
+      prev = iter->key().ToString();
+    }
+    ASSERT_EQ(kNumThreads * kNumKeysPerThread, count);
+  }
+  delete mem;
+}
+
+TEST_F(DBMemTableTest, AdaptiveRadixTreeRepDB) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.memtable_factory.reset(new ARTRepFactory());
+  Reopen(options);
+
+  ASSERT_OK(Put("foo", "v1"));
+  ASSERT_OK(Put("foobar", "v2"));
+  ASSERT_OK(Put("fo", "v3"));
+  ASSERT_OK(Put("bar", "v4"));
+  ASSERT_OK(Put("foo", "v5"));
+  ASSERT_OK(Delete("fo"));
+  ASSERT_EQ("v5", Get("foo"));
+  ASSERT_EQ("v2", Get("foobar"));
+  ASSERT_EQ("NOT_FOUND", Get("fo"));
+  ASSERT_EQ("NOT_FOUND", Get("f"));
+
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  iter->SeekToFirst();
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ("bar", iter->key().ToString());
+  iter->Next();
+  ASSERT_EQ("foo", iter->key().ToString());
+  ASSERT_EQ("v5", iter->value().ToString());
+  iter->Next();
+  ASSERT_EQ("foobar", iter->key().ToString());
+  iter->Next();
+  ASSERT_FALSE(iter->Valid());
+  iter->SeekForPrev("foo0");
+  ASSERT_EQ("foo", iter->key().ToString());
+  iter->Prev();
+  ASSERT_EQ("bar", iter->key().ToString());
+  iter.reset();
+
+  ASSERT_OK(Flush());
+  ASSERT_EQ("v5", Get("foo"));
+  ASSERT_EQ("v2", Get("foobar"));
+  ASSERT_EQ("NOT_FOUND", Get("fo"));
+}
+
 TEST_F(DBMemTableTest, InsertWithHint) {
   Options options;
   options.allow_concurrent_memtable_write = false;
@@ -244,6 +410,67 @@ TEST_F(DBMemTableTest, InsertWithHint) {
   ASSERT_EQ("vvv", Get("whitelisted"));
 }
 
+TEST_F(DBMemTableTest, PointLookupIndex) {
+  Options options = CurrentOptions();
+  options.memtable_point_lookup_index = true;
+  options.merge_operator = MergeOperators::CreateStringAppendOperator();
+  Reopen(options);
+
+  ASSERT_OK(Put("k1", "v1"));
+  ASSERT_OK(Put("k2", "v1"));
+  const Snapshot* snapshot = db_->GetSnapshot();
+  ASSERT_OK(Put("k1", "v2"));
+  ASSERT_OK(Delete("k2"));
+  ASSERT_OK(Merge("k3", "a"));
+  ASSERT_OK(Merge("k3", "b"));
+  ASSERT_OK(Put("k4", "v1"));
+  ASSERT_OK(SingleDelete("k4"));
+  ASSERT_OK(Put("k5", "v1"));
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(), "k5",
+                             "k6"));
+
+  ASSERT_EQ("v2", Get("k1"));
+  ASSERT_EQ("NOT_FOUND", Get("k2"));
+  ASSERT_EQ("a,b", Get("k3"));
+  ASSERT_EQ("NOT_FOUND", Get("k4"));
+  ASSERT_EQ("NOT_FOUND", Get("k5"));
+  ASSERT_EQ("NOT_FOUND", Get("k6"));
+  ASSERT_EQ("v1", Get("k1", snapshot));
+  ASSERT_EQ("v1", Get("k2", snapshot));
+  ASSERT_EQ("NOT_FOUND", Get("k3", snapshot));
+
+  // Keys missing from the new memtable are looked up in the SST file.
+  ASSERT_OK(Flush());
+  ASSERT_OK(Merge("k3", "c"));
+  ASSERT_OK(Put("k1", "v3"));
+  ASSERT_EQ("v3", Get("k1"));
+  ASSERT_EQ("NOT_FOUND", Get("k2"));
+  ASSERT_EQ("a,b,c", Get("k3"));
+  ASSERT_EQ("v1", Get("k1", snapshot));
+  db_->ReleaseSnapshot(snapshot);
+
+  // Concurrent writers to the same keys leave the newest entry in the index.
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < 1000; i++) {
+        ASSERT_OK(Put("key" + ToString(i % 10), ToString(t * 1000 + i)));
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  int count = 0;
+  for (iter->Seek("key"); iter->Valid() && iter->key().starts_with("key");
+       iter->Next()) {
+    ASSERT_EQ(iter->value().ToString(), Get(iter->key().ToString()));
+    count++;
+  }
+  ASSERT_EQ(10, count);
+}
+
 TEST_F(DBMemTableTest, ColumnFamilyId) {
   // Verifies MemTableRepFactory is told the right column family id.
   Options options;
@@ -649,6 +649,39 @@ TEST_F(DBRangeDelTest, GetCoveredKeyFromSst) {
   } while (ChangeOptions(kRangeDelSkipConfigs | kSkipHashCuckoo));
 }
 
+TEST_F(DBRangeDelTest, GetWithManyRangeDeletions) {
+  const int kNumKeys = 100;
+  auto key = [](int i) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "key%03d", i);
+    return std::string(buf);
+  };
+  DestroyAndReopen(CurrentOptions());
+  for (int i = 0; i < kNumKeys; ++i) {
+    ASSERT_OK(Put(key(i), "val"));
+  }
+  // Reads in between range deletions must see every one of them
+  const Snapshot* snapshot = nullptr;
+  for (int i = 0; i < kNumKeys; i += 2) {
+    if (i == kNumKeys / 2) {
+      snapshot = db_->GetSnapshot();
+    }
+    ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(),
+                               key(i), key(i + 1)));
+    ASSERT_EQ("NOT_FOUND", Get(key(i)));
+    ASSERT_EQ("val", Get(key(i + 1)));
+  }
+  for (int flushed = 0; flushed < 2; ++flushed) {
+    for (int i = 0; i < kNumKeys; ++i) {
+      ASSERT_EQ(i % 2 == 0 ? "NOT_FOUND" : "val", Get(key(i)));
+      ASSERT_EQ(i % 2 == 0 && i < kNumKeys / 2 ? "NOT_FOUND" : "val",
+                Get(key(i), snapshot));
+    }
+    ASSERT_OK(Flush());
+  }
+  db_->ReleaseSnapshot(snapshot);
+}
+
 TEST_F(DBRangeDelTest, GetCoveredMergeOperandFromMemtable) {
   const int kNumMergeOps = 10;
   Options opts = CurrentOptions();
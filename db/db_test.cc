@@ -5712,6 +5712,113 @@ TEST_F(DBTest, RowCache) {
   ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_MISS), 1);
 }
 
+TEST_F(DBTest, RowCacheNegativeEntries) {
+  Options options = CurrentOptions();
+  options.statistics = rocksdb::CreateDBStatistics();
+  options.row_cache = NewLRUCache(8192);
+  DestroyAndReopen(options);
+
+  ASSERT_OK(Put("a", "va"));
+  ASSERT_OK(Put("z", "vz"));
+  ASSERT_OK(Flush());
+
+  // "m" is within the key range of the file, but not in it
+  ASSERT_EQ(Get("m"), "NOT_FOUND");
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_HIT), 0);
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_MISS), 1);
+  ASSERT_EQ(Get("m"), "NOT_FOUND");
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_HIT), 1);
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_MISS), 1);
+
+  // A newer file with the key is looked up in its own entry
+  ASSERT_OK(Put("m", "vm"));
+  ASSERT_OK(Flush());
+  ASSERT_EQ(Get("m"), "vm");
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_HIT), 1);
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_MISS), 2);
+  ASSERT_EQ(Get("m"), "vm");
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_HIT), 2);
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_MISS), 2);
+
+  // Deleted in a newer file, then absent from the file compacted from them
+  ASSERT_OK(Delete("m"));
+  ASSERT_OK(Flush());
+  ASSERT_EQ(Get("m"), "NOT_FOUND");
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ(Get("m"), "NOT_FOUND");
+  ASSERT_EQ(Get("m"), "NOT_FOUND");
+  ASSERT_EQ(Get("a"), "va");
+
+  // A file with a range tombstone over the key must keep deleting it
+  ASSERT_OK(Put("k", "vk"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(), "j",
+                             "l"));
+  ASSERT_OK(Flush());
+  ASSERT_EQ(Get("k"), "NOT_FOUND");
+  ASSERT_EQ(Get("k"), "NOT_FOUND");
+}
+
+TEST_F(DBTest, RowCacheRangeTombstoneOlderThanFile) {
+  Options options = CurrentOptions();
+  options.statistics = rocksdb::CreateDBStatistics();
+  options.row_cache = NewLRUCache(8192);
+  options.disable_auto_compactions = true;
+  DestroyAndReopen(options);
+  // Keeps the sequence numbers of the bottommost files
+  const Snapshot* snapshot = db_->GetSnapshot();
+
+  ASSERT_OK(Put("c", "vc"));
+  ASSERT_OK(Put("k", "vk"));
+  ASSERT_OK(Flush());
+  MoveFilesToLevel(2);
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(), "k",
+                             "l"));
+  ASSERT_OK(Flush());
+  MoveFilesToLevel(1);
+  // "j" is compacted into the L2 file of "k", past the L1 range tombstone
+  // over "k", which is older than "j"
+  ASSERT_OK(Put("j", "vj"));
+  ASSERT_OK(Flush());
+  ColumnFamilyMetaData cf_meta;
+  db_->GetColumnFamilyMetaData(&cf_meta);
+  ASSERT_EQ(1U, cf_meta.levels[0].files.size());
+  ASSERT_OK(db_->CompactFiles(CompactionOptions(),
+                              {cf_meta.levels[0].files[0].name}, 2));
+  ASSERT_EQ("0,1,1", FilesPerLevel());
+
+  ASSERT_EQ(Get("k"), "NOT_FOUND");
+  ASSERT_EQ(Get("k"), "NOT_FOUND");
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_HIT), 1);
+  ASSERT_EQ(Get("j"), "vj");
+  db_->ReleaseSnapshot(snapshot);
+}
+
+TEST_F(DBTest, RowCacheSizePerColumnFamily) {
+  Options options = CurrentOptions();
+  options.statistics = rocksdb::CreateDBStatistics();
+  options.row_cache = NewLRUCache(8192);
+  CreateColumnFamilies({"pikachu"}, options);
+  Options pikachu_options = options;
+  pikachu_options.row_cache_size = 8192;
+  ReopenWithColumnFamilies({"default", "pikachu"},
+                           std::vector<Options>{options, pikachu_options});
+
+  ASSERT_OK(Put(1, "foo", "bar"));
+  ASSERT_OK(Flush(1));
+  ASSERT_EQ(Get(1, "foo"), "bar");
+  ASSERT_EQ(Get(1, "foo"), "bar");
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_HIT), 1);
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_MISS), 1);
+  // The column family has a row cache of its own
+  ASSERT_EQ(0, options.row_cache->GetUsage());
+
+  ASSERT_OK(Put(0, "foo", "bar"));
+  ASSERT_OK(Flush(0));
+  ASSERT_EQ(Get(0, "foo"), "bar");
+  ASSERT_LT(0, options.row_cache->GetUsage());
+}
+
 TEST_F(DBTest, PinnableSliceAndRowCache) {
   Options options = CurrentOptions();
   options.statistics = rocksdb::CreateDBStatistics();
@@ -5730,6 +5837,8 @@ TEST_F(DBTest, PinnableSliceAndRowCache) {
     PinnableSlice pin_slice;
     ASSERT_EQ(Get("foo", &pin_slice), Status::OK());
     ASSERT_EQ(pin_slice.ToString(), "bar");
+    // The value is not copied out of the cache
+    ASSERT_TRUE(pin_slice.IsPinned());
     // Entry is already in cache, lookup will remove the element from lru
     ASSERT_EQ(
         reinterpret_cast<LRUCache*>(options.row_cache.get())->TEST_GetLRUSize(),
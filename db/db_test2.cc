@@ -454,6 +454,154 @@ TEST_F(DBTest2, SharedWriteBufferLimitAcrossDB) {
   rocksdb::SyncPoint::GetInstance()->DisableProcessing();
 }
 
+TEST_F(DBTest2, SharedWriteBufferCostBasedFlushAcrossDB) {
+  std::string dbname2 = test::PerThreadDBPath("db_shared_wb_db2");
+  Options options = CurrentOptions();
+  options.arena_block_size = 4096;
+  // Avoid undeterministic value by malloc_usable_size();
+  // Force arena block size to 1
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "Arena::Arena:0", [&](void* arg) {
+        size_t* block_size = static_cast<size_t*>(arg);
+        *block_size = 1;
+      });
+
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "Arena::AllocateNewBlock:0", [&](void* arg) {
+        std::pair<size_t*, size_t*>* pair =
+            static_cast<std::pair<size_t*, size_t*>*>(arg);
+        *std::get<0>(*pair) = *std::get<1>(*pair);
+      });
+  rocksdb::SyncPoint::GetInstance()->EnableProcessing();
+
+  options.write_buffer_size = 500000;  // this is never hit
+  // Use a write buffer total size so that the soft limit is about
+  // 105000.
+  options.write_buffer_manager.reset(
+      new WriteBufferManager(120000, {}, true /* cost_based_flush */));
+  CreateAndReopenWithCF({"cf1", "cf2"}, options);
+
+  ASSERT_OK(DestroyDB(dbname2, options));
+  DB* db2 = nullptr;
+  ASSERT_OK(DB::Open(options, dbname2, &db2));
+
+  WriteOptions wo;
+  wo.disableWAL = true;
+
+  std::function<void()> wait_flush = [&]() {
+    dbfull()->TEST_WaitForFlushMemTable(handles_[0]);
+    dbfull()->TEST_WaitForFlushMemTable(handles_[1]);
+    dbfull()->TEST_WaitForFlushMemTable(handles_[2]);
+    // Also waits for the flushed memtables of DB2 to be freed
+    static_cast<DBImpl*>(db2)->TEST_WaitForCompact();
+  };
+
+  // The largest memtable is in DB2, which then goes idle
+  ASSERT_OK(db2->Put(wo, Key(1), DummyString(60000)));
+  ASSERT_OK(Put(1, Key(1), DummyString(30000), wo));
+  ASSERT_OK(Put(2, Key(1), DummyString(20000), wo));
+  // Over the limit. DB1 asks DB2 to flush instead of flushing its own
+  // oldest memtable, and DB2 switches it without waiting for a write.
+  ASSERT_OK(Put(0, Key(1), DummyString(1), wo));
+  wait_flush();
+  ASSERT_EQ(GetNumberOfSstFilesForColumnFamily(db_, "default") +
+                GetNumberOfSstFilesForColumnFamily(db_, "cf1") +
+                GetNumberOfSstFilesForColumnFamily(db_, "cf2"),
+            static_cast<uint64_t>(0));
+  ASSERT_EQ(GetNumberOfSstFilesForColumnFamily(db2, "default"),
+            static_cast<uint64_t>(1));
+
+  // Over the limit again; now cf2 of DB1 is the largest, and is switched
+  // by the write that finds the limit exceeded.
+  ASSERT_OK(Put(2, Key(2), DummyString(60000), wo));
+  ASSERT_OK(Put(0, Key(2), DummyString(1), wo));
+  wait_flush();
+  ASSERT_EQ(GetNumberOfSstFilesForColumnFamily(db_, "cf2"),
+            static_cast<uint64_t>(1));
+  ASSERT_EQ(GetNumberOfSstFilesForColumnFamily(db_, "default"),
+            static_cast<uint64_t>(0));
+
+  delete db2;
+  ASSERT_OK(DestroyDB(dbname2, options));
+
+  rocksdb::SyncPoint::GetInstance()->DisableProcessing();
+}
+
+TEST_F(DBTest2, SharedWriteBufferCostBasedFlushIdleDB) {
+  std::string dbname2 = test::PerThreadDBPath("db_shared_wb_db2");
+  Options options = CurrentOptions();
+  options.arena_block_size = 4096;
+  // Avoid undeterministic value by malloc_usable_size();
+  // Force arena block size to 1
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "Arena::Arena:0", [&](void* arg) {
+        size_t* block_size = static_cast<size_t*>(arg);
+        *block_size = 1;
+      });
+
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "Arena::AllocateNewBlock:0", [&](void* arg) {
+        std::pair<size_t*, size_t*>* pair =
+            static_cast<std::pair<size_t*, size_t*>*>(arg);
+        *std::get<0>(*pair) = *std::get<1>(*pair);
+      });
+  rocksdb::SyncPoint::GetInstance()->EnableProcessing();
+
+  options.write_buffer_size = 500000;  // this is never hit
+  // Use a write buffer total size so that the soft limit is about
+  // 105000.
+  options.write_buffer_manager.reset(
+      new WriteBufferManager(120000, {}, true /* cost_based_flush */));
+  CreateAndReopenWithCF({"cf1", "cf2"}, options);
+
+  ASSERT_OK(DestroyDB(dbname2, options));
+  DB* db2 = nullptr;
+  ASSERT_OK(DB::Open(options, dbname2, &db2));
+
+  WriteOptions wo;
+  wo.disableWAL = true;
+
+  std::function<void()> wait_flush = [&]() {
+    dbfull()->TEST_WaitForFlushMemTable(handles_[0]);
+    dbfull()->TEST_WaitForFlushMemTable(handles_[1]);
+    dbfull()->TEST_WaitForFlushMemTable(handles_[2]);
+    // Also waits for the flushed memtables of DB2 to be freed
+    static_cast<DBImpl*>(db2)->TEST_WaitForCompact();
+  };
+
+  // DB2 has the largest memtable, and is never written to again
+  ASSERT_OK(db2->Put(wo, Key(1), DummyString(60000)));
+  ASSERT_OK(Put(1, Key(1), DummyString(30000), wo));
+  ASSERT_OK(Put(2, Key(1), DummyString(20000), wo));
+  size_t mutable_before =
+      options.write_buffer_manager->mutable_memtable_memory_usage();
+  // Over the limit. DB2 is asked to flush, and switches its memtable
+  // without waiting for a write.
+  ASSERT_OK(Put(0, Key(1), DummyString(1), wo));
+  ASSERT_GT(mutable_before - 50000,
+            options.write_buffer_manager->mutable_memtable_memory_usage());
+  wait_flush();
+  ASSERT_EQ(GetNumberOfSstFilesForColumnFamily(db2, "default"),
+            static_cast<uint64_t>(1));
+
+  // Further writes to DB1 do not flush its own memtables one after another
+  for (int i = 2; i < 6; i++) {
+    ASSERT_OK(Put(0, Key(i), DummyString(1000), wo));
+    wait_flush();
+  }
+  ASSERT_EQ(GetNumberOfSstFilesForColumnFamily(db_, "default") +
+                GetNumberOfSstFilesForColumnFamily(db_, "cf1") +
+                GetNumberOfSstFilesForColumnFamily(db_, "cf2"),
+            static_cast<uint64_t>(0));
+  ASSERT_EQ(GetNumberOfSstFilesForColumnFamily(db2, "default"),
+            static_cast<uint64_t>(1));
+
+  delete db2;
+  ASSERT_OK(DestroyDB(dbname2, options));
+
+  rocksdb::SyncPoint::GetInstance()->DisableProcessing();
+}
+
 namespace {
   void ValidateKeyExistence(DB* db, const std::vector<Slice>& keys_must_exist,
     const std::vector<Slice>& keys_must_not_exist) {
@@ -2598,6 +2746,196 @@ TEST_F(DBTest2, TraceAndReplay) {
 
 #endif  // ROCKSDB_LITE
 
+TEST_F(DBTest2, HotKeyCache) {
+  Options options = CurrentOptions();
+  options.hot_key_cache_size = 1 << 20;
+  options.merge_operator = MergeOperators::CreatePutOperator();
+  options.statistics = rocksdb::CreateDBStatistics();
+  Reopen(options);
+
+  // Keys are cached the second time they are read
+  ASSERT_OK(Put("foo", "v1"));
+  ASSERT_EQ("v1", Get("foo"));
+  ASSERT_EQ("v1", Get("foo"));
+  ASSERT_EQ(0, TestGetTickerCount(options, HOT_KEY_CACHE_HIT));
+  ASSERT_EQ("v1", Get("foo"));
+  ASSERT_EQ(1, TestGetTickerCount(options, HOT_KEY_CACHE_HIT));
+
+  // Writes invalidate the cached value, and the key stays hot
+  ASSERT_OK(Put("foo", "v2"));
+  ASSERT_EQ("v2", Get("foo"));
+  ASSERT_EQ(1, TestGetTickerCount(options, HOT_KEY_CACHE_HIT));
+  ASSERT_EQ("v2", Get("foo"));
+  ASSERT_EQ(2, TestGetTickerCount(options, HOT_KEY_CACHE_HIT));
+
+  // Snapshots older than the cached value read it from the DB
+  const Snapshot* snapshot = db_->GetSnapshot();
+  ASSERT_OK(Merge("foo", "v3"));
+  ASSERT_EQ("v3", Get("foo"));
+  ASSERT_EQ("v3", Get("foo"));
+  ASSERT_EQ("v2", Get("foo", snapshot));
+  ASSERT_EQ(3, TestGetTickerCount(options, HOT_KEY_CACHE_HIT));
+  db_->ReleaseSnapshot(snapshot);
+
+  // Absent keys are cached as well
+  ASSERT_OK(Delete("foo"));
+  ASSERT_EQ("NOT_FOUND", Get("foo"));
+  ASSERT_EQ("NOT_FOUND", Get("foo"));
+  ASSERT_EQ(4, TestGetTickerCount(options, HOT_KEY_CACHE_HIT));
+
+  // Range deletions invalidate all keys
+  ASSERT_OK(Put("bar", "v1"));
+  ASSERT_OK(Put("foo", "v4"));
+  ASSERT_EQ("v1", Get("bar"));
+  ASSERT_EQ("v4", Get("foo"));
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(), "a",
+                             "z"));
+  ASSERT_EQ("NOT_FOUND", Get("bar"));
+  ASSERT_EQ("NOT_FOUND", Get("foo"));
+  ASSERT_EQ(4, TestGetTickerCount(options, HOT_KEY_CACHE_HIT));
+
+  // Values survive flushes and compactions
+  ASSERT_OK(Put("foo", "v5"));
+  ASSERT_EQ("v5", Get("foo"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ("v5", Get("foo"));
+  ASSERT_EQ(5, TestGetTickerCount(options, HOT_KEY_CACHE_HIT));
+}
+
+#ifndef ROCKSDB_LITE
+TEST_F(DBTest2, HotKeyCacheDeleteFilesInRange) {
+  Options options = CurrentOptions();
+  options.hot_key_cache_size = 1 << 20;
+  options.statistics = rocksdb::CreateDBStatistics();
+  Reopen(options);
+
+  ASSERT_OK(Put("foo", "v1"));
+  ASSERT_OK(Flush());
+  MoveFilesToLevel(1);
+  for (int i = 0; i < 3; i++) {
+    ASSERT_EQ("v1", Get("foo"));
+  }
+  ASSERT_EQ(1, TestGetTickerCount(options, HOT_KEY_CACHE_HIT));
+
+  // Deleting the file drops the key without a write
+  Slice begin("a");
+  Slice end("z");
+  ASSERT_OK(DeleteFilesInRange(db_, db_->DefaultColumnFamily(), &begin, &end));
+  ASSERT_EQ("", FilesPerLevel());
+  ASSERT_EQ("NOT_FOUND", Get("foo"));
+  ASSERT_EQ(1, TestGetTickerCount(options, HOT_KEY_CACHE_HIT));
+}
+#endif  // ROCKSDB_LITE
+
+TEST_F(DBTest2, HotKeyCacheFIFOCompaction) {
+  Options options = CurrentOptions();
+  options.hot_key_cache_size = 1 << 20;
+  options.compaction_style = kCompactionStyleFIFO;
+  options.statistics = rocksdb::CreateDBStatistics();
+  DestroyAndReopen(options);
+
+  // FIFO compaction drops files without writes, so the cache is not used
+  ASSERT_OK(Put("foo", "v1"));
+  ASSERT_OK(Flush());
+  for (int i = 0; i < 3; i++) {
+    ASSERT_EQ("v1", Get("foo"));
+  }
+  ASSERT_EQ(0, TestGetTickerCount(options, HOT_KEY_CACHE_HIT));
+  ASSERT_EQ(0, TestGetTickerCount(options, HOT_KEY_CACHE_MISS));
+}
+
+TEST_F(DBTest2, HotKeyCacheReadTier) {
+  Options options = CurrentOptions();
+  options.hot_key_cache_size = 1 << 20;
+  options.statistics = rocksdb::CreateDBStatistics();
+  Reopen(options);
+
+  ASSERT_OK(Put("foo", "v1"));
+  ASSERT_OK(Flush());
+  WriteOptions wo;
+  wo.disableWAL = true;
+  ASSERT_OK(db_->Put(wo, "foo", "v2"));
+  for (int i = 0; i < 3; i++) {
+    ASSERT_EQ("v2", Get("foo"));
+  }
+  ASSERT_EQ(1, TestGetTickerCount(options, HOT_KEY_CACHE_HIT));
+
+  // The cached value is not persisted yet
+  ReadOptions ro;
+  ro.read_tier = kPersistedTier;
+  std::string value;
+  ASSERT_OK(db_->Get(ro, "foo", &value));
+  ASSERT_EQ("v1", value);
+  ASSERT_EQ(1, TestGetTickerCount(options, HOT_KEY_CACHE_HIT));
+}
+
+TEST_F(DBTest2, GetAfterFlushReusesThreadLocalSuperVersion) {
+  Options options = CurrentOptions();
+  options.statistics = rocksdb::CreateDBStatistics();
+  Reopen(options);
+
+  ASSERT_OK(Put("foo", "v1"));
+  ASSERT_EQ("v1", Get("foo"));
+  uint64_t acquires = TestGetTickerCount(options, NUMBER_SUPERVERSION_ACQUIRES);
+
+  // The flush hands this thread the new SuperVersions, so reads do not have
+  // to acquire them under the DB mutex
+  for (int i = 0; i < 3; i++) {
+    ASSERT_OK(Put("foo", "v" + ToString(i + 2)));
+    ASSERT_OK(Flush());
+    ASSERT_EQ("v" + ToString(i + 2), Get("foo"));
+  }
+  ASSERT_EQ(acquires,
+            TestGetTickerCount(options, NUMBER_SUPERVERSION_ACQUIRES));
+}
+
+TEST_F(DBTest2, LearnedLevelIndex) {
+  Options options = CurrentOptions();
+  options.learned_level_index = true;
+  options.disable_auto_compactions = true;
+  options.compression = kNoCompression;
+  options.target_file_size_base = 4 << 10;
+  DestroyAndReopen(options);
+
+  auto id_key = [](uint64_t id) {
+    std::string key(8, '\0');
+    for (int i = 0; i < 8; ++i) {
+      key.push_back(static_cast<char>(id >> (56 - 8 * i)));
+    }
+    return key;
+  };
+  Random rnd(301);
+  const uint64_t kNumKeys = 2000;
+  for (uint64_t i = 0; i < kNumKeys; ++i) {
+    ASSERT_OK(Put(id_key(i * 2), RandomString(&rnd, 100)));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ(0, NumTableFilesAtLevel(0));
+
+  int narrowed = 0;
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "NarrowFileRangeWithLearnedIndex:Narrowed",
+      [&](void* /*arg*/) { ++narrowed; });
+  rocksdb::SyncPoint::GetInstance()->EnableProcessing();
+
+  for (uint64_t id = 0; id < kNumKeys * 2; ++id) {
+    std::string value;
+    Status s = db_->Get(ReadOptions(), id_key(id), &value);
+    if (id % 2 == 0) {
+      ASSERT_OK(s);
+      ASSERT_EQ(100, value.size());
+    } else {
+      ASSERT_TRUE(s.IsNotFound());
+    }
+  }
+  ASSERT_GT(narrowed, 0);
+
+  rocksdb::SyncPoint::GetInstance()->DisableProcessing();
+  rocksdb::SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
 TEST_F(DBTest2, PinnableSliceAndMmapReads) {
   Options options = CurrentOptions();
   options.allow_mmap_reads = true;
@@ -586,6 +586,47 @@ TEST_F(DBWALTest, RecoverWithLargeLog) {
   } while (ChangeWalOptions());
 }
 
+TEST_F(DBWALTest, RecoverWithCompressedWAL) {
+  if (!Zlib_Supported()) {
+    return;
+  }
+  Options options = CurrentOptions();
+  options.wal_compression = kZlibCompression;
+  CreateAndReopenWithCF({"pikachu"}, options);
+  ASSERT_OK(Put(1, "foo", "v1"));
+  ASSERT_OK(Put(1, "bar", DummyString(10000, 'b')));
+  ReopenWithColumnFamilies({"default", "pikachu"}, options);
+  ASSERT_EQ("v1", Get(1, "foo"));
+  ASSERT_EQ(DummyString(10000, 'b'), Get(1, "bar"));
+
+  // The WAL created by the flush below is compressed as well, and the
+  // transaction log iterator can read both.
+  SequenceNumber start = dbfull()->GetLatestSequenceNumber();
+  ASSERT_OK(Put(1, "baz", "v3"));
+  ASSERT_OK(Put(0, "default", "v4"));
+  ASSERT_OK(Flush(0));
+  ASSERT_OK(Put(1, "qux", DummyString(10000, 'q')));
+  unique_ptr<TransactionLogIterator> iter;
+  ASSERT_OK(db_->GetUpdatesSince(start + 1, &iter));
+  int num_batches = 0;
+  for (; iter->Valid(); iter->Next()) {
+    BatchResult batch = iter->GetBatch();
+    ASSERT_EQ(start + 1 + num_batches, batch.sequence);
+    num_batches++;
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(3, num_batches);
+  iter.reset();
+
+  // Compressed WALs are readable regardless of the option.
+  options.wal_compression = kNoCompression;
+  ReopenWithColumnFamilies({"default", "pikachu"}, options);
+  ASSERT_EQ("v1", Get(1, "foo"));
+  ASSERT_EQ("v3", Get(1, "baz"));
+  ASSERT_EQ("v4", Get(0, "default"));
+  ASSERT_EQ(DummyString(10000, 'q'), Get(1, "qux"));
+}
+
 // In https://reviews.facebook.net/D20661 we change
 // recovery behavior: previously for each log file each column family
 // memtable was flushed, even it was empty. Now it's changed:
@@ -1096,6 +1137,118 @@ TEST_F(DBWALTest, kSkipAnyCorruptedRecords) {
   }
 }
 
+// Test scope:
+// - Recovery with a pool of memtable insert threads, with batches that hold
+//   merges, which take the single-threaded path, between the others
+// - A corrupted record in the middle of the last WAL is treated as in the
+//   single-threaded replay, in each WALRecoveryMode
+TEST_F(DBWALTest, RecoverWithParallelReplay) {
+  const int kNumBatches = 2000;
+  const int kCorruptedBatch = kNumBatches * 9 / 10;
+  // Writes kNumBatches batches and returns the WAL holding batch
+  // kCorruptedBatch in *corrupt_wal, its offset in that file in
+  // *corrupt_offset and its sequence number in *corrupt_sequence.
+  auto write_batches = [&](char first, std::string* corrupt_wal,
+                           uint64_t* corrupt_offset,
+                           SequenceNumber* corrupt_sequence) {
+    for (int i = 0; i < kNumBatches; i++) {
+      if (i == kCorruptedBatch) {
+        *corrupt_wal = LogFileName(dbname_, dbfull()->TEST_LogfileNumber());
+        ASSERT_OK(env_->GetFileSize(*corrupt_wal, corrupt_offset));
+        *corrupt_sequence = dbfull()->GetLatestSequenceNumber() + 1;
+      }
+      char c = static_cast<char>(first + i % 26);
+      WriteBatch batch;
+      ASSERT_OK(batch.Put(handles_[0], Key(i), DummyString(100, c)));
+      ASSERT_OK(batch.Put(handles_[1], Key(i), DummyString(200, c)));
+      if (i % 10 == 0) {
+        ASSERT_OK(batch.Delete(handles_[1], Key(i)));
+      }
+      if (i % 7 == 0) {
+        ASSERT_OK(batch.Merge(handles_[0], Key(i), "m"));
+      }
+      ASSERT_OK(dbfull()->Write(WriteOptions(), &batch));
+    }
+  };
+  auto check_batch = [&](char first, int i) {
+    char c = static_cast<char>(first + i % 26);
+    ASSERT_EQ(DummyString(100, c) + (i % 7 == 0 ? ",m" : ""), Get(0, Key(i)));
+    if (i % 10 == 0) {
+      ASSERT_EQ("NOT_FOUND", Get(1, Key(i)));
+    } else {
+      ASSERT_EQ(DummyString(200, c), Get(1, Key(i)));
+    }
+  };
+
+  for (auto mode : {WALRecoveryMode::kTolerateCorruptedTailRecords,
+                    WALRecoveryMode::kAbsoluteConsistency,
+                    WALRecoveryMode::kPointInTimeRecovery,
+                    WALRecoveryMode::kSkipAnyCorruptedRecords}) {
+    Options options = CurrentOptions();
+    options.allow_concurrent_memtable_write = true;
+    options.merge_operator = MergeOperators::CreateStringAppendOperator();
+    options.disable_auto_compactions = true;
+    options.wal_recovery_mode = mode;
+    options.max_wal_recovery_threads = 4;
+    DestroyAndReopen(options);
+    CreateAndReopenWithCF({"pikachu"}, options);
+    std::string corrupt_wal;
+    uint64_t corrupt_offset = 0;
+    SequenceNumber corrupt_sequence = 0;
+    write_batches('a', &corrupt_wal, &corrupt_offset, &corrupt_sequence);
+    SequenceNumber last_sequence = dbfull()->GetLatestSequenceNumber();
+    ASSERT_EQ(NumTableFilesAtLevel(0, 1), 0);
+
+    // Reopen with a small write buffer so that memtables fill up, and get
+    // flushed, while the replay workers are inserting.
+    Options small_buffer_options = options;
+    small_buffer_options.write_buffer_size = 100000;
+    ReopenWithColumnFamilies({"default", "pikachu"}, small_buffer_options);
+    ASSERT_EQ(last_sequence, dbfull()->GetLatestSequenceNumber());
+    ASSERT_GT(NumTableFilesAtLevel(0, 1), 1);
+    for (int i = 0; i < kNumBatches; i++) {
+      check_batch('a', i);
+    }
+
+    // Overwrite all keys, and corrupt the record of one of the last batches
+    // in the WAL.
+    ReopenWithColumnFamilies({"default", "pikachu"}, options);
+    write_batches('A', &corrupt_wal, &corrupt_offset, &corrupt_sequence);
+    last_sequence = dbfull()->GetLatestSequenceNumber();
+    Close();
+    RecoveryTestHelper::InduceCorruption(
+        corrupt_wal, static_cast<size_t>(corrupt_offset), 8);
+
+    Status s = TryReopenWithColumnFamilies({"default", "pikachu"},
+                                           small_buffer_options);
+    switch (mode) {
+      case WALRecoveryMode::kTolerateCorruptedTailRecords:
+      case WALRecoveryMode::kAbsoluteConsistency:
+        ASSERT_NOK(s);
+        break;
+      case WALRecoveryMode::kPointInTimeRecovery:
+        // Nothing from the corrupted batch on was applied
+        ASSERT_OK(s);
+        ASSERT_EQ(corrupt_sequence - 1, dbfull()->GetLatestSequenceNumber());
+        for (int i = 0; i < kNumBatches; i++) {
+          check_batch(i < kCorruptedBatch ? 'A' : 'a', i);
+        }
+        break;
+      case WALRecoveryMode::kSkipAnyCorruptedRecords:
+        // The rest of the log block of the corrupted record is dropped, so
+        // some of the batches after it may be lost as well.
+        ASSERT_OK(s);
+        for (int i = 0; i < kCorruptedBatch; i++) {
+          check_batch('A', i);
+        }
+        check_batch('a', kCorruptedBatch);
+        check_batch('A', kNumBatches - 1);
+        ASSERT_EQ(last_sequence, dbfull()->GetLatestSequenceNumber());
+        break;
+    }
+  }
+}
+
 TEST_F(DBWALTest, AvoidFlushDuringRecovery) {
   Options options = CurrentOptions();
   options.disable_auto_compactions = true;
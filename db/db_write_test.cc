@@ -39,6 +39,109 @@ TEST_P(DBWriteTest, SyncAndDisableWAL) {
   ASSERT_TRUE(dbfull()->Write(write_options, &batch).IsInvalidArgument());
 }
 
+TEST_P(DBWriteTest, ProtectedBatch) {
+  Open();
+  WriteBatch batch(0 /* reserved_bytes */, 0 /* max_bytes */,
+                   4 /* protection_bytes_per_key */);
+  ASSERT_OK(batch.Put("foo", "bar"));
+  ASSERT_OK(batch.Delete("baz"));
+  ASSERT_OK(dbfull()->Write(WriteOptions(), &batch));
+  ASSERT_EQ("bar", Get("foo"));
+
+  WriteBatch corrupted(0, 0, 4);
+  ASSERT_OK(corrupted.Put("foo", "boo"));
+  ASSERT_OK(corrupted.Put("baz", "boo"));
+  Slice contents = WriteBatchInternal::Contents(&corrupted);
+  const_cast<char*>(contents.data())[contents.size() - 1] ^= 0x01;
+  // The corrupted batch is caught before it goes to the WAL. Only that write
+  // fails.
+  ASSERT_TRUE(dbfull()->Write(WriteOptions(), &corrupted).IsCorruption());
+  ASSERT_EQ("NOT_FOUND", Get("baz"));
+  ASSERT_OK(Put("qux", "v"));
+
+  // Nor is it replayed from the WAL
+  Reopen(GetOptions());
+  ASSERT_EQ("bar", Get("foo"));
+  ASSERT_EQ("NOT_FOUND", Get("baz"));
+  ASSERT_EQ("v", Get("qux"));
+}
+
+TEST_P(DBWriteTest, MemTableProtection) {
+  Options options = GetOptions();
+  options.memtable_protection_bytes_per_key = 4;
+  CreateAndReopenWithCF({"pikachu"}, options);
+  // Entries of protected batches keep the checksums of the batch, the others
+  // get theirs as they are inserted
+  WriteBatch batch(0 /* reserved_bytes */, 0 /* max_bytes */,
+                   4 /* protection_bytes_per_key */);
+  ASSERT_OK(batch.Put("foo", "v1"));
+  ASSERT_OK(batch.Put(handles_[1], "foo", "v1"));
+  ASSERT_OK(batch.Delete("bar"));
+  ASSERT_OK(batch.SingleDelete(handles_[1], "bar"));
+  ASSERT_OK(batch.DeleteRange(handles_[1], "a", "b"));
+  ASSERT_OK(dbfull()->Write(WriteOptions(), &batch));
+  ASSERT_OK(Put("baz", "v2"));
+  ASSERT_OK(Put(1, "baz", "v2"));
+  ASSERT_OK(Delete(1, "qux"));
+  ASSERT_OK(Flush(0));
+  ASSERT_OK(Flush(1));
+  ASSERT_EQ("v1", Get("foo"));
+  ASSERT_EQ("v1", Get(1, "foo"));
+  ASSERT_EQ("v2", Get(1, "baz"));
+
+  // A memtable entry that changed in memory fails the flush
+  ASSERT_OK(Put("foo", "v3"));
+  {
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+    iter->Seek("foo");
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ("v3", iter->value());
+    const_cast<char*>(iter->value().data())[1] ^= 0x01;
+  }
+  ASSERT_TRUE(Flush(0).IsCorruption());
+}
+
+TEST_P(DBWriteTest, PutByReference) {
+  Options options = GetOptions();
+  Reopen(options);
+  const int kNumThreads = 4;
+  const int kNumBatches = 20;
+  // Write groups of several batches with referenced values
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < kNumBatches; i++) {
+        std::string value(64 << 10, static_cast<char>('a' + t));
+        std::string key = ToString(t) + "_" + ToString(i);
+        WriteBatch batch;
+        ASSERT_OK(batch.Put(key, "small"));
+        ASSERT_OK(batch.PutByReference(key + "_big", value));
+        ASSERT_OK(dbfull()->Write(WriteOptions(), &batch));
+        // The DB has its own copy once Write() returned
+        value.assign(value.size(), 'x');
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  auto verify = [&]() {
+    for (int t = 0; t < kNumThreads; t++) {
+      for (int i = 0; i < kNumBatches; i++) {
+        std::string key = ToString(t) + "_" + ToString(i);
+        ASSERT_EQ("small", Get(key));
+        ASSERT_EQ(std::string(64 << 10, static_cast<char>('a' + t)),
+                  Get(key + "_big"));
+      }
+    }
+  };
+  verify();
+  // The values were written to the WAL
+  Reopen(options);
+  verify();
+}
+
 TEST_P(DBWriteTest, IOErrorOnWALWritePropagateToWriteThreadFollower) {
   constexpr int kNumThreads = 5;
   std::unique_ptr<FaultInjectionTestEnv> mock_env(
@@ -308,6 +308,10 @@ Status FlushJob::WriteLevel0Table() {
       total_num_entries += m->num_entries();
       total_num_deletes += m->num_deletes();
       total_memory_usage += m->ApproximateMemoryUsage();
+      if (s.ok()) {
+        // Entries that changed in memory must not be persisted
+        s = m->VerifyEntryChecksums();
+      }
     }
 
     event_logger_->Log()
@@ -348,18 +352,21 @@ Status FlushJob::WriteLevel0Table() {
       uint64_t oldest_key_time =
           mems_.front()->ApproximateOldestKeyTime();
 
-      s = BuildTable(
-          dbname_, db_options_.env, *cfd_->ioptions(), mutable_cf_options_,
-          env_options_, cfd_->table_cache(), iter.get(),
-          std::move(range_del_iter), &meta_, cfd_->internal_comparator(),
-          cfd_->int_tbl_prop_collector_factories(), cfd_->GetID(),
-          cfd_->GetName(), existing_snapshots_,
-          earliest_write_conflict_snapshot_, snapshot_checker_,
-          output_compression_, cfd_->ioptions()->compression_opts,
-          mutable_cf_options_.paranoid_file_checks, cfd_->internal_stats(),
-          TableFileCreationReason::kFlush, event_logger_, job_context_->job_id,
-          Env::IO_HIGH, &table_properties_, 0 /* level */, current_time,
-          oldest_key_time, write_hint);
+      if (s.ok()) {
+        s = BuildTable(
+            dbname_, db_options_.env, *cfd_->ioptions(), mutable_cf_options_,
+            env_options_, cfd_->table_cache(), iter.get(),
+            std::move(range_del_iter), &meta_, cfd_->internal_comparator(),
+            cfd_->int_tbl_prop_collector_factories(), cfd_->GetID(),
+            cfd_->GetName(), existing_snapshots_,
+            earliest_write_conflict_snapshot_, snapshot_checker_,
+            output_compression_, cfd_->ioptions()->compression_opts,
+            mutable_cf_options_.paranoid_file_checks, cfd_->internal_stats(),
+            TableFileCreationReason::kFlush, event_logger_,
+            job_context_->job_id, Env::IO_HIGH, &table_properties_,
+            0 /* level */, current_time, oldest_key_time, write_hint,
+            base_->storage_info());
+      }
       LogFlush(db_options_.info_log);
     }
     ROCKS_LOG_INFO(db_options_.info_log,
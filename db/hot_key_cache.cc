@@ -0,0 +1,142 @@
+//  Copyright (c) 2018-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "db/hot_key_cache.h"
+
+#include "util/coding.h"
+#include "util/hash.h"
+
+namespace rocksdb {
+
+namespace {
+
+struct HotKeyCacheEntry {
+  std::string value;
+  SequenceNumber seq;
+  uint64_t epoch;
+  bool found;
+};
+
+void DeleteHotKeyCacheEntry(const Slice& /*key*/, void* value) {
+  delete static_cast<HotKeyCacheEntry*>(value);
+}
+
+void ReleaseHotKeyCacheHandle(void* cache, void* handle) {
+  static_cast<Cache*>(cache)->Release(static_cast<Cache::Handle*>(handle));
+}
+
+std::string MakeCacheKey(uint32_t column_family_id, const Slice& key) {
+  std::string cache_key;
+  cache_key.reserve(sizeof(column_family_id) + key.size());
+  PutFixed32(&cache_key, column_family_id);
+  cache_key.append(key.data(), key.size());
+  return cache_key;
+}
+
+}  // anonymous namespace
+
+HotKeyCache::HotKeyCache(size_t capacity)
+    : cache_(NewLRUCache(capacity)),
+      stripes_(new Stripe[kNumStripes]),
+      recent_reads_(new std::atomic<uint32_t>[kNumRecentReads]),
+      epoch_(0),
+      last_invalidate_all_seq_(0) {
+  for (size_t i = 0; i < kNumRecentReads; i++) {
+    recent_reads_[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+HotKeyCache::Stripe* HotKeyCache::GetStripe(const Slice& cache_key) {
+  return &stripes_[GetSliceHash(cache_key) % kNumStripes];
+}
+
+bool HotKeyCache::Admit(const Slice& cache_key) {
+  uint32_t hash = GetSliceHash(cache_key);
+  std::atomic<uint32_t>& slot = recent_reads_[hash % kNumRecentReads];
+  // 0 marks an empty slot
+  uint32_t tag = hash == 0 ? 1 : hash;
+  if (slot.load(std::memory_order_relaxed) == tag) {
+    return true;
+  }
+  slot.store(tag, std::memory_order_relaxed);
+  return false;
+}
+
+bool HotKeyCache::Lookup(uint32_t column_family_id, const Slice& key,
+                         SequenceNumber snapshot, PinnableSlice* value,
+                         bool* found) {
+  std::string cache_key = MakeCacheKey(column_family_id, key);
+  Cache::Handle* handle = cache_->Lookup(cache_key);
+  if (handle == nullptr) {
+    return false;
+  }
+  auto* entry = static_cast<HotKeyCacheEntry*>(cache_->Value(handle));
+  if (entry->epoch != epoch_.load() || entry->seq > snapshot) {
+    // Invalidated, or too new for the snapshot
+    cache_->Release(handle);
+    return false;
+  }
+  *found = entry->found;
+  if (entry->found) {
+    value->PinSlice(entry->value, &ReleaseHotKeyCacheHandle, cache_.get(),
+                    handle);
+  } else {
+    cache_->Release(handle);
+  }
+  return true;
+}
+
+void HotKeyCache::Insert(uint32_t column_family_id, const Slice& key,
+                         SequenceNumber seq, uint64_t epoch,
+                         const Slice* value) {
+  // The epoch was read before last_invalidate_all_seq_, and InvalidateAll()
+  // writes them in the opposite order. So either the entry gets an epoch
+  // that a concurrent InvalidateAll() ends, or it is not inserted.
+  if (epoch != epoch_.load() || last_invalidate_all_seq_.load() > seq) {
+    return;
+  }
+  std::string cache_key = MakeCacheKey(column_family_id, key);
+  if (!Admit(cache_key)) {
+    return;
+  }
+  Stripe* stripe = GetStripe(cache_key);
+  std::lock_guard<SpinMutex> l(stripe->mutex);
+  if (stripe->last_write_seq > seq) {
+    // The key, or another one of the stripe, was written after the read
+    return;
+  }
+  auto* entry = new HotKeyCacheEntry();
+  if (value != nullptr) {
+    entry->value.assign(value->data(), value->size());
+  }
+  entry->seq = seq;
+  entry->epoch = epoch;
+  entry->found = value != nullptr;
+  size_t charge = cache_key.size() + entry->value.size() + sizeof(*entry);
+  cache_->Insert(cache_key, entry, charge, &DeleteHotKeyCacheEntry);
+}
+
+void HotKeyCache::Invalidate(uint32_t column_family_id, const Slice& key,
+                             SequenceNumber seq) {
+  std::string cache_key = MakeCacheKey(column_family_id, key);
+  Stripe* stripe = GetStripe(cache_key);
+  std::lock_guard<SpinMutex> l(stripe->mutex);
+  if (stripe->last_write_seq < seq) {
+    stripe->last_write_seq = seq;
+  }
+  cache_->Erase(cache_key);
+}
+
+void HotKeyCache::InvalidateAll(SequenceNumber seq) {
+  SequenceNumber last_seq = last_invalidate_all_seq_.load();
+  while (last_seq < seq &&
+         !last_invalidate_all_seq_.compare_exchange_weak(last_seq, seq)) {
+  }
+  epoch_.fetch_add(1);
+  // Free the memory of the entries not in use
+  cache_->EraseUnRefEntries();
+}
+
+}  // namespace rocksdb
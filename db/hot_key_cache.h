@@ -0,0 +1,93 @@
+//  Copyright (c) 2018-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "rocksdb/cache.h"
+#include "rocksdb/slice.h"
+#include "rocksdb/types.h"
+#include "util/mutexlock.h"
+
+namespace rocksdb {
+
+class PinnableSlice;
+
+// HotKeyCache caches the latest values of recently read keys in front of the
+// memtables and SST files of a DB, so that reading them again takes a single
+// hash lookup.
+//
+// An entry records the sequence number of the read that filled it, and is
+// valid for reads at that sequence number or later. It stays valid as long as
+// it is in the cache: every write removes the entry of its key before the
+// write becomes visible, and a read only fills the cache if no write to the
+// key was applied after the read's sequence number. Writes that may affect
+// any key, like range deletions, invalidate all entries at once.
+//
+// Thread-safe.
+class HotKeyCache {
+ public:
+  explicit HotKeyCache(size_t capacity);
+
+  // Returns true if the cache knows the value of key in the column family as
+  // of sequence number snapshot. Then *found tells whether the key exists,
+  // and if it does, value is pinned to the cached value.
+  bool Lookup(uint32_t column_family_id, const Slice& key,
+              SequenceNumber snapshot, PinnableSlice* value, bool* found);
+
+  // Returns the token to pass to Insert() for a read that starts now.
+  uint64_t GetEpoch() const { return epoch_.load(); }
+
+  // Caches value, or the absence of key if value is nullptr, as the result of
+  // a read of the column family at sequence number seq, which started when
+  // GetEpoch() returned epoch. Does nothing if the key was written after seq,
+  // or if it was not read recently.
+  void Insert(uint32_t column_family_id, const Slice& key, SequenceNumber seq,
+              uint64_t epoch, const Slice* value);
+
+  // Invalidates the entry of key for a write at sequence number seq.
+  // REQUIRES: the write is not visible to reads yet.
+  void Invalidate(uint32_t column_family_id, const Slice& key,
+                  SequenceNumber seq);
+
+  // Invalidates all entries for a change at sequence number seq. Reads
+  // started before the call do not fill the cache. Reads at sequence numbers
+  // smaller than seq do not fill it either, so a change that is not visible
+  // to reads yet can be covered by passing its sequence number.
+  void InvalidateAll(SequenceNumber seq);
+
+  size_t GetUsage() const { return cache_->GetUsage(); }
+
+ private:
+  struct Stripe {
+    SpinMutex mutex;
+    // The largest sequence number of the writes to the keys of this stripe
+    SequenceNumber last_write_seq = 0;
+  };
+
+  static const size_t kNumStripes = 1024;
+  static const size_t kNumRecentReads = 16 * 1024;
+
+  Stripe* GetStripe(const Slice& cache_key);
+
+  // Returns true if the key was read recently, and records that it was read
+  // otherwise.
+  bool Admit(const Slice& cache_key);
+
+  std::shared_ptr<Cache> cache_;
+  std::unique_ptr<Stripe[]> stripes_;
+  // Hashes of the cache keys of recently read keys, by hash. Keys stay
+  // admitted until another key takes their slot, so a hot key that is
+  // written to is cached again on its next read.
+  std::unique_ptr<std::atomic<uint32_t>[]> recent_reads_;
+  // Entries inserted in an older epoch are invalid
+  std::atomic<uint64_t> epoch_;
+  std::atomic<SequenceNumber> last_invalidate_all_seq_;
+};
+
+}  // namespace rocksdb
@@ -12,6 +12,7 @@
 #include <stdio.h>
 #include "rocksdb/env.h"
 #include "util/coding.h"
+#include "util/compression.h"
 #include "util/crc32c.h"
 #include "util/file_reader_writer.h"
 #include "util/util.h"
@@ -38,7 +39,9 @@ Reader::Reader(std::shared_ptr<Logger> info_log,
       end_of_buffer_offset_(0),
       initial_offset_(initial_offset),
       log_number_(log_num),
-      recycled_(false) {}
+      recycled_(false),
+      compression_type_(kNoCompression),
+      compression_type_record_read_(false) {}
 
 Reader::~Reader() {
   delete[] backing_store_;
@@ -108,6 +111,10 @@ bool Reader::ReadRecord(Slice* record, std::string* scratch,
         scratch->clear();
         *record = fragment;
         last_record_offset_ = prospective_record_offset;
+        if (compression_type_record_read_ && !UncompressRecord(record)) {
+          in_fragmented_record = false;
+          break;
+        }
         return true;
 
       case kFirstType:
@@ -143,10 +150,43 @@ bool Reader::ReadRecord(Slice* record, std::string* scratch,
           scratch->append(fragment.data(), fragment.size());
           *record = Slice(*scratch);
           last_record_offset_ = prospective_record_offset;
+          if (compression_type_record_read_ && !UncompressRecord(record)) {
+            in_fragmented_record = false;
+            scratch->clear();
+            break;
+          }
           return true;
         }
         break;
 
+      case kSetCompressionType: {
+        if (compression_type_record_read_) {
+          ReportCorruption(fragment.size(),
+                           "read multiple SetCompressionType records");
+          break;
+        }
+        if (in_fragmented_record) {
+          ReportCorruption(scratch->size(), "partial record without end(3)");
+          in_fragmented_record = false;
+          scratch->clear();
+        }
+        if (fragment.size() != 1) {
+          ReportCorruption(fragment.size(), "bad SetCompressionType record");
+          break;
+        }
+        compression_type_ = static_cast<CompressionType>(fragment[0]);
+        if (!CompressionTypeSupported(compression_type_)) {
+          ReportDrop(fragment.size(),
+                     Status::NotSupported("WAL compression type",
+                                          CompressionTypeToString(
+                                              compression_type_)));
+          break;
+        }
+        uncompression_ctx_.reset(new UncompressionContext(compression_type_));
+        compression_type_record_read_ = true;
+        break;
+      }
+
       case kBadHeader:
         if (wal_recovery_mode == WALRecoveryMode::kAbsoluteConsistency) {
           // in clean shutdown we don't expect any error in the log files
@@ -227,6 +267,76 @@ bool Reader::ReadRecord(Slice* record, std::string* scratch,
   return false;
 }
 
+bool Reader::UncompressRecord(Slice* record) {
+  if (record->empty()) {
+    ReportCorruption(0, "missing record compression type");
+    return false;
+  }
+  const CompressionType type = static_cast<CompressionType>((*record)[0]);
+  const char* data = record->data() + 1;
+  const size_t n = record->size() - 1;
+  if (type == kNoCompression) {
+    *record = Slice(data, n);
+    return true;
+  }
+  if (type != compression_type_) {
+    ReportCorruption(record->size(), "unexpected record compression type");
+    return false;
+  }
+
+  // Records are written with compress format version 2, which stores the
+  // uncompressed size with the data.
+  const uint32_t kCompressFormatVersion = 2;
+  int decompress_size = 0;
+  uncompressed_record_.reset();
+  switch (type) {
+    case kSnappyCompression: {
+      size_t ulength = 0;
+      if (Snappy_GetUncompressedLength(data, n, &ulength)) {
+        uncompressed_record_.reset(new char[ulength]);
+        if (Snappy_Uncompress(data, n, uncompressed_record_.get())) {
+          decompress_size = static_cast<int>(ulength);
+        } else {
+          uncompressed_record_.reset();
+        }
+      }
+      break;
+    }
+    case kZlibCompression:
+      uncompressed_record_.reset(Zlib_Uncompress(
+          *uncompression_ctx_, data, n, &decompress_size,
+          kCompressFormatVersion));
+      break;
+    case kBZip2Compression:
+      uncompressed_record_.reset(BZip2_Uncompress(data, n, &decompress_size,
+                                                  kCompressFormatVersion));
+      break;
+    case kLZ4Compression:
+    case kLZ4HCCompression:
+      uncompressed_record_.reset(LZ4_Uncompress(*uncompression_ctx_, data, n,
+                                                &decompress_size,
+                                                kCompressFormatVersion));
+      break;
+    case kXpressCompression:
+      uncompressed_record_.reset(
+          XPRESS_Uncompress(data, n, &decompress_size));
+      break;
+    case kZSTD:
+    case kZSTDNotFinalCompression:
+      uncompressed_record_.reset(
+          ZSTD_Uncompress(*uncompression_ctx_, data, n, &decompress_size));
+      break;
+    default:
+      break;
+  }
+  if (!uncompressed_record_) {
+    ReportCorruption(record->size(), "failed to uncompress record");
+    return false;
+  }
+  *record = Slice(uncompressed_record_.get(), decompress_size);
+  return true;
+}
+
 uint64_t Reader::LastRecordOffset() {
   return last_record_offset_;
 }
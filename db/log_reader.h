@@ -20,6 +20,7 @@ namespace rocksdb {
 
 class SequentialFileReader;
 class Logger;
+class UncompressionContext;
 using std::unique_ptr;
 
 namespace log {
@@ -117,6 +118,13 @@ class Reader {
   // Whether this is a recycled log file
   bool recycled_;
 
+  // Set from the kSetCompressionType record of a compressed log
+  CompressionType compression_type_;
+  bool compression_type_record_read_;
+  std::unique_ptr<UncompressionContext> uncompression_ctx_;
+  // Holds the last record returned by ReadRecord() if it was compressed
+  std::unique_ptr<char[]> uncompressed_record_;
+
   // Extend record types with the following special values
   enum {
     kEof = kMaxRecordType + 1,
@@ -147,6 +155,11 @@ class Reader {
   // Read some more
   bool ReadMore(size_t* drop_size, int *error);
 
+  // Strips the compression type prefix from *record and, if the record was
+  // compressed, decompresses it into uncompressed_record_ and points *record
+  // there. Returns false and reports the corruption if that fails.
+  bool UncompressRecord(Slice* record);
+
   // Reports dropped bytes to the reporter.
   // buffer_ must be updated to remove the dropped bytes prior to invocation.
   void ReportCorruption(size_t bytes, const char* reason);
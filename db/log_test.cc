@@ -11,6 +11,7 @@
 #include "db/log_writer.h"
 #include "rocksdb/env.h"
 #include "util/coding.h"
+#include "util/compression.h"
 #include "util/crc32c.h"
 #include "util/file_reader_writer.h"
 #include "util/random.h"
@@ -180,6 +181,10 @@ class LogTest : public ::testing::TestWithParam<int> {
     writer_.AddRecord(Slice(msg));
   }
 
+  void Write(const SliceParts& parts) {
+    writer_.AddRecord(parts);
+  }
+
   size_t WrittenBytes() const {
     return dest_contents().size();
   }
@@ -339,6 +344,21 @@ TEST_P(LogTest, Fragmentation) {
   ASSERT_EQ("EOF", Read());
 }
 
+TEST_P(LogTest, ScatteredRecord) {
+  const std::string big = BigString("big", 2 * kBlockSize);
+  Slice parts[] = {Slice("header"), Slice(), Slice(big), Slice("trailer")};
+  Write(SliceParts(parts, 4));
+  Write(SliceParts(parts, 1));
+  Write(SliceParts(parts + 1, 1));
+  Write("foo");
+  ASSERT_EQ("header" + big + "trailer", Read());
+  ASSERT_EQ("header", Read());
+  ASSERT_EQ("", Read());
+  ASSERT_EQ("foo", Read());
+  ASSERT_EQ("EOF", Read());
+  ASSERT_EQ(0U, DroppedBytes());
+}
+
 TEST_P(LogTest, MarginalTrailer) {
   // Make a trailer that is exactly the same length as an empty record.
   int header_size = GetParam() ? kRecyclableHeaderSize : kHeaderSize;
@@ -728,6 +748,30 @@ TEST_P(LogTest, Recycle) {
   ASSERT_EQ("EOF", Read());
 }
 
+TEST_P(LogTest, CompressedRecords) {
+  if (GetParam()) {
+    return;  // compression is not supported for recycled logs
+  }
+  if (!Zlib_Supported()) {
+    return;
+  }
+  unique_ptr<WritableFileWriter> dest_holder(test::GetWritableFileWriter(
+      new test::StringSink(get_reader_contents())));
+  Writer compressed_writer(std::move(dest_holder), 123, false, false,
+                           kZlibCompression);
+  ASSERT_OK(compressed_writer.AddCompressionTypeRecord());
+  const std::string big = BigString("compressible", 3 * kBlockSize);
+  ASSERT_OK(compressed_writer.AddRecord(Slice("foo")));
+  ASSERT_OK(compressed_writer.AddRecord(Slice(big)));
+  ASSERT_OK(compressed_writer.AddRecord(Slice("")));
+  ASSERT_LT(get_reader_contents()->size(), big.size());
+  ASSERT_EQ("foo", Read());
+  ASSERT_EQ(big, Read());
+  ASSERT_EQ("", Read());
+  ASSERT_EQ("EOF", Read());
+  ASSERT_EQ(0U, DroppedBytes());
+}
+
 INSTANTIATE_TEST_CASE_P(bool, LogTest, ::testing::Values(0, 2));
 
 }  // namespace log
@@ -10,8 +10,11 @@
 #include "db/log_writer.h"
 
 #include <stdint.h>
+#include <algorithm>
 #include "rocksdb/env.h"
+#include "util/autovector.h"
 #include "util/coding.h"
+#include "util/compression.h"
 #include "util/crc32c.h"
 #include "util/file_reader_writer.h"
 
@@ -19,12 +22,17 @@ namespace rocksdb {
 namespace log {
 
 Writer::Writer(unique_ptr<WritableFileWriter>&& dest, uint64_t log_number,
-               bool recycle_log_files, bool manual_flush)
+               bool recycle_log_files, bool manual_flush,
+               CompressionType compression_type)
     : dest_(std::move(dest)),
       block_offset_(0),
       log_number_(log_number),
       recycle_log_files_(recycle_log_files),
-      manual_flush_(manual_flush) {
+      manual_flush_(manual_flush),
+      compression_type_(compression_type) {
+  // The compression type record does not carry a log number, so it cannot
+  // be told apart from a stale one in a recycled log.
+  assert(compression_type_ == kNoCompression || !recycle_log_files_);
   for (int i = 0; i <= kMaxRecordType; i++) {
     char t = static_cast<char>(i);
     type_crc_[i] = crc32c::Value(&t, 1);
@@ -35,9 +43,63 @@ Writer::~Writer() { WriteBuffer(); }
 
 Status Writer::WriteBuffer() { return dest_->Flush(); }
 
+Status Writer::AddCompressionTypeRecord() {
+  if (compression_type_ == kNoCompression) {
+    return Status::OK();
+  }
+  assert(block_offset_ == 0);
+  assert(compression_ctx_ == nullptr);
+  char type = static_cast<char>(compression_type_);
+  Slice payload(&type, 1);
+  int part_index = 0;
+  size_t part_offset = 0;
+  Status s = EmitPhysicalRecord(kSetCompressionType, SliceParts(&payload, 1),
+                                &part_index, &part_offset, payload.size());
+  if (s.ok()) {
+    compression_ctx_.reset(new CompressionContext(compression_type_));
+  }
+  return s;
+}
+
 Status Writer::AddRecord(const Slice& slice) {
-  const char* ptr = slice.data();
-  size_t left = slice.size();
+  return AddRecord(SliceParts(&slice, 1));
+}
+
+Status Writer::AddRecord(const SliceParts& record) {
+  SliceParts parts = record;
+  size_t left = 0;
+  for (int i = 0; i < parts.num_parts; ++i) {
+    left += parts.parts[i].size();
+  }
+
+  char record_compression_type;
+  Slice compressed_parts[2];
+  if (compression_ctx_ != nullptr) {
+    Slice uncompressed;
+    if (record.num_parts == 1) {
+      uncompressed = record.parts[0];
+    } else {
+      uncompressed_buffer_.clear();
+      uncompressed = Slice(record, &uncompressed_buffer_);
+    }
+    // Compress format version 2 stores the uncompressed size with the data.
+    // Records that do not get smaller are written uncompressed.
+    CompressionType type = kNoCompression;
+    Slice compressed = uncompressed;
+    compressed_buffer_.clear();
+    if (CompressData(*compression_ctx_, 2 /* compress_format_version */,
+                     uncompressed.data(), uncompressed.size(),
+                     &compressed_buffer_) &&
+        compressed_buffer_.size() < uncompressed.size()) {
+      type = compression_ctx_->type();
+      compressed = compressed_buffer_;
+    }
+    record_compression_type = static_cast<char>(type);
+    compressed_parts[0] = Slice(&record_compression_type, 1);
+    compressed_parts[1] = compressed;
+    parts = SliceParts(compressed_parts, 2);
+    left = 1 + compressed.size();
+  }
 
   // Header size varies depending on whether we are recycling or not.
   const int header_size =
@@ -48,6 +110,8 @@ Status Writer::AddRecord(const Slice& slice) {
   // zero-length record
   Status s;
   bool begin = true;
+  int part_index = 0;
+  size_t part_offset = 0;
   do {
     const int64_t leftover = kBlockSize - block_offset_;
     assert(leftover >= 0);
@@ -84,8 +148,8 @@ Status Writer::AddRecord(const Slice& slice) {
       type = recycle_log_files_ ? kRecyclableMiddleType : kMiddleType;
     }
 
-    s = EmitPhysicalRecord(type, ptr, fragment_length);
-    ptr += fragment_length;
+    s = EmitPhysicalRecord(type, parts, &part_index, &part_offset,
+                           fragment_length);
     left -= fragment_length;
     begin = false;
   } while (s.ok() && left > 0);
@@ -94,7 +158,9 @@ Status Writer::AddRecord(const Slice& slice) {
 
 bool Writer::TEST_BufferIsEmpty() { return dest_->TEST_BufferIsEmpty(); }
 
-Status Writer::EmitPhysicalRecord(RecordType t, const char* ptr, size_t n) {
+Status Writer::EmitPhysicalRecord(RecordType t, const SliceParts& parts,
+                                  int* part_index, size_t* part_offset,
+                                  size_t n) {
   assert(n <= 0xffff);  // Must fit in two bytes
 
   size_t header_size;
@@ -106,7 +172,7 @@ Status Writer::EmitPhysicalRecord(RecordType t, const char* ptr, size_t n) {
   buf[6] = static_cast<char>(t);
 
   uint32_t crc = type_crc_[t];
-  if (t < kRecyclableFullType) {
+  if (t < kRecyclableFullType || t > kRecyclableLastType) {
     // Legacy record format
     assert(block_offset_ + kHeaderSize + n <= kBlockSize);
     header_size = kHeaderSize;
@@ -124,19 +190,36 @@ Status Writer::EmitPhysicalRecord(RecordType t, const char* ptr, size_t n) {
     crc = crc32c::Extend(crc, buf + 7, 4);
   }
 
-  // Compute the crc of the record type and the payload.
-  crc = crc32c::Extend(crc, ptr, n);
+  // Collect the pieces of the parts the payload spans, and compute the crc
+  // of the record type and the payload.
+  autovector<Slice, 4> payload;
+  size_t left = n;
+  while (left > 0) {
+    assert(*part_index < parts.num_parts);
+    const Slice& part = parts.parts[*part_index];
+    const size_t piece_size = std::min(left, part.size() - *part_offset);
+    if (piece_size > 0) {
+      payload.push_back(Slice(part.data() + *part_offset, piece_size));
+      crc = crc32c::Extend(crc, payload.back().data(), piece_size);
+      left -= piece_size;
+      *part_offset += piece_size;
+    }
+    if (*part_offset == part.size()) {
+      ++*part_index;
+      *part_offset = 0;
+    }
+  }
   crc = crc32c::Mask(crc);  // Adjust for storage
   EncodeFixed32(buf, crc);
 
   // Write the header and the payload
   Status s = dest_->Append(Slice(buf, header_size));
+  for (size_t i = 0; s.ok() && i < payload.size(); ++i) {
+    s = dest_->Append(payload[i]);
+  }
   if (s.ok()) {
-    s = dest_->Append(Slice(ptr, n));
-    if (s.ok()) {
-      if (!manual_flush_) {
-        s = dest_->Flush();
-      }
+    if (!manual_flush_) {
+      s = dest_->Flush();
     }
   }
   block_offset_ += header_size + n;
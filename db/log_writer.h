@@ -13,11 +13,13 @@
 #include <memory>
 
 #include "db/log_format.h"
+#include "rocksdb/options.h"
 #include "rocksdb/slice.h"
 #include "rocksdb/status.h"
 
 namespace rocksdb {
 
+class CompressionContext;
 class WritableFileWriter;
 
 using std::unique_ptr;
@@ -66,6 +68,16 @@ namespace log {
  * Same as above, with the addition of
  * Log number = 32bit log file number, so that we can distinguish between
  * records written by the most recent log writer vs a previous one.
+ *
+ * Compressed logs:
+ *
+ * A log written with compression starts with a kSetCompressionType record
+ * whose one byte payload is the CompressionType. Every logical record after
+ * it is prefixed, before fragmentation, with one byte holding the
+ * compression type actually used for that record (kNoCompression when the
+ * record did not compress well), followed by the possibly compressed data.
+ * Each record is compressed on its own, so any record can be decoded
+ * without the ones before it.
  */
 class Writer {
  public:
@@ -73,11 +85,20 @@ class Writer {
   // "*dest" must be initially empty.
   // "*dest" must remain live while this Writer is in use.
   explicit Writer(unique_ptr<WritableFileWriter>&& dest, uint64_t log_number,
-                  bool recycle_log_files, bool manual_flush = false);
+                  bool recycle_log_files, bool manual_flush = false,
+                  CompressionType compression_type = kNoCompression);
   ~Writer();
 
   Status AddRecord(const Slice& slice);
 
+  // Adds the concatenation of the parts as a single record, without
+  // copying them into one buffer first (unless the log is compressed).
+  Status AddRecord(const SliceParts& parts);
+
+  // Writes the kSetCompressionType record. Must be called before the first
+  // AddRecord() if the writer was created with compression; no-op otherwise.
+  Status AddCompressionTypeRecord();
+
   WritableFileWriter* file() { return dest_.get(); }
   const WritableFileWriter* file() const { return dest_.get(); }
 
@@ -98,12 +119,23 @@ class Writer {
   // record type stored in the header.
   uint32_t type_crc_[kMaxRecordType + 1];
 
-  Status EmitPhysicalRecord(RecordType type, const char* ptr, size_t length);
+  // Emits the next "length" bytes of "parts", starting at "*part_index" and
+  // "*part_offset", as one physical record and advances the position.
+  Status EmitPhysicalRecord(RecordType type, const SliceParts& parts,
+                            int* part_index, size_t* part_offset,
+                            size_t length);
 
   // If true, it does not flush after each write. Instead it relies on the upper
   // layer to manually does the flush by calling ::WriteBuffer()
   bool manual_flush_;
 
+  // Compression used for the records. The context is kept for the lifetime
+  // of the writer so that e.g. ZSTD does not reallocate it for every record.
+  CompressionType compression_type_;
+  std::unique_ptr<CompressionContext> compression_ctx_;
+  std::string compressed_buffer_;
+  std::string uncompressed_buffer_;
+
   // No copying allowed
   Writer(const Writer&);
   void operator=(const Writer&);
@@ -18,6 +18,7 @@
 #include "db/merge_helper.h"
 #include "db/pinned_iterators_manager.h"
 #include "db/read_callback.h"
+#include "db/write_batch_internal.h"
 #include "monitoring/perf_context_imp.h"
 #include "monitoring/statistics.h"
 #include "port/port.h"
@@ -40,6 +41,96 @@
 
 namespace rocksdb {
 
+// A fixed size hash table of singly linked chains, mapping each user key to
+// the newest memtable entry of that key. Nodes are only ever prepended to a
+// chain, and the entry of a node only ever moves to a larger sequence number,
+// so concurrent writers and readers need no locks. All memory comes from the
+// memtable arena and is released with it.
+class MemTable::KeyIndex {
+ public:
+  KeyIndex(Allocator* allocator, size_t num_buckets, size_t huge_page_size,
+           Logger* logger)
+      : allocator_(allocator), num_buckets_(num_buckets) {
+    char* mem = allocator_->AllocateAligned(
+        sizeof(std::atomic<Node*>) * num_buckets_, huge_page_size, logger);
+    buckets_ = reinterpret_cast<std::atomic<Node*>*>(mem);
+    for (size_t i = 0; i < num_buckets_; i++) {
+      new (&buckets_[i]) std::atomic<Node*>(nullptr);
+    }
+  }
+
+  // Records entry, which has been inserted into the memtable for user_key
+  // with sequence number seq, unless the key already has a newer entry.
+  // REQUIRES: entry stays valid as long as the memtable
+  void Add(const Slice& user_key, SequenceNumber seq, const char* entry) {
+    std::atomic<Node*>& bucket = buckets_[Bucket(user_key)];
+    Node* head = bucket.load(std::memory_order_acquire);
+    // Nodes from here on have been checked not to hold user_key.
+    Node* checked = nullptr;
+    Node* node = nullptr;
+    while (true) {
+      for (Node* n = head; n != checked; n = n->next) {
+        const char* cur = n->entry.load(std::memory_order_acquire);
+        if (UserKey(cur) == user_key) {
+          while (Sequence(cur) < seq &&
+                 !n->entry.compare_exchange_weak(cur, entry,
+                                                 std::memory_order_release,
+                                                 std::memory_order_acquire)) {
+          }
+          return;
+        }
+      }
+      if (node == nullptr) {
+        node = new (allocator_->AllocateAligned(sizeof(Node))) Node(entry);
+      }
+      node->next = head;
+      checked = head;
+      if (bucket.compare_exchange_weak(head, node, std::memory_order_release,
+                                       std::memory_order_acquire)) {
+        return;
+      }
+      // Another writer prepended to the chain. Only the nodes in front of the
+      // old head need to be checked again.
+    }
+  }
+
+  // Returns the newest entry of user_key, or nullptr if the memtable has
+  // none.
+  const char* Get(const Slice& user_key) const {
+    for (Node* n = buckets_[Bucket(user_key)].load(std::memory_order_acquire);
+         n != nullptr; n = n->next) {
+      const char* entry = n->entry.load(std::memory_order_acquire);
+      if (UserKey(entry) == user_key) {
+        return entry;
+      }
+    }
+    return nullptr;
+  }
+
+ private:
+  struct Node {
+    explicit Node(const char* e) : entry(e), next(nullptr) {}
+    std::atomic<const char*> entry;
+    Node* next;
+  };
+
+  size_t Bucket(const Slice& user_key) const {
+    return GetSliceHash(user_key) % num_buckets_;
+  }
+
+  static Slice UserKey(const char* entry) {
+    return ExtractUserKey(GetLengthPrefixedSlice(entry));
+  }
+
+  static SequenceNumber Sequence(const char* entry) {
+    return GetInternalKeySeqno(GetLengthPrefixedSlice(entry));
+  }
+
+  Allocator* const allocator_;
+  const size_t num_buckets_;
+  std::atomic<Node*>* buckets_;
+};
+
 ImmutableMemTableOptions::ImmutableMemTableOptions(
     const ImmutableCFOptions& ioptions,
     const MutableCFOptions& mutable_cf_options)
@@ -56,7 +147,8 @@ ImmutableMemTableOptions::ImmutableMemTableOptions(
       max_successive_merges(mutable_cf_options.max_successive_merges),
       statistics(ioptions.statistics),
       merge_operator(ioptions.merge_operator),
-      info_log(ioptions.info_log) {}
+      info_log(ioptions.info_log),
+      protection_bytes_per_key(ioptions.memtable_protection_bytes_per_key) {}
 
 MemTable::MemTable(const InternalKeyComparator& cmp,
                    const ImmutableCFOptions& ioptions,
@@ -65,6 +157,7 @@ MemTable::MemTable(const InternalKeyComparator& cmp,
                    SequenceNumber latest_seq, uint32_t column_family_id)
     : comparator_(cmp),
       moptions_(ioptions, mutable_cf_options),
+      column_family_id_(column_family_id),
       refs_(0),
       kArenaBlockSize(OptimizeBlockSize(moptions_.arena_block_size)),
       mem_tracker_(write_buffer_manager),
@@ -73,7 +166,8 @@ MemTable::MemTable(const InternalKeyComparator& cmp,
           (write_buffer_manager != nullptr && write_buffer_manager->enabled())
               ? &mem_tracker_
               : nullptr,
-          mutable_cf_options.memtable_huge_page_size),
+          mutable_cf_options.memtable_huge_page_size,
+          ioptions.memtable_numa_aware_allocation),
       table_(ioptions.memtable_factory->CreateMemTableRep(
           comparator_, &arena_, mutable_cf_options.prefix_extractor.get(),
           ioptions.info_log, column_family_id)),
@@ -81,6 +175,8 @@ MemTable::MemTable(const InternalKeyComparator& cmp,
           comparator_, &arena_, nullptr /* transform */, ioptions.info_log,
           column_family_id)),
       is_range_del_table_empty_(true),
+      num_range_deletes_(0),
+      fragmented_range_dels_num_range_deletes_(0),
       data_size_(0),
       num_entries_(0),
       num_deletes_(0),
@@ -97,6 +193,7 @@ MemTable::MemTable(const InternalKeyComparator& cmp,
                  ? moptions_.inplace_update_num_locks
                  : 0),
       prefix_extractor_(mutable_cf_options.prefix_extractor.get()),
+      key_index_(nullptr),
       flush_state_(FLUSH_NOT_REQUESTED),
       env_(ioptions.env),
       insert_with_hint_prefix_extractor_(
@@ -112,6 +209,19 @@ MemTable::MemTable(const InternalKeyComparator& cmp,
         6 /* hard coded 6 probes */, nullptr, moptions_.memtable_huge_page_size,
         ioptions.info_log));
   }
+
+  // The index matches keys by their bytes, which is only correct if keys
+  // that compare equal are the same bytes.
+  const Comparator* ucmp = cmp.user_comparator();
+  if (ioptions.memtable_point_lookup_index &&
+      !moptions_.inplace_update_support &&
+      (ucmp == BytewiseComparator() || ucmp == ReverseBytewiseComparator())) {
+    size_t num_buckets =
+        std::max<size_t>(mutable_cf_options.write_buffer_size / 256, 1024);
+    key_index_ = new (arena_.AllocateAligned(sizeof(KeyIndex)))
+        KeyIndex(&arena_, num_buckets, moptions_.memtable_huge_page_size,
+                 ioptions.info_log);
+  }
 }
 
 MemTable::~MemTable() {
@@ -360,6 +470,13 @@ class MemTableIterator : public InternalIterator {
     iter_->Next();
     valid_ = iter_->Valid();
   }
+  virtual bool NextAndGetResult(Slice* ret_key) override {
+    MemTableIterator::Next();
+    if (valid_) {
+      *ret_key = MemTableIterator::key();
+    }
+    return valid_;
+  }
   virtual void Prev() override {
     PERF_COUNTER_ADD(prev_on_memtable_count, 1);
     assert(Valid());
@@ -418,6 +535,35 @@ InternalIterator* MemTable::NewRangeTombstoneIterator(
                               true /* use_range_del_table */);
 }
 
+Status MemTable::GetFragmentedRangeTombstones(
+    std::shared_ptr<const FragmentedRangeTombstoneList>* tombstones) {
+  uint64_t num_range_deletes =
+      num_range_deletes_.load(std::memory_order_acquire);
+  {
+    std::lock_guard<SpinMutex> l(fragmented_range_dels_mutex_);
+    if (fragmented_range_dels_ != nullptr &&
+        fragmented_range_dels_num_range_deletes_ >= num_range_deletes) {
+      *tombstones = fragmented_range_dels_;
+      return Status::OK();
+    }
+  }
+  // The iterator sees at least the first num_range_deletes range deletions
+  std::unique_ptr<InternalIterator> range_del_iter(
+      NewRangeTombstoneIterator(ReadOptions()));
+  Status s = FragmentedRangeTombstoneList::Create(
+      range_del_iter.get(), comparator_.comparator.user_comparator(),
+      tombstones);
+  if (s.ok()) {
+    std::lock_guard<SpinMutex> l(fragmented_range_dels_mutex_);
+    if (fragmented_range_dels_ == nullptr ||
+        fragmented_range_dels_num_range_deletes_ < num_range_deletes) {
+      fragmented_range_dels_ = *tombstones;
+      fragmented_range_dels_num_range_deletes_ = num_range_deletes;
+    }
+  }
+  return s;
+}
+
 port::RWMutex* MemTable::GetLock(const Slice& key) {
   static murmur_hash hash;
   return &locks_[hash(key) % locks_.size()];
@@ -447,18 +593,21 @@ MemTable::MemTableStats MemTable::ApproximateStats(const Slice& start_ikey,
 bool MemTable::Add(SequenceNumber s, ValueType type,
                    const Slice& key, /* user key */
                    const Slice& value, bool allow_concurrent,
-                   MemTablePostProcessInfo* post_process_info) {
+                   MemTablePostProcessInfo* post_process_info,
+                   const uint32_t* entry_checksum) {
   // Format of an entry is concatenation of:
   //  key_size     : varint32 of internal_key.size()
   //  key bytes    : char[internal_key.size()]
   //  value_size   : varint32 of value.size()
   //  value bytes  : char[value.size()]
+  //  checksum     : fixed32, with memtable_protection_bytes_per_key
   uint32_t key_size = static_cast<uint32_t>(key.size());
   uint32_t val_size = static_cast<uint32_t>(value.size());
   uint32_t internal_key_size = key_size + 8;
-  const uint32_t encoded_len = VarintLength(internal_key_size) +
-                               internal_key_size + VarintLength(val_size) +
-                               val_size;
+  const uint32_t encoded_len =
+      VarintLength(internal_key_size) + internal_key_size +
+      VarintLength(val_size) + val_size +
+      static_cast<uint32_t>(moptions_.protection_bytes_per_key);
   char* buf = nullptr;
   std::unique_ptr<MemTableRep>& table =
       type == kTypeRangeDeletion ? range_del_table_ : table_;
@@ -473,7 +622,18 @@ bool MemTable::Add(SequenceNumber s, ValueType type,
   p += 8;
   p = EncodeVarint32(p, val_size);
   memcpy(p, value.data(), val_size);
-  assert((unsigned)(p + val_size - buf) == (unsigned)encoded_len);
+  p += val_size;
+  if (moptions_.protection_bytes_per_key != 0) {
+    assert(entry_checksum == nullptr ||
+           *entry_checksum == WriteBatchInternal::EntryChecksum(
+                                  type, column_family_id_, key, value));
+    EncodeFixed32(p, entry_checksum != nullptr
+                         ? *entry_checksum
+                         : WriteBatchInternal::EntryChecksum(
+                               type, column_family_id_, key, value));
+    p += sizeof(uint32_t);
+  }
+  assert((unsigned)(p - buf) == (unsigned)encoded_len);
   if (!allow_concurrent) {
     // Extract prefix for insert with hint.
     if (insert_with_hint_prefix_extractor_ != nullptr &&
@@ -549,13 +709,44 @@ bool MemTable::Add(SequenceNumber s, ValueType type,
         !first_seqno_.compare_exchange_weak(cur_earliest_seqno, s)) {
     }
   }
-  if (is_range_del_table_empty_ && type == kTypeRangeDeletion) {
-    is_range_del_table_empty_ = false;
+  if (key_index_ != nullptr && type != kTypeRangeDeletion) {
+    key_index_->Add(key_slice, s, buf);
+  }
+  if (type == kTypeRangeDeletion) {
+    if (is_range_del_table_empty_) {
+      is_range_del_table_empty_ = false;
+    }
+    // Counted after the insertion, so a cached fragmented list is never
+    // taken for up to date without the new tombstone
+    num_range_deletes_.fetch_add(1, std::memory_order_release);
   }
   UpdateOldestKeyTime();
   return true;
 }
 
+Status MemTable::VerifyEntryChecksums() {
+  if (moptions_.protection_bytes_per_key == 0) {
+    return Status::OK();
+  }
+  for (MemTableRep* table : {table_.get(), range_del_table_.get()}) {
+    std::unique_ptr<MemTableRep::Iterator> iter(table->GetIterator());
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      const char* entry = iter->key();
+      uint32_t key_length = 0;
+      const char* key_ptr = GetVarint32Ptr(entry, entry + 5, &key_length);
+      Slice internal_key(key_ptr, key_length);
+      Slice value = GetLengthPrefixedSlice(key_ptr + key_length);
+      if (WriteBatchInternal::EntryChecksum(
+              ExtractValueType(internal_key), column_family_id_,
+              ExtractUserKey(internal_key),
+              value) != DecodeFixed32(value.data() + value.size())) {
+        return Status::Corruption("memtable entry checksum mismatch");
+      }
+    }
+  }
+  return Status::OK();
+}
+
 // Callback from MemTable::Get()
 namespace {
 
@@ -729,12 +920,14 @@ bool MemTable::Get(const LookupKey& key, std::string* value, Status* s,
   }
   PERF_TIMER_GUARD(get_from_memtable_time);
 
-  std::unique_ptr<InternalIterator> range_del_iter(
-      NewRangeTombstoneIterator(read_opts));
-  Status status = range_del_agg->AddTombstones(std::move(range_del_iter));
-  if (!status.ok()) {
-    *s = status;
-    return false;
+  if (!read_opts.ignore_range_deletions && !is_range_del_table_empty_) {
+    std::shared_ptr<const FragmentedRangeTombstoneList> range_dels;
+    Status status = GetFragmentedRangeTombstones(&range_dels);
+    if (!status.ok()) {
+      *s = status;
+      return false;
+    }
+    range_del_agg->AddFragmentedTombstones(std::move(range_dels));
   }
 
   Slice user_key = key.user_key();
@@ -769,7 +962,29 @@ bool MemTable::Get(const LookupKey& key, std::string* value, Status* s,
     saver.env_ = env_;
     saver.callback_ = callback;
     saver.is_blob_index = is_blob_index;
-    table_->Get(key, &saver, SaveValue);
+    // With the key index, the memtable only needs to be searched when the
+    // newest entry of the key is not visible to this lookup, or when it is a
+    // merge operand and older entries have to be collected too. Visibility
+    // decided by a callback is not known up front, so those lookups always
+    // search.
+    const char* newest = nullptr;
+    bool search = true;
+    if (key_index_ != nullptr && callback == nullptr) {
+      newest = key_index_->Get(user_key);
+      if (newest == nullptr) {
+        search = false;
+      } else {
+        Slice newest_key = GetLengthPrefixedSlice(newest);
+        search = GetInternalKeySeqno(newest_key) >
+                     GetInternalKeySeqno(key.internal_key()) ||
+                 ExtractValueType(newest_key) == kTypeMerge;
+      }
+    }
+    if (search) {
+      table_->Get(key, &saver, SaveValue);
+    } else if (newest != nullptr) {
+      SaveValue(&saver, newest);
+    }
 
     *seq = saver.seq;
   }
@@ -28,6 +28,7 @@
 #include "util/concurrent_arena.h"
 #include "util/dynamic_bloom.h"
 #include "util/hash.h"
+#include "util/mutexlock.h"
 
 namespace rocksdb {
 
@@ -52,6 +53,7 @@ struct ImmutableMemTableOptions {
   Statistics* statistics;
   MergeOperator* merge_operator;
   Logger* info_log;
+  size_t protection_bytes_per_key;
 };
 
 // Batched counters to updated when inserting keys in one write batch.
@@ -85,6 +87,9 @@ class MemTable {
                            const char* prefix_len_key2) const override;
     virtual int operator()(const char* prefix_len_key,
                            const DecodedType& key) const override;
+    virtual const Comparator* user_comparator() const override {
+      return comparator.user_comparator();
+    }
   };
 
   // MemTables are reference counted.  The initial reference count
@@ -145,6 +150,23 @@ class MemTable {
                                                 std::memory_order_relaxed);
   }
 
+  // Like MarkFlushScheduled(), but whether or not the memtable asked for a
+  // flush itself.
+  bool MarkFlushScheduledIfNotScheduled() {
+    auto before = FLUSH_NOT_REQUESTED;
+    if (flush_state_.compare_exchange_strong(before, FLUSH_SCHEDULED,
+                                             std::memory_order_relaxed,
+                                             std::memory_order_relaxed)) {
+      return true;
+    }
+    return MarkFlushScheduled();
+  }
+
+  // Returns true if a flush of this memtable was requested or scheduled
+  bool IsFlushPending() const {
+    return flush_state_.load(std::memory_order_relaxed) != FLUSH_NOT_REQUESTED;
+  }
+
   // Return an iterator that yields the contents of the memtable.
   //
   // The caller must ensure that the underlying MemTable remains live
@@ -161,6 +183,12 @@ class MemTable {
 
   InternalIterator* NewRangeTombstoneIterator(const ReadOptions& read_options);
 
+  // Returns the range tombstones of the memtable, fragmented. The result is
+  // cached until the next range deletion is added, so reads in between share
+  // it.
+  Status GetFragmentedRangeTombstones(
+      std::shared_ptr<const FragmentedRangeTombstoneList>* tombstones);
+
   // Add an entry into memtable that maps key to value at the
   // specified sequence number and with the specified type.
   // Typically value will be empty if type==kTypeDeletion.
@@ -168,11 +196,23 @@ class MemTable {
   // REQUIRES: if allow_concurrent = false, external synchronization to prevent
   // simultaneous operations on the same MemTable.
   //
+  // With memtable_protection_bytes_per_key, entry_checksum may point to the
+  // checksum the entry has in a protected WriteBatch, which is then kept
+  // with the entry. Otherwise the checksum is computed here.
+  //
   // Returns false if MemTableRepFactory::CanHandleDuplicatedKey() is true and
   // the <key, seq> already exists.
   bool Add(SequenceNumber seq, ValueType type, const Slice& key,
            const Slice& value, bool allow_concurrent = false,
-           MemTablePostProcessInfo* post_process_info = nullptr);
+           MemTablePostProcessInfo* post_process_info = nullptr,
+           const uint32_t* entry_checksum = nullptr);
+
+  // Checks every entry against the checksum it was added with, if the
+  // memtable keeps them, and returns Corruption if one does not match.
+  //
+  // REQUIRES: external synchronization to prevent simultaneous
+  // operations on the same MemTable (unless this Memtable is immutable).
+  Status VerifyEntryChecksums();
 
   // If memtable contains a value for key, store it in *value and return true.
   // If memtable contains a deletion for key, store a NotFound() error
@@ -385,6 +425,7 @@ class MemTable {
 
   KeyComparator comparator_;
   const ImmutableMemTableOptions moptions_;
+  const uint32_t column_family_id_;
   int refs_;
   const size_t kArenaBlockSize;
   AllocTracker mem_tracker_;
@@ -392,6 +433,13 @@ class MemTable {
   unique_ptr<MemTableRep> table_;
   unique_ptr<MemTableRep> range_del_table_;
   bool is_range_del_table_empty_;
+  // Number of range deletions added
+  std::atomic<uint64_t> num_range_deletes_;
+  // Fragmented range tombstones of the first
+  // fragmented_range_dels_num_range_deletes_ range deletions, or more
+  SpinMutex fragmented_range_dels_mutex_;
+  std::shared_ptr<const FragmentedRangeTombstoneList> fragmented_range_dels_;
+  uint64_t fragmented_range_dels_num_range_deletes_;
 
   // Total data size of all data inserted
   std::atomic<uint64_t> data_size_;
@@ -432,6 +480,11 @@ class MemTable {
   const SliceTransform* const prefix_extractor_;
   std::unique_ptr<DynamicBloom> prefix_bloom_;
 
+  // Index from user key to the newest entry of the key, or nullptr if
+  // memtable_point_lookup_index is off. Allocated from arena_.
+  class KeyIndex;
+  KeyIndex* key_index_;
+
   std::atomic<FlushStateEnum> flush_state_;
 
   Env* env_;
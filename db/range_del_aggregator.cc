@@ -406,6 +406,9 @@ bool RangeDelAggregator::ShouldDeleteImpl(const ParsedInternalKey& parsed,
                                           RangeDelPositioningMode mode) {
   assert(IsValueType(parsed.type));
   assert(rep_ != nullptr);
+  if (!rep_->fragmented_tombstones_.empty() && ShouldDeleteFragmented(parsed)) {
+    return true;
+  }
   auto& tombstone_map = GetRangeDelMap(parsed.sequence);
   if (tombstone_map.IsEmpty()) {
     return false;
@@ -413,6 +416,32 @@ bool RangeDelAggregator::ShouldDeleteImpl(const ParsedInternalKey& parsed,
   return tombstone_map.ShouldDelete(parsed, mode);
 }
 
+bool RangeDelAggregator::ShouldDeleteFragmented(
+    const ParsedInternalKey& parsed) {
+  // Only the tombstones in the key's snapshot stripe can delete it. With the
+  // single snapshot of a read, that is the tombstones no newer than
+  // upper_bound_, unless the key itself is newer.
+  SequenceNumber upper_bound =
+      parsed.sequence <= upper_bound_ ? upper_bound_ : kMaxSequenceNumber;
+  const Comparator* ucmp = icmp_.user_comparator();
+  for (const auto& fragmented : rep_->fragmented_tombstones_) {
+    // Same as truncating the tombstones, see AddTombstones()
+    if ((fragmented.smallest != nullptr &&
+         ucmp->Compare(parsed.user_key, fragmented.smallest->user_key()) <
+             0) ||
+        (fragmented.largest != nullptr &&
+         ucmp->Compare(parsed.user_key, fragmented.largest->user_key()) >=
+             0)) {
+      continue;
+    }
+    if (parsed.sequence < fragmented.tombstones->MaxCoveringTombstoneSeqnum(
+                              parsed.user_key, upper_bound)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 bool RangeDelAggregator::IsRangeOverlapped(const Slice& start,
                                            const Slice& end) {
   // Unimplemented because the only client of this method, file ingestion,
@@ -503,6 +532,19 @@ Status RangeDelAggregator::AddTombstones(
   return Status::OK();
 }
 
+void RangeDelAggregator::AddFragmentedTombstones(
+    std::shared_ptr<const FragmentedRangeTombstoneList> tombstones,
+    const InternalKey* smallest, const InternalKey* largest) {
+  if (tombstones == nullptr || tombstones->empty()) {
+    return;
+  }
+  if (rep_ == nullptr) {
+    InitRep({upper_bound_});
+  }
+  rep_->fragmented_tombstones_.push_back(
+      {std::move(tombstones), smallest, largest});
+}
+
 void RangeDelAggregator::InvalidateRangeDelMapPositions() {
   if (rep_ == nullptr) {
     return;
@@ -532,6 +574,9 @@ bool RangeDelAggregator::IsEmpty() {
   if (rep_ == nullptr) {
     return true;
   }
+  if (!rep_->fragmented_tombstones_.empty()) {
+    return false;
+  }
   for (const auto& stripe : rep_->stripe_map_) {
     if (!stripe.second->IsEmpty()) {
       return false;
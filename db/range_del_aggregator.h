@@ -14,6 +14,7 @@
 #include "db/compaction_iteration_stats.h"
 #include "db/dbformat.h"
 #include "db/pinned_iterators_manager.h"
+#include "db/range_tombstone_fragmenter.h"
 #include "db/version_edit.h"
 #include "include/rocksdb/comparator.h"
 #include "include/rocksdb/types.h"
@@ -148,6 +149,17 @@ class RangeDelAggregator {
                        const InternalKey* smallest = nullptr,
                        const InternalKey* largest = nullptr);
 
+  // Adds tombstones that were fragmented ahead of time, which are searched
+  // in place instead of being added to the aggregation structure one by one.
+  // They are truncated to smallest and largest like in AddTombstones(), and
+  // smallest and largest must outlive this object. Only for aggregators
+  // constructed for reads; the tombstones are consulted by ShouldDelete() and
+  // IsEmpty(), but not presented by NewIterator().
+  void AddFragmentedTombstones(
+      std::shared_ptr<const FragmentedRangeTombstoneList> tombstones,
+      const InternalKey* smallest = nullptr,
+      const InternalKey* largest = nullptr);
+
   // Resets iterators maintained across calls to ShouldDelete(). This may be
   // called when the tombstones change, or the owner may call explicitly, e.g.,
   // if it's an iterator that just seeked to an arbitrary position. The effect
@@ -171,11 +183,18 @@ class RangeDelAggregator {
   // their seqnums are greater than the next smaller snapshot's seqnum.
   typedef std::map<SequenceNumber, std::unique_ptr<RangeDelMap>> StripeMap;
 
+  struct FragmentedTombstones {
+    std::shared_ptr<const FragmentedRangeTombstoneList> tombstones;
+    const InternalKey* smallest;
+    const InternalKey* largest;
+  };
+
   struct Rep {
     StripeMap stripe_map_;
     PinnedIteratorsManager pinned_iters_mgr_;
     std::list<std::string> pinned_slices_;
     std::set<uint64_t> added_files_;
+    std::vector<FragmentedTombstones> fragmented_tombstones_;
   };
   // Initializes rep_ lazily. This aggregator object is constructed for every
   // read, so expensive members should only be created when necessary, i.e.,
@@ -184,6 +203,7 @@ class RangeDelAggregator {
 
   std::unique_ptr<RangeDelMap> NewRangeDelMap();
   RangeDelMap& GetRangeDelMap(SequenceNumber seq);
+  bool ShouldDeleteFragmented(const ParsedInternalKey& parsed);
 
   SequenceNumber upper_bound_;
   std::unique_ptr<Rep> rep_;
@@ -44,6 +44,24 @@ void AddTombstones(RangeDelAggregator* range_del_agg,
   range_del_agg->AddTombstones(std::move(range_del_iter), smallest, largest);
 }
 
+void AddFragmentedTombstones(RangeDelAggregator* range_del_agg,
+                             const std::vector<RangeTombstone>& range_dels,
+                             const InternalKey* smallest = nullptr,
+                             const InternalKey* largest = nullptr) {
+  std::vector<std::string> keys, values;
+  for (const auto& range_del : range_dels) {
+    auto key_and_value = range_del.Serialize();
+    keys.push_back(key_and_value.first.Encode().ToString());
+    values.push_back(key_and_value.second.ToString());
+  }
+  test::VectorIterator range_del_iter(keys, values);
+  std::shared_ptr<const FragmentedRangeTombstoneList> fragmented;
+  ASSERT_OK(FragmentedRangeTombstoneList::Create(
+      &range_del_iter, icmp.user_comparator(), &fragmented));
+  range_del_agg->AddFragmentedTombstones(std::move(fragmented), smallest,
+                                         largest);
+}
+
 void VerifyTombstonesEq(const RangeTombstone& a, const RangeTombstone& b) {
   ASSERT_EQ(a.seq_, b.seq_);
   ASSERT_EQ(a.start_key_, b.start_key_);
@@ -119,6 +137,31 @@ void VerifyRangeDels(
     }
   }
 
+  // Same result for tombstones fragmented ahead of time
+  for (Direction dir : {kForward, kReverse}) {
+    RangeDelAggregator range_del_agg(icmp,
+                                     kMaxSequenceNumber /* upper_bound */);
+
+    std::vector<RangeTombstone> range_dels = range_dels_in;
+    if (dir == kReverse) {
+      std::reverse(range_dels.begin(), range_dels.end());
+    }
+    AddFragmentedTombstones(&range_del_agg, range_dels, smallest, largest);
+
+    for (const auto expected_point : expected_points) {
+      ParsedInternalKey parsed_key;
+      parsed_key.user_key = expected_point.begin;
+      parsed_key.sequence = expected_point.seq;
+      parsed_key.type = kTypeValue;
+      ASSERT_FALSE(range_del_agg.ShouldDelete(parsed_key));
+      if (parsed_key.sequence > 0) {
+        --parsed_key.sequence;
+        ASSERT_EQ(!expected_point.expectAlive,
+                  range_del_agg.ShouldDelete(parsed_key));
+      }
+    }
+  }
+
   RangeDelAggregator range_del_agg(icmp, {} /* snapshots */,
                                    false /* collapse_deletions */);
   AddTombstones(&range_del_agg, range_dels_in);
@@ -287,6 +330,47 @@ TEST_F(RangeDelAggregatorTest, MergingIteratorSeek) {
                      {{"c", "d", 20}, {"e", "f", 20}, {"f", "g", 10}});
 }
 
+TEST_F(RangeDelAggregatorTest, FragmentTombstones) {
+  std::vector<std::string> keys, values;
+  for (const RangeTombstone& range_del :
+       std::vector<RangeTombstone>{{"a", "c", 10}, {"b", "d", 20},
+                                   {"b", "c", 20}, {"e", "f", 5},
+                                   {"f", "g", 5}, {"h", "h", 30}}) {
+    auto key_and_value = range_del.Serialize();
+    keys.push_back(key_and_value.first.Encode().ToString());
+    values.push_back(key_and_value.second.ToString());
+  }
+  test::VectorIterator range_del_iter(keys, values);
+  std::shared_ptr<const FragmentedRangeTombstoneList> fragmented;
+  ASSERT_OK(FragmentedRangeTombstoneList::Create(
+      &range_del_iter, icmp.user_comparator(), &fragmented));
+  // [a, b) @ 10, [b, c) @ 20, 10, [c, d) @ 20, [e, g) @ 5
+  ASSERT_EQ(4U, fragmented->num_fragments());
+  ASSERT_EQ(10U, fragmented->MaxCoveringTombstoneSeqnum("a", 30));
+  ASSERT_EQ(20U, fragmented->MaxCoveringTombstoneSeqnum("b", 30));
+  ASSERT_EQ(10U, fragmented->MaxCoveringTombstoneSeqnum("b", 15));
+  ASSERT_EQ(0U, fragmented->MaxCoveringTombstoneSeqnum("b", 5));
+  ASSERT_EQ(0U, fragmented->MaxCoveringTombstoneSeqnum("c", 15));
+  ASSERT_EQ(0U, fragmented->MaxCoveringTombstoneSeqnum("d", 30));
+  ASSERT_EQ(5U, fragmented->MaxCoveringTombstoneSeqnum("f", 30));
+  ASSERT_EQ(0U, fragmented->MaxCoveringTombstoneSeqnum("h", 30));
+}
+
+TEST_F(RangeDelAggregatorTest, FragmentedTombstonesAboveUpperBound) {
+  RangeDelAggregator range_del_agg(icmp, 15 /* upper_bound */);
+  AddFragmentedTombstones(&range_del_agg, {{"a", "c", 10}, {"b", "d", 20}});
+  ParsedInternalKey parsed_key("b", 5, kTypeValue);
+  ASSERT_TRUE(range_del_agg.ShouldDelete(parsed_key));
+  parsed_key.sequence = 12;
+  ASSERT_FALSE(range_del_agg.ShouldDelete(parsed_key));
+  parsed_key.user_key = "c";
+  parsed_key.sequence = 5;
+  ASSERT_FALSE(range_del_agg.ShouldDelete(parsed_key));
+  // Keys newer than the upper bound are deleted by newer tombstones
+  parsed_key.sequence = 16;
+  ASSERT_TRUE(range_del_agg.ShouldDelete(parsed_key));
+}
+
 TEST_F(RangeDelAggregatorTest, TruncateTombstones) {
   const InternalKey smallest("b", 1, kTypeRangeDeletion);
   const InternalKey largest("e", kMaxSequenceNumber, kTypeRangeDeletion);
@@ -0,0 +1,156 @@
+//  Copyright (c) 2018-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "db/range_tombstone_fragmenter.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace rocksdb {
+
+namespace {
+
+struct IndexedTombstone {
+  size_t start_idx;
+  size_t end_idx;
+  SequenceNumber seq;
+};
+
+}  // anonymous namespace
+
+Status FragmentedRangeTombstoneList::Create(
+    InternalIterator* unfragmented_tombstones, const Comparator* ucmp,
+    std::shared_ptr<const FragmentedRangeTombstoneList>* tombstones) {
+  std::unique_ptr<FragmentedRangeTombstoneList> list(
+      new FragmentedRangeTombstoneList(ucmp));
+  // Start and end keys, in pairs
+  std::vector<std::string> tombstone_keys;
+  std::vector<SequenceNumber> tombstone_seqs;
+  if (unfragmented_tombstones != nullptr) {
+    InternalIterator* iter = unfragmented_tombstones;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      ParsedInternalKey parsed_key;
+      if (!ParseInternalKey(iter->key(), &parsed_key)) {
+        return Status::Corruption(
+            "Unable to parse range tombstone InternalKey");
+      }
+      if (ucmp->Compare(parsed_key.user_key, iter->value()) >= 0) {
+        // The tombstone covers no keys
+        continue;
+      }
+      tombstone_keys.push_back(parsed_key.user_key.ToString());
+      tombstone_keys.push_back(iter->value().ToString());
+      tombstone_seqs.push_back(parsed_key.sequence);
+    }
+    Status s = iter->status();
+    if (!s.ok()) {
+      return s;
+    }
+  }
+
+  auto less = [ucmp](const std::string& a, const std::string& b) {
+    return ucmp->Compare(a, b) < 0;
+  };
+  auto& keys = list->keys_;
+  keys = tombstone_keys;
+  std::sort(keys.begin(), keys.end(), less);
+  keys.erase(std::unique(keys.begin(), keys.end(),
+                         [ucmp](const std::string& a, const std::string& b) {
+                           return ucmp->Compare(a, b) == 0;
+                         }),
+             keys.end());
+  auto key_idx = [&](const std::string& key) {
+    return static_cast<size_t>(
+        std::lower_bound(keys.begin(), keys.end(), key, less) - keys.begin());
+  };
+  std::vector<IndexedTombstone> indexed;
+  indexed.reserve(tombstone_seqs.size());
+  for (size_t i = 0; i < tombstone_seqs.size(); ++i) {
+    indexed.push_back({key_idx(tombstone_keys[2 * i]),
+                       key_idx(tombstone_keys[2 * i + 1]), tombstone_seqs[i]});
+  }
+  std::sort(indexed.begin(), indexed.end(),
+            [](const IndexedTombstone& a, const IndexedTombstone& b) {
+              return a.start_idx < b.start_idx;
+            });
+
+  // Sweep over the keys, keeping the tombstones that cover the fragment
+  // starting at each of them
+  std::vector<IndexedTombstone> active;
+  std::vector<SequenceNumber> fragment_seqs;
+  size_t next = 0;
+  for (size_t i = 0; i + 1 < keys.size(); ++i) {
+    active.erase(std::remove_if(active.begin(), active.end(),
+                                [i](const IndexedTombstone& t) {
+                                  return t.end_idx <= i;
+                                }),
+                 active.end());
+    while (next < indexed.size() && indexed[next].start_idx == i) {
+      active.push_back(indexed[next++]);
+    }
+    if (active.empty()) {
+      continue;
+    }
+    fragment_seqs.clear();
+    for (const auto& t : active) {
+      fragment_seqs.push_back(t.seq);
+    }
+    std::sort(fragment_seqs.begin(), fragment_seqs.end(),
+              std::greater<SequenceNumber>());
+    fragment_seqs.erase(
+        std::unique(fragment_seqs.begin(), fragment_seqs.end()),
+        fragment_seqs.end());
+
+    auto& seqs = list->seqs_;
+    auto& fragments = list->fragments_;
+    if (!fragments.empty() && fragments.back().end_idx == i &&
+        seqs.size() - fragments.back().seq_start_idx == fragment_seqs.size() &&
+        std::equal(fragment_seqs.begin(), fragment_seqs.end(),
+                   seqs.begin() + fragments.back().seq_start_idx)) {
+      // Same tombstones as the previous fragment; extend it
+      fragments.back().end_idx = i + 1;
+      continue;
+    }
+    fragments.push_back(
+        {i, i + 1, seqs.size(), seqs.size() + fragment_seqs.size()});
+    seqs.insert(seqs.end(), fragment_seqs.begin(), fragment_seqs.end());
+  }
+  tombstones->reset(list.release());
+  return Status::OK();
+}
+
+SequenceNumber FragmentedRangeTombstoneList::MaxCoveringTombstoneSeqnum(
+    const Slice& user_key, SequenceNumber upper_bound) const {
+  auto fragment =
+      std::upper_bound(fragments_.begin(), fragments_.end(), user_key,
+                       [this](const Slice& key, const Fragment& f) {
+                         return ucmp_->Compare(key, keys_[f.start_idx]) < 0;
+                       });
+  if (fragment == fragments_.begin()) {
+    return 0;
+  }
+  --fragment;
+  if (ucmp_->Compare(user_key, keys_[fragment->end_idx]) >= 0) {
+    return 0;
+  }
+  auto seqs_end = seqs_.begin() + fragment->seq_end_idx;
+  // Seqnums are in decreasing order
+  auto seq = std::lower_bound(seqs_.begin() + fragment->seq_start_idx,
+                              seqs_end, upper_bound,
+                              std::greater<SequenceNumber>());
+  return seq == seqs_end ? 0 : *seq;
+}
+
+size_t FragmentedRangeTombstoneList::ApproximateMemoryUsage() const {
+  size_t usage = sizeof(*this) + keys_.capacity() * sizeof(std::string) +
+                 fragments_.capacity() * sizeof(Fragment) +
+                 seqs_.capacity() * sizeof(SequenceNumber);
+  for (const auto& key : keys_) {
+    usage += key.capacity();
+  }
+  return usage;
+}
+
+}  // namespace rocksdb
@@ -0,0 +1,74 @@
+//  Copyright (c) 2018-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "db/dbformat.h"
+#include "rocksdb/comparator.h"
+#include "rocksdb/status.h"
+#include "rocksdb/types.h"
+#include "table/internal_iterator.h"
+
+namespace rocksdb {
+
+// A FragmentedRangeTombstoneList holds the range tombstones of a memtable or
+// an SST file, cut into fragments at every start and end key so that the
+// fragments do not overlap. For example, the tombstones [a, c) @ 10 and
+// [b, d) @ 20 become the fragments
+//
+//     [a, b) @ 10,   [b, c) @ 20, 10,   [c, d) @ 20
+//
+// with the seqnums of each fragment in decreasing order. The tombstones that
+// cover a key are then found with a binary search, which is much cheaper than
+// adding all tombstones to a RangeDelAggregator on every point lookup.
+//
+// The list is immutable once created, so it can be shared by concurrent
+// reads.
+class FragmentedRangeTombstoneList {
+ public:
+  // Reads all tombstones of unfragmented_tombstones, which may be nullptr if
+  // there are none, and fragments them. The iterator is not needed after this
+  // returns.
+  // @return non-OK status if any of the tombstone keys are corrupted.
+  static Status Create(
+      InternalIterator* unfragmented_tombstones, const Comparator* ucmp,
+      std::shared_ptr<const FragmentedRangeTombstoneList>* tombstones);
+
+  // Returns the largest seqnum of the tombstones covering user_key that is
+  // not larger than upper_bound, or 0 if there is none.
+  SequenceNumber MaxCoveringTombstoneSeqnum(const Slice& user_key,
+                                            SequenceNumber upper_bound) const;
+
+  bool empty() const { return fragments_.empty(); }
+  size_t num_fragments() const { return fragments_.size(); }
+
+  size_t ApproximateMemoryUsage() const;
+
+ private:
+  // Covers the keys from keys_[start_idx] (inclusive) to keys_[end_idx]
+  // (exclusive), with seqnums seqs_[seq_start_idx, seq_end_idx).
+  struct Fragment {
+    size_t start_idx;
+    size_t end_idx;
+    size_t seq_start_idx;
+    size_t seq_end_idx;
+  };
+
+  explicit FragmentedRangeTombstoneList(const Comparator* ucmp)
+      : ucmp_(ucmp) {}
+
+  const Comparator* ucmp_;
+  // The distinct start and end keys of the tombstones, in order
+  std::vector<std::string> keys_;
+  // Ordered by start key
+  std::vector<Fragment> fragments_;
+  std::vector<SequenceNumber> seqs_;
+};
+
+}  // namespace rocksdb
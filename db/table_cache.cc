@@ -10,6 +10,7 @@
 #include "db/table_cache.h"
 
 #include "db/dbformat.h"
+#include "db/range_tombstone_fragmenter.h"
 #include "db/version_edit.h"
 #include "util/filename.h"
 
@@ -61,6 +62,30 @@ void AppendVarint64(IterKey* key, uint64_t v) {
 
 #endif  // ROCKSDB_LITE
 
+// Like TableCache::AddRangeTombstones(), but only gets the fragmented
+// tombstones, so they can be added to several aggregators.
+Status GetFragmentedRangeTombstones(
+    const ReadOptions& options,
+    const InternalKeyComparator& internal_comparator, TableReader* t,
+    std::shared_ptr<const FragmentedRangeTombstoneList>* tombstones) {
+  *tombstones = t->GetFragmentedRangeTombstones();
+  if (*tombstones != nullptr) {
+    return Status::OK();
+  }
+  std::unique_ptr<InternalIterator> range_del_iter(
+      t->NewRangeTombstoneIterator(options));
+  Status s;
+  if (range_del_iter != nullptr) {
+    s = range_del_iter->status();
+  }
+  if (s.ok()) {
+    s = FragmentedRangeTombstoneList::Create(
+        range_del_iter.get(), internal_comparator.user_comparator(),
+        tombstones);
+  }
+  return s;
+}
+
 }  // namespace
 
 TableCache::TableCache(const ImmutableCFOptions& ioptions,
@@ -284,6 +309,30 @@ InternalIterator* TableCache::NewIterator(
   return result;
 }
 
+Status TableCache::AddRangeTombstones(const ReadOptions& options,
+                                      TableReader* t,
+                                      const FileMetaData& file_meta,
+                                      RangeDelAggregator* range_del_agg) {
+  auto fragmented_range_dels = t->GetFragmentedRangeTombstones();
+  if (fragmented_range_dels != nullptr) {
+    range_del_agg->AddFragmentedTombstones(std::move(fragmented_range_dels),
+                                           &file_meta.smallest,
+                                           &file_meta.largest);
+    return Status::OK();
+  }
+  std::unique_ptr<InternalIterator> range_del_iter(
+      t->NewRangeTombstoneIterator(options));
+  Status s;
+  if (range_del_iter != nullptr) {
+    s = range_del_iter->status();
+  }
+  if (s.ok()) {
+    s = range_del_agg->AddTombstones(std::move(range_del_iter),
+                                     &file_meta.smallest, &file_meta.largest);
+  }
+  return s;
+}
+
 Status TableCache::Get(const ReadOptions& options,
                        const InternalKeyComparator& internal_comparator,
                        const FileMetaData& file_meta, const Slice& k,
@@ -319,6 +368,8 @@ Status TableCache::Get(const ReadOptions& options,
     row_cache_key.TrimAppend(row_cache_key.Size(), user_key.data(),
                              user_key.size());
 
+    // An empty entry records that the file has nothing for the key. As file
+    // numbers are never reused, it cannot get stale.
     if (auto row_handle =
             ioptions_.row_cache->Lookup(row_cache_key.GetUserKey())) {
       // Cleanable routine to release the cache entry
@@ -339,6 +390,8 @@ Status TableCache::Get(const ReadOptions& options,
       // get_context.pinnable_slice_ is reset.
       value_pinner.RegisterCleanup(release_cache_entry_func,
                                    ioptions_.row_cache.get(), row_handle);
+      // The entries are replayed with their sequence numbers, so that the
+      // range tombstones of newer files still apply to them
       replayGetContextLog(*found_row_cache_entry, user_key, get_context,
                           &value_pinner);
       RecordTick(ioptions_.statistics, ROW_CACHE_HIT);
@@ -365,17 +418,8 @@ Status TableCache::Get(const ReadOptions& options,
     }
     if (s.ok() && get_context->range_del_agg() != nullptr &&
         !options.ignore_range_deletions) {
-      std::unique_ptr<InternalIterator> range_del_iter(
-          t->NewRangeTombstoneIterator(options));
-      if (range_del_iter != nullptr) {
-        s = range_del_iter->status();
-      }
-      if (s.ok()) {
-        s = get_context->range_del_agg()->AddTombstones(
-            std::move(range_del_iter),
-            &file_meta.smallest,
-            &file_meta.largest);
-      }
+      s = AddRangeTombstones(options, t, file_meta,
+                             get_context->range_del_agg());
     }
     if (s.ok()) {
       get_context->SetReplayLog(row_cache_entry);  // nullptr if no cache.
@@ -390,8 +434,17 @@ Status TableCache::Get(const ReadOptions& options,
   }
 
 #ifndef ROCKSDB_LITE
-  // Put the replay log in row cache only if something was found.
-  if (!done && s.ok() && row_cache_entry && !row_cache_entry->empty()) {
+  // Put the replay log in row cache, or an empty one if nothing was found.
+  // Without I/O, the key may not have been searched for, so an empty replay
+  // log does not mean it is absent. Range tombstones of the file are not
+  // applied on a row cache hit, so files with any are not cached.
+  bool cacheable = false;
+  if (!done && s.ok() && row_cache_entry &&
+      (!row_cache_entry->empty() || options.read_tier != kBlockCacheTier)) {
+    auto props = t->GetTableProperties();
+    cacheable = props != nullptr && props->num_range_deletions == 0;
+  }
+  if (cacheable) {
     size_t charge =
         row_cache_key.Size() + row_cache_entry->size() + sizeof(std::string);
     void* row_ptr = new std::string(std::move(*row_cache_entry));
@@ -406,6 +459,98 @@ Status TableCache::Get(const ReadOptions& options,
   return s;
 }
 
+void TableCache::MultiGet(const ReadOptions& options,
+                          const InternalKeyComparator& internal_comparator,
+                          const FileMetaData& file_meta,
+                          const std::vector<Slice>& keys,
+                          const std::vector<GetContext*>& get_contexts,
+                          std::vector<Status>* statuses,
+                          const SliceTransform* prefix_extractor,
+                          HistogramImpl* file_read_hist, bool skip_filters,
+                          int level) {
+  assert(keys.size() == get_contexts.size());
+  statuses->assign(keys.size(), Status::OK());
+#ifndef ROCKSDB_LITE
+  // The row cache works key by key
+  if (ioptions_.row_cache) {
+    for (size_t i = 0; i < keys.size(); ++i) {
+      (*statuses)[i] =
+          Get(options, internal_comparator, file_meta, keys[i],
+              get_contexts[i], prefix_extractor, file_read_hist, skip_filters,
+              level);
+    }
+    return;
+  }
+#endif  // ROCKSDB_LITE
+  auto& fd = file_meta.fd;
+  Status s;
+  TableReader* t = fd.table_reader;
+  Cache::Handle* handle = nullptr;
+  if (t == nullptr) {
+    s = FindTable(
+        env_options_, internal_comparator, fd, &handle, prefix_extractor,
+        options.read_tier == kBlockCacheTier /* no_io */,
+        true /* record_read_stats */, file_read_hist, skip_filters, level);
+    if (s.ok()) {
+      t = GetTableReaderFromHandle(handle);
+    } else if (options.read_tier == kBlockCacheTier && s.IsIncomplete()) {
+      // Couldn't find Table in cache but treat as kFound if no_io set
+      for (auto* get_context : get_contexts) {
+        get_context->MarkKeyMayExist();
+      }
+      return;
+    } else {
+      statuses->assign(keys.size(), s);
+      return;
+    }
+  }
+
+  // The range tombstones of the file are fragmented once, and shared by the
+  // aggregators of all the keys
+  std::shared_ptr<const FragmentedRangeTombstoneList> range_dels;
+  Status range_del_status;
+  if (!options.ignore_range_deletions) {
+    range_del_status = GetFragmentedRangeTombstones(
+        options, internal_comparator, t, &range_dels);
+  }
+
+  // Keys whose range deletions could be added, in the same order
+  std::vector<Slice> lookup_keys;
+  std::vector<GetContext*> lookup_contexts;
+  std::vector<size_t> lookup_positions;
+  lookup_keys.reserve(keys.size());
+  lookup_contexts.reserve(keys.size());
+  lookup_positions.reserve(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    GetContext* get_context = get_contexts[i];
+    if (get_context->range_del_agg() != nullptr &&
+        !options.ignore_range_deletions) {
+      if (!range_del_status.ok()) {
+        (*statuses)[i] = range_del_status;
+        continue;
+      }
+      if (!range_dels->empty()) {
+        get_context->range_del_agg()->AddFragmentedTombstones(
+            range_dels, &file_meta.smallest, &file_meta.largest);
+      }
+    }
+    lookup_keys.push_back(keys[i]);
+    lookup_contexts.push_back(get_context);
+    lookup_positions.push_back(i);
+  }
+
+  std::vector<Status> lookup_statuses;
+  t->MultiGet(options, lookup_keys, lookup_contexts, prefix_extractor,
+              &lookup_statuses, skip_filters);
+  for (size_t j = 0; j < lookup_positions.size(); ++j) {
+    (*statuses)[lookup_positions[j]] = lookup_statuses[j];
+  }
+
+  if (handle != nullptr) {
+    ReleaseHandle(handle);
+  }
+}
+
 Status TableCache::GetTableProperties(
     const EnvOptions& env_options,
     const InternalKeyComparator& internal_comparator, const FileDescriptor& fd,
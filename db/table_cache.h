@@ -75,6 +75,18 @@ class TableCache {
              HistogramImpl* file_read_hist = nullptr, bool skip_filters = false,
              int level = -1);
 
+  // Like calling Get() for each of keys, which must be sorted, with the
+  // corresponding get_contexts. The table is found once for all of them.
+  // The status of the lookup of keys[i] is stored in (*statuses)[i].
+  void MultiGet(const ReadOptions& options,
+                const InternalKeyComparator& internal_comparator,
+                const FileMetaData& file_meta, const std::vector<Slice>& keys,
+                const std::vector<GetContext*>& get_contexts,
+                std::vector<Status>* statuses,
+                const SliceTransform* prefix_extractor = nullptr,
+                HistogramImpl* file_read_hist = nullptr,
+                bool skip_filters = false, int level = -1);
+
   // Evict any entry for the specified file number
   static void Evict(Cache* cache, uint64_t file_number);
 
@@ -134,6 +146,12 @@ class TableCache {
   }
 
  private:
+  // Adds the range tombstones of the table to range_del_agg for a point
+  // lookup, preferring the ones the table reader keeps fragmented.
+  Status AddRangeTombstones(const ReadOptions& options, TableReader* t,
+                            const FileMetaData& file_meta,
+                            RangeDelAggregator* range_del_agg);
+
   // Build a table reader
   Status GetTableReader(const EnvOptions& env_options,
                         const InternalKeyComparator& internal_comparator,
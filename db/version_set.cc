@@ -15,6 +15,7 @@
 
 #include <inttypes.h>
 #include <stdio.h>
+#include <string.h>
 #include <algorithm>
 #include <map>
 #include <set>
@@ -78,6 +79,40 @@ int FindFileInRange(const InternalKeyComparator& icmp,
   return right;
 }
 
+// Files the learned index of a level predicts the file for a key to be within
+const uint32_t kLearnedLevelIndexMaxError = 2;
+
+// Narrows [*left, *right] to the files the learned index predicts the
+// earliest file whose largest key >= key to be in, if the files next to them
+// confirm it. FindFileInRange() over the narrowed range returns the same file
+// then.
+void NarrowFileRangeWithLearnedIndex(const LearnedIndex& learned_index,
+                                     const InternalKeyComparator& icmp,
+                                     const LevelFilesBrief& file_level,
+                                     const Slice& key, uint32_t* left,
+                                     uint32_t* right) {
+  uint32_t first, last;
+  learned_index.Predict(ExtractUserKey(key), &first, &last);
+  first = std::max(first, *left);
+  last = std::min(last, *right);
+  if (first > last) {
+    return;
+  }
+  if (first > *left &&
+      icmp.InternalKeyComparator::Compare(
+          file_level.files[first - 1].largest_key, key) >= 0) {
+    return;
+  }
+  if (last < *right &&
+      icmp.InternalKeyComparator::Compare(file_level.files[last].largest_key,
+                                          key) < 0) {
+    return;
+  }
+  TEST_SYNC_POINT("NarrowFileRangeWithLearnedIndex:Narrowed");
+  *left = first;
+  *right = last;
+}
+
 Status OverlapWithIterator(const Comparator* ucmp,
     const Slice& smallest_user_key,
     const Slice& largest_user_key,
@@ -117,7 +152,8 @@ class FilePicker {
              const Slice& ikey, autovector<LevelFilesBrief>* file_levels,
              unsigned int num_levels, FileIndexer* file_indexer,
              const Comparator* user_comparator,
-             const InternalKeyComparator* internal_comparator)
+             const InternalKeyComparator* internal_comparator,
+             const std::vector<LearnedIndex>* learned_level_index = nullptr)
       : num_levels_(num_levels),
         curr_level_(static_cast<unsigned int>(-1)),
         returned_file_level_(static_cast<unsigned int>(-1)),
@@ -134,7 +170,8 @@ class FilePicker {
         ikey_(ikey),
         file_indexer_(file_indexer),
         user_comparator_(user_comparator),
-        internal_comparator_(internal_comparator) {
+        internal_comparator_(internal_comparator),
+        learned_level_index_(learned_level_index) {
 #ifdef NDEBUG
     (void)files;
 #endif
@@ -270,6 +307,7 @@ class FilePicker {
   FileIndexer* file_indexer_;
   const Comparator* user_comparator_;
   const InternalKeyComparator* internal_comparator_;
+  const std::vector<LearnedIndex>* learned_level_index_;
 #ifndef NDEBUG
   FdWithKeyRange* prev_file_;
 #endif
@@ -315,10 +353,18 @@ class FilePicker {
             search_right_bound_ =
                 static_cast<int32_t>(curr_file_level_->num_files) - 1;
           }
-          start_index =
-              FindFileInRange(*internal_comparator_, *curr_file_level_, ikey_,
-                              static_cast<uint32_t>(search_left_bound_),
-                              static_cast<uint32_t>(search_right_bound_));
+          uint32_t left = static_cast<uint32_t>(search_left_bound_);
+          uint32_t right = static_cast<uint32_t>(search_right_bound_);
+          if (learned_level_index_ != nullptr &&
+              curr_level_ < learned_level_index_->size() &&
+              (*learned_level_index_)[curr_level_].num_keys() ==
+                  curr_file_level_->num_files) {
+            NarrowFileRangeWithLearnedIndex(
+                (*learned_level_index_)[curr_level_], *internal_comparator_,
+                *curr_file_level_, ikey_, &left, &right);
+          }
+          start_index = FindFileInRange(*internal_comparator_,
+                                        *curr_file_level_, ikey_, left, right);
         } else {
           // search_left_bound > search_right_bound, key does not exist in
           // this level. Since no comparison is done in this level, it will
@@ -492,6 +538,7 @@ class LevelIterator final : public InternalIterator {
   virtual void SeekToFirst() override;
   virtual void SeekToLast() override;
   virtual void Next() override;
+  virtual bool NextAndGetResult(Slice* ret_key) override;
   virtual void Prev() override;
 
   virtual bool Valid() const override { return file_iter_.Valid(); }
@@ -619,6 +666,15 @@ void LevelIterator::Next() {
   SkipEmptyFileForward();
 }
 
+bool LevelIterator::NextAndGetResult(Slice* ret_key) {
+  Next();
+  bool is_valid = Valid();
+  if (is_valid) {
+    *ret_key = key();
+  }
+  return is_valid;
+}
+
 void LevelIterator::Prev() {
   assert(Valid());
   file_iter_.Prev();
@@ -1190,7 +1246,8 @@ void Version::Get(const ReadOptions& read_options, const LookupKey& k,
   FilePicker fp(
       storage_info_.files_, user_key, ikey, &storage_info_.level_files_brief_,
       storage_info_.num_non_empty_levels_, &storage_info_.file_indexer_,
-      user_comparator(), internal_comparator());
+      user_comparator(), internal_comparator(),
+      &storage_info_.learned_level_index_);
   FdWithKeyRange* f = fp.GetNextFile();
 
   while (f != nullptr) {
@@ -1275,6 +1332,175 @@ void Version::Get(const ReadOptions& read_options, const LookupKey& k,
   }
 }
 
+void Version::MultiGet(const ReadOptions& read_options,
+                       const std::vector<LookupKey*>& keys,
+                       const std::vector<PinnableSlice*>& values,
+                       const std::vector<Status*>& statuses,
+                       const std::vector<MergeContext*>& merge_contexts,
+                       const std::vector<RangeDelAggregator*>& range_del_aggs) {
+  const size_t num_keys = keys.size();
+  std::vector<std::unique_ptr<PinnedIteratorsManager>> pinned_iters_mgrs(
+      num_keys);
+  std::vector<std::unique_ptr<GetContext>> get_contexts(num_keys);
+  std::vector<std::unique_ptr<FilePicker>> file_pickers(num_keys);
+  // Next file to look into for each key, nullptr once the lookup is over
+  std::vector<FdWithKeyRange*> files(num_keys);
+  // Whether the lookup ended before running out of files
+  std::vector<bool> finished(num_keys, false);
+
+  for (size_t i = 0; i < num_keys; ++i) {
+    assert(statuses[i]->ok() || statuses[i]->IsMergeInProgress());
+    Slice user_key = keys[i]->user_key();
+    pinned_iters_mgrs[i].reset(new PinnedIteratorsManager());
+    get_contexts[i].reset(new GetContext(
+        user_comparator(), merge_operator_, info_log_, db_statistics_,
+        statuses[i]->ok() ? GetContext::kNotFound : GetContext::kMerge,
+        user_key, values[i], nullptr /* value_found */, merge_contexts[i],
+        range_del_aggs[i], this->env_, nullptr /* seq */,
+        merge_operator_ ? pinned_iters_mgrs[i].get() : nullptr));
+    // Pin blocks that we read to hold merge operands
+    if (merge_operator_) {
+      pinned_iters_mgrs[i]->StartPinning();
+    }
+    file_pickers[i].reset(new FilePicker(
+        storage_info_.files_, user_key, keys[i]->internal_key(),
+        &storage_info_.level_files_brief_,
+        storage_info_.num_non_empty_levels_, &storage_info_.file_indexer_,
+        user_comparator(), internal_comparator(),
+        &storage_info_.learned_level_index_));
+    files[i] = file_pickers[i]->GetNextFile();
+  }
+
+  // Every round looks every key up in its next file. Keys that need the same
+  // file in a round are looked up in it together; being sorted, they stay
+  // sorted in their group.
+  std::vector<std::pair<FdWithKeyRange*, std::vector<size_t>>> groups;
+  std::unordered_map<FdWithKeyRange*, size_t> group_of_file;
+  std::vector<Slice> batch_keys;
+  std::vector<GetContext*> batch_contexts;
+  std::vector<Status> batch_statuses;
+  while (true) {
+    groups.clear();
+    group_of_file.clear();
+    for (size_t i = 0; i < num_keys; ++i) {
+      if (files[i] == nullptr) {
+        continue;
+      }
+      auto it = group_of_file.find(files[i]);
+      if (it == group_of_file.end()) {
+        group_of_file.emplace(files[i], groups.size());
+        groups.emplace_back(files[i], std::vector<size_t>({i}));
+      } else {
+        groups[it->second].second.push_back(i);
+      }
+    }
+    if (groups.empty()) {
+      break;
+    }
+
+    for (auto& group : groups) {
+      FdWithKeyRange* f = group.first;
+      const std::vector<size_t>& indexes = group.second;
+      // All the keys of the group are at the same level
+      FilePicker* fp = file_pickers[indexes[0]].get();
+      batch_keys.clear();
+      batch_contexts.clear();
+      for (size_t i : indexes) {
+        if (get_contexts[i]->sample()) {
+          sample_file_read_inc(f->file_metadata);
+        }
+        batch_keys.push_back(keys[i]->internal_key());
+        batch_contexts.push_back(get_contexts[i].get());
+      }
+      table_cache_->MultiGet(
+          read_options, *internal_comparator(), *f->file_metadata, batch_keys,
+          batch_contexts, &batch_statuses,
+          mutable_cf_options_.prefix_extractor.get(),
+          cfd_->internal_stats()->GetFileReadHist(fp->GetHitFileLevel()),
+          IsFilterSkipped(static_cast<int>(fp->GetHitFileLevel()),
+                          fp->IsHitFileLastInLevel()),
+          fp->GetCurrentLevel());
+
+      for (size_t j = 0; j < indexes.size(); ++j) {
+        size_t i = indexes[j];
+        GetContext& get_context = *get_contexts[i];
+        Status* status = statuses[i];
+        *status = batch_statuses[j];
+        files[i] = nullptr;
+        finished[i] = true;
+        // TODO: examine the behavior for corrupted key
+        if (!status->ok()) {
+          continue;
+        }
+
+        // report the counters before returning
+        if (get_context.State() != GetContext::kNotFound &&
+            get_context.State() != GetContext::kMerge &&
+            db_statistics_ != nullptr) {
+          get_context.ReportCounters();
+        }
+        switch (get_context.State()) {
+          case GetContext::kNotFound:
+          case GetContext::kMerge:
+            // Keep searching in other files
+            finished[i] = false;
+            files[i] = file_pickers[i]->GetNextFile();
+            break;
+          case GetContext::kFound:
+            if (fp->GetHitFileLevel() == 0) {
+              RecordTick(db_statistics_, GET_HIT_L0);
+            } else if (fp->GetHitFileLevel() == 1) {
+              RecordTick(db_statistics_, GET_HIT_L1);
+            } else if (fp->GetHitFileLevel() >= 2) {
+              RecordTick(db_statistics_, GET_HIT_L2_AND_UP);
+            }
+            break;
+          case GetContext::kDeleted:
+            // Use empty error message for speed
+            *status = Status::NotFound();
+            break;
+          case GetContext::kCorrupt:
+            *status =
+                Status::Corruption("corrupted key for ", keys[i]->user_key());
+            break;
+          case GetContext::kBlobIndex:
+            ROCKS_LOG_ERROR(info_log_, "Encounter unexpected blob index.");
+            *status = Status::NotSupported(
+                "Encounter unexpected blob index. Please open DB with "
+                "rocksdb::blob_db::BlobDB instead.");
+            break;
+        }
+      }
+    }
+  }
+
+  for (size_t i = 0; i < num_keys; ++i) {
+    if (finished[i]) {
+      continue;
+    }
+    GetContext& get_context = *get_contexts[i];
+    if (db_statistics_ != nullptr) {
+      get_context.ReportCounters();
+    }
+    if (GetContext::kMerge == get_context.State()) {
+      if (!merge_operator_) {
+        *statuses[i] = Status::InvalidArgument(
+            "merge_operator is not properly initialized.");
+        continue;
+      }
+      // merge_operands are in saver and we hit the beginning of the key
+      // history do a final merge of nullptr and operands;
+      *statuses[i] = MergeHelper::TimedFullMerge(
+          merge_operator_, keys[i]->user_key(), nullptr,
+          merge_contexts[i]->GetOperands(), values[i]->GetSelf(), info_log_,
+          db_statistics_, env_, nullptr /* result_operand */, true);
+      values[i]->PinSelf();
+    } else {
+      *statuses[i] = Status::NotFound();  // Use an empty error message for speed
+    }
+  }
+}
+
 bool Version::IsFilterSkipped(int level, bool is_file_last_in_level) {
   // Reaching the bottom level implies misses at all upper levels, so we'll
   // skip checking the filters when we predict a hit.
@@ -1291,6 +1517,25 @@ void VersionStorageInfo::GenerateLevelFilesBrief() {
   }
 }
 
+void VersionStorageInfo::GenerateLearnedLevelIndex() {
+  learned_level_index_.clear();
+  if (strcmp(user_comparator_->Name(), BytewiseComparator()->Name()) != 0) {
+    return;
+  }
+  learned_level_index_.resize(level_files_brief_.size());
+  for (size_t level = 1; level < level_files_brief_.size(); level++) {
+    const rocksdb::LevelFilesBrief& file_level = level_files_brief_[level];
+    LearnedIndex::Builder builder(kLearnedLevelIndexMaxError);
+    for (size_t i = 0; i < file_level.num_files; i++) {
+      builder.Add(ExtractUserKey(file_level.files[i].largest_key));
+    }
+    std::string encoded;
+    if (builder.Finish(&encoded)) {
+      learned_level_index_[level].DecodeFrom(encoded);
+    }
+  }
+}
+
 void Version::PrepareApply(
     const MutableCFOptions& mutable_cf_options,
     bool update_stats) {
@@ -1300,6 +1545,9 @@ void Version::PrepareApply(
   storage_info_.UpdateFilesByCompactionPri(cfd_->ioptions()->compaction_pri);
   storage_info_.GenerateFileIndexer();
   storage_info_.GenerateLevelFilesBrief();
+  if (cfd_->ioptions()->learned_level_index) {
+    storage_info_.GenerateLearnedLevelIndex();
+  }
   storage_info_.GenerateLevel0NonOverlapping();
   storage_info_.GenerateBottommostFiles();
 }
@@ -2371,6 +2619,55 @@ void VersionStorageInfo::ExtendFileRangeWithinInterval(
   *end_index = right;
 }
 
+void VersionStorageInfo::GetSplitKeys(
+    const Slice* begin, const Slice* end, size_t n,
+    std::vector<std::string>* split_keys) const {
+  split_keys->clear();
+  // Smallest user key and size of each file in the range
+  std::vector<std::pair<Slice, uint64_t>> files;
+  uint64_t total_size = 0;
+  for (int level = 0; level < num_levels_; level++) {
+    for (FileMetaData* f : files_[level]) {
+      if ((begin != nullptr &&
+           user_comparator_->Compare(f->largest.user_key(), *begin) < 0) ||
+          (end != nullptr &&
+           user_comparator_->Compare(f->smallest.user_key(), *end) >= 0)) {
+        continue;
+      }
+      files.emplace_back(f->smallest.user_key(), f->fd.GetFileSize());
+      total_size += f->fd.GetFileSize();
+    }
+  }
+  std::sort(files.begin(), files.end(),
+            [this](const std::pair<Slice, uint64_t>& a,
+                   const std::pair<Slice, uint64_t>& b) {
+              return user_comparator_->Compare(a.first, b.first) < 0;
+            });
+
+  // Split before the first file that starts at or after each multiple of
+  // total_size / n
+  uint64_t size_before = 0;
+  size_t part = 1;
+  for (const auto& file : files) {
+    if (part >= n) {
+      break;
+    }
+    if (size_before >= total_size / n * part) {
+      const Slice& key = file.first;
+      if ((begin == nullptr || user_comparator_->Compare(key, *begin) > 0) &&
+          (end == nullptr || user_comparator_->Compare(key, *end) < 0) &&
+          (split_keys->empty() ||
+           user_comparator_->Compare(key, split_keys->back()) > 0)) {
+        split_keys->push_back(key.ToString());
+      }
+      while (part < n && size_before >= total_size / n * part) {
+        part++;
+      }
+    }
+    size_before += file.second;
+  }
+}
+
 uint64_t VersionStorageInfo::NumLevelBytes(int level) const {
   assert(level >= 0);
   assert(level < num_levels());
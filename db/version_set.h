@@ -40,6 +40,7 @@
 #include "db/version_builder.h"
 #include "db/version_edit.h"
 #include "db/write_controller.h"
+#include "table/learned_index.h"
 #include "monitoring/instrumented_mutex.h"
 #include "options/db_options.h"
 #include "port/port.h"
@@ -154,6 +155,8 @@ class VersionStorageInfo {
 
   // Generate level_files_brief_ from files_
   void GenerateLevelFilesBrief();
+  // Generate learned_level_index_ from level_files_brief_
+  void GenerateLearnedLevelIndex();
   // Sort all files for this version based on their file size and
   // record results in files_by_compaction_pri_. The largest files are listed
   // first.
@@ -242,6 +245,15 @@ class VersionStorageInfo {
   bool HasOverlappingUserKey(const std::vector<FileMetaData*>* inputs,
                              int level);
 
+  // Returns in *split_keys up to n - 1 increasing user keys inside
+  // (*begin, *end) that split the bytes of the files overlapping
+  // [*begin, *end) into n parts of about the same size. Split keys are the
+  // smallest keys of files and the bytes of a file are counted from there,
+  // so there are fewer parts than n if there are not enough files.
+  // begin==nullptr and end==nullptr represent unbounded ends.
+  void GetSplitKeys(const Slice* begin, const Slice* end, size_t n,
+                    std::vector<std::string>* split_keys) const;
+
   int num_levels() const { return num_levels_; }
 
   // REQUIRES: This version has been saved (see VersionSet::SaveTo)
@@ -421,6 +433,9 @@ class VersionStorageInfo {
   // A short brief metadata of files per level
   autovector<rocksdb::LevelFilesBrief> level_files_brief_;
   FileIndexer file_indexer_;
+  // Models of the largest keys of the files of levels > 0, if enabled.
+  // Empty models for levels that are not modeled.
+  std::vector<LearnedIndex> learned_level_index_;
   Arena arena_;  // Used to allocate space for file_levels_
 
   CompactionStyle compaction_style_;
@@ -566,6 +581,20 @@ class Version {
            bool* key_exists = nullptr, SequenceNumber* seq = nullptr,
            ReadCallback* callback = nullptr, bool* is_blob = nullptr);
 
+  // Like calling Get() for each of keys, which must be sorted by user key.
+  // The arguments of the lookup of keys[i] are values[i], statuses[i],
+  // merge_contexts[i] and range_del_aggs[i]. The lookups go through the
+  // levels together: a file needed by several keys is searched once for all
+  // of them, and so is a data block of a block-based table. Values are
+  // always copied into values[i].
+  //
+  // REQUIRES: lock is not held
+  void MultiGet(const ReadOptions&, const std::vector<LookupKey*>& keys,
+                const std::vector<PinnableSlice*>& values,
+                const std::vector<Status*>& statuses,
+                const std::vector<MergeContext*>& merge_contexts,
+                const std::vector<RangeDelAggregator*>& range_del_aggs);
+
   // Loads some stats information from files. Call without mutex held. It needs
   // to be called before applying the version to the version set.
   void PrepareApply(const MutableCFOptions& mutable_cf_options,
@@ -32,6 +32,9 @@
 // varstring :=
 //    len: varint32
 //    data: uint8[len]
+//
+// The data of the values added with PutByReference() is left out of rep_ and
+// kept in value_refs_ instead.
 
 #include "rocksdb/write_batch.h"
 
@@ -53,6 +56,7 @@
 #include "monitoring/statistics.h"
 #include "rocksdb/merge_operator.h"
 #include "util/coding.h"
+#include "util/crc32c.h"
 #include "util/duplicate_detector.h"
 #include "util/string_util.h"
 #include "util/util.h"
@@ -147,6 +151,15 @@ WriteBatch::WriteBatch(size_t reserved_bytes, size_t max_bytes)
   rep_.resize(WriteBatchInternal::kHeader);
 }
 
+WriteBatch::WriteBatch(size_t reserved_bytes, size_t max_bytes,
+                       size_t protection_bytes_per_key)
+    : WriteBatch(reserved_bytes, max_bytes) {
+  assert(protection_bytes_per_key == 0 || protection_bytes_per_key == 4);
+  if (protection_bytes_per_key != 0) {
+    prot_info_.reset(new ProtectionInfo());
+  }
+}
+
 WriteBatch::WriteBatch(const std::string& rep)
     : save_points_(nullptr),
       content_flags_(ContentFlags::DEFERRED),
@@ -160,10 +173,18 @@ WriteBatch::WriteBatch(std::string&& rep)
       rep_(std::move(rep)) {}
 
 WriteBatch::WriteBatch(const WriteBatch& src)
-    : save_points_(src.save_points_),
+    : save_points_(src.save_points_ != nullptr
+                       ? new SavePoints(*src.save_points_)
+                       : nullptr),
       wal_term_point_(src.wal_term_point_),
       content_flags_(src.content_flags_.load(std::memory_order_relaxed)),
       max_bytes_(src.max_bytes_),
+      prot_info_(src.prot_info_ != nullptr
+                     ? new ProtectionInfo(*src.prot_info_)
+                     : nullptr),
+      value_refs_(src.value_refs_ != nullptr
+                      ? new ValueReferences(*src.value_refs_)
+                      : nullptr),
       rep_(src.rep_) {}
 
 WriteBatch::WriteBatch(WriteBatch&& src) noexcept
@@ -171,6 +192,8 @@ WriteBatch::WriteBatch(WriteBatch&& src) noexcept
       wal_term_point_(std::move(src.wal_term_point_)),
       content_flags_(src.content_flags_.load(std::memory_order_relaxed)),
       max_bytes_(src.max_bytes_),
+      prot_info_(std::move(src.prot_info_)),
+      value_refs_(std::move(src.value_refs_)),
       rep_(std::move(src.rep_)) {}
 
 WriteBatch& WriteBatch::operator=(const WriteBatch& src) {
@@ -208,6 +231,12 @@ void WriteBatch::Clear() {
 
   content_flags_.store(0, std::memory_order_relaxed);
 
+  if (prot_info_ != nullptr) {
+    prot_info_->entry_checksums.clear();
+  }
+
+  value_refs_.reset();
+
   if (save_points_ != nullptr) {
     while (!save_points_->stack.empty()) {
       save_points_->stack.pop();
@@ -396,8 +425,233 @@ Status ReadRecordFromWriteBatch(Slice* input, char* tag,
   return Status::OK();
 }
 
+namespace {
+// Returns true for the entries that are included in the count of the batch,
+// which are the ones that are protected.
+bool IsCountedEntry(char tag) {
+  switch (tag) {
+    case kTypeColumnFamilyValue:
+    case kTypeValue:
+    case kTypeColumnFamilyDeletion:
+    case kTypeDeletion:
+    case kTypeColumnFamilySingleDeletion:
+    case kTypeSingleDeletion:
+    case kTypeColumnFamilyRangeDeletion:
+    case kTypeRangeDeletion:
+    case kTypeColumnFamilyMerge:
+    case kTypeMerge:
+    case kTypeColumnFamilyBlobIndex:
+    case kTypeBlobIndex:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool IsColumnFamilyTag(char tag) {
+  switch (tag) {
+    case kTypeColumnFamilyValue:
+    case kTypeColumnFamilyDeletion:
+    case kTypeColumnFamilySingleDeletion:
+    case kTypeColumnFamilyRangeDeletion:
+    case kTypeColumnFamilyMerge:
+    case kTypeColumnFamilyBlobIndex:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Returns the tag of an entry of the given type in a column family other
+// than the default one
+ValueType ColumnFamilyTag(ValueType type) {
+  switch (type) {
+    case kTypeValue:
+      return kTypeColumnFamilyValue;
+    case kTypeDeletion:
+      return kTypeColumnFamilyDeletion;
+    case kTypeSingleDeletion:
+      return kTypeColumnFamilySingleDeletion;
+    case kTypeRangeDeletion:
+      return kTypeColumnFamilyRangeDeletion;
+    case kTypeMerge:
+      return kTypeColumnFamilyMerge;
+    case kTypeBlobIndex:
+      return kTypeColumnFamilyBlobIndex;
+    default:
+      assert(false);
+      return type;
+  }
+}
+
+// Returns the checksum of an entry encoded as entry in rep_, followed by the
+// bytes of *value_ref if its value was added with PutByReference().
+uint32_t EncodedEntryChecksum(const Slice& entry, const Slice* value_ref) {
+  uint32_t crc = crc32c::Value(entry.data(), entry.size());
+  if (value_ref != nullptr) {
+    crc = crc32c::Extend(crc, value_ref->data(), value_ref->size());
+  }
+  return crc;
+}
+
+Status VerifyEntryChecksum(const ProtectionInfo& prot_info, size_t index,
+                           const Slice& entry, const Slice* value_ref) {
+  if (index >= prot_info.entry_checksums.size()) {
+    return Status::Corruption("WriteBatch has unprotected entries");
+  }
+  if (EncodedEntryChecksum(entry, value_ref) !=
+      prot_info.entry_checksums[index]) {
+    return Status::Corruption("WriteBatch entry checksum mismatch");
+  }
+  return Status::OK();
+}
+
+// Like ReadRecordFromWriteBatch(), for a batch whose entries are in rep and
+// whose referenced values are in refs, which may be nullptr. *next_ref is
+// the index in refs of the first reference that was not read yet. If the
+// value of the entry read is referenced, *value_ref is set to it, and
+// otherwise to nullptr.
+Status ReadEntry(const std::string& rep, const ValueReferences* refs,
+                 size_t* next_ref, Slice* input, char* tag,
+                 uint32_t* column_family, Slice* key, Slice* value,
+                 Slice* blob, Slice* xid, const Slice** value_ref) {
+  *value_ref = nullptr;
+  if (LIKELY(refs == nullptr || *next_ref == refs->refs.size())) {
+    return ReadRecordFromWriteBatch(input, tag, column_family, key, value,
+                                    blob, xid);
+  }
+  const ValueReferences::Reference& ref = refs->refs[*next_ref];
+  const size_t offset = static_cast<size_t>(input->data() - rep.data());
+  if (offset != ref.entry_offset) {
+    assert(offset < ref.entry_offset);
+    return ReadRecordFromWriteBatch(input, tag, column_family, key, value,
+                                    blob, xid);
+  }
+  // A Put that ends with the length of its value
+  assert(ref.value_offset <= rep.size());
+  Slice entry(input->data(), ref.value_offset - offset);
+  uint32_t value_size;
+  *tag = entry[0];
+  entry.remove_prefix(1);
+  *column_family = 0;
+  if ((*tag != kTypeValue && *tag != kTypeColumnFamilyValue) ||
+      (*tag == kTypeColumnFamilyValue &&
+       !GetVarint32(&entry, column_family)) ||
+      !GetLengthPrefixedSlice(&entry, key) ||
+      !GetVarint32(&entry, &value_size) || !entry.empty() ||
+      value_size != ref.value.size()) {
+    return Status::Corruption("bad WriteBatch Put");
+  }
+  *value = ref.value;
+  *value_ref = &ref.value;
+  input->remove_prefix(ref.value_offset - offset);
+  ++*next_ref;
+  return Status::OK();
+}
+}  // anonymous namespace
+
+void WriteBatchInternal::ProtectLastEntry(WriteBatch* b, size_t offset) {
+  assert(b->prot_info_ != nullptr);
+  assert(offset < b->rep_.size());
+  const Slice* value_ref = nullptr;
+  if (HasValueReferences(b) &&
+      b->value_refs_->refs.back().entry_offset == offset) {
+    value_ref = &b->value_refs_->refs.back().value;
+  }
+  b->prot_info_->entry_checksums.push_back(EncodedEntryChecksum(
+      Slice(b->rep_.data() + offset, b->rep_.size() - offset), value_ref));
+}
+
+Status WriteBatchInternal::ProtectEntries(WriteBatch* b, size_t offset) {
+  assert(b->prot_info_ != nullptr);
+  Slice input(b->rep_.data() + offset, b->rep_.size() - offset);
+  Slice key, value, blob, xid;
+  char tag;
+  uint32_t column_family;
+  while (!input.empty()) {
+    const char* entry = input.data();
+    Status s = ReadRecordFromWriteBatch(&input, &tag, &column_family, &key,
+                                        &value, &blob, &xid);
+    if (!s.ok()) {
+      return s;
+    }
+    // Entries set or appended as a whole never reference their values
+    if (IsCountedEntry(tag)) {
+      b->prot_info_->entry_checksums.push_back(
+          EncodedEntryChecksum(Slice(entry, input.data() - entry),
+                               nullptr));
+    }
+  }
+  return Status::OK();
+}
+
+Status WriteBatchInternal::VerifyChecksums(const WriteBatch* b) {
+  if (b->prot_info_ == nullptr) {
+    return Status::OK();
+  }
+  Slice input(b->rep_);
+  if (input.size() < WriteBatchInternal::kHeader) {
+    return Status::Corruption("malformed WriteBatch (too small)");
+  }
+  input.remove_prefix(WriteBatchInternal::kHeader);
+  Slice key, value, blob, xid;
+  char tag;
+  uint32_t column_family;
+  size_t protected_entries = 0;
+  size_t next_ref = 0;
+  const Slice* value_ref;
+  while (!input.empty()) {
+    const char* entry = input.data();
+    Status s = ReadEntry(b->rep_, b->value_refs_.get(), &next_ref, &input,
+                         &tag, &column_family, &key, &value, &blob, &xid,
+                         &value_ref);
+    if (s.ok() && IsCountedEntry(tag)) {
+      s = VerifyEntryChecksum(*b->prot_info_, protected_entries++,
+                              Slice(entry, input.data() - entry), value_ref);
+    }
+    if (!s.ok()) {
+      return s;
+    }
+  }
+  if (protected_entries != b->prot_info_->entry_checksums.size()) {
+    return Status::Corruption("WriteBatch has fewer entries than checksums");
+  }
+  return Status::OK();
+}
+
+uint32_t WriteBatchInternal::EntryChecksum(ValueType type,
+                                           uint32_t column_family_id,
+                                           const Slice& key,
+                                           const Slice& value) {
+  // The entry as Put() and friends encode it, without copying key and value:
+  // a tag and up to two varint32s before the key
+  char buf[11];
+  char* p = buf;
+  if (column_family_id == 0) {
+    *p++ = static_cast<char>(type);
+  } else {
+    *p++ = static_cast<char>(ColumnFamilyTag(type));
+    p = EncodeVarint32(p, column_family_id);
+  }
+  p = EncodeVarint32(p, static_cast<uint32_t>(key.size()));
+  uint32_t crc = crc32c::Value(buf, p - buf);
+  crc = crc32c::Extend(crc, key.data(), key.size());
+  if (type != kTypeDeletion && type != kTypeSingleDeletion) {
+    p = EncodeVarint32(buf, static_cast<uint32_t>(value.size()));
+    crc = crc32c::Extend(crc, buf, p - buf);
+    crc = crc32c::Extend(crc, value.data(), value.size());
+  }
+  return crc;
+}
+
 Status WriteBatch::Iterate(Handler* handler) const {
-  Slice input(rep_);
+  return WriteBatchInternal::Iterate(this, handler, nullptr);
+}
+
+Status WriteBatchInternal::Iterate(const WriteBatch* batch,
+                                   WriteBatch::Handler* handler,
+                                   const uint32_t** entry_checksum) {
+  Slice input(batch->rep_);
   if (input.size() < WriteBatchInternal::kHeader) {
     return Status::Corruption("malformed WriteBatch (too small)");
   }
@@ -414,6 +668,12 @@ Status WriteBatch::Iterate(Handler* handler) const {
   char tag = 0;
   uint32_t column_family = 0;  // default
   bool last_was_try_again = false;
+  size_t protected_entries = 0;
+  size_t next_ref = 0;
+  const Slice* value_ref;
+  if (entry_checksum != nullptr) {
+    *entry_checksum = nullptr;
+  }
   while (((s.ok() && !input.empty()) || UNLIKELY(s.IsTryAgain())) &&
          handler->Continue()) {
     if (LIKELY(!s.IsTryAgain())) {
@@ -421,11 +681,32 @@ Status WriteBatch::Iterate(Handler* handler) const {
       tag = 0;
       column_family = 0;  // default
 
-      s = ReadRecordFromWriteBatch(&input, &tag, &column_family, &key, &value,
-                                   &blob, &xid);
+      const char* entry = input.data();
+      s = ReadEntry(batch->rep_, batch->value_refs_.get(), &next_ref, &input,
+                    &tag, &column_family, &key, &value, &blob, &xid,
+                    &value_ref);
       if (!s.ok()) {
         return s;
       }
+      if (UNLIKELY(entry_checksum != nullptr &&
+                   batch->prot_info_ != nullptr)) {
+        *entry_checksum = nullptr;
+        if (IsCountedEntry(tag)) {
+          s = VerifyEntryChecksum(*batch->prot_info_, protected_entries,
+                                  Slice(entry, input.data() - entry),
+                                  value_ref);
+          if (!s.ok()) {
+            return s;
+          }
+          // EntryChecksum() assumes the short tags for the default column
+          // family, as the batch writes them
+          if ((column_family == 0) == !IsColumnFamilyTag(tag)) {
+            *entry_checksum =
+                &batch->prot_info_->entry_checksums[protected_entries];
+          }
+          protected_entries++;
+        }
+      }
     } else {
       assert(s.IsTryAgain());
       assert(!last_was_try_again); // to detect infinite loop bugs
@@ -441,7 +722,7 @@ Status WriteBatch::Iterate(Handler* handler) const {
     switch (tag) {
       case kTypeColumnFamilyValue:
       case kTypeValue:
-        assert(content_flags_.load(std::memory_order_relaxed) &
+        assert(batch->content_flags_.load(std::memory_order_relaxed) &
                (ContentFlags::DEFERRED | ContentFlags::HAS_PUT));
         s = handler->PutCF(column_family, key, value);
         if (LIKELY(s.ok())) {
@@ -451,7 +732,7 @@ Status WriteBatch::Iterate(Handler* handler) const {
         break;
       case kTypeColumnFamilyDeletion:
       case kTypeDeletion:
-        assert(content_flags_.load(std::memory_order_relaxed) &
+        assert(batch->content_flags_.load(std::memory_order_relaxed) &
                (ContentFlags::DEFERRED | ContentFlags::HAS_DELETE));
         s = handler->DeleteCF(column_family, key);
         if (LIKELY(s.ok())) {
@@ -461,7 +742,7 @@ Status WriteBatch::Iterate(Handler* handler) const {
         break;
       case kTypeColumnFamilySingleDeletion:
       case kTypeSingleDeletion:
-        assert(content_flags_.load(std::memory_order_relaxed) &
+        assert(batch->content_flags_.load(std::memory_order_relaxed) &
                (ContentFlags::DEFERRED | ContentFlags::HAS_SINGLE_DELETE));
         s = handler->SingleDeleteCF(column_family, key);
         if (LIKELY(s.ok())) {
@@ -471,7 +752,7 @@ Status WriteBatch::Iterate(Handler* handler) const {
         break;
       case kTypeColumnFamilyRangeDeletion:
       case kTypeRangeDeletion:
-        assert(content_flags_.load(std::memory_order_relaxed) &
+        assert(batch->content_flags_.load(std::memory_order_relaxed) &
                (ContentFlags::DEFERRED | ContentFlags::HAS_DELETE_RANGE));
         s = handler->DeleteRangeCF(column_family, key, value);
         if (LIKELY(s.ok())) {
@@ -481,7 +762,7 @@ Status WriteBatch::Iterate(Handler* handler) const {
         break;
       case kTypeColumnFamilyMerge:
       case kTypeMerge:
-        assert(content_flags_.load(std::memory_order_relaxed) &
+        assert(batch->content_flags_.load(std::memory_order_relaxed) &
                (ContentFlags::DEFERRED | ContentFlags::HAS_MERGE));
         s = handler->MergeCF(column_family, key, value);
         if (LIKELY(s.ok())) {
@@ -491,7 +772,7 @@ Status WriteBatch::Iterate(Handler* handler) const {
         break;
       case kTypeColumnFamilyBlobIndex:
       case kTypeBlobIndex:
-        assert(content_flags_.load(std::memory_order_relaxed) &
+        assert(batch->content_flags_.load(std::memory_order_relaxed) &
                (ContentFlags::DEFERRED | ContentFlags::HAS_BLOB_INDEX));
         s = handler->PutBlobIndexCF(column_family, key, value);
         if (LIKELY(s.ok())) {
@@ -504,7 +785,7 @@ Status WriteBatch::Iterate(Handler* handler) const {
         empty_batch = false;
         break;
       case kTypeBeginPrepareXID:
-        assert(content_flags_.load(std::memory_order_relaxed) &
+        assert(batch->content_flags_.load(std::memory_order_relaxed) &
                (ContentFlags::DEFERRED | ContentFlags::HAS_BEGIN_PREPARE));
         handler->MarkBeginPrepare();
         empty_batch = false;
@@ -523,7 +804,7 @@ Status WriteBatch::Iterate(Handler* handler) const {
         }
         break;
       case kTypeBeginPersistedPrepareXID:
-        assert(content_flags_.load(std::memory_order_relaxed) &
+        assert(batch->content_flags_.load(std::memory_order_relaxed) &
                (ContentFlags::DEFERRED | ContentFlags::HAS_BEGIN_PREPARE));
         handler->MarkBeginPrepare();
         empty_batch = false;
@@ -536,7 +817,7 @@ Status WriteBatch::Iterate(Handler* handler) const {
         }
         break;
       case kTypeBeginUnprepareXID:
-        assert(content_flags_.load(std::memory_order_relaxed) &
+        assert(batch->content_flags_.load(std::memory_order_relaxed) &
                (ContentFlags::DEFERRED | ContentFlags::HAS_BEGIN_UNPREPARE));
         handler->MarkBeginPrepare(true /* unprepared */);
         empty_batch = false;
@@ -555,19 +836,19 @@ Status WriteBatch::Iterate(Handler* handler) const {
         }
         break;
       case kTypeEndPrepareXID:
-        assert(content_flags_.load(std::memory_order_relaxed) &
+        assert(batch->content_flags_.load(std::memory_order_relaxed) &
                (ContentFlags::DEFERRED | ContentFlags::HAS_END_PREPARE));
         handler->MarkEndPrepare(xid);
         empty_batch = true;
         break;
       case kTypeCommitXID:
-        assert(content_flags_.load(std::memory_order_relaxed) &
+        assert(batch->content_flags_.load(std::memory_order_relaxed) &
                (ContentFlags::DEFERRED | ContentFlags::HAS_COMMIT));
         handler->MarkCommit(xid);
         empty_batch = true;
         break;
       case kTypeRollbackXID:
-        assert(content_flags_.load(std::memory_order_relaxed) &
+        assert(batch->content_flags_.load(std::memory_order_relaxed) &
                (ContentFlags::DEFERRED | ContentFlags::HAS_ROLLBACK));
         handler->MarkRollback(xid);
         empty_batch = true;
@@ -583,7 +864,7 @@ Status WriteBatch::Iterate(Handler* handler) const {
   if (!s.ok()) {
     return s;
   }
-  if (found != WriteBatchInternal::Count(this)) {
+  if (found != WriteBatchInternal::Count(batch)) {
     return Status::Corruption("WriteBatch has wrong count");
   } else {
     return Status::OK();
@@ -649,6 +930,45 @@ Status WriteBatch::Put(ColumnFamilyHandle* column_family, const Slice& key,
                                  value);
 }
 
+Status WriteBatchInternal::PutByReference(WriteBatch* b,
+                                          uint32_t column_family_id,
+                                          const Slice& key,
+                                          const Slice& value) {
+  if (key.size() > size_t{port::kMaxUint32}) {
+    return Status::InvalidArgument("key is too large");
+  }
+  if (value.size() > size_t{port::kMaxUint32}) {
+    return Status::InvalidArgument("value is too large");
+  }
+
+  LocalSavePoint save(b);
+  const size_t entry_offset = b->rep_.size();
+  WriteBatchInternal::SetCount(b, WriteBatchInternal::Count(b) + 1);
+  if (column_family_id == 0) {
+    b->rep_.push_back(static_cast<char>(kTypeValue));
+  } else {
+    b->rep_.push_back(static_cast<char>(kTypeColumnFamilyValue));
+    PutVarint32(&b->rep_, column_family_id);
+  }
+  PutLengthPrefixedSlice(&b->rep_, key);
+  PutVarint32(&b->rep_, static_cast<uint32_t>(value.size()));
+  if (b->value_refs_ == nullptr) {
+    b->value_refs_.reset(new ValueReferences());
+  }
+  b->value_refs_->refs.push_back({entry_offset, b->rep_.size(), value});
+  b->value_refs_->value_bytes += value.size();
+  b->content_flags_.store(
+      b->content_flags_.load(std::memory_order_relaxed) | ContentFlags::HAS_PUT,
+      std::memory_order_relaxed);
+  return save.commit();
+}
+
+Status WriteBatch::PutByReference(ColumnFamilyHandle* column_family,
+                                  const Slice& key, const Slice& value) {
+  return WriteBatchInternal::PutByReference(
+      this, GetColumnFamilyID(column_family), key, value);
+}
+
 Status WriteBatchInternal::CheckSlicePartsLength(const SliceParts& key,
                                                  const SliceParts& value) {
   size_t total_key_bytes = 0;
@@ -1012,8 +1332,12 @@ Status WriteBatch::RollbackToSavePoint() {
     Clear();
   } else {
     rep_.resize(savepoint.size);
+    WriteBatchInternal::TruncateValueReferences(this, savepoint.size);
     WriteBatchInternal::SetCount(this, savepoint.count);
     content_flags_.store(savepoint.content_flags, std::memory_order_relaxed);
+    if (prot_info_ != nullptr) {
+      prot_info_->entry_checksums.resize(savepoint.count);
+    }
   }
 
   return Status::OK();
@@ -1040,6 +1364,7 @@ class MemTableInserter : public WriteBatch::Handler {
   // log number that all Memtables inserted into should reference
   uint64_t log_number_ref_;
   DBImpl* db_;
+  HotKeyCache* const hot_key_cache_;
   const bool concurrent_memtable_writes_;
   bool       post_info_created_;
 
@@ -1067,6 +1392,9 @@ class MemTableInserter : public WriteBatch::Handler {
   using DupDetector = std::aligned_storage<sizeof(DuplicateDetector)>::type;
   DupDetector       duplicate_detector_;
   bool              dup_dectector_on_;
+  // The verified checksum of the entry being inserted, if the batch is
+  // protected
+  const uint32_t* entry_checksum_;
 
   MemPostInfoMap& GetPostMap() {
     assert(concurrent_memtable_writes_);
@@ -1110,6 +1438,7 @@ class MemTableInserter : public WriteBatch::Handler {
         recovering_log_number_(recovering_log_number),
         log_number_ref_(0),
         db_(reinterpret_cast<DBImpl*>(db)),
+        hot_key_cache_(db_ != nullptr ? db_->hot_key_cache() : nullptr),
         concurrent_memtable_writes_(concurrent_memtable_writes),
         post_info_created_(false),
         has_valid_writes_(has_valid_writes),
@@ -1125,7 +1454,8 @@ class MemTableInserter : public WriteBatch::Handler {
         write_before_prepare_(!batch_per_txn),
         unprepared_batch_(false),
         duplicate_detector_(),
-        dup_dectector_on_(false) {
+        dup_dectector_on_(false),
+        entry_checksum_(nullptr) {
     assert(cf_mems_);
   }
 
@@ -1164,6 +1494,9 @@ class MemTableInserter : public WriteBatch::Handler {
 
   SequenceNumber sequence() const { return sequence_; }
 
+  // Where WriteBatchInternal::Iterate() stores the checksum of each entry
+  const uint32_t** entry_checksum() { return &entry_checksum_; }
+
   void PostProcess() {
     assert(concurrent_memtable_writes_);
     // If post info was not created there is nothing
@@ -1215,6 +1548,13 @@ class MemTableInserter : public WriteBatch::Handler {
     return true;
   }
 
+  // Invalidates the cached value of key before the write becomes visible
+  void InvalidateHotKey(uint32_t column_family_id, const Slice& key) {
+    if (hot_key_cache_ != nullptr) {
+      hot_key_cache_->Invalidate(column_family_id, key, sequence_);
+    }
+  }
+
   Status PutCFImpl(uint32_t column_family_id, const Slice& key,
                    const Slice& value, ValueType value_type) {
     // optimize for non-recovery mode
@@ -1238,6 +1578,7 @@ class MemTableInserter : public WriteBatch::Handler {
       return seek_status;
     }
     Status ret_status;
+    InvalidateHotKey(column_family_id, key);
 
     MemTable* mem = cf_mems_->GetMemTable();
     auto* moptions = mem->GetImmutableMemTableOptions();
@@ -1245,9 +1586,9 @@ class MemTableInserter : public WriteBatch::Handler {
     // any kind of transactions including the ones that use seq_per_batch
     assert(!seq_per_batch_ || !moptions->inplace_update_support);
     if (!moptions->inplace_update_support) {
-      bool mem_res =
-          mem->Add(sequence_, value_type, key, value,
-                   concurrent_memtable_writes_, get_post_process_info(mem));
+      bool mem_res = mem->Add(sequence_, value_type, key, value,
+                              concurrent_memtable_writes_,
+                              get_post_process_info(mem), entry_checksum_);
       if (UNLIKELY(!mem_res)) {
         assert(seq_per_batch_);
         ret_status = Status::TryAgain("key+seq exists");
@@ -1324,13 +1665,21 @@ class MemTableInserter : public WriteBatch::Handler {
     return PutCFImpl(column_family_id, key, value, kTypeValue);
   }
 
-  Status DeleteImpl(uint32_t /*column_family_id*/, const Slice& key,
+  Status DeleteImpl(uint32_t column_family_id, const Slice& key,
                     const Slice& value, ValueType delete_type) {
     Status ret_status;
+    if (delete_type == kTypeRangeDeletion) {
+      if (hot_key_cache_ != nullptr) {
+        hot_key_cache_->InvalidateAll(sequence_);
+      }
+    } else {
+      InvalidateHotKey(column_family_id, key);
+    }
     MemTable* mem = cf_mems_->GetMemTable();
     bool mem_res =
         mem->Add(sequence_, delete_type, key, value,
-                 concurrent_memtable_writes_, get_post_process_info(mem));
+                 concurrent_memtable_writes_, get_post_process_info(mem),
+                 entry_checksum_);
     if (UNLIKELY(!mem_res)) {
       assert(seq_per_batch_);
       ret_status = Status::TryAgain("key+seq exists");
@@ -1492,6 +1841,7 @@ class MemTableInserter : public WriteBatch::Handler {
     }
 
     Status ret_status;
+    InvalidateHotKey(column_family_id, key);
     MemTable* mem = cf_mems_->GetMemTable();
     auto* moptions = mem->GetImmutableMemTableOptions();
     bool perform_merge = false;
@@ -1559,7 +1909,10 @@ class MemTableInserter : public WriteBatch::Handler {
 
     if (!perform_merge) {
       // Add merge operator to memtable
-      bool mem_res = mem->Add(sequence_, kTypeMerge, key, value);
+      bool mem_res =
+          mem->Add(sequence_, kTypeMerge, key, value,
+                   false /* allow_concurrent */,
+                   nullptr /* post_process_info */, entry_checksum_);
       if (UNLIKELY(!mem_res)) {
         assert(seq_per_batch_);
         ret_status = Status::TryAgain("key+seq exists");
@@ -1772,7 +2125,8 @@ Status WriteBatchInternal::InsertInto(
     }
     SetSequence(w->batch, inserter.sequence());
     inserter.set_log_number_ref(w->log_ref);
-    w->status = w->batch->Iterate(&inserter);
+    w->status = WriteBatchInternal::Iterate(w->batch, &inserter,
+                                            inserter.entry_checksum());
     if (!w->status.ok()) {
       return w->status;
     }
@@ -1798,7 +2152,8 @@ Status WriteBatchInternal::InsertInto(
       seq_per_batch, batch_per_txn);
   SetSequence(writer->batch, sequence);
   inserter.set_log_number_ref(writer->log_ref);
-  Status s = writer->batch->Iterate(&inserter);
+  Status s = WriteBatchInternal::Iterate(writer->batch, &inserter,
+                                         inserter.entry_checksum());
   assert(!seq_per_batch || batch_cnt != 0);
   assert(!seq_per_batch || inserter.sequence() - sequence == batch_cnt);
   if (concurrent_memtable_writes) {
@@ -1817,7 +2172,8 @@ Status WriteBatchInternal::InsertInto(
                             ignore_missing_column_families, log_number, db,
                             concurrent_memtable_writes, has_valid_writes,
                             seq_per_batch, batch_per_txn);
-  Status s = batch->Iterate(&inserter);
+  Status s =
+      WriteBatchInternal::Iterate(batch, &inserter, inserter.entry_checksum());
   if (next_seq != nullptr) {
     *next_seq = inserter.sequence();
   }
@@ -1831,11 +2187,51 @@ Status WriteBatchInternal::SetContents(WriteBatch* b, const Slice& contents) {
   assert(contents.size() >= WriteBatchInternal::kHeader);
   b->rep_.assign(contents.data(), contents.size());
   b->content_flags_.store(ContentFlags::DEFERRED, std::memory_order_relaxed);
+  b->value_refs_.reset();
+  if (b->prot_info_ != nullptr) {
+    b->prot_info_->entry_checksums.clear();
+    return ProtectEntries(b, WriteBatchInternal::kHeader);
+  }
   return Status::OK();
 }
 
+Status WriteBatchInternal::CheckContents(const WriteBatch* b) {
+  BatchContentClassifier classifier;
+  Status s = b->Iterate(&classifier);
+  if (s.ok()) {
+    b->content_flags_.store(classifier.content_flags,
+                            std::memory_order_relaxed);
+  }
+  return s;
+}
+
 Status WriteBatchInternal::Append(WriteBatch* dst, const WriteBatch* src,
                                   const bool wal_only) {
+  const size_t offset = dst->rep_.size();
+  const int count = Count(dst);
+  std::vector<Slice> entries;
+  AppendByReference(dst, src, &entries, wal_only);
+  for (const auto& part : entries) {
+    dst->rep_.append(part.data(), part.size());
+  }
+  if (dst->prot_info_ != nullptr) {
+    if (src->prot_info_ == nullptr) {
+      return ProtectEntries(dst, offset);
+    }
+    const auto& src_checksums = src->prot_info_->entry_checksums;
+    assert(src_checksums.size() >=
+           static_cast<size_t>(Count(dst) - count));
+    dst->prot_info_->entry_checksums.insert(
+        dst->prot_info_->entry_checksums.end(), src_checksums.begin(),
+        src_checksums.begin() + (Count(dst) - count));
+  }
+  return Status::OK();
+}
+
+void WriteBatchInternal::AppendByReference(WriteBatch* dst,
+                                           const WriteBatch* src,
+                                           std::vector<Slice>* entries,
+                                           const bool wal_only) {
   size_t src_len;
   int src_count;
   uint32_t src_flags;
@@ -1854,11 +2250,45 @@ Status WriteBatchInternal::Append(WriteBatch* dst, const WriteBatch* src,
 
   SetCount(dst, Count(dst) + src_count);
   assert(src->rep_.size() >= WriteBatchInternal::kHeader);
-  dst->rep_.append(src->rep_.data() + WriteBatchInternal::kHeader, src_len);
   dst->content_flags_.store(
       dst->content_flags_.load(std::memory_order_relaxed) | src_flags,
       std::memory_order_relaxed);
-  return Status::OK();
+  AppendContentParts(src, WriteBatchInternal::kHeader,
+                     WriteBatchInternal::kHeader + src_len, entries);
+}
+
+void WriteBatchInternal::TruncateValueReferences(WriteBatch* b,
+                                                 size_t offset) {
+  if (b->value_refs_ == nullptr) {
+    return;
+  }
+  auto& refs = b->value_refs_->refs;
+  while (!refs.empty() && refs.back().entry_offset >= offset) {
+    b->value_refs_->value_bytes -= refs.back().value.size();
+    refs.pop_back();
+  }
+}
+
+void WriteBatchInternal::AppendContentParts(const WriteBatch* b, size_t begin,
+                                            size_t end,
+                                            std::vector<Slice>* parts) {
+  assert(begin <= end && end <= b->rep_.size());
+  if (b->value_refs_ != nullptr) {
+    for (const auto& ref : b->value_refs_->refs) {
+      if (ref.entry_offset < begin) {
+        continue;
+      }
+      if (ref.value_offset > end) {
+        break;
+      }
+      parts->emplace_back(b->rep_.data() + begin, ref.value_offset - begin);
+      parts->push_back(ref.value);
+      begin = ref.value_offset;
+    }
+  }
+  if (begin < end) {
+    parts->emplace_back(b->rep_.data() + begin, end - begin);
+  }
 }
 
 size_t WriteBatchInternal::AppendedByteSize(size_t leftByteSize,
@@ -9,6 +9,7 @@
 
 #pragma once
 #include <vector>
+#include "db/dbformat.h"
 #include "db/write_thread.h"
 #include "rocksdb/types.h"
 #include "rocksdb/write_batch.h"
@@ -59,6 +60,32 @@ class ColumnFamilyMemTablesDefault : public ColumnFamilyMemTables {
   MemTable* mem_;
 };
 
+// Checksums of the entries of a WriteBatch created with a non-zero
+// protection_bytes_per_key: a crc32c of each counted entry (Put, Delete,
+// SingleDelete, DeleteRange, Merge and PutBlobIndex) as it is encoded in
+// rep_, in the order of the entries.
+struct ProtectionInfo {
+  std::vector<uint32_t> entry_checksums;
+};
+
+// The values of a WriteBatch that were added with PutByReference(). Their
+// bytes are not copied into rep_: each one belongs right after the length of
+// the value that ends the entry of its Put in rep_.
+struct ValueReferences {
+  struct Reference {
+    // Offset in rep_ of the entry of the Put
+    size_t entry_offset;
+    // Offset in rep_ where the bytes of the value belong, i.e. the end of
+    // the entry
+    size_t value_offset;
+    Slice value;
+  };
+  // In the order of the entries
+  std::vector<Reference> refs;
+  // Sum of the sizes of the referenced values
+  size_t value_bytes = 0;
+};
+
 // WriteBatchInternal provides static methods for manipulating a
 // WriteBatch that we don't want in the public WriteBatch interface.
 class WriteBatchInternal {
@@ -102,6 +129,9 @@ class WriteBatchInternal {
   static Status PutBlobIndex(WriteBatch* batch, uint32_t column_family_id,
                              const Slice& key, const Slice& value);
 
+  static Status PutByReference(WriteBatch* batch, uint32_t column_family_id,
+                               const Slice& key, const Slice& value);
+
   static Status MarkEndPrepare(WriteBatch* batch, const Slice& xid,
                                const bool write_after_commit = true,
                                const bool unprepared_batch = false);
@@ -133,12 +163,63 @@ class WriteBatchInternal {
     return Slice(batch->rep_);
   }
 
+  // The size of the encoded batch, including the values it only references
   static size_t ByteSize(const WriteBatch* batch) {
-    return batch->rep_.size();
+    return batch->rep_.size() + (batch->value_refs_ != nullptr
+                                     ? batch->value_refs_->value_bytes
+                                     : 0);
   }
 
+  static bool HasValueReferences(const WriteBatch* batch) {
+    return batch->value_refs_ != nullptr && !batch->value_refs_->refs.empty();
+  }
+
+  // Drops the references to the values of the entries at or after offset in
+  // rep_, after the batch was truncated to offset.
+  static void TruncateValueReferences(WriteBatch* batch, size_t offset);
+
+  // Appends to parts the bytes of the encoded batch that are at [begin, end)
+  // in rep_, with the referenced values of the entries in the range in
+  // place. The slices point into batch and into the referenced values.
+  static void AppendContentParts(const WriteBatch* batch, size_t begin,
+                                 size_t end, std::vector<Slice>* parts);
+
   static Status SetContents(WriteBatch* batch, const Slice& contents);
 
+  // Decodes every record of the batch, remembering which kinds of records it
+  // holds for the Has*() methods. Returns Corruption if the batch cannot be
+  // fully decoded.
+  static Status CheckContents(const WriteBatch* batch);
+
+  static bool HasProtectionInfo(const WriteBatch* batch) {
+    return batch->prot_info_ != nullptr;
+  }
+
+  // Appends the checksum of the entry starting at offset, which must be the
+  // last one in the batch, to the protection info of the batch.
+  static void ProtectLastEntry(WriteBatch* batch, size_t offset);
+
+  // Appends the checksums of all entries starting at offset to the protection
+  // info of the batch.
+  static Status ProtectEntries(WriteBatch* batch, size_t offset);
+
+  // Returns Corruption if an entry of a protected batch does not match its
+  // checksum.
+  static Status VerifyChecksums(const WriteBatch* batch);
+
+  // Returns the checksum that an entry of the given type, column family, key
+  // and value has in a protected batch. For a DeleteRange, key and value are
+  // the begin and end keys.
+  static uint32_t EntryChecksum(ValueType type, uint32_t column_family_id,
+                                const Slice& key, const Slice& value);
+
+  // Like WriteBatch::Iterate(). If entry_checksum is not nullptr and the
+  // batch is protected, each entry is first checked against its checksum,
+  // and *entry_checksum points to that checksum while the handler processes
+  // the entry, or is nullptr if the entry has none.
+  static Status Iterate(const WriteBatch* batch, WriteBatch::Handler* handler,
+                        const uint32_t** entry_checksum);
+
   static Status CheckSlicePartsLength(const SliceParts& key,
                                       const SliceParts& value);
 
@@ -188,6 +269,14 @@ class WriteBatchInternal {
   static Status Append(WriteBatch* dst, const WriteBatch* src,
                        const bool WAL_only = false);
 
+  // Like Append(), but only adds the count and the content flags of src to
+  // dst, and appends the entries of src that Append() would copy to the end
+  // of dst to entries instead. The slices point into src and into the values
+  // it references.
+  static void AppendByReference(WriteBatch* dst, const WriteBatch* src,
+                                std::vector<Slice>* entries,
+                                const bool WAL_only = false);
+
   // Returns the byte size of appending a WriteBatch with ByteSize
   // leftByteSize and a WriteBatch with ByteSize rightByteSize
   static size_t AppendedByteSize(size_t leftByteSize, size_t rightByteSize);
@@ -219,13 +308,19 @@ class LocalSavePoint {
 #ifndef NDEBUG
     committed_ = true;
 #endif
-    if (batch_->max_bytes_ && batch_->rep_.size() > batch_->max_bytes_) {
+    if (batch_->max_bytes_ &&
+        WriteBatchInternal::ByteSize(batch_) > batch_->max_bytes_) {
       batch_->rep_.resize(savepoint_.size);
+      WriteBatchInternal::TruncateValueReferences(batch_, savepoint_.size);
       WriteBatchInternal::SetCount(batch_, savepoint_.count);
       batch_->content_flags_.store(savepoint_.content_flags,
                                    std::memory_order_relaxed);
       return Status::MemoryLimit();
     }
+    if (batch_->prot_info_ != nullptr &&
+        WriteBatchInternal::Count(batch_) > savepoint_.count) {
+      WriteBatchInternal::ProtectLastEntry(batch_, savepoint_.size);
+    }
     return Status::OK();
   }
 
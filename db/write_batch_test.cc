@@ -878,6 +878,115 @@ TEST_F(WriteBatchTest, SavePointTest) {
   ASSERT_EQ("Delete(A)@0", PrintContents(&batch3));
 }
 
+TEST_F(WriteBatchTest, ProtectionInfo) {
+  WriteBatch batch(0, 0, 4);
+  ASSERT_OK(batch.Put("foo", "bar"));
+  ASSERT_OK(batch.Delete("box"));
+  ASSERT_OK(batch.SingleDelete("baz"));
+  ASSERT_OK(batch.DeleteRange("bar", "foo"));
+  ASSERT_OK(batch.PutLogData("blob"));
+  batch.SetSavePoint();
+  ASSERT_OK(batch.Merge("omom", "nom"));
+  ASSERT_OK(batch.RollbackToSavePoint());
+  ASSERT_OK(batch.Merge("omom", "nom"));
+  ASSERT_OK(WriteBatchInternal::VerifyChecksums(&batch));
+
+  // Unprotected entries appended to a protected batch get protected.
+  WriteBatch unprotected;
+  ASSERT_OK(unprotected.Put("zoo", "zar"));
+  ASSERT_OK(WriteBatchInternal::Append(&batch, &unprotected));
+  ASSERT_EQ(6, batch.Count());
+  ASSERT_OK(WriteBatchInternal::VerifyChecksums(&batch));
+
+  WriteBatch copy(batch);
+  ASSERT_OK(WriteBatchInternal::VerifyChecksums(&copy));
+  ASSERT_EQ(
+      "SingleDelete(baz)@2"
+      "Delete(box)@1"
+      "Put(foo, bar)@0"
+      "Merge(omom, nom)@4"
+      "Put(zoo, zar)@5"
+      "DeleteRange(bar, foo)@3",
+      PrintContents(&copy));
+
+  // Flip a bit of a value behind the back of the batch.
+  char* rep = const_cast<char*>(WriteBatchInternal::Contents(&batch).data());
+  size_t pos = WriteBatchInternal::Contents(&batch).ToString().find("zar");
+  ASSERT_NE(std::string::npos, pos);
+  rep[pos] ^= 0x01;
+  ASSERT_TRUE(WriteBatchInternal::VerifyChecksums(&batch).IsCorruption());
+  ASSERT_NE(std::string::npos, PrintContents(&batch).find("Corruption"));
+
+  batch.Clear();
+  ASSERT_OK(batch.Put("foo", "bar"));
+  ASSERT_OK(WriteBatchInternal::VerifyChecksums(&batch));
+}
+
+TEST_F(WriteBatchTest, PutByReference) {
+  std::string value(1000, 'v');
+  WriteBatch batch;
+  ColumnFamilyHandleImplDummy two(2);
+  ASSERT_OK(batch.Put("foo", "bar"));
+  ASSERT_OK(batch.PutByReference("baz", value));
+  ASSERT_OK(batch.PutByReference(&two, "box", "referenced"));
+  ASSERT_OK(batch.Delete("foo"));
+  ASSERT_EQ(4, batch.Count());
+  // The values are left out of the batch
+  ASSERT_TRUE(WriteBatchInternal::HasValueReferences(&batch));
+  ASSERT_LT(batch.GetDataSize(), value.size());
+  ASSERT_EQ(batch.GetDataSize() + value.size() + 10,
+            WriteBatchInternal::ByteSize(&batch));
+
+  TestHandler handler;
+  ASSERT_OK(batch.Iterate(&handler));
+  ASSERT_EQ("Put(foo, bar)Put(baz, " + value +
+                ")PutCF(2, box, referenced)Delete(foo)",
+            handler.seen);
+
+  // Appending to another batch copies the values, and the parts of the
+  // encoded batch, which are written to the WAL, are the same bytes.
+  WriteBatch copy;
+  ASSERT_OK(WriteBatchInternal::Append(&copy, &batch));
+  ASSERT_FALSE(WriteBatchInternal::HasValueReferences(&copy));
+  std::vector<Slice> parts;
+  WriteBatchInternal::AppendContentParts(
+      &batch, 0, WriteBatchInternal::Contents(&batch).size(), &parts);
+  ASSERT_EQ(5U, parts.size());
+  std::string contents;
+  for (const auto& part : parts) {
+    contents.append(part.data(), part.size());
+  }
+  ASSERT_EQ(copy.Data(), contents);
+
+  // Rolling back drops the references after the save point
+  batch.SetSavePoint();
+  ASSERT_OK(batch.PutByReference("zoo", value));
+  ASSERT_EQ(5, batch.Count());
+  ASSERT_OK(batch.RollbackToSavePoint());
+  ASSERT_EQ(WriteBatchInternal::ByteSize(&copy),
+            WriteBatchInternal::ByteSize(&batch));
+
+  // The referenced values count against max_bytes
+  WriteBatch limited(0, 100);
+  ASSERT_OK(limited.Put("foo", "bar"));
+  ASSERT_TRUE(limited.PutByReference("baz", value).IsMemoryLimit());
+  ASSERT_FALSE(WriteBatchInternal::HasValueReferences(&limited));
+  ASSERT_EQ(1, limited.Count());
+
+  // The checksum of an entry covers its referenced value
+  WriteBatch protected_batch(0, 0, 4);
+  ASSERT_OK(protected_batch.PutByReference("baz", value));
+  ASSERT_OK(protected_batch.Put("foo", "bar"));
+  ASSERT_OK(WriteBatchInternal::VerifyChecksums(&protected_batch));
+  value[0] = 'x';
+  ASSERT_TRUE(
+      WriteBatchInternal::VerifyChecksums(&protected_batch).IsCorruption());
+
+  batch.Clear();
+  ASSERT_FALSE(WriteBatchInternal::HasValueReferences(&batch));
+  ASSERT_EQ(batch.GetDataSize(), WriteBatchInternal::ByteSize(&batch));
+}
+
 TEST_F(WriteBatchTest, MemoryLimitTest) {
   Status s;
   // The header size is 12 bytes. The two Puts take 8 bytes which gives total
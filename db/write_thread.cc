@@ -680,6 +680,21 @@ void WriteThread::EnterUnbatched(Writer* w, InstrumentedMutex* mu) {
   mu->Lock();
 }
 
+bool WriteThread::TryEnterUnbatched(Writer* w, InstrumentedMutex* mu) {
+  assert(w != nullptr && w->batch == nullptr);
+  w->link_older = nullptr;
+  Writer* newest_writer = nullptr;
+  if (!newest_writer_.compare_exchange_strong(newest_writer, w)) {
+    return false;
+  }
+  if (enable_pipelined_write_) {
+    mu->Unlock();
+    WaitForMemTableWriters();
+    mu->Lock();
+  }
+  return true;
+}
+
 void WriteThread::ExitUnbatched(Writer* w) {
   assert(w != nullptr);
   Writer* newest_writer = w;
@@ -128,7 +128,8 @@ class WriteThread {
     WriteGroup* write_group;
     SequenceNumber sequence;  // the sequence number to use for the first key
     Status status;            // status of memtable inserter
-    Status callback_status;   // status returned by callback->Callback()
+    Status callback_status;   // status returned by callback->Callback(),
+                              // or of the checksums of a protected batch
 
     std::aligned_storage<sizeof(std::mutex)>::type state_mutex_bytes;
     std::aligned_storage<sizeof(std::condition_variable)>::type state_cv_bytes;
@@ -203,13 +204,11 @@ class WriteThread {
     Status FinalStatus() {
       if (!status.ok()) {
         // a non-ok memtable write status takes presidence
-        assert(callback == nullptr || callback_status.ok());
         return status;
       } else if (!callback_status.ok()) {
-        // if the callback failed then that is the status we want
-        // because a memtable insert should not have been attempted
-        assert(callback != nullptr);
-        assert(status.ok());
+        // if the callback failed, or the batch did not match its checksums,
+        // then that is the status we want because a memtable insert should
+        // not have been attempted
         return callback_status;
       } else {
         // if there is no callback then we only care about
@@ -219,9 +218,7 @@ class WriteThread {
       }
     }
 
-    bool CallbackFailed() {
-      return (callback != nullptr) && !callback_status.ok();
-    }
+    bool CallbackFailed() { return !callback_status.ok(); }
 
     bool ShouldWriteToMemtable() {
       return status.ok() && !CallbackFailed() && !disable_memtable;
@@ -327,6 +324,15 @@ class WriteThread {
   // REQUIRES: db mutex held
   void EnterUnbatched(Writer* w, InstrumentedMutex* mu);
 
+  // Like EnterUnbatched, but only registers w if there are no other writers,
+  // and returns false otherwise. Never waits for other writers to exit, but
+  // still waits for pending memtable writers if pipelined write is enabled.
+  //
+  // Writer* w:              A Writer not eligible for batching
+  // InstrumentedMutex* mu:  The db mutex, to unlock while waiting
+  // REQUIRES: db mutex held
+  bool TryEnterUnbatched(Writer* w, InstrumentedMutex* mu);
+
   // Completes a Writer begun with EnterUnbatched, unblocking subsequent
   // writers.
   void ExitUnbatched(Writer* w);
@@ -811,6 +811,46 @@ class IoctlFriendlyTmpdir {
 };
 
 #ifndef ROCKSDB_LITE
+TEST_F(EnvPosixTest, MultiRead) {
+  EnvOptions soptions;
+  std::string fname = test::PerThreadDBPath(env_, "testfile");
+  const size_t kFileSize = 64 * 1024;
+  std::string data;
+  Random rnd(301);
+  test::RandomString(&rnd, static_cast<int>(kFileSize), &data);
+  {
+    unique_ptr<WritableFile> wfile;
+    ASSERT_OK(env_->NewWritableFile(fname, &wfile, soptions));
+    ASSERT_OK(wfile->Append(data));
+    ASSERT_OK(wfile->Close());
+  }
+
+  unique_ptr<RandomAccessFile> file;
+  ASSERT_OK(env_->NewRandomAccessFile(fname, &file, soptions));
+  // More reads than fit in one submission, the last one past the end of the
+  // file
+  const size_t kNumReads = 100;
+  std::vector<ReadRequest> reqs(kNumReads);
+  std::vector<std::unique_ptr<char[]>> scratches;
+  for (size_t i = 0; i < kNumReads; ++i) {
+    reqs[i].offset = (i * 7919) % kFileSize;
+    reqs[i].len = 100 + i;
+    scratches.emplace_back(new char[reqs[i].len]);
+    reqs[i].scratch = scratches.back().get();
+  }
+  reqs[kNumReads - 1].offset = kFileSize - 10;
+  ASSERT_OK(file->MultiRead(reqs.data(), reqs.size()));
+  for (size_t i = 0; i < kNumReads; ++i) {
+    ASSERT_OK(reqs[i].status);
+    size_t expected_len = std::min(
+        reqs[i].len, kFileSize - static_cast<size_t>(reqs[i].offset));
+    ASSERT_EQ(Slice(data.data() + reqs[i].offset, expected_len),
+              reqs[i].result);
+  }
+  ASSERT_EQ(10, reqs[kNumReads - 1].result.size());
+  ASSERT_OK(env_->DeleteFile(fname));
+}
+
 TEST_F(EnvPosixTest, PositionedAppend) {
   unique_ptr<WritableFile> writable_file;
   EnvOptions options;
@@ -27,6 +27,11 @@
 #include <sys/syscall.h>
 #include <sys/sysmacros.h>
 #endif
+#ifdef ROCKSDB_IOURING_PRESENT
+#include <linux/io_uring.h>
+#include <sys/uio.h>
+#include <vector>
+#endif
 #include "env/posix_logger.h"
 #include "monitoring/iostats_context_imp.h"
 #include "port/port.h"
@@ -356,6 +361,203 @@ Status PosixRandomAccessFile::Read(uint64_t offset, size_t n, Slice* result,
   return s;
 }
 
+#ifdef ROCKSDB_IOURING_PRESENT
+namespace {
+// A minimal io_uring, set up through the system calls directly, used to
+// submit the reads of PosixRandomAccessFile::MultiRead() together. Every
+// thread has its own ring, so that no locking is needed.
+class IOUring {
+ public:
+  // Returns the ring of the calling thread, or nullptr if io_uring is not
+  // usable.
+  static IOUring* ForThisThread() {
+    static thread_local IOUring ring;
+    return ring.fd_ >= 0 ? &ring : nullptr;
+  }
+
+  // Reads the requests into their scratch buffers, and sets (*results)[i] to
+  // what pread() would have returned for reqs[i], or to -errno. Returns the
+  // number of requests read, starting from the first. Stops using the ring
+  // after it fails; the remaining requests are left to the caller.
+  size_t Read(int fd, ReadRequest* reqs, size_t num_reqs,
+              std::vector<ssize_t>* results) {
+    std::vector<struct iovec> iovs(num_reqs);
+    size_t num_read = 0;
+    while (num_read < num_reqs && fd_ >= 0) {
+      unsigned n = static_cast<unsigned>(
+          std::min(num_reqs - num_read, static_cast<size_t>(sq_entries_)));
+      unsigned tail = *sq_tail_;
+      for (unsigned j = 0; j < n; ++j) {
+        size_t i = num_read + j;
+        iovs[i].iov_base = reqs[i].scratch;
+        iovs[i].iov_len = reqs[i].len;
+        unsigned index = (tail + j) & sq_mask_;
+        struct io_uring_sqe* sqe = &sqes_[index];
+        memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = IORING_OP_READV;
+        sqe->fd = fd;
+        sqe->off = reqs[i].offset;
+        sqe->addr = reinterpret_cast<uint64_t>(&iovs[i]);
+        sqe->len = 1;
+        sqe->user_data = i;
+        sq_array_[index] = index;
+      }
+      __atomic_store_n(sq_tail_, tail + n, __ATOMIC_RELEASE);
+
+      unsigned submitted = 0;
+      while (submitted < n) {
+        long ret = syscall(__NR_io_uring_enter, fd_, n - submitted, 0, 0,
+                           nullptr, 0);
+        if (ret < 0) {
+          if (errno == EINTR || errno == EAGAIN) {
+            continue;
+          }
+          // Take back what the kernel did not consume, and give up on the
+          // ring once the submitted reads are done.
+          __atomic_store_n(sq_tail_, tail + submitted, __ATOMIC_RELEASE);
+          break;
+        }
+        submitted += static_cast<unsigned>(ret);
+      }
+
+      unsigned completed = 0;
+      while (completed < submitted) {
+        unsigned head = *cq_head_;
+        if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+          syscall(__NR_io_uring_enter, fd_, 0, 1, IORING_ENTER_GETEVENTS,
+                  nullptr, 0);
+          continue;
+        }
+        struct io_uring_cqe* cqe = &cqes_[head & cq_mask_];
+        (*results)[static_cast<size_t>(cqe->user_data)] = cqe->res;
+        __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+        ++completed;
+      }
+      num_read += submitted;
+      if (submitted < n) {
+        Close();
+      }
+    }
+    return num_read;
+  }
+
+ private:
+  IOUring() : fd_(-1) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int fd = static_cast<int>(
+        syscall(__NR_io_uring_setup, kEntries, &params));
+    if (fd < 0) {
+      return;
+    }
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ =
+        params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+    sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    cq_ring_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    void* sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    fd_ = fd;
+    if (sq_ring_ == MAP_FAILED || cq_ring_ == MAP_FAILED ||
+        sqes == MAP_FAILED) {
+      sqes_ = sqes == MAP_FAILED ? nullptr
+                                 : static_cast<struct io_uring_sqe*>(sqes);
+      Close();
+      return;
+    }
+    char* sq = static_cast<char*>(sq_ring_);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    sq_entries_ = params.sq_entries;
+    sqes_ = static_cast<struct io_uring_sqe*>(sqes);
+    char* cq = static_cast<char*>(cq_ring_);
+    cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+  }
+
+  ~IOUring() { Close(); }
+
+  void Close() {
+    if (fd_ < 0) {
+      return;
+    }
+    if (sq_ring_ != MAP_FAILED) {
+      munmap(sq_ring_, sq_ring_size_);
+    }
+    if (cq_ring_ != MAP_FAILED) {
+      munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sqes_ != nullptr) {
+      munmap(sqes_, sqes_size_);
+    }
+    close(fd_);
+    fd_ = -1;
+  }
+
+  static const unsigned kEntries = 64;
+
+  int fd_;
+  void* sq_ring_ = MAP_FAILED;
+  size_t sq_ring_size_ = 0;
+  unsigned* sq_tail_ = nullptr;
+  unsigned sq_mask_ = 0;
+  unsigned* sq_array_ = nullptr;
+  unsigned sq_entries_ = 0;
+  struct io_uring_sqe* sqes_ = nullptr;
+  size_t sqes_size_ = 0;
+  void* cq_ring_ = MAP_FAILED;
+  size_t cq_ring_size_ = 0;
+  unsigned* cq_head_ = nullptr;
+  unsigned* cq_tail_ = nullptr;
+  unsigned cq_mask_ = 0;
+  struct io_uring_cqe* cqes_ = nullptr;
+};
+}  // namespace
+#endif  // ROCKSDB_IOURING_PRESENT
+
+Status PosixRandomAccessFile::MultiRead(ReadRequest* reqs, size_t num_reqs) {
+  size_t num_read = 0;
+#ifdef ROCKSDB_IOURING_PRESENT
+  IOUring* ring = (num_reqs > 1 && !use_direct_io())
+                      ? IOUring::ForThisThread()
+                      : nullptr;
+  if (ring != nullptr) {
+    std::vector<ssize_t> results(num_reqs);
+    num_read = ring->Read(fd_, reqs, num_reqs, &results);
+    for (size_t i = 0; i < num_read; ++i) {
+      ReadRequest& req = reqs[i];
+      ssize_t r = results[i];
+      if (r < 0) {
+        req.status = IOError("While pread offset " + ToString(req.offset) +
+                                 " len " + ToString(req.len),
+                             filename_, static_cast<int>(-r));
+        req.result = Slice(req.scratch, 0);
+      } else if (r > 0 && static_cast<size_t>(r) < req.len) {
+        // Read the rest like Read() does
+        Slice rest;
+        req.status = Read(req.offset + r, req.len - r, &rest, req.scratch + r);
+        req.result =
+            Slice(req.scratch, req.status.ok() ? r + rest.size() : 0);
+      } else {
+        req.status = Status::OK();
+        req.result = Slice(req.scratch, static_cast<size_t>(r));
+      }
+    }
+  }
+#endif  // ROCKSDB_IOURING_PRESENT
+  for (size_t i = num_read; i < num_reqs; ++i) {
+    ReadRequest& req = reqs[i];
+    req.status = Read(req.offset, req.len, &req.result, req.scratch);
+  }
+  return Status::OK();
+}
+
 Status PosixRandomAccessFile::Prefetch(uint64_t offset, size_t n) {
   Status s;
   if (!use_direct_io()) {
@@ -91,6 +91,10 @@ class PosixRandomAccessFile : public RandomAccessFile {
   virtual Status Read(uint64_t offset, size_t n, Slice* result,
                       char* scratch) const override;
 
+  // With io_uring, the reads are submitted together with one system call
+  // from a ring owned by the calling thread.
+  virtual Status MultiRead(ReadRequest* reqs, size_t num_reqs) override;
+
   virtual Status Prefetch(uint64_t offset, size_t n) override;
 
 #if defined(OS_LINUX) || defined(OS_MACOSX) || defined(OS_AIX)
@@ -126,6 +126,20 @@ struct CompressionOptions {
   // Default: 0.
   uint32_t zstd_max_train_bytes;
 
+  // Number of threads compressing the data blocks of an SST file while it is
+  // built by a flush or compaction. With more than one, full data blocks are
+  // handed to a pool of that many threads, which compress and checksum them,
+  // while the thread building the file keeps cutting blocks and writes them
+  // out in their original order as they complete. The file is the same as
+  // one built with a single thread.
+  //
+  // Only the block-based table supports it, and only with the
+  // kBinarySearch index and without block-based filters. Other
+  // configurations compress on the thread building the file.
+  //
+  // Default: 1.
+  uint32_t parallel_threads;
+
   // When the compression options are set by the user, it will be set to "true".
   // For bottommost_compression_opts, to enable it, user must set enabled=true.
   // Otherwise, bottommost compression will use compression_opts as default
@@ -143,6 +157,7 @@ struct CompressionOptions {
         strategy(0),
         max_dict_bytes(0),
         zstd_max_train_bytes(0),
+        parallel_threads(1),
         enabled(false) {}
   CompressionOptions(int wbits, int _lev, int _strategy, int _max_dict_bytes,
                      int _zstd_max_train_bytes, bool _enabled)
@@ -151,6 +166,7 @@ struct CompressionOptions {
         strategy(_strategy),
         max_dict_bytes(_max_dict_bytes),
         zstd_max_train_bytes(_zstd_max_train_bytes),
+        parallel_threads(1),
         enabled(_enabled) {}
 };
 
@@ -293,6 +309,17 @@ struct AdvancedColumnFamilyOptions {
   // Dynamically changeable through SetOptions() API
   size_t memtable_huge_page_size = 0;
 
+  // If true, the memtable arena keeps separate blocks for every NUMA node,
+  // and each write takes memory from the blocks of the node it runs on, so
+  // entries stay local to the socket that wrote them. Huge pages, if
+  // memtable_huge_page_size is set, are also placed on that node.
+  // This is most useful with allow_concurrent_memtable_write, where writers
+  // on different sockets insert into the memtable at the same time.
+  // Only has an effect if RocksDB is built with NUMA support.
+  //
+  // Default: false
+  bool memtable_numa_aware_allocation = false;
+
   // If non-nullptr, memtable will use the specified function to extract
   // prefixes for keys, and for each prefix maintain a hint of insert location
   // to reduce CPU usage for inserting keys with the prefix. Keys out of
@@ -315,6 +342,33 @@ struct AdvancedColumnFamilyOptions {
   std::shared_ptr<const SliceTransform>
       memtable_insert_with_hint_prefix_extractor = nullptr;
 
+  // If true, every memtable keeps a hash index from each user key to the
+  // newest entry of that key. A point lookup that can see the newest entry
+  // then reads it directly instead of searching the memtable, and a lookup
+  // of a key that is not in the memtable returns without a search. Lookups
+  // through an older snapshot, and lookups whose newest entry is a merge
+  // operand, still search the memtable.
+  //
+  // The index takes 8 bytes per 256 bytes of write_buffer_size, plus about
+  // 16 bytes per distinct key, all charged to the memtable. The option is
+  // ignored when inplace_update_support is set or when the comparator is not
+  // one of the built-in bytewise comparators.
+  //
+  // Default: false
+  bool memtable_point_lookup_index = false;
+
+  // If not 0, every memtable entry keeps a checksum of the key, value, type
+  // and column family it was written with. For an entry written through a
+  // WriteBatch created with protection_bytes_per_key, this is the checksum
+  // the batch already carries, verified as the entry is inserted. The
+  // checksums are verified again before the memtable is flushed, and the
+  // flush fails with Corruption if an entry changed in memory.
+  // Supported values are 0 and 4 (a crc32c per entry). The option is
+  // ignored when inplace_update_support is set.
+  //
+  // Default: 0 (disable)
+  size_t memtable_protection_bytes_per_key = 0;
+
   // Control locality of bloom filter probes to improve cache miss rate.
   // This option only applies to memtable prefix bloom and plaintable
   // prefix bloom. It essentially limits every bloom checking to one cache line.
@@ -577,6 +631,26 @@ struct AdvancedColumnFamilyOptions {
   // Default: false
   bool optimize_filters_for_hits = false;
 
+  // If non-zero, this column family caches table rows in a row cache of its
+  // own with this capacity in bytes, instead of in DBOptions::row_cache.
+  // This lets column families with different read patterns have row caches
+  // sized for them. Besides the values of keys that are found, the row cache
+  // remembers that a key is absent from a table file, so repeated lookups of
+  // such keys skip the file.
+  // Not supported in ROCKSDB_LITE mode!
+  //
+  // Default: 0 (use DBOptions::row_cache)
+  size_t row_cache_size = 0;
+
+  // If true, each version keeps a piecewise linear model of the largest keys
+  // of the files in every level, like BlockBasedTableOptions::learned_index
+  // does for index blocks, so point lookups find the file that may have a
+  // key by checking a few files instead of binary searching the level.
+  // Only used with the bytewise comparator.
+  //
+  // Default: false
+  bool learned_level_index = false;
+
   // After writing every SST file, reopen it and read all the keys.
   // Default: false
   bool paranoid_file_checks = false;
@@ -409,6 +409,26 @@ class DB {
       const std::vector<ColumnFamilyHandle*>& column_families,
       std::vector<Iterator*>* iterators) = 0;
 
+  // Splits the keys of column_family in [*range.start, *range.limit) into up
+  // to num_iterators consecutive parts of about the same size, going by the
+  // SST files that overlap the range, and returns in *iterators one iterator
+  // per part, in key order. The iterators are bounded to their parts and
+  // read the same snapshot of the same files, so they can be used from
+  // different threads to scan the range in parallel. The range is narrowed to
+  // options.iterate_lower_bound and options.iterate_upper_bound where those
+  // are narrower, and a null range.start or range.limit is unbounded. Fewer
+  // iterators are returned if the range does not span enough files; tailing
+  // iterators cannot be split, and Refresh() is not supported on the parts.
+  // Iterators are heap allocated and need to be deleted before the db is
+  // deleted.
+  virtual Status NewParallelIterators(const ReadOptions& /*options*/,
+                                      ColumnFamilyHandle* /*column_family*/,
+                                      const RangePtr& /*range*/,
+                                      size_t /*num_iterators*/,
+                                      std::vector<Iterator*>* /*iterators*/) {
+    return Status::NotSupported("NewParallelIterators() is not implemented.");
+  }
+
   // Return a handle to the current DB state.  Iterators created with
   // this handle will all observe a stable snapshot of the current DB
   // state.  The caller must call ReleaseSnapshot(result) when the
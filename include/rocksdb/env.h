@@ -542,6 +542,20 @@ class SequentialFile {
   }
 };
 
+// A read of RandomAccessFile::MultiRead().
+struct ReadRequest {
+  // File offset in bytes
+  uint64_t offset;
+  // Length to read in bytes
+  size_t len;
+  // A buffer of at least len bytes the data may be read into
+  char* scratch;
+  // Output: the data read, as set by RandomAccessFile::Read()
+  Slice result;
+  // Output: the status of the read
+  Status status;
+};
+
 // A file abstraction for randomly reading the contents of a file.
 class RandomAccessFile {
  public:
@@ -567,6 +581,21 @@ class RandomAccessFile {
     return Status::OK();
   }
 
+  // Reads several ranges of the file, like calling Read() for each of them,
+  // except that an implementation may have all of them in flight at once.
+  // The result and status of every read is stored in its request. Returns a
+  // non-OK status only if the reads could not be issued at all.
+  //
+  // Safe for concurrent use by multiple threads.
+  // If Direct I/O enabled, the requests should be aligned properly.
+  virtual Status MultiRead(ReadRequest* reqs, size_t num_reqs) {
+    for (size_t i = 0; i < num_reqs; ++i) {
+      ReadRequest& req = reqs[i];
+      req.status = Read(req.offset, req.len, &req.result, req.scratch);
+    }
+    return Status::OK();
+  }
+
   // Tries to get an unique ID for this file that will be the same each time
   // the file is opened (and will stay the same while the file is open).
   // Furthermore, it tries to make this ID at most "max_size" bytes. If such an
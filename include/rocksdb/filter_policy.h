@@ -26,6 +26,8 @@
 #include <string>
 #include <vector>
 
+#include "rocksdb/advanced_options.h"
+
 namespace rocksdb {
 
 class Slice;
@@ -71,6 +73,35 @@ class FilterBitsReader {
 
   // Check if the entry match the bits in filter
   virtual bool MayMatch(const Slice& entry) = 0;
+
+  // Check if each of the num_keys entries *keys[i] match the bits in filter,
+  // and store the result in may_match[i]. Readers can override it to overlap
+  // the memory accesses of the probes.
+  virtual void MultiMayMatch(int num_keys, Slice** keys, bool* may_match) {
+    for (int i = 0; i < num_keys; i++) {
+      may_match[i] = MayMatch(*keys[i]);
+    }
+  }
+};
+
+// Describes the table file a full filter is built for, so that a
+// FilterPolicy can size the filter of every file differently.
+struct FilterBuildingContext {
+  // Options::compaction_style of the column family
+  CompactionStyle compaction_style = kCompactionStyleLevel;
+  // Options::num_levels of the column family
+  int num_levels = -1;
+  // The level the file is written to, or -1 if unknown, e.g. for files
+  // built by SstFileWriter
+  int level_at_creation = -1;
+  // Options::max_bytes_for_level_multiplier of the column family
+  double level_size_multiplier = 10;
+  // The level L0 files are compacted to when the file is created, or -1 if
+  // unknown
+  int base_level = -1;
+  // Total size in bytes of the files of every level when the file is
+  // created, or empty if unknown
+  std::vector<uint64_t> level_bytes;
 };
 
 // We add a new format of filter block called full filter block
@@ -119,6 +150,13 @@ class FilterPolicy {
     return nullptr;
   }
 
+  // Like GetFilterBitsBuilder(), but for the file described by context. The
+  // filters built must still be readable by GetFilterBitsReader().
+  virtual FilterBitsBuilder* GetBuilderWithContext(
+      const FilterBuildingContext& /*context*/) const {
+    return GetFilterBitsBuilder();
+  }
+
   // Get the FilterBitsReader, which is ONLY used for full filter block
   // It contains interface to tell if key can be in filter
   // The input slice should NOT be deleted by FilterPolicy
@@ -135,6 +173,12 @@ class FilterPolicy {
 // is 10, which yields a filter with ~ 1% false positive rate.
 // use_block_based_builder: use block based filter rather than full filter.
 // If you want to builder full filter, it needs to be set to false.
+// use_split_block_filter: build full filters that set all bits of a key in a
+// single 32-byte block, which are faster to probe, with AVX2 in particular,
+// but have a somewhat higher false positive rate for the same bits_per_key.
+// Filters in either format can be read whatever this is set to, but older
+// versions of RocksDB ignore split block filters. Ignored when
+// use_block_based_builder is true.
 //
 // Callers must delete the result after any database that is using the
 // result has been closed.
@@ -147,7 +191,39 @@ class FilterPolicy {
 // FilterPolicy (like NewBloomFilterPolicy) that does not ignore
 // trailing spaces in keys.
 extern const FilterPolicy* NewBloomFilterPolicy(int bits_per_key,
-    bool use_block_based_builder = true);
+    bool use_block_based_builder = true, bool use_split_block_filter = false);
+
+// Return a new filter policy that builds xor filters, which are static
+// filters that take about 1.23 * log2(1 / false_positive_rate) bits per key,
+// compared to about 1.44 * log2(1 / false_positive_rate) bits per key for a
+// bloom filter. bits_per_key is rounded to a multiple of 1.23; 10 yields
+// ~0.4% false positives, 7.5 ~1.6%. The filters work as full, partitioned and
+// block based filters, but can only be read with this filter policy.
+//
+// Callers must delete the result after any database that is using the
+// result has been closed. The same restriction on comparators as for
+// NewBloomFilterPolicy() applies.
+extern const FilterPolicy* NewXorFilterPolicy(double bits_per_key);
+
+// Return a new filter policy that builds full bloom filters with
+// approximately bits_per_key bits per key on average over a column family
+// using level compaction, but spends them unevenly across the levels: a
+// level gets ln(S / n) / ln(2)^2 more bits per key than bits_per_key, where
+// n is its size in bytes and S the geometric mean of the sizes of all
+// levels, weighted by size. The large bottom levels get a little less than
+// bits_per_key, and the much smaller upper levels get more. This lowers the
+// sum of the false positive rates over all levels, i.e. the expected I/O of
+// a point lookup of a missing key, for the same filter memory.
+//
+// A file written to a level that has no data yet gets
+// ln(max_bytes_for_level_multiplier) / ln(2)^2 more bits per key for each
+// level it is above the deepest level with data. Files written by other
+// compaction styles or to an unknown level get bits_per_key bits per key.
+// The filters are readable by the filter policy returned by
+// NewBloomFilterPolicy(), so the two can be swapped without rewriting any
+// file.
+extern const FilterPolicy* NewLevelAdaptiveBloomFilterPolicy(
+    double bits_per_key);
 }
 
 #endif  // STORAGE_ROCKSDB_INCLUDE_FILTER_POLICY_H_
@@ -19,6 +19,7 @@
 #ifndef STORAGE_ROCKSDB_INCLUDE_ITERATOR_H_
 #define STORAGE_ROCKSDB_INCLUDE_ITERATOR_H_
 
+#include <functional>
 #include <string>
 #include "rocksdb/cleanable.h"
 #include "rocksdb/slice.h"
@@ -84,6 +85,22 @@ class Iterator : public Cleanable {
   // satisfied without doing some IO, then this returns Status::Incomplete().
   virtual Status status() const = 0;
 
+  // Calls callback on the current entry and the ones after it, moving the
+  // iterator past each entry for which callback returns true. Stops when
+  // max_entries entries have been passed, when their keys and values add up
+  // to max_bytes or more, when the iterator becomes invalid, or when callback
+  // returns false, in which case the iterator stays on that entry. Returns
+  // the number of entries passed; check status() to tell an error apart from
+  // the end of the source.
+  //
+  // The key and value are valid only during the call. The DB iterator runs
+  // the whole loop internally, which saves the virtual calls of Valid(),
+  // key(), value() and Next() on every entry of a long scan.
+  virtual size_t NextBatch(
+      size_t max_entries, size_t max_bytes,
+      const std::function<bool(const Slice& key, const Slice& value)>&
+          callback);
+
   // If supported, renew the iterator to represent the latest state. The
   // iterator will be invalidated after the call. Not supported if
   // ReadOptions.snapshot is given when creating the iterator.
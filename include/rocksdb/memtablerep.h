@@ -45,6 +45,7 @@ namespace rocksdb {
 
 class Arena;
 class Allocator;
+class Comparator;
 class LookupKey;
 class SliceTransform;
 class Logger;
@@ -75,6 +76,10 @@ class MemTableRep {
     virtual int operator()(const char* prefix_len_key,
                            const Slice& key) const = 0;
 
+    // Returns the comparator of the user keys in the internal keys that are
+    // compared, or nullptr if it is not known.
+    virtual const Comparator* user_comparator() const { return nullptr; }
+
     virtual ~KeyComparator() { }
   };
 
@@ -321,6 +326,32 @@ class VectorRepFactory : public MemTableRepFactory {
   }
 };
 
+// This creates MemTableReps that are backed by an adaptive radix tree over
+// the bytes of the keys. Compared to the skip list, a lookup or insertion
+// follows one node per distinct byte of the key instead of comparing whole
+// keys O(log N) times, which makes it faster for short keys that share
+// prefixes. Insertions can be concurrent. Iterators keep the path to their
+// position, so Next() and Prev() take amortized constant time. The leaves
+// are the memtable entries, so the tree keeps no copy of the keys, but its
+// inner nodes still take more memory than the skip list's nodes.
+//
+// Only BytewiseComparator is supported. Memtables of column families with
+// any other comparator, or created with a KeyComparator that does not
+// report its user comparator, fall back to a skip list.
+class ARTRepFactory : public MemTableRepFactory {
+ public:
+  using MemTableRepFactory::CreateMemTableRep;
+  virtual MemTableRep* CreateMemTableRep(const MemTableRep::KeyComparator&,
+                                         Allocator*, const SliceTransform*,
+                                         Logger* logger) override;
+
+  virtual const char* Name() const override { return "ARTRepFactory"; }
+
+  bool IsInsertConcurrentlySupported() const override { return true; }
+
+  bool CanHandleDuplicatedKey() const override { return true; }
+};
+
 // This class contains a fixed array of buckets, each
 // pointing to a skiplist (null if the bucket is empty).
 // bucket_count: number of fixed array buckets
@@ -797,6 +797,30 @@ struct DBOptions {
   // Default: 0
   uint64_t delayed_write_rate = 0;
 
+  // If true, writes are paced before a column family reaches
+  // level0_slowdown_writes_trigger or soft_pending_compaction_bytes_limit.
+  // The number of L0 files and the compaction debt are extrapolated from
+  // how they changed since the last flush or compaction, and once the
+  // prediction is past the point where compactions are sped up, the write
+  // rate is lowered gradually from delayed_write_rate. Crossing the slowdown
+  // thresholds then continues from the paced rate instead of jumping to
+  // delayed_write_rate, and the rate is raised back no faster than it is
+  // after a regular slowdown. Has no effect if auto compactions are disabled.
+  //
+  // Default: false
+  bool enable_write_stall_pacing = false;
+
+  // If true, every column family keeps its own write stall state. When a
+  // column family hits a slowdown or stop condition, only writes to that
+  // column family are delayed or stopped, before they join the write queue,
+  // while writes to other column families keep going. All writes still go
+  // through the same WAL and sequence numbers in the same order.
+  // delayed_write_rate then applies to each column family separately, and
+  // "rocksdb.is-write-stopped" no longer reports stopped column families.
+  //
+  // Default: false
+  bool enable_per_column_family_write_stall = false;
+
   // By default, a single write thread queue is maintained. The thread gets
   // to the head of the queue becomes write batch group leader and responsible
   // for writing to WAL and memtable for the batch group.
@@ -861,6 +885,23 @@ struct DBOptions {
   // Default: kPointInTimeRecovery
   WALRecoveryMode wal_recovery_mode = WALRecoveryMode::kPointInTimeRecovery;
 
+  // If greater than 1, DB::Open() replays the WAL with this many threads
+  // inserting recovered write batches into the memtables, while the opening
+  // thread keeps reading and checksumming the log records. Only takes effect
+  // when allow_concurrent_memtable_write is true and allow_2pc is false;
+  // otherwise the WAL is replayed on the opening thread.
+  // Default: 1
+  int max_wal_recovery_threads = 1;
+
+  // If not kNoCompression, WAL records are compressed with this compression
+  // type before they are written. Records that do not compress well are
+  // stored uncompressed. Reading the WAL, including through
+  // GetUpdatesSince(), decompresses records transparently. WAL files written
+  // with compression cannot be read by older versions of RocksDB.
+  // Not supported together with recycle_log_file_num.
+  // Default: kNoCompression
+  CompressionType wal_compression = kNoCompression;
+
   // if set to false then recovery will fail when a prepared
   // transaction is encountered in the WAL
   bool allow_2pc = false;
@@ -870,6 +911,19 @@ struct DBOptions {
   // Not supported in ROCKSDB_LITE mode!
   std::shared_ptr<Cache> row_cache = nullptr;
 
+  // If not zero, DB::Get() keeps the latest values of recently read keys, up
+  // to this many bytes, in a cache in front of the memtables and SST files.
+  // Reads of these keys then take a single hash lookup. Every write
+  // invalidates the cached value of its key, and range deletions and file
+  // ingestion invalidate the whole cache, so reads return the same results as
+  // without it, including reads at snapshots. A key is cached the second time
+  // it is read within a short while, so keys read once do not evict hot ones.
+  // The cache is not used by column families with a compaction filter or
+  // FIFO compaction, by reads with ignore_range_deletions or a read_tier
+  // other than kReadAllTier, or with WritePrepared transactions.
+  // Default: 0 (disabled)
+  size_t hot_key_cache_size = 0;
+
 #ifndef ROCKSDB_LITE
   // A filter object supplied to be invoked while processing write-ahead-logs
   // (WALs) during recovery. The filter provides a way to inspect log
@@ -323,6 +323,10 @@ enum Tickers : uint32_t {
   // Number of keys actually found in MultiGet calls (vs number requested by caller)
   // NUMBER_MULTIGET_KEYS_READ gives the number requested by caller
   NUMBER_MULTIGET_KEYS_FOUND,
+
+  // DB::Get() hits and misses of DBOptions::hot_key_cache_size
+  HOT_KEY_CACHE_HIT,
+  HOT_KEY_CACHE_MISS,
   TICKER_ENUM_MAX
 };
 
@@ -475,6 +479,8 @@ const std::vector<std::pair<Tickers, std::string>> TickersNameMap = {
     {TXN_DUPLICATE_KEY_OVERHEAD, "rocksdb.txn.overhead.duplicate.key"},
     {TXN_SNAPSHOT_MUTEX_OVERHEAD, "rocksdb.txn.overhead.mutex.snapshot"},
     {NUMBER_MULTIGET_KEYS_FOUND, "rocksdb.number.multiget.keys.found"},
+    {HOT_KEY_CACHE_HIT, "rocksdb.hot.key.cache.hit"},
+    {HOT_KEY_CACHE_MISS, "rocksdb.hot.key.cache.miss"},
 };
 
 /**
@@ -244,6 +244,15 @@ struct BlockBasedTableOptions {
 
   // Align data blocks on lesser of page size and block size
   bool block_align = false;
+
+  // If true, tables with a kBinarySearch index also store a piecewise linear
+  // model of the keys of the index block. It predicts where in the index
+  // block a key is, so that lookups search a few entries around there
+  // instead of binary searching the whole block. This works best for keys
+  // that are spread evenly in bytewise order, like fixed-width sequential
+  // IDs; tables whose keys the model does not fit well are written without
+  // it. Only used with the bytewise comparator.
+  bool learned_index = false;
 };
 
 // Table Properties that are specific to block-based table properties.
@@ -157,6 +157,16 @@ class StackableDB : public DB {
     return db_->NewIterators(options, column_families, iterators);
   }
 
+  virtual Status NewParallelIterators(const ReadOptions& options,
+                                      ColumnFamilyHandle* column_family,
+                                      const RangePtr& range,
+                                      size_t num_iterators,
+                                      std::vector<Iterator*>* iterators)
+      override {
+    return db_->NewParallelIterators(options, column_family, range,
+                                     num_iterators, iterators);
+  }
+
 
   virtual const Snapshot* GetSnapshot() override {
     return db_->GetSnapshot();
@@ -26,6 +26,7 @@
 #define STORAGE_ROCKSDB_INCLUDE_WRITE_BATCH_H_
 
 #include <atomic>
+#include <memory>
 #include <stack>
 #include <string>
 #include <stdint.h>
@@ -38,6 +39,8 @@ class Slice;
 class ColumnFamilyHandle;
 struct SavePoints;
 struct SliceParts;
+struct ProtectionInfo;
+struct ValueReferences;
 
 struct SavePoint {
   size_t size;  // size of rep_
@@ -61,6 +64,16 @@ struct SavePoint {
 class WriteBatch : public WriteBatchBase {
  public:
   explicit WriteBatch(size_t reserved_bytes = 0, size_t max_bytes = 0);
+  // If protection_bytes_per_key is not 0, a checksum of every entry is
+  // computed as it is added to the batch. The checksums are verified as the
+  // entries are inserted into the memtable, and the write fails with
+  // Corruption if the batch changed in memory in between. The batch has
+  // already been written to the WAL by then, so the DB also stops accepting
+  // writes. With memtable_protection_bytes_per_key, each checksum then stays
+  // with its memtable entry until the memtable is flushed. Supported values
+  // are 0 and 4 (a crc32c per entry).
+  WriteBatch(size_t reserved_bytes, size_t max_bytes,
+             size_t protection_bytes_per_key);
   ~WriteBatch() override;
 
   using WriteBatchBase::Put;
@@ -80,6 +93,26 @@ class WriteBatch : public WriteBatchBase {
     return Put(nullptr, key, value);
   }
 
+  // Like Put(), but the batch only keeps a reference to the bytes of value
+  // instead of a copy of them. They are copied just once, into the WAL and
+  // into the memtable, when the batch is written to the DB. The key is
+  // copied into the batch as usual.
+  //
+  // The caller must keep the bytes of value alive and unchanged for as long
+  // as the batch refers to them: until every DB::Write() of the batch has
+  // returned, and until the batch is destroyed, cleared or rolled back to a
+  // save point set before this call. Copies of the batch refer to the same
+  // bytes.
+  //
+  // Data() and GetDataSize() do not include the referenced values, so the
+  // batch cannot be rebuilt from Data() while it holds references. Iterate()
+  // and the DB see the values as if they had been added with Put().
+  Status PutByReference(ColumnFamilyHandle* column_family, const Slice& key,
+                        const Slice& value);
+  Status PutByReference(const Slice& key, const Slice& value) {
+    return PutByReference(nullptr, key, value);
+  }
+
   using WriteBatchBase::Delete;
   // If the database contains a mapping for "key", erase it.  Else do nothing.
   Status Delete(ColumnFamilyHandle* column_family, const Slice& key) override;
@@ -271,6 +304,7 @@ class WriteBatch : public WriteBatchBase {
 
    protected:
     friend class WriteBatch;
+    friend class WriteBatchInternal;
     virtual bool WriteAfterCommit() const { return true; }
     virtual bool WriteBeforePrepare() const { return false; }
   };
@@ -360,6 +394,12 @@ class WriteBatch : public WriteBatchBase {
   // more details.
   bool is_latest_persistent_state_ = false;
 
+  // Checksums of the entries, if the batch is protected
+  std::unique_ptr<ProtectionInfo> prot_info_;
+
+  // The values added with PutByReference(), if any
+  std::unique_ptr<ValueReferences> value_refs_;
+
  protected:
   std::string rep_;  // See comment in write_batch.cc for the format of rep_
 
@@ -14,22 +14,60 @@
 
 #include <atomic>
 #include <cstddef>
+#include <mutex>
+#include <vector>
 #include "rocksdb/cache.h"
 
 namespace rocksdb {
 
 class WriteBufferManager {
  public:
+  class FlushCandidateSource;
+
+  // A mutable memtable that could be flushed to free memory.
+  struct FlushCandidate {
+    FlushCandidateSource* source = nullptr;
+    uint32_t column_family_id = 0;
+    size_t memory_usage = 0;
+    // Seconds since the first write to the memtable
+    uint64_t age_seconds = 0;
+    // Whether the memtable keeps the oldest live WAL of its DB from being
+    // deleted
+    bool pins_oldest_wal = false;
+  };
+
+  // A DB instance whose memtables take memory from this manager. Implemented
+  // by the DB; not meant to be used by applications.
+  class FlushCandidateSource {
+   public:
+    virtual ~FlushCandidateSource() {}
+    // Appends the mutable memtables that could be flushed and are not being
+    // flushed already.
+    virtual void GetWriteBufferFlushCandidates(
+        std::vector<FlushCandidate>* candidates) = 0;
+    // Schedules a flush of the mutable memtable of a column family. The
+    // memtable is switched right away, or by the write in progress in the
+    // instance if there is one.
+    virtual void RequestWriteBufferFlush(uint32_t column_family_id) = 0;
+  };
+
   // _buffer_size = 0 indicates no limit. Memory won't be capped.
   // memory_usage() won't be valid and ShouldFlush() will always return true.
   // if `cache` is provided, we'll put dummy entries in the cache and cost
   // the memory allocated to the cache. It can be used even if _buffer_size = 0.
+  // If `cost_based_flush` is true, the memtable to flush when the limit is hit
+  // is picked among all column families of all DB instances sharing this
+  // manager, by FlushScore(). Otherwise the DB that hits the limit flushes
+  // its own oldest memtable.
   explicit WriteBufferManager(size_t _buffer_size,
-                              std::shared_ptr<Cache> cache = {});
+                              std::shared_ptr<Cache> cache = {},
+                              bool cost_based_flush = false);
   ~WriteBufferManager();
 
   bool enabled() const { return buffer_size_ != 0; }
 
+  bool cost_based_flush() const { return cost_based_flush_; }
+
   // Only valid if enabled()
   size_t memory_usage() const {
     return memory_used_.load(std::memory_order_relaxed);
@@ -81,6 +119,22 @@ class WriteBufferManager {
     }
   }
 
+  // Used with cost_based_flush. A DB instance registers when it is opened
+  // and unregisters when it is closed.
+  void RegisterFlushCandidateSource(FlushCandidateSource* source);
+  void UnregisterFlushCandidateSource(FlushCandidateSource* source);
+
+  // Used with cost_based_flush. Asks the instance owning the memtable with
+  // the highest FlushScore() among all registered instances to flush it.
+  // Must be called without holding any DB mutex. Returns false if there was
+  // no memtable to flush.
+  bool RequestFlushOfBestCandidate();
+
+  // Bigger memtables make bigger L0 files, so the score is the memory usage,
+  // raised by up to 2x for memtables written to for a long time, and by 1.5x
+  // if the memtable keeps the oldest WAL of its DB alive.
+  static double FlushScore(const FlushCandidate& candidate);
+
  private:
   const size_t buffer_size_;
   const size_t mutable_limit_;
@@ -90,6 +144,11 @@ class WriteBufferManager {
   struct CacheRep;
   std::unique_ptr<CacheRep> cache_rep_;
 
+  const bool cost_based_flush_;
+  // Protects sources_. Acquired before the mutex of any DB instance.
+  std::mutex sources_mutex_;
+  std::vector<FlushCandidateSource*> sources_;
+
   void ReserveMemWithCache(size_t mem);
   void FreeMemWithCache(size_t mem);
 
@@ -3308,8 +3308,12 @@ class TickerTypeJni {
         return 0x5D;
       case rocksdb::Tickers::NUMBER_MULTIGET_KEYS_FOUND:
         return 0x5E;
-      case rocksdb::Tickers::TICKER_ENUM_MAX:
+      case rocksdb::Tickers::HOT_KEY_CACHE_HIT:
         return 0x5F;
+      case rocksdb::Tickers::HOT_KEY_CACHE_MISS:
+        return 0x60;
+      case rocksdb::Tickers::TICKER_ENUM_MAX:
+        return 0x61;
 
       default:
         // undefined/default
@@ -3512,6 +3516,10 @@ class TickerTypeJni {
       case 0x5E:
         return rocksdb::Tickers::NUMBER_MULTIGET_KEYS_FOUND;
       case 0x5F:
+        return rocksdb::Tickers::HOT_KEY_CACHE_HIT;
+      case 0x60:
+        return rocksdb::Tickers::HOT_KEY_CACHE_MISS;
+      case 0x61:
         return rocksdb::Tickers::TICKER_ENUM_MAX;
 
       default:
@@ -475,7 +475,17 @@ public enum TickerType {
      */
     NUMBER_MULTIGET_KEYS_FOUND((byte) 0x5E),
 
-    TICKER_ENUM_MAX((byte) 0x5F);
+    /**
+     * Number of DB::Get() hits in the hot key cache
+     */
+    HOT_KEY_CACHE_HIT((byte) 0x5F),
+
+    /**
+     * Number of DB::Get() misses in the hot key cache
+     */
+    HOT_KEY_CACHE_MISS((byte) 0x60),
+
+    TICKER_ENUM_MAX((byte) 0x61);
 
 
     private final byte value;
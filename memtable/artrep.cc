@@ -0,0 +1,896 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+#ifndef ROCKSDB_LITE
+#include "rocksdb/memtablerep.h"
+
+#include <string.h>
+#include <atomic>
+#include <new>
+#include <string>
+
+#include "db/dbformat.h"
+#include "port/port.h"
+#include "rocksdb/comparator.h"
+#include "util/allocator.h"
+#include "util/arena.h"
+#include "util/autovector.h"
+#include "util/coding.h"
+#include "util/logging.h"
+
+namespace rocksdb {
+namespace {
+
+// An adaptive radix tree, as described in "The Adaptive Radix Tree: ARTful
+// Indexing for Main-Memory Databases" (Leis et al., ICDE 2013), made
+// concurrent with optimistic lock coupling, as described in "The ART of
+// Practical Synchronization" (Leis et al., DaMoN 2016).
+//
+// The tree is built over a binary-comparable encoding of the internal keys
+// (see EncodeKey()), which only preserves the order of BytewiseComparator.
+// The leaves are the memtable entries themselves, and the encoding of their
+// keys is computed again whenever it is needed, so the tree holds no copy
+// of the keys besides the compressed paths of inner nodes.
+// Nothing is ever removed from a memtable, so replaced nodes are simply left
+// in the arena, and readers that race with a writer can always safely read
+// whatever they point to before they validate it.
+//
+// Every inner node has a version. Writers lock the nodes they modify by
+// setting a bit in it, and bump it when they unlock. Readers never write to
+// the tree: they read the version before and validate it after they read a
+// node, and start over from the root if it changed. A reader also validates
+// the parent after it reads the version of a child, so that the child was
+// still linked from the parent when it was read.
+
+// Encodes an internal key such that memcmp() orders the encodings like the
+// internal key comparator with BytewiseComparator: the user key with every
+// 0x00 escaped as 0x00 0xff and terminated by 0x00 0x00, followed by the
+// inverted packed sequence number and type in big endian. No encoding is a
+// prefix of another one, so all keys end up in leaves.
+size_t EncodedKeyLength(const Slice& internal_key) {
+  Slice user_key = ExtractUserKey(internal_key);
+  size_t len = user_key.size() + 2 + 8;
+  for (size_t i = 0; i < user_key.size(); i++) {
+    if (user_key[i] == '\0') {
+      len++;
+    }
+  }
+  return len;
+}
+
+void EncodeKey(const Slice& internal_key, char* dst) {
+  Slice user_key = ExtractUserKey(internal_key);
+  for (size_t i = 0; i < user_key.size(); i++) {
+    *dst++ = user_key[i];
+    if (user_key[i] == '\0') {
+      *dst++ = '\xff';
+    }
+  }
+  *dst++ = '\0';
+  *dst++ = '\0';
+  uint64_t packed = ~DecodeFixed64(internal_key.data() + user_key.size());
+  for (int shift = 56; shift >= 0; shift -= 8) {
+    *dst++ = static_cast<char>((packed >> shift) & 0xff);
+  }
+}
+
+// Holds the encoding of a key, on the stack unless the key is long.
+class EncodedKey {
+ public:
+  EncodedKey() {}
+
+  Slice Set(const Slice& internal_key) {
+    size_t size = EncodedKeyLength(internal_key);
+    char* dst = space_;
+    if (size > sizeof(space_)) {
+      buf_.resize(size);
+      dst = &buf_[0];
+    }
+    EncodeKey(internal_key, dst);
+    key_ = Slice(dst, size);
+    return key_;
+  }
+
+  // Encodes the key of a length prefixed entry
+  Slice SetEntry(const char* entry) {
+    return Set(GetLengthPrefixedSlice(entry));
+  }
+
+  const Slice& key() const { return key_; }
+
+ private:
+  char space_[64];
+  std::string buf_;
+  Slice key_;
+
+  // No copying allowed
+  EncodedKey(const EncodedKey&);
+  void operator=(const EncodedKey&);
+};
+
+// A leaf is the length prefixed entry that was inserted. Entries are
+// allocated aligned by ARTRep::Allocate(), so child pointers have their
+// lowest bit set if they point to a leaf.
+inline bool IsLeaf(void* child) {
+  return (reinterpret_cast<uintptr_t>(child) & 1) != 0;
+}
+
+inline const char* AsLeaf(void* child) {
+  return reinterpret_cast<const char*>(reinterpret_cast<uintptr_t>(child) &
+                                       ~static_cast<uintptr_t>(1));
+}
+
+inline void* TagLeaf(const char* entry) {
+  assert((reinterpret_cast<uintptr_t>(entry) & 1) == 0);
+  return reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(entry) | 1);
+}
+
+enum NodeType : uint8_t { kNode4, kNode16, kNode48, kNode256 };
+
+struct InnerNode {
+  static const uint64_t kObsolete = 1;
+  static const uint64_t kLocked = 2;
+
+  InnerNode(NodeType _type, const char* _prefix, uint32_t prefix_len)
+      : version(0), type(_type), num_children(0), prefix_base(_prefix) {
+    prefix_range.store(prefix_len, std::memory_order_relaxed);
+  }
+
+  // Waits while the node is locked. Returns false if the node has been
+  // replaced, in which case the caller has to start over.
+  bool ReadLock(uint64_t* v) const {
+    uint64_t cur = version.load(std::memory_order_acquire);
+    while ((cur & kLocked) != 0) {
+      port::AsmVolatilePause();
+      cur = version.load(std::memory_order_acquire);
+    }
+    *v = cur;
+    return (cur & kObsolete) == 0;
+  }
+
+  // Returns true if the node has not been modified since ReadLock()
+  // returned v.
+  bool Validate(uint64_t v) const {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version.load(std::memory_order_relaxed) == v;
+  }
+
+  bool UpgradeToWriteLock(uint64_t v) {
+    if (!version.compare_exchange_strong(v, v + kLocked,
+                                         std::memory_order_acquire)) {
+      return false;
+    }
+    // Readers that see any of the following writes also see the lock
+    std::atomic_thread_fence(std::memory_order_release);
+    return true;
+  }
+
+  void WriteUnlock() { version.fetch_add(kLocked, std::memory_order_release); }
+
+  void WriteUnlockObsolete() {
+    version.fetch_add(kLocked + kObsolete, std::memory_order_release);
+  }
+
+  // The compressed path of the node, i.e. the bytes that all keys below it
+  // share after the byte that leads to it. The bytes never change, but the
+  // path is shortened when a key that diverges from it is inserted.
+  Slice Prefix() const {
+    uint64_t range = prefix_range.load(std::memory_order_relaxed);
+    return Slice(prefix_base + (range >> 32),
+                 static_cast<size_t>(range & 0xffffffffu));
+  }
+
+  void RemovePrefix(size_t n) {
+    uint64_t range = prefix_range.load(std::memory_order_relaxed);
+    assert(n <= (range & 0xffffffffu));
+    prefix_range.store(range + (static_cast<uint64_t>(n) << 32) - n,
+                       std::memory_order_relaxed);
+  }
+
+  // Bit 0: obsolete, bit 1: locked, the rest counts modifications
+  std::atomic<uint64_t> version;
+  const NodeType type;
+  std::atomic<uint16_t> num_children;
+  // Points into memory of the allocator, which is never freed or modified
+  const char* const prefix_base;
+  // Offset from prefix_base in the upper and length in the lower 32 bits, so
+  // that both are read at once
+  std::atomic<uint64_t> prefix_range;
+};
+
+// Node4 and Node16 keep their keys sorted.
+template <size_t kCapacity>
+struct SortedNode : public InnerNode {
+  SortedNode(const char* _prefix, uint32_t prefix_len)
+      : InnerNode(kCapacity == 4 ? kNode4 : kNode16, _prefix, prefix_len) {}
+
+  std::atomic<uint8_t> keys[kCapacity];
+  std::atomic<void*> children[kCapacity];
+};
+
+typedef SortedNode<4> Node4;
+typedef SortedNode<16> Node16;
+
+struct Node48 : public InnerNode {
+  Node48(const char* _prefix, uint32_t prefix_len)
+      : InnerNode(kNode48, _prefix, prefix_len) {
+    for (auto& index : child_index) {
+      index.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  // 1 + the slot in children of every byte, 0 if there is no child
+  std::atomic<uint8_t> child_index[256];
+  std::atomic<void*> children[48];
+};
+
+struct Node256 : public InnerNode {
+  Node256(const char* _prefix, uint32_t prefix_len)
+      : InnerNode(kNode256, _prefix, prefix_len) {
+    for (auto& child : children) {
+      child.store(nullptr, std::memory_order_relaxed);
+    }
+  }
+
+  std::atomic<void*> children[256];
+};
+
+template <size_t kCapacity>
+size_t NumSorted(const SortedNode<kCapacity>* node) {
+  // The count may be read while a writer changes the node, so never trust
+  // it beyond the capacity. The caller validates the version later on.
+  return std::min<size_t>(
+      node->num_children.load(std::memory_order_relaxed), kCapacity);
+}
+
+template <size_t kCapacity>
+void* FindSortedChild(const SortedNode<kCapacity>* node, uint8_t byte) {
+  size_t n = NumSorted(node);
+  for (size_t i = 0; i < n; i++) {
+    if (node->keys[i].load(std::memory_order_relaxed) == byte) {
+      return node->children[i].load(std::memory_order_relaxed);
+    }
+  }
+  return nullptr;
+}
+
+// Finds the child with the smallest byte greater than after, if forward,
+// or the child with the largest byte less than before otherwise.
+template <size_t kCapacity>
+void* NextSortedChild(const SortedNode<kCapacity>* node, bool forward,
+                      int bound, uint8_t* byte) {
+  size_t n = NumSorted(node);
+  if (forward) {
+    for (size_t i = 0; i < n; i++) {
+      uint8_t b = node->keys[i].load(std::memory_order_relaxed);
+      if (b > bound) {
+        *byte = b;
+        return node->children[i].load(std::memory_order_relaxed);
+      }
+    }
+  } else {
+    for (size_t i = n; i > 0; i--) {
+      uint8_t b = node->keys[i - 1].load(std::memory_order_relaxed);
+      if (b < bound) {
+        *byte = b;
+        return node->children[i - 1].load(std::memory_order_relaxed);
+      }
+    }
+  }
+  return nullptr;
+}
+
+template <size_t kCapacity>
+void ReplaceSortedChild(SortedNode<kCapacity>* node, uint8_t byte,
+                        void* child) {
+  size_t n = node->num_children.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < n; i++) {
+    if (node->keys[i].load(std::memory_order_relaxed) == byte) {
+      node->children[i].store(child, std::memory_order_relaxed);
+      return;
+    }
+  }
+  assert(false);
+}
+
+template <size_t kCapacity>
+void AddSortedChild(SortedNode<kCapacity>* node, uint8_t byte, void* child) {
+  size_t n = node->num_children.load(std::memory_order_relaxed);
+  assert(n < kCapacity);
+  size_t pos = n;
+  while (pos > 0 && node->keys[pos - 1].load(std::memory_order_relaxed) >
+                        byte) {
+    node->keys[pos].store(node->keys[pos - 1].load(std::memory_order_relaxed),
+                          std::memory_order_relaxed);
+    node->children[pos].store(
+        node->children[pos - 1].load(std::memory_order_relaxed),
+        std::memory_order_relaxed);
+    pos--;
+  }
+  node->keys[pos].store(byte, std::memory_order_relaxed);
+  node->children[pos].store(child, std::memory_order_relaxed);
+  node->num_children.store(static_cast<uint16_t>(n + 1),
+                           std::memory_order_relaxed);
+}
+
+void* FindChild(const InnerNode* node, uint8_t byte) {
+  switch (node->type) {
+    case kNode4:
+      return FindSortedChild(static_cast<const Node4*>(node), byte);
+    case kNode16:
+      return FindSortedChild(static_cast<const Node16*>(node), byte);
+    case kNode48: {
+      auto n48 = static_cast<const Node48*>(node);
+      uint8_t index = n48->child_index[byte].load(std::memory_order_relaxed);
+      return index == 0 ? nullptr
+                        : n48->children[index - 1].load(
+                              std::memory_order_relaxed);
+    }
+    case kNode256:
+      return static_cast<const Node256*>(node)->children[byte].load(
+          std::memory_order_relaxed);
+  }
+  assert(false);
+  return nullptr;
+}
+
+// bound is -1 or 256 to find the first or the last child.
+void* NextChild(const InnerNode* node, bool forward, int bound,
+                uint8_t* byte) {
+  switch (node->type) {
+    case kNode4:
+      return NextSortedChild(static_cast<const Node4*>(node), forward, bound,
+                             byte);
+    case kNode16:
+      return NextSortedChild(static_cast<const Node16*>(node), forward, bound,
+                             byte);
+    case kNode48: {
+      auto n48 = static_cast<const Node48*>(node);
+      for (int b = forward ? bound + 1 : bound - 1; b >= 0 && b < 256;
+           b += forward ? 1 : -1) {
+        uint8_t index = n48->child_index[b].load(std::memory_order_relaxed);
+        if (index != 0) {
+          *byte = static_cast<uint8_t>(b);
+          return n48->children[index - 1].load(
+              std::memory_order_relaxed);
+        }
+      }
+      return nullptr;
+    }
+    case kNode256: {
+      auto n256 = static_cast<const Node256*>(node);
+      for (int b = forward ? bound + 1 : bound - 1; b >= 0 && b < 256;
+           b += forward ? 1 : -1) {
+        void* child = n256->children[b].load(std::memory_order_relaxed);
+        if (child != nullptr) {
+          *byte = static_cast<uint8_t>(b);
+          return child;
+        }
+      }
+      return nullptr;
+    }
+  }
+  assert(false);
+  return nullptr;
+}
+
+bool IsFull(const InnerNode* node) {
+  size_t n = node->num_children.load(std::memory_order_relaxed);
+  switch (node->type) {
+    case kNode4:
+      return n == 4;
+    case kNode16:
+      return n == 16;
+    case kNode48:
+      return n == 48;
+    case kNode256:
+      return false;
+  }
+  assert(false);
+  return false;
+}
+
+// REQUIRES: node is write locked and not full.
+void AddChild(InnerNode* node, uint8_t byte, void* child) {
+  switch (node->type) {
+    case kNode4:
+      AddSortedChild(static_cast<Node4*>(node), byte, child);
+      return;
+    case kNode16:
+      AddSortedChild(static_cast<Node16*>(node), byte, child);
+      return;
+    case kNode48: {
+      auto n48 = static_cast<Node48*>(node);
+      uint16_t n = n48->num_children.load(std::memory_order_relaxed);
+      assert(n < 48);
+      n48->children[n].store(child, std::memory_order_relaxed);
+      n48->child_index[byte].store(static_cast<uint8_t>(n + 1),
+                                   std::memory_order_relaxed);
+      n48->num_children.store(n + 1, std::memory_order_relaxed);
+      return;
+    }
+    case kNode256: {
+      auto n256 = static_cast<Node256*>(node);
+      n256->children[byte].store(child, std::memory_order_relaxed);
+      n256->num_children.store(
+          n256->num_children.load(std::memory_order_relaxed) + 1,
+          std::memory_order_relaxed);
+      return;
+    }
+  }
+  assert(false);
+}
+
+// REQUIRES: node is write locked and has a child for byte.
+void ReplaceChild(InnerNode* node, uint8_t byte, void* child) {
+  switch (node->type) {
+    case kNode4:
+      ReplaceSortedChild(static_cast<Node4*>(node), byte, child);
+      return;
+    case kNode16:
+      ReplaceSortedChild(static_cast<Node16*>(node), byte, child);
+      return;
+    case kNode48: {
+      auto n48 = static_cast<Node48*>(node);
+      uint8_t index = n48->child_index[byte].load(std::memory_order_relaxed);
+      assert(index != 0);
+      n48->children[index - 1].store(child, std::memory_order_relaxed);
+      return;
+    }
+    case kNode256:
+      static_cast<Node256*>(node)->children[byte].store(
+          child, std::memory_order_relaxed);
+      return;
+  }
+  assert(false);
+}
+
+class ARTRep : public MemTableRep {
+ public:
+  explicit ARTRep(Allocator* allocator)
+      : MemTableRep(allocator),
+        root_(new (allocator->AllocateAligned(sizeof(Node256)))
+                  Node256(nullptr, 0)) {}
+
+  virtual void Insert(KeyHandle handle) override {
+    bool res = InsertKey(handle);
+    assert(res);
+    (void)res;
+  }
+
+  // Entries are aligned, so that their lowest bit can tag them as leaves
+  virtual KeyHandle Allocate(const size_t len, char** buf) override {
+    *buf = allocator_->AllocateAligned(len);
+    return static_cast<KeyHandle>(*buf);
+  }
+
+  virtual bool InsertKey(KeyHandle handle) override {
+    return InsertLeaf(static_cast<const char*>(handle));
+  }
+
+  virtual bool InsertKeyWithHint(KeyHandle handle, void** /*hint*/) override {
+    return InsertKey(handle);
+  }
+
+  virtual void InsertConcurrently(KeyHandle handle) override {
+    Insert(handle);
+  }
+
+  virtual bool InsertKeyConcurrently(KeyHandle handle) override {
+    return InsertKey(handle);
+  }
+
+  virtual bool Contains(const char* key) const override {
+    EncodedKey encoded;
+    encoded.SetEntry(key);
+    Path path;
+    EncodedKey leaf_key;
+    const char* leaf = Find(encoded.key(), true /* forward */,
+                            false /* strict */, &path, &leaf_key);
+    return leaf != nullptr && leaf_key.SetEntry(leaf) == encoded.key();
+  }
+
+  virtual size_t ApproximateMemoryUsage() override {
+    // All memory is allocated through allocator; nothing to report here
+    return 0;
+  }
+
+  virtual void Get(const LookupKey& k, void* callback_args,
+                   bool (*callback_func)(void* arg,
+                                         const char* entry)) override {
+    ARTRep::Iterator iter(this);
+    for (iter.Seek(k.internal_key(), nullptr);
+         iter.Valid() && callback_func(callback_args, iter.key());
+         iter.Next()) {
+    }
+  }
+
+  virtual MemTableRep::Iterator* GetIterator(Arena* arena) override {
+    void* mem = arena ? arena->AllocateAligned(sizeof(ARTRep::Iterator))
+                      : operator new(sizeof(ARTRep::Iterator));
+    return new (mem) ARTRep::Iterator(this);
+  }
+
+  virtual ~ARTRep() override {}
+
+ private:
+  // A node on the way from the root to a leaf, the version it had when it
+  // was read, and the byte of the child that the way continues with
+  struct Step {
+    InnerNode* node;
+    uint64_t version;
+    uint8_t byte;
+  };
+  typedef autovector<Step, 16> Path;
+
+  // The iterator keeps the way to its leaf. A step moves to the next child
+  // of the deepest node on it that has one, unless one of the nodes it reads
+  // changed since they were recorded, in which case the step searches from
+  // the root for the key next to the current one instead. Either way keys
+  // that were inserted concurrently in between are never missed.
+  class Iterator : public MemTableRep::Iterator {
+   public:
+    explicit Iterator(const ARTRep* rep) : rep_(rep), leaf_(nullptr) {}
+
+    virtual ~Iterator() override {}
+
+    virtual bool Valid() const override { return leaf_ != nullptr; }
+
+    virtual const char* key() const override {
+      assert(Valid());
+      return leaf_;
+    }
+
+    virtual void Next() override { Move(true /* forward */); }
+
+    virtual void Prev() override { Move(false /* forward */); }
+
+    virtual void Seek(const Slice& internal_key,
+                      const char* memtable_key) override {
+      tmp_.Set(memtable_key != nullptr ? GetLengthPrefixedSlice(memtable_key)
+                                       : internal_key);
+      leaf_ = rep_->Find(tmp_.key(), true /* forward */, false /* strict */,
+                         &path_, &leaf_key_);
+    }
+
+    virtual void SeekForPrev(const Slice& internal_key,
+                             const char* memtable_key) override {
+      tmp_.Set(memtable_key != nullptr ? GetLengthPrefixedSlice(memtable_key)
+                                       : internal_key);
+      leaf_ = rep_->Find(tmp_.key(), false /* forward */, false /* strict */,
+                         &path_, &leaf_key_);
+    }
+
+    virtual void SeekToFirst() override { leaf_ = rep_->First(true, &path_); }
+
+    virtual void SeekToLast() override { leaf_ = rep_->First(false, &path_); }
+
+   private:
+    void Move(bool forward) {
+      assert(Valid());
+      const char* next;
+      if (rep_->TryStep(forward, &path_, &next)) {
+        leaf_ = next;
+      } else {
+        tmp_.SetEntry(leaf_);
+        leaf_ = rep_->Find(tmp_.key(), forward, true /* strict */, &path_,
+                           &leaf_key_);
+      }
+    }
+
+    const ARTRep* rep_;
+    const char* leaf_;
+    // The way from the root to leaf_
+    Path path_;
+    EncodedKey tmp_;       // The target of searches
+    EncodedKey leaf_key_;  // For the keys of the leaves they compare with
+  };
+
+  template <class NodeT>
+  NodeT* NewNode(const char* prefix, size_t prefix_len) {
+    return new (allocator_->AllocateAligned(sizeof(NodeT)))
+        NodeT(prefix, static_cast<uint32_t>(prefix_len));
+  }
+
+  // Returns a copy of node with room for more children.
+  // REQUIRES: node is write locked.
+  InnerNode* Grow(InnerNode* node) {
+    Slice prefix = node->Prefix();
+    uint8_t byte = 0;
+    int bound = -1;
+    InnerNode* bigger;
+    switch (node->type) {
+      case kNode4:
+        bigger = NewNode<Node16>(prefix.data(), prefix.size());
+        break;
+      case kNode16:
+        bigger = NewNode<Node48>(prefix.data(), prefix.size());
+        break;
+      default:
+        assert(node->type == kNode48);
+        bigger = NewNode<Node256>(prefix.data(), prefix.size());
+        break;
+    }
+    while (void* child = NextChild(node, true, bound, &byte)) {
+      AddChild(bigger, byte, child);
+      bound = byte;
+    }
+    return bigger;
+  }
+
+  bool InsertLeaf(const char* leaf) {
+    EncodedKey encoded;
+    const Slice key = encoded.SetEntry(leaf);
+    EncodedKey other_key;
+  restart:
+    InnerNode* parent = nullptr;
+    uint64_t parent_version = 0;
+    uint8_t parent_byte = 0;
+    InnerNode* node = root_;
+    size_t depth = 0;
+    while (true) {
+      uint64_t version;
+      if (!node->ReadLock(&version) ||
+          (parent != nullptr && !parent->Validate(parent_version))) {
+        goto restart;
+      }
+      Slice prefix = node->Prefix();
+      size_t matched = 0;
+      while (matched < prefix.size() && depth + matched < key.size() &&
+             prefix[matched] == key[depth + matched]) {
+        matched++;
+      }
+      if (matched < prefix.size()) {
+        // The key leaves the compressed path of node. Put a new node with
+        // the common part in front of it.
+        assert(parent != nullptr);
+        if (!parent->UpgradeToWriteLock(parent_version)) {
+          goto restart;
+        }
+        if (!node->UpgradeToWriteLock(version)) {
+          parent->WriteUnlock();
+          goto restart;
+        }
+        // Keys are never a prefix of each other
+        assert(depth + matched < key.size());
+        InnerNode* split = NewNode<Node4>(prefix.data(), matched);
+        AddChild(split, static_cast<uint8_t>(prefix[matched]), node);
+        AddChild(split, static_cast<uint8_t>(key[depth + matched]),
+                 TagLeaf(leaf));
+        node->RemovePrefix(matched + 1);
+        ReplaceChild(parent, parent_byte, split);
+        node->WriteUnlock();
+        parent->WriteUnlock();
+        return true;
+      }
+      depth += prefix.size();
+      if (depth >= key.size()) {
+        // Only possible if node changed since it was read
+        goto restart;
+      }
+      uint8_t byte = static_cast<uint8_t>(key[depth]);
+      void* child = FindChild(node, byte);
+      if (!node->Validate(version)) {
+        goto restart;
+      }
+
+      if (child == nullptr) {
+        if (!IsFull(node)) {
+          if (!node->UpgradeToWriteLock(version)) {
+            goto restart;
+          }
+          AddChild(node, byte, TagLeaf(leaf));
+          node->WriteUnlock();
+          return true;
+        }
+        assert(parent != nullptr);
+        if (!parent->UpgradeToWriteLock(parent_version)) {
+          goto restart;
+        }
+        if (!node->UpgradeToWriteLock(version)) {
+          parent->WriteUnlock();
+          goto restart;
+        }
+        InnerNode* bigger = Grow(node);
+        AddChild(bigger, byte, TagLeaf(leaf));
+        ReplaceChild(parent, parent_byte, bigger);
+        node->WriteUnlockObsolete();
+        parent->WriteUnlock();
+        return true;
+      }
+
+      if (IsLeaf(child)) {
+        const Slice other = other_key.SetEntry(AsLeaf(child));
+        if (other == key) {
+          return false;
+        }
+        if (!node->UpgradeToWriteLock(version)) {
+          goto restart;
+        }
+        // Replace the leaf with a node that holds both keys. Its compressed
+        // path is the only copy of key bytes that the tree keeps.
+        size_t start = depth + 1;
+        size_t common = 0;
+        while (key[start + common] == other[start + common]) {
+          common++;
+        }
+        char* prefix = nullptr;
+        if (common > 0) {
+          prefix = allocator_->Allocate(common);
+          memcpy(prefix, key.data() + start, common);
+        }
+        InnerNode* split = NewNode<Node4>(prefix, common);
+        AddChild(split, static_cast<uint8_t>(other[start + common]), child);
+        AddChild(split, static_cast<uint8_t>(key[start + common]),
+                 TagLeaf(leaf));
+        ReplaceChild(node, byte, split);
+        node->WriteUnlock();
+        return true;
+      }
+
+      parent = node;
+      parent_version = version;
+      parent_byte = byte;
+      node = static_cast<InnerNode*>(child);
+      depth++;
+    }
+  }
+
+  // Returns the first leaf whose key is greater than (or equal to, unless
+  // strict) target if forward, or the last leaf whose key is less than (or
+  // equal to) target otherwise, and sets *path to the way to it. Returns
+  // nullptr if there is none. leaf_key is used to encode the keys of leaves.
+  const char* Find(const Slice& target, bool forward, bool strict,
+                   Path* path, EncodedKey* leaf_key) const {
+    const char* leaf;
+    while (!TryFind(target, forward, strict, &leaf, path, leaf_key)) {
+    }
+    return leaf;
+  }
+
+  // Returns the first leaf if forward, the last one otherwise, and sets
+  // *path to the way to it.
+  const char* First(bool forward, Path* path) const {
+    const char* leaf;
+    do {
+      path->clear();
+    } while (!TryFirst(root_, nullptr, 0, forward, &leaf, path));
+    return leaf;
+  }
+
+  // Returns false if the tree changed under the search.
+  bool TryFind(const Slice& target, bool forward, bool strict,
+               const char** leaf, Path* path, EncodedKey* leaf_key) const {
+    path->clear();
+    InnerNode* node = root_;
+    InnerNode* parent = nullptr;
+    uint64_t parent_version = 0;
+    size_t depth = 0;
+    while (true) {
+      uint64_t version;
+      if (!node->ReadLock(&version) ||
+          (parent != nullptr && !parent->Validate(parent_version))) {
+        return false;
+      }
+      // Compare the compressed path with the target. If the target ends
+      // within or right after it, it is less than all keys below.
+      Slice prefix = node->Prefix();
+      size_t n = std::min(prefix.size(), target.size() - depth);
+      int cmp = memcmp(prefix.data(), target.data() + depth, n);
+      if (cmp == 0 && depth + prefix.size() >= target.size()) {
+        cmp = 1;
+      }
+      if (!node->Validate(version)) {
+        return false;
+      }
+      if (cmp != 0) {
+        if ((cmp > 0) == forward) {
+          // All keys below are past the target
+          return TryFirst(node, parent, parent_version, forward, leaf, path);
+        }
+        break;
+      }
+      depth += prefix.size();
+      uint8_t byte = static_cast<uint8_t>(target[depth]);
+      void* child = FindChild(node, byte);
+      if (!node->Validate(version)) {
+        return false;
+      }
+      path->push_back(Step{node, version, byte});
+      if (child == nullptr) {
+        break;
+      }
+      if (IsLeaf(child)) {
+        int r = leaf_key->SetEntry(AsLeaf(child)).compare(target);
+        if ((r == 0 && !strict) || (r != 0 && (r > 0) == forward)) {
+          *leaf = AsLeaf(child);
+          return true;
+        }
+        break;
+      }
+      parent = node;
+      parent_version = version;
+      node = static_cast<InnerNode*>(child);
+      depth++;
+    }
+
+    // Nothing below the last node on the path is past the target
+    return TryStep(forward, path, leaf);
+  }
+
+  // Finds the closest sibling on the way back up from the end of path, and
+  // the first (or last) leaf below it. Returns false if one of the nodes
+  // changed since it was added to path.
+  bool TryStep(bool forward, Path* path, const char** leaf) const {
+    while (!path->empty()) {
+      Step& step = path->back();
+      uint8_t byte;
+      void* child = NextChild(step.node, forward, step.byte, &byte);
+      if (!step.node->Validate(step.version)) {
+        return false;
+      }
+      if (child != nullptr) {
+        step.byte = byte;
+        return TryFirst(child, step.node, step.version, forward, leaf, path);
+      }
+      path->pop_back();
+    }
+    *leaf = nullptr;
+    return true;
+  }
+
+  // Finds the first (or last) leaf below child and adds the way to it to
+  // path. parent is validated against parent_version after the version of
+  // every inner node is read.
+  bool TryFirst(void* child, InnerNode* parent, uint64_t parent_version,
+                bool forward, const char** leaf, Path* path) const {
+    while (!IsLeaf(child)) {
+      InnerNode* node = static_cast<InnerNode*>(child);
+      uint64_t version;
+      if (!node->ReadLock(&version) ||
+          (parent != nullptr && !parent->Validate(parent_version))) {
+        return false;
+      }
+      uint8_t byte;
+      child = NextChild(node, forward, forward ? -1 : 256, &byte);
+      if (!node->Validate(version)) {
+        return false;
+      }
+      if (child == nullptr) {
+        // Only the root can be empty
+        assert(node == root_);
+        *leaf = nullptr;
+        return true;
+      }
+      path->push_back(Step{node, version, byte});
+      parent = node;
+      parent_version = version;
+    }
+    *leaf = AsLeaf(child);
+    return true;
+  }
+
+  InnerNode* const root_;
+};
+}  // anon namespace
+
+MemTableRep* ARTRepFactory::CreateMemTableRep(
+    const MemTableRep::KeyComparator& compare, Allocator* allocator,
+    const SliceTransform* transform, Logger* logger) {
+  const Comparator* user_comparator = compare.user_comparator();
+  if (user_comparator == nullptr ||
+      strcmp(user_comparator->Name(), BytewiseComparator()->Name()) != 0) {
+    ROCKS_LOG_WARN(logger,
+                   "ARTRepFactory does not support comparator %s, using a "
+                   "skip list instead",
+                   user_comparator != nullptr ? user_comparator->Name()
+                                              : "(unknown)");
+    return SkipListFactory().CreateMemTableRep(compare, allocator, transform,
+                                               logger);
+  }
+  return new ARTRep(allocator);
+}
+}  // namespace rocksdb
+#endif  // ROCKSDB_LITE
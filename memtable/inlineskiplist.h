@@ -52,6 +52,7 @@
 #include "util/allocator.h"
 #include "util/coding.h"
 #include "util/random.h"
+#include "util/thread_local.h"
 
 namespace rocksdb {
 
@@ -102,7 +103,10 @@ class InlineSkipList {
   // REQUIRES: no concurrent calls to any of inserts.
   bool InsertWithHint(const char* key, void** hint);
 
-  // Like Insert, but external synchronization is not required.
+  // Like Insert, but external synchronization is not required. Every
+  // thread keeps its own splice of its last insertion into the list, so
+  // a thread inserting sequential keys does not need to search from the
+  // head each time.
   bool InsertConcurrently(const char* key);
 
   // Inserts a node into the skip list.  key must have been allocated by
@@ -198,6 +202,10 @@ class InlineSkipList {
   // non-concurrent insertion.
   Splice* seq_splice_;
 
+  // The Splice of every thread that called InsertConcurrently, allocated
+  // from allocator_ on its first insertion.
+  ThreadLocalPtr concurrent_splices_;
+
   inline int GetMaxHeight() const {
     return max_height_.load(std::memory_order_relaxed);
   }
@@ -650,12 +658,16 @@ bool InlineSkipList<Comparator>::Insert(const char* key) {
 
 template <class Comparator>
 bool InlineSkipList<Comparator>::InsertConcurrently(const char* key) {
-  Node* prev[kMaxPossibleHeight];
-  Node* next[kMaxPossibleHeight];
-  Splice splice;
-  splice.prev_ = prev;
-  splice.next_ = next;
-  return Insert<true>(key, &splice, false);
+  Splice* splice = reinterpret_cast<Splice*>(concurrent_splices_.Get());
+  if (splice == nullptr) {
+    splice = AllocateSplice();
+    concurrent_splices_.Reset(splice);
+  }
+  // Other threads may have inserted anywhere since this thread's last
+  // insertion, so be pessimistic and only reuse the splice if it still
+  // brackets the key at the bottom level. The CAS below catches any insert
+  // that lands in between.
+  return Insert<true>(key, splice, false);
 }
 
 template <class Comparator>
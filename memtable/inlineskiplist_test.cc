@@ -310,6 +310,45 @@ TEST_F(InlineSkipTest, InsertWithHint_CompatibleWithInsertWithoutHint) {
 }
 
 #ifndef ROCKSDB_VALGRIND_RUN
+TEST_F(InlineSkipTest, ConcurrentInsertSequentialPerThread) {
+  const int kNumThreads = 4;
+  const Key kNumKeysPerThread = 10000;
+  ConcurrentArena arena;
+  TestComparator cmp;
+  TestInlineSkipList list(cmp, &arena);
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&list, t, kNumKeysPerThread]() {
+      // Half of the threads insert their own range, the other half
+      // interleave their keys with each other.
+      for (Key i = 0; i < kNumKeysPerThread; i++) {
+        Key key = t < kNumThreads / 2
+                      ? t * kNumKeysPerThread + i
+                      : (kNumThreads / 2) * kNumKeysPerThread +
+                            i * (kNumThreads / 2) + (t - kNumThreads / 2);
+        char* buf = list.AllocateKey(sizeof(Key));
+        memcpy(buf, &key, sizeof(Key));
+        ASSERT_TRUE(list.InsertConcurrently(buf));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  list.TEST_Validate();
+
+  TestInlineSkipList::Iterator iter(&list);
+  Key count = 0;
+  for (iter.SeekToFirst(); iter.Valid(); iter.Next()) {
+    count++;
+  }
+  ASSERT_EQ(kNumThreads * kNumKeysPerThread, count);
+  for (Key i = 0; i < kNumKeysPerThread; i++) {
+    Key key = kNumKeysPerThread + i;
+    ASSERT_TRUE(list.Contains(Encode(&key)));
+  }
+}
+
 // We want to make sure that with a single writer and multiple
 // concurrent readers (with no synchronization other than when a
 // reader's iterator is created), the reader always observes all the
@@ -36,6 +36,7 @@ int main() {
 #include "rocksdb/slice_transform.h"
 #include "rocksdb/write_buffer_manager.h"
 #include "util/arena.h"
+#include "util/concurrent_arena.h"
 #include "util/gflags_compat.h"
 #include "util/mutexlock.h"
 #include "util/stop_watch.h"
@@ -49,6 +50,13 @@ DEFINE_string(benchmarks, "fillrandom",
               "Comma-separated list of benchmarks to run. Options:\n"
               "\tfillrandom             -- write N random values\n"
               "\tfillseq                -- write N values in sequential order\n"
+              "\tfillrandomconcurrent   -- N threads write random values of "
+              "their own\n"
+              "\t                          key ranges concurrently\n"
+              "\tfillseqconcurrent      -- N threads write values of their "
+              "own key\n"
+              "\t                          ranges in sequential order "
+              "concurrently\n"
               "\treadrandom             -- read N values in random order\n"
               "\treadseq                -- scan the DB\n"
               "\treadwrite              -- 1 thread writes while N - 1 threads "
@@ -63,6 +71,7 @@ DEFINE_string(memtablerep, "skiplist",
               "  more details. Options:\n"
               "\tskiplist            -- backed by a skiplist\n"
               "\tvector              -- backed by an std::vector\n"
+              "\tart                 -- backed by an adaptive radix tree\n"
               "\thashskiplist        -- backed by a hash skip list\n"
               "\thashlinklist        -- backed by a hash linked list\n"
               "\tcuckoo              -- backed by a cuckoo hash table");
@@ -246,7 +255,9 @@ class FillBenchmarkThread : public BenchmarkThread {
       : BenchmarkThread(table, key_gen, bytes_written, bytes_read, sequence,
                         num_ops, read_hits) {}
 
-  void FillOne() {
+  void FillOne() { InsertOne(key_gen_->Next(), false /* concurrently */); }
+
+  void InsertOne(uint64_t key, bool concurrently) {
     char* buf = nullptr;
     auto internal_key_size = 16;
     auto encoded_len =
@@ -254,7 +265,6 @@ class FillBenchmarkThread : public BenchmarkThread {
     KeyHandle handle = table_->Allocate(encoded_len, &buf);
     assert(buf != nullptr);
     char* p = EncodeVarint32(buf, internal_key_size);
-    auto key = key_gen_->Next();
     EncodeFixed64(p, key);
     p += 8;
     EncodeFixed64(p, ++(*sequence_));
@@ -263,7 +273,11 @@ class FillBenchmarkThread : public BenchmarkThread {
     memcpy(p, bytes.data(), FLAGS_item_size);
     p += FLAGS_item_size;
     assert(p == buf + encoded_len);
-    table_->Insert(handle);
+    if (concurrently) {
+      table_->InsertConcurrently(handle);
+    } else {
+      table_->Insert(handle);
+    }
     *bytes_written_ += encoded_len;
   }
 
@@ -298,6 +312,29 @@ class ConcurrentFillBenchmarkThread : public FillBenchmarkThread {
   std::atomic_int* threads_done_;
 };
 
+// Inserts the keys of key_gen, shifted by key_offset, with InsertConcurrently.
+// bytes_written and sequence must not be shared with other threads.
+class FillConcurrentlyBenchmarkThread : public FillBenchmarkThread {
+ public:
+  FillConcurrentlyBenchmarkThread(MemTableRep* table, KeyGenerator* key_gen,
+                                  uint64_t* bytes_written,
+                                  uint64_t* bytes_read, uint64_t* sequence,
+                                  uint64_t num_ops, uint64_t* read_hits,
+                                  uint64_t key_offset)
+      : FillBenchmarkThread(table, key_gen, bytes_written, bytes_read, sequence,
+                            num_ops, read_hits),
+        key_offset_(key_offset) {}
+
+  void operator()() override {
+    for (unsigned int i = 0; i < num_ops_; ++i) {
+      InsertOne(key_offset_ + key_gen_->Next(), true /* concurrently */);
+    }
+  }
+
+ private:
+  uint64_t key_offset_;
+};
+
 class ReadBenchmarkThread : public BenchmarkThread {
  public:
   ReadBenchmarkThread(MemTableRep* table, KeyGenerator* key_gen,
@@ -487,6 +524,46 @@ class FillBenchmark : public Benchmark {
   }
 };
 
+class FillConcurrentlyBenchmark : public Benchmark {
+ public:
+  explicit FillConcurrentlyBenchmark(MemTableRep* table, Random64* rand,
+                                     WriteMode mode, uint64_t* sequence)
+      : Benchmark(table, nullptr, sequence, FLAGS_num_threads),
+        rand_(rand),
+        mode_(mode) {
+    num_write_ops_per_thread_ = FLAGS_num_operations / FLAGS_num_threads;
+  }
+
+  void RunThreads(std::vector<port::Thread>* threads, uint64_t* bytes_written,
+                  uint64_t* bytes_read, bool /*write*/,
+                  uint64_t* read_hits) override {
+    // Every thread writes its own key range, so that the keys are unique.
+    std::vector<std::unique_ptr<KeyGenerator>> key_gens;
+    std::vector<uint64_t> thread_bytes_written(num_threads_, 0);
+    std::vector<uint64_t> thread_sequences(num_threads_, 0);
+    for (uint32_t i = 0; i < num_threads_; ++i) {
+      key_gens.emplace_back(
+          new KeyGenerator(rand_, mode_, num_write_ops_per_thread_));
+    }
+    for (uint32_t i = 0; i < num_threads_; ++i) {
+      threads->emplace_back(FillConcurrentlyBenchmarkThread(
+          table_, key_gens[i].get(), &thread_bytes_written[i], bytes_read,
+          &thread_sequences[i], num_write_ops_per_thread_, read_hits,
+          i * num_write_ops_per_thread_));
+    }
+    for (auto& thread : *threads) {
+      thread.join();
+    }
+    for (uint32_t i = 0; i < num_threads_; ++i) {
+      *bytes_written += thread_bytes_written[i];
+    }
+  }
+
+ private:
+  Random64* rand_;
+  WriteMode mode_;
+};
+
 class ReadBenchmark : public Benchmark {
  public:
   explicit ReadBenchmark(MemTableRep* table, KeyGenerator* key_gen,
@@ -594,6 +671,8 @@ int main(int argc, char** argv) {
 #ifndef ROCKSDB_LITE
   } else if (FLAGS_memtablerep == "vector") {
     factory.reset(new rocksdb::VectorRepFactory);
+  } else if (FLAGS_memtablerep == "art") {
+    factory.reset(new rocksdb::ARTRepFactory);
   } else if (FLAGS_memtablerep == "hashskiplist") {
     factory.reset(rocksdb::NewHashSkipListRepFactory(
         FLAGS_bucket_count, FLAGS_hashskiplist_height,
@@ -622,7 +701,9 @@ int main(int argc, char** argv) {
   rocksdb::InternalKeyComparator internal_key_comp(
       rocksdb::BytewiseComparator());
   rocksdb::MemTable::KeyComparator key_comp(internal_key_comp);
-  rocksdb::Arena arena;
+  // Same as the arena of MemTable, so that keys can be allocated
+  // concurrently.
+  rocksdb::ConcurrentArena arena;
   rocksdb::WriteBufferManager wb(FLAGS_write_buffer_size);
   uint64_t sequence;
   auto createMemtableRep = [&] {
@@ -658,6 +739,21 @@ int main(int argc, char** argv) {
                                               FLAGS_num_operations));
       benchmark.reset(new rocksdb::FillBenchmark(memtablerep.get(),
                                                  key_gen.get(), &sequence));
+    } else if (name == rocksdb::Slice("fillseqconcurrent") ||
+               name == rocksdb::Slice("fillrandomconcurrent")) {
+      if (!factory->IsInsertConcurrentlySupported()) {
+        std::cout << "WARNING: skipping '" << name.ToString()
+                  << "', concurrent inserts are not supported by "
+                  << FLAGS_memtablerep << std::endl;
+        continue;
+      }
+      memtablerep.reset(createMemtableRep());
+      benchmark.reset(new rocksdb::FillConcurrentlyBenchmark(
+          memtablerep.get(), &rng,
+          name == rocksdb::Slice("fillseqconcurrent")
+              ? rocksdb::SEQUENTIAL
+              : rocksdb::UNIQUE_RANDOM,
+          &sequence));
     } else if (name == rocksdb::Slice("readrandom")) {
       key_gen.reset(new rocksdb::KeyGenerator(&rng, rocksdb::RANDOM,
                                               FLAGS_num_operations));
@@ -8,10 +8,16 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 
 #include "rocksdb/write_buffer_manager.h"
+#include <algorithm>
 #include <mutex>
 #include "util/coding.h"
 
 namespace rocksdb {
+namespace {
+// Age at which a memtable scores twice its size in FlushScore()
+const uint64_t kFlushScoreMaxAgeSeconds = 600;
+}  // namespace
+
 #ifndef ROCKSDB_LITE
 namespace {
 const size_t kSizeDummyEntry = 1024 * 1024;
@@ -49,12 +55,14 @@ struct WriteBufferManager::CacheRep {};
 #endif  // ROCKSDB_LITE
 
 WriteBufferManager::WriteBufferManager(size_t _buffer_size,
-                                       std::shared_ptr<Cache> cache)
+                                       std::shared_ptr<Cache> cache,
+                                       bool cost_based_flush)
     : buffer_size_(_buffer_size),
       mutable_limit_(buffer_size_ * 7 / 8),
       memory_used_(0),
       memory_active_(0),
-      cache_rep_(nullptr) {
+      cache_rep_(nullptr),
+      cost_based_flush_(cost_based_flush) {
 #ifndef ROCKSDB_LITE
   if (cache) {
     // Construct the cache key using the pointer to this.
@@ -127,4 +135,50 @@ void WriteBufferManager::FreeMemWithCache(size_t mem) {
   (void)mem;
 #endif  // ROCKSDB_LITE
 }
+
+void WriteBufferManager::RegisterFlushCandidateSource(
+    FlushCandidateSource* source) {
+  std::lock_guard<std::mutex> lock(sources_mutex_);
+  sources_.push_back(source);
+}
+
+void WriteBufferManager::UnregisterFlushCandidateSource(
+    FlushCandidateSource* source) {
+  std::lock_guard<std::mutex> lock(sources_mutex_);
+  sources_.erase(std::remove(sources_.begin(), sources_.end(), source),
+                 sources_.end());
+}
+
+bool WriteBufferManager::RequestFlushOfBestCandidate() {
+  std::lock_guard<std::mutex> lock(sources_mutex_);
+  std::vector<FlushCandidate> candidates;
+  for (auto* source : sources_) {
+    source->GetWriteBufferFlushCandidates(&candidates);
+  }
+  const FlushCandidate* best = nullptr;
+  double best_score = 0;
+  for (const auto& candidate : candidates) {
+    double score = FlushScore(candidate);
+    if (best == nullptr || score > best_score) {
+      best = &candidate;
+      best_score = score;
+    }
+  }
+  if (best == nullptr) {
+    return false;
+  }
+  best->source->RequestWriteBufferFlush(best->column_family_id);
+  return true;
+}
+
+double WriteBufferManager::FlushScore(const FlushCandidate& candidate) {
+  double score = static_cast<double>(candidate.memory_usage);
+  score *= 1.0 + static_cast<double>(std::min(candidate.age_seconds,
+                                              kFlushScoreMaxAgeSeconds)) /
+                     kFlushScoreMaxAgeSeconds;
+  if (candidate.pins_oldest_wal) {
+    score *= 1.5;
+  }
+  return score;
+}
 }  // namespace rocksdb
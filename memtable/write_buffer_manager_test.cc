@@ -8,6 +8,7 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 
 #include "rocksdb/write_buffer_manager.h"
+#include <set>
 #include "util/testharness.h"
 
 namespace rocksdb {
@@ -143,6 +144,68 @@ TEST_F(WriteBufferManagerTest, NoCapCacheCost) {
   ASSERT_LT(cache->GetPinnedUsage(), 1024 * 1024 + 10000);
 }
 #endif  // ROCKSDB_LITE
+
+namespace {
+class FakeFlushCandidateSource
+    : public WriteBufferManager::FlushCandidateSource {
+ public:
+  void GetWriteBufferFlushCandidates(
+      std::vector<WriteBufferManager::FlushCandidate>* candidates) override {
+    for (auto candidate : candidates_) {
+      if (requested_.count(candidate.column_family_id) == 0) {
+        candidate.source = this;
+        candidates->push_back(candidate);
+      }
+    }
+  }
+  void RequestWriteBufferFlush(uint32_t column_family_id) override {
+    requested_.insert(column_family_id);
+  }
+  void AddCandidate(uint32_t cf_id, size_t memory_usage, uint64_t age_seconds,
+                    bool pins_oldest_wal) {
+    WriteBufferManager::FlushCandidate candidate;
+    candidate.column_family_id = cf_id;
+    candidate.memory_usage = memory_usage;
+    candidate.age_seconds = age_seconds;
+    candidate.pins_oldest_wal = pins_oldest_wal;
+    candidates_.push_back(candidate);
+  }
+
+  std::vector<WriteBufferManager::FlushCandidate> candidates_;
+  std::set<uint32_t> requested_;
+};
+}  // namespace
+
+TEST_F(WriteBufferManagerTest, CostBasedFlush) {
+  WriteBufferManager wbf(10 * 1024 * 1024, {}, true /* cost_based_flush */);
+  ASSERT_TRUE(wbf.cost_based_flush());
+  ASSERT_FALSE(wbf.RequestFlushOfBestCandidate());
+
+  FakeFlushCandidateSource db1;
+  FakeFlushCandidateSource db2;
+  wbf.RegisterFlushCandidateSource(&db1);
+  wbf.RegisterFlushCandidateSource(&db2);
+  db1.AddCandidate(0, 1 << 20, 0, true);
+  db1.AddCandidate(1, 2 << 20, 0, false);
+  // Old, but small
+  db2.AddCandidate(0, 1 << 19, 3600, true);
+  // Written for 5 minutes
+  db2.AddCandidate(1, 3 << 19, 300, false);
+
+  // db1 cf1: 2MB; db2 cf1: 1.5MB * 1.5
+  ASSERT_TRUE(wbf.RequestFlushOfBestCandidate());
+  ASSERT_EQ(db2.requested_, std::set<uint32_t>({1}));
+  ASSERT_TRUE(db1.requested_.empty());
+  ASSERT_TRUE(wbf.RequestFlushOfBestCandidate());
+  ASSERT_EQ(db1.requested_, std::set<uint32_t>({1}));
+  // db1 cf0: 1MB * 1.5; db2 cf0: 0.5MB * 2 * 1.5
+  ASSERT_TRUE(wbf.RequestFlushOfBestCandidate());
+  ASSERT_EQ(db1.requested_, std::set<uint32_t>({0, 1}));
+
+  wbf.UnregisterFlushCandidateSource(&db2);
+  ASSERT_FALSE(wbf.RequestFlushOfBestCandidate());
+  wbf.UnregisterFlushCandidateSource(&db1);
+}
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
@@ -25,6 +25,11 @@ ImmutableCFOptions::ImmutableCFOptions(const Options& options)
 
 ImmutableCFOptions::ImmutableCFOptions(const ImmutableDBOptions& db_options,
                                        const ColumnFamilyOptions& cf_options)
+    : ImmutableCFOptions(db_options, cf_options, db_options.row_cache) {}
+
+ImmutableCFOptions::ImmutableCFOptions(const ImmutableDBOptions& db_options,
+                                       const ColumnFamilyOptions& cf_options,
+                                       std::shared_ptr<Cache> _row_cache)
     : compaction_style(cf_options.compaction_style),
       compaction_pri(cf_options.compaction_pri),
       user_comparator(cf_options.comparator),
@@ -71,10 +76,16 @@ ImmutableCFOptions::ImmutableCFOptions(const ImmutableDBOptions& db_options,
       allow_ingest_behind(db_options.allow_ingest_behind),
       preserve_deletes(db_options.preserve_deletes),
       listeners(db_options.listeners),
-      row_cache(db_options.row_cache),
+      row_cache(_row_cache),
+      learned_level_index(cf_options.learned_level_index),
       max_subcompactions(db_options.max_subcompactions),
       memtable_insert_with_hint_prefix_extractor(
           cf_options.memtable_insert_with_hint_prefix_extractor.get()),
+      memtable_point_lookup_index(cf_options.memtable_point_lookup_index),
+      memtable_numa_aware_allocation(
+          cf_options.memtable_numa_aware_allocation),
+      memtable_protection_bytes_per_key(
+          cf_options.memtable_protection_bytes_per_key),
       cf_paths(cf_options.cf_paths) {}
 
 // Multiple two operands. If they overflow, return op1.
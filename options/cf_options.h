@@ -26,6 +26,12 @@ struct ImmutableCFOptions {
   ImmutableCFOptions(const ImmutableDBOptions& db_options,
                      const ColumnFamilyOptions& cf_options);
 
+  // Like above, with row_cache instead of DBOptions::row_cache. Used by
+  // column families that have a row cache of their own.
+  ImmutableCFOptions(const ImmutableDBOptions& db_options,
+                     const ColumnFamilyOptions& cf_options,
+                     std::shared_ptr<Cache> row_cache);
+
   CompactionStyle compaction_style;
 
   CompactionPri compaction_pri;
@@ -113,12 +119,23 @@ struct ImmutableCFOptions {
   // when specific RocksDB event happens.
   std::vector<std::shared_ptr<EventListener>> listeners;
 
+  // DBOptions::row_cache, or the row cache of the column family if
+  // row_cache_size is set. The column family creates it once, and copies of
+  // these options share it.
   std::shared_ptr<Cache> row_cache;
 
+  bool learned_level_index;
+
   uint32_t max_subcompactions;
 
   const SliceTransform* memtable_insert_with_hint_prefix_extractor;
 
+  bool memtable_point_lookup_index;
+
+  bool memtable_numa_aware_allocation;
+
+  size_t memtable_protection_bytes_per_key;
+
   std::vector<DbPath> cf_paths;
 };
 
@@ -16,6 +16,7 @@
 #include "rocksdb/env.h"
 #include "rocksdb/sst_file_manager.h"
 #include "rocksdb/wal_filter.h"
+#include "util/compression.h"
 #include "util/logging.h"
 
 namespace rocksdb {
@@ -74,8 +75,14 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       write_thread_slow_yield_usec(options.write_thread_slow_yield_usec),
       skip_stats_update_on_db_open(options.skip_stats_update_on_db_open),
       wal_recovery_mode(options.wal_recovery_mode),
+      max_wal_recovery_threads(options.max_wal_recovery_threads),
+      wal_compression(options.wal_compression),
+      enable_write_stall_pacing(options.enable_write_stall_pacing),
+      enable_per_column_family_write_stall(
+          options.enable_per_column_family_write_stall),
       allow_2pc(options.allow_2pc),
       row_cache(options.row_cache),
+      hot_key_cache_size(options.hot_key_cache_size),
 #ifndef ROCKSDB_LITE
       wal_filter(options.wal_filter),
 #endif  // ROCKSDB_LITE
@@ -179,6 +186,15 @@ void ImmutableDBOptions::Dump(Logger* log) const {
       sst_file_manager ? sst_file_manager->GetDeleteRateBytesPerSecond() : 0);
   ROCKS_LOG_HEADER(log, "                      Options.wal_recovery_mode: %d",
                    wal_recovery_mode);
+  ROCKS_LOG_HEADER(log, "               Options.max_wal_recovery_threads: %d",
+                   max_wal_recovery_threads);
+  ROCKS_LOG_HEADER(log, "                        Options.wal_compression: %s",
+                   CompressionTypeToString(wal_compression).c_str());
+  ROCKS_LOG_HEADER(log, "              Options.enable_write_stall_pacing: %d",
+                   enable_write_stall_pacing);
+  ROCKS_LOG_HEADER(log,
+                   "   Options.enable_per_column_family_write_stall: %d",
+                   enable_per_column_family_write_stall);
   ROCKS_LOG_HEADER(log, "                 Options.enable_thread_tracking: %d",
                    enable_thread_tracking);
   ROCKS_LOG_HEADER(log, "                 Options.enable_pipelined_write: %d",
@@ -201,6 +217,9 @@ void ImmutableDBOptions::Dump(Logger* log) const {
     ROCKS_LOG_HEADER(log,
                      "                              Options.row_cache: None");
   }
+  ROCKS_LOG_HEADER(
+      log, "                     Options.hot_key_cache_size: %" ROCKSDB_PRIszt,
+      hot_key_cache_size);
 #ifndef ROCKSDB_LITE
   ROCKS_LOG_HEADER(log, "                             Options.wal_filter: %s",
                    wal_filter ? wal_filter->Name() : "None");
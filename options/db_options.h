@@ -66,8 +66,13 @@ struct ImmutableDBOptions {
   uint64_t write_thread_slow_yield_usec;
   bool skip_stats_update_on_db_open;
   WALRecoveryMode wal_recovery_mode;
+  int max_wal_recovery_threads;
+  CompressionType wal_compression;
+  bool enable_write_stall_pacing;
+  bool enable_per_column_family_write_stall;
   bool allow_2pc;
   std::shared_ptr<Cache> row_cache;
+  size_t hot_key_cache_size;
 #ifndef ROCKSDB_LITE
   WalFilter* wal_filter;
 #endif  // ROCKSDB_LITE
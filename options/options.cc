@@ -52,8 +52,12 @@ AdvancedColumnFamilyOptions::AdvancedColumnFamilyOptions(const Options& options)
       memtable_prefix_bloom_size_ratio(
           options.memtable_prefix_bloom_size_ratio),
       memtable_huge_page_size(options.memtable_huge_page_size),
+      memtable_numa_aware_allocation(options.memtable_numa_aware_allocation),
       memtable_insert_with_hint_prefix_extractor(
           options.memtable_insert_with_hint_prefix_extractor),
+      memtable_point_lookup_index(options.memtable_point_lookup_index),
+      memtable_protection_bytes_per_key(
+          options.memtable_protection_bytes_per_key),
       bloom_locality(options.bloom_locality),
       arena_block_size(options.arena_block_size),
       compression_per_level(options.compression_per_level),
@@ -83,6 +87,8 @@ AdvancedColumnFamilyOptions::AdvancedColumnFamilyOptions(const Options& options)
           options.table_properties_collector_factories),
       max_successive_merges(options.max_successive_merges),
       optimize_filters_for_hits(options.optimize_filters_for_hits),
+      row_cache_size(options.row_cache_size),
+      learned_level_index(options.learned_level_index),
       paranoid_file_checks(options.paranoid_file_checks),
       force_consistency_checks(options.force_consistency_checks),
       report_bg_io_stats(options.report_bg_io_stats),
@@ -154,6 +160,12 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
                      memtable_insert_with_hint_prefix_extractor == nullptr
                          ? "nullptr"
                          : memtable_insert_with_hint_prefix_extractor->Name());
+    ROCKS_LOG_HEADER(log,
+                     "             Options.memtable_point_lookup_index: %d",
+                     memtable_point_lookup_index);
+    ROCKS_LOG_HEADER(
+        log, "  Options.memtable_protection_bytes_per_key: %" ROCKSDB_PRIszt,
+        memtable_protection_bytes_per_key);
     ROCKS_LOG_HEADER(log, "            Options.num_levels: %d", num_levels);
     ROCKS_LOG_HEADER(log, "       Options.min_write_buffer_number_to_merge: %d",
                      min_write_buffer_number_to_merge);
@@ -178,6 +190,10 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
         "        Options.bottommost_compression_opts.zstd_max_train_bytes: "
         "%" ROCKSDB_PRIszt,
         bottommost_compression_opts.zstd_max_train_bytes);
+    ROCKS_LOG_HEADER(
+        log,
+        "        Options.bottommost_compression_opts.parallel_threads: %" PRIu32,
+        bottommost_compression_opts.parallel_threads);
     ROCKS_LOG_HEADER(
         log, "                 Options.bottommost_compression_opts.enabled: %s",
         bottommost_compression_opts.enabled ? "true" : "false");
@@ -195,6 +211,10 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
                      "        Options.compression_opts.zstd_max_train_bytes: "
                      "%" ROCKSDB_PRIszt,
                      compression_opts.zstd_max_train_bytes);
+    ROCKS_LOG_HEADER(log,
+                     "        Options.compression_opts.parallel_threads: "
+                     "%" PRIu32,
+                     compression_opts.parallel_threads);
     ROCKS_LOG_HEADER(log,
                      "                 Options.compression_opts.enabled: %s",
                      compression_opts.enabled ? "true" : "false");
@@ -330,6 +350,8 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
 
     ROCKS_LOG_HEADER(log, "  Options.memtable_huge_page_size: %" ROCKSDB_PRIszt,
                      memtable_huge_page_size);
+    ROCKS_LOG_HEADER(log, "  Options.memtable_numa_aware_allocation: %d",
+                     memtable_numa_aware_allocation);
     ROCKS_LOG_HEADER(log,
                      "                          Options.bloom_locality: %d",
                      bloom_locality);
@@ -341,6 +363,12 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
     ROCKS_LOG_HEADER(log,
                      "               Options.optimize_filters_for_hits: %d",
                      optimize_filters_for_hits);
+    ROCKS_LOG_HEADER(
+        log, "                          Options.row_cache_size: %" ROCKSDB_PRIszt,
+        row_cache_size);
+    ROCKS_LOG_HEADER(log,
+                     "                     Options.learned_level_index: %d",
+                     learned_level_index);
     ROCKS_LOG_HEADER(log, "               Options.paranoid_file_checks: %d",
                      paranoid_file_checks);
     ROCKS_LOG_HEADER(log, "               Options.force_consistency_checks: %d",
@@ -108,8 +108,16 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.skip_stats_update_on_db_open =
       immutable_db_options.skip_stats_update_on_db_open;
   options.wal_recovery_mode = immutable_db_options.wal_recovery_mode;
+  options.max_wal_recovery_threads =
+      immutable_db_options.max_wal_recovery_threads;
+  options.wal_compression = immutable_db_options.wal_compression;
+  options.enable_write_stall_pacing =
+      immutable_db_options.enable_write_stall_pacing;
+  options.enable_per_column_family_write_stall =
+      immutable_db_options.enable_per_column_family_write_stall;
   options.allow_2pc = immutable_db_options.allow_2pc;
   options.row_cache = immutable_db_options.row_cache;
+  options.hot_key_cache_size = immutable_db_options.hot_key_cache_size;
 #ifndef ROCKSDB_LITE
   options.wal_filter = immutable_db_options.wal_filter;
 #endif  // ROCKSDB_LITE
@@ -921,8 +929,19 @@ Status ParseCompressionOptions(const std::string& value, const std::string& name
       return Status::InvalidArgument(
           "unable to parse the specified CF option " + name);
     }
+    end = value.find(':', start);
     compression_opts.enabled =
-        ParseBoolean("", value.substr(start, value.size() - start));
+        ParseBoolean("", value.substr(start, end - start));
+  }
+  // parallel_threads is optional for backwards compatibility
+  if (end != std::string::npos) {
+    start = end + 1;
+    if (start >= value.size()) {
+      return Status::InvalidArgument(
+          "unable to parse the specified CF option " + name);
+    }
+    compression_opts.parallel_threads =
+        ParseUint32(value.substr(start, value.size() - start));
   }
   return Status::OK();
 }
@@ -1504,6 +1523,22 @@ std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct DBOptions, wal_recovery_mode),
           OptionType::kWALRecoveryMode, OptionVerificationType::kNormal, false,
           0}},
+        {"max_wal_recovery_threads",
+         {offsetof(struct DBOptions, max_wal_recovery_threads),
+          OptionType::kInt, OptionVerificationType::kNormal, false, 0}},
+        {"wal_compression",
+         {offsetof(struct DBOptions, wal_compression),
+          OptionType::kCompressionType, OptionVerificationType::kNormal, false,
+          0}},
+        {"hot_key_cache_size",
+         {offsetof(struct DBOptions, hot_key_cache_size), OptionType::kSizeT,
+          OptionVerificationType::kNormal, false, 0}},
+        {"enable_per_column_family_write_stall",
+         {offsetof(struct DBOptions, enable_per_column_family_write_stall),
+          OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
+        {"enable_write_stall_pacing",
+         {offsetof(struct DBOptions, enable_write_stall_pacing),
+          OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
         {"enable_write_thread_adaptive_yield",
          {offsetof(struct DBOptions, enable_write_thread_adaptive_yield),
           OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
@@ -1689,6 +1724,12 @@ std::unordered_map<std::string, OptionTypeInfo>
         {"optimize_filters_for_hits",
          {offset_of(&ColumnFamilyOptions::optimize_filters_for_hits),
           OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
+        {"row_cache_size",
+         {offset_of(&ColumnFamilyOptions::row_cache_size), OptionType::kSizeT,
+          OptionVerificationType::kNormal, false, 0}},
+        {"learned_level_index",
+         {offset_of(&ColumnFamilyOptions::learned_level_index),
+          OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
         {"paranoid_file_checks",
          {offset_of(&ColumnFamilyOptions::paranoid_file_checks),
           OptionType::kBoolean, OptionVerificationType::kNormal, true,
@@ -1847,6 +1888,15 @@ std::unordered_map<std::string, OptionTypeInfo>
               &ColumnFamilyOptions::memtable_insert_with_hint_prefix_extractor),
           OptionType::kSliceTransform, OptionVerificationType::kByNameAllowNull,
           false, 0}},
+        {"memtable_point_lookup_index",
+         {offset_of(&ColumnFamilyOptions::memtable_point_lookup_index),
+          OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
+        {"memtable_numa_aware_allocation",
+         {offset_of(&ColumnFamilyOptions::memtable_numa_aware_allocation),
+          OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
+        {"memtable_protection_bytes_per_key",
+         {offset_of(&ColumnFamilyOptions::memtable_protection_bytes_per_key),
+          OptionType::kSizeT, OptionVerificationType::kNormal, false, 0}},
         {"memtable_factory",
          {offset_of(&ColumnFamilyOptions::memtable_factory),
           OptionType::kMemTableRepFactory, OptionVerificationType::kByName,
@@ -154,7 +154,8 @@ TEST_F(OptionsSettableTest, BlockBasedTableOptionsAllFieldsSettable) {
       "hash_index_allow_collision=false;"
       "verify_compression=true;read_amp_bytes_per_bit=0;"
       "enable_index_compression=false;"
-      "block_align=true",
+      "block_align=true;"
+      "learned_index=true",
       new_bbto));
 
   ASSERT_EQ(unset_bytes_base,
@@ -276,6 +277,11 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
                              "enable_pipelined_write=false;"
                              "allow_concurrent_memtable_write=true;"
                              "wal_recovery_mode=kPointInTimeRecovery;"
+                             "max_wal_recovery_threads=4;"
+                             "wal_compression=kZSTD;"
+                             "enable_write_stall_pacing=true;"
+                             "enable_per_column_family_write_stall=true;"
+                             "hot_key_cache_size=1048576;"
                              "enable_write_thread_adaptive_yield=true;"
                              "write_thread_slow_yield_usec=5;"
                              "write_thread_max_yield_usec=1000;"
@@ -431,10 +437,15 @@ TEST_F(OptionsSettableTest, ColumnFamilyOptionsAllFieldsSettable) {
       "merge_operator=aabcxehazrMergeOperator;"
       "memtable_prefix_bloom_size_ratio=0.4642;"
       "memtable_insert_with_hint_prefix_extractor=rocksdb.CappedPrefix.13;"
+      "memtable_point_lookup_index=true;"
+      "memtable_numa_aware_allocation=true;"
+      "memtable_protection_bytes_per_key=4;"
       "paranoid_file_checks=true;"
       "force_consistency_checks=true;"
       "inplace_update_num_locks=7429;"
       "optimize_filters_for_hits=false;"
+      "row_cache_size=1048576;"
+      "learned_level_index=true;"
       "level_compaction_dynamic_level_bytes=false;"
       "inplace_update_support=false;"
       "compaction_style=kCompactionStyleFIFO;"
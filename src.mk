@@ -33,6 +33,7 @@ LIB_SOURCES =                                                   \
   db/flush_job.cc                                               \
   db/flush_scheduler.cc                                         \
   db/forward_iterator.cc                                        \
+  db/hot_key_cache.cc                                           \
   db/internal_stats.cc                                          \
   db/logs_with_prep_tracker.cc                                  \
   db/log_reader.cc                                              \
@@ -43,6 +44,7 @@ LIB_SOURCES =                                                   \
   db/merge_helper.cc                                            \
   db/merge_operator.cc                                          \
   db/range_del_aggregator.cc                                    \
+  db/range_tombstone_fragmenter.cc                              \
   db/repair.cc                                                  \
   db/snapshot_impl.cc                                           \
   db/table_cache.cc                                             \
@@ -64,6 +66,7 @@ LIB_SOURCES =                                                   \
   env/io_posix.cc                                               \
   env/mock_env.cc                                               \
   memtable/alloc_tracker.cc                                     \
+  memtable/artrep.cc                                            \
   memtable/hash_cuckoo_rep.cc                                   \
   memtable/hash_linklist_rep.cc                                 \
   memtable/hash_skiplist_rep.cc                                 \
@@ -110,6 +113,7 @@ LIB_SOURCES =                                                   \
   table/get_context.cc                                          \
   table/index_builder.cc                                        \
   table/iterator.cc                                             \
+  table/learned_index.cc                                        \
   table/merging_iterator.cc                                     \
   table/meta_blocks.cc                                          \
   table/partitioned_filter_block.cc                             \
@@ -155,6 +159,7 @@ LIB_SOURCES =                                                   \
   util/threadpool_imp.cc                                        \
   util/trace_replay.cc                                          \
   util/transaction_test_util.cc                                 \
+  util/xor_filter.cc                                            \
   util/xxhash.cc                                                \
   utilities/backupable/backupable_db.cc                         \
   utilities/blob_db/blob_compaction_filter.cc                   \
@@ -376,6 +381,7 @@ MAIN_SOURCES =                                                          \
   util/timer_queue_test.cc                                              \
   util/thread_list_test.cc                                              \
   util/thread_local_test.cc                                             \
+  util/xor_filter_test.cc                                               \
   utilities/backupable/backupable_db_test.cc                            \
   utilities/blob_db/blob_db_test.cc                                     \
   utilities/cassandra/cassandra_format_test.cc                          \
@@ -198,6 +198,8 @@ void IndexBlockIter::Seek(const Slice& target) {
   bool ok = false;
   if (prefix_index_) {
     ok = PrefixSeek(target, &index);
+  } else if (learned_index_) {
+    ok = LearnedSeek(seek_key, &index);
   } else {
     ok = BinarySeek(seek_key, 0, num_restarts_ - 1, &index, active_comparator_);
   }
@@ -421,6 +423,22 @@ bool BlockIter::BinarySeek(const Slice& target, uint32_t left, uint32_t right,
   return true;
 }
 
+// Binary search in the restart points the learned index predicts. The keys
+// next to them tell whether the prediction is right; if not, the search
+// covers the rest of the restart points on that side.
+bool IndexBlockIter::LearnedSeek(const Slice& target, uint32_t* index) {
+  uint32_t left, right;
+  learned_index_->Predict(key_includes_seq_ ? ExtractUserKey(target) : target,
+                          &left, &right);
+  if (left > 0 && CompareBlockKey(left, target) > 0) {
+    left = 0;
+  }
+  if (right < num_restarts_ - 1 && CompareBlockKey(right, target) < 0) {
+    right = num_restarts_ - 1;
+  }
+  return BinarySeek(target, left, right, index, active_comparator_);
+}
+
 // Compare target key and the block key of the block of `block_index`.
 // Return -1 if error.
 int IndexBlockIter::CompareBlockKey(uint32_t block_index, const Slice& target) {
@@ -27,6 +27,7 @@
 #include "rocksdb/statistics.h"
 #include "table/block_prefix_index.h"
 #include "table/internal_iterator.h"
+#include "table/learned_index.h"
 #include "util/random.h"
 #include "util/sync_point.h"
 #include "format.h"
@@ -414,7 +415,8 @@ class DataBlockIter final : public BlockIter {
 
 class IndexBlockIter final : public BlockIter {
  public:
-  IndexBlockIter() : BlockIter(), prefix_index_(nullptr) {}
+  IndexBlockIter()
+      : BlockIter(), prefix_index_(nullptr), learned_index_(nullptr) {}
 
   virtual Slice key() const override {
     assert(Valid());
@@ -441,6 +443,15 @@ class IndexBlockIter final : public BlockIter {
     active_comparator_ = key_includes_seq_ ? comparator_ : user_comparator;
     key_.SetIsUserKey(!key_includes_seq_);
     prefix_index_ = prefix_index;
+    learned_index_ = nullptr;
+  }
+
+  // Makes Seek() search around the restart point predicted by the model,
+  // which must have been built from the keys of the restart points.
+  void SetLearnedIndex(const LearnedIndex* learned_index) {
+    assert(learned_index == nullptr ||
+           learned_index->num_keys() == num_restarts_);
+    learned_index_ = learned_index;
   }
 
   virtual void Seek(const Slice& target) override;
@@ -468,6 +479,7 @@ class IndexBlockIter final : public BlockIter {
 
  private:
   bool PrefixSeek(const Slice& target, uint32_t* index);
+  bool LearnedSeek(const Slice& target, uint32_t* index);
   bool BinaryBlockIndexSeek(const Slice& target, uint32_t* block_ids,
                             uint32_t left, uint32_t right,
                             uint32_t* index);
@@ -488,6 +500,7 @@ class IndexBlockIter final : public BlockIter {
   // key_includes_seq_ ? comparator_ : user_comparator_
   const Comparator* active_comparator_;
   BlockPrefixIndex* prefix_index_;
+  const LearnedIndex* learned_index_;
 };
 
 }  // namespace rocksdb
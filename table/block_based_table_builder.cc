@@ -12,6 +12,7 @@
 #include <assert.h>
 #include <stdio.h>
 
+#include <deque>
 #include <list>
 #include <map>
 #include <memory>
@@ -20,6 +21,7 @@
 #include <utility>
 
 #include "db/dbformat.h"
+#include "port/port.h"
 
 #include "rocksdb/cache.h"
 #include "rocksdb/comparator.h"
@@ -61,13 +63,23 @@ namespace {
 
 // Create a filter block builder based on its type.
 FilterBlockBuilder* CreateFilterBlockBuilder(
-    const ImmutableCFOptions& /*opt*/, const MutableCFOptions& mopt,
-    const BlockBasedTableOptions& table_opt,
+    const ImmutableCFOptions& opt, const MutableCFOptions& mopt,
+    const BlockBasedTableOptions& table_opt, const int level_at_creation,
+    const int base_level, const std::vector<uint64_t>* level_bytes,
     PartitionedIndexBuilder* const p_index_builder) {
   if (table_opt.filter_policy == nullptr) return nullptr;
 
+  FilterBuildingContext context;
+  context.compaction_style = opt.compaction_style;
+  context.num_levels = opt.num_levels;
+  context.level_at_creation = level_at_creation;
+  context.level_size_multiplier = mopt.max_bytes_for_level_multiplier;
+  context.base_level = base_level;
+  if (level_bytes != nullptr) {
+    context.level_bytes = *level_bytes;
+  }
   FilterBitsBuilder* filter_bits_builder =
-      table_opt.filter_policy->GetFilterBitsBuilder();
+      table_opt.filter_policy->GetBuilderWithContext(context);
   if (filter_bits_builder == nullptr) {
     return new BlockBasedFilterBlockBuilder(mopt.prefix_extractor.get(),
                                             table_opt);
@@ -242,6 +254,83 @@ class BlockBasedTableBuilder::BlockBasedTablePropertiesCollector
   bool prefix_filtering_;
 };
 
+namespace {
+
+// Fills in the trailer of a block: its compression type, followed by the
+// checksum of the block contents and the type.
+void ComputeBlockTrailer(const Slice& block_contents, CompressionType type,
+                         ChecksumType checksum_type, char* trailer) {
+  trailer[0] = type;
+  char* trailer_without_type = trailer + 1;
+  switch (checksum_type) {
+    case kNoChecksum:
+      EncodeFixed32(trailer_without_type, 0);
+      break;
+    case kCRC32c: {
+      auto crc = crc32c::Value(block_contents.data(), block_contents.size());
+      crc = crc32c::Extend(crc, trailer, 1);  // Extend to cover block type
+      EncodeFixed32(trailer_without_type, crc32c::Mask(crc));
+      break;
+    }
+    case kxxHash: {
+      void* xxh = XXH32_init(0);
+      XXH32_update(xxh, block_contents.data(),
+                   static_cast<uint32_t>(block_contents.size()));
+      XXH32_update(xxh, trailer, 1);  // Extend  to cover block type
+      EncodeFixed32(trailer_without_type, XXH32_digest(xxh));
+      break;
+    }
+  }
+}
+
+}  // namespace
+
+// State of the compression threads, used when
+// CompressionOptions::parallel_threads > 1. Data blocks are queued in file
+// order; the workers compress and checksum them in any order, and the thread
+// driving the builder writes them out from the front of the queue.
+struct BlockBasedTableBuilder::ParallelCompressionRep {
+  struct BlockRep {
+    std::string raw;
+    std::string compressed_output;
+    // Either raw or compressed_output
+    Slice contents;
+    CompressionType type = kNoCompression;
+    char trailer[kBlockTrailerSize];
+    Status status;
+    // Keys for the index entry of the block
+    std::string last_key;
+    std::string next_key;
+    bool has_next_key = false;
+    bool done = false;
+  };
+
+  explicit ParallelCompressionRep(uint32_t parallel_threads)
+      : work_cv(&mu),
+        done_cv(&mu),
+        max_queued_blocks(2 * static_cast<size_t>(parallel_threads)) {}
+
+  port::Mutex mu;
+  // Signalled when a block is queued, or the workers have to stop
+  port::CondVar work_cv;
+  // Signalled when a block has been compressed
+  port::CondVar done_cv;
+  // Blocks not yet picked up by a worker
+  std::deque<BlockRep*> to_compress;
+  // Blocks not yet written to the file, in file order
+  std::deque<std::unique_ptr<BlockRep>> queue;
+  const size_t max_queued_blocks;
+  bool stop = false;
+  std::vector<port::Thread> workers;
+
+  // Uncompressed bytes in queue, and uncompressed and written bytes of the
+  // data blocks written so far, to estimate the file size. Only accessed by
+  // the thread driving the builder.
+  uint64_t raw_bytes_queued = 0;
+  uint64_t raw_bytes_written = 0;
+  uint64_t bytes_written = 0;
+};
+
 struct BlockBasedTableBuilder::Rep {
   const ImmutableCFOptions ioptions;
   const MutableCFOptions moptions;
@@ -261,6 +350,7 @@ struct BlockBasedTableBuilder::Rep {
   std::string last_key;
   // Compression dictionary or nullptr
   const std::string* compression_dict;
+  const CompressionOptions compression_opts;
   CompressionContext compression_ctx;
   std::unique_ptr<UncompressionContext> verify_ctx;
   TableProperties props;
@@ -281,6 +371,8 @@ struct BlockBasedTableBuilder::Rep {
 
   std::vector<std::unique_ptr<IntTblPropCollector>> table_properties_collectors;
 
+  std::unique_ptr<ParallelCompressionRep> pc_rep;
+
   Rep(const ImmutableCFOptions& _ioptions, const MutableCFOptions& _moptions,
       const BlockBasedTableOptions& table_opt,
       const InternalKeyComparator& icomparator,
@@ -291,7 +383,8 @@ struct BlockBasedTableBuilder::Rep {
       const CompressionOptions& _compression_opts,
       const std::string* _compression_dict, const bool skip_filters,
       const std::string& _column_family_name, const uint64_t _creation_time,
-      const uint64_t _oldest_key_time)
+      const uint64_t _oldest_key_time, const int level_at_creation,
+      const int base_level, const std::vector<uint64_t>* level_bytes)
       : ioptions(_ioptions),
         moptions(_moptions),
         table_options(table_opt),
@@ -305,6 +398,7 @@ struct BlockBasedTableBuilder::Rep {
         range_del_block(1 /* block_restart_interval */),
         internal_prefix_transform(_moptions.prefix_extractor.get()),
         compression_dict(_compression_dict),
+        compression_opts(_compression_opts),
         compression_ctx(_compression_type, _compression_opts),
         compressed_cache_key_prefix_size(0),
         flush_block_policy(
@@ -327,8 +421,10 @@ struct BlockBasedTableBuilder::Rep {
     if (skip_filters) {
       filter_builder = nullptr;
     } else {
-      filter_builder.reset(CreateFilterBlockBuilder(
-          _ioptions, _moptions, table_options, p_index_builder_));
+      filter_builder.reset(
+          CreateFilterBlockBuilder(_ioptions, _moptions, table_options,
+                                   level_at_creation, base_level, level_bytes,
+                                   p_index_builder_));
     }
 
     for (auto& collector_factories : *int_tbl_prop_collector_factories) {
@@ -362,7 +458,8 @@ BlockBasedTableBuilder::BlockBasedTableBuilder(
     const CompressionOptions& compression_opts,
     const std::string* compression_dict, const bool skip_filters,
     const std::string& column_family_name, const uint64_t creation_time,
-    const uint64_t oldest_key_time) {
+    const uint64_t oldest_key_time, const int level_at_creation,
+    const int base_level, const std::vector<uint64_t>* level_bytes) {
   BlockBasedTableOptions sanitized_table_options(table_options);
   if (sanitized_table_options.format_version == 0 &&
       sanitized_table_options.checksum != kCRC32c) {
@@ -379,11 +476,27 @@ BlockBasedTableBuilder::BlockBasedTableBuilder(
       new Rep(ioptions, moptions, sanitized_table_options, internal_comparator,
               int_tbl_prop_collector_factories, column_family_id, file,
               compression_type, compression_opts, compression_dict,
-              skip_filters, column_family_name, creation_time, oldest_key_time);
+              skip_filters, column_family_name, creation_time, oldest_key_time,
+              level_at_creation, base_level, level_bytes);
 
   if (rep_->filter_builder != nullptr) {
     rep_->filter_builder->StartBlock(0);
   }
+  // The index entry of a data block is only added once the block is written,
+  // after keys of later blocks have been passed to the index and filter
+  // builders. Only the plain index and full filters don't mind.
+  if (compression_opts.parallel_threads > 1 &&
+      sanitized_table_options.index_type ==
+          BlockBasedTableOptions::kBinarySearch &&
+      (rep_->filter_builder == nullptr ||
+       !rep_->filter_builder->IsBlockBased())) {
+    rep_->pc_rep.reset(
+        new ParallelCompressionRep(compression_opts.parallel_threads));
+    for (uint32_t i = 0; i < compression_opts.parallel_threads; i++) {
+      rep_->pc_rep->workers.emplace_back(
+          &BlockBasedTableBuilder::CompressionWorker, this);
+    }
+  }
   if (table_options.block_cache_compressed.get() != nullptr) {
     BlockBasedTable::GenerateCachePrefix(
         table_options.block_cache_compressed.get(), file->writable_file(),
@@ -394,6 +507,7 @@ BlockBasedTableBuilder::BlockBasedTableBuilder(
 
 BlockBasedTableBuilder::~BlockBasedTableBuilder() {
   assert(rep_->closed);  // Catch errors where caller forgot to call Finish()
+  StopCompressionWorkers();
   delete rep_;
 }
 
@@ -408,7 +522,10 @@ void BlockBasedTableBuilder::Add(const Slice& key, const Slice& value) {
     }
 
     auto should_flush = r->flush_block_policy->Update(key, value);
-    if (should_flush) {
+    if (should_flush && r->pc_rep != nullptr) {
+      assert(!r->data_block.empty());
+      EnqueueDataBlock(&key);
+    } else if (should_flush) {
       assert(!r->data_block.empty());
       Flush();
 
@@ -485,7 +602,22 @@ void BlockBasedTableBuilder::WriteBlock(const Slice& raw_block_contents,
   assert(ok());
   Rep* r = rep_;
 
-  auto type = r->compression_ctx.type();
+  CompressionType type;
+  Slice block_contents = CompressAndVerifyBlock(
+      raw_block_contents, is_data_block, r->compression_ctx,
+      r->verify_ctx.get(), &r->compressed_output, &type, &r->status);
+  WriteRawBlock(block_contents, type, handle, is_data_block);
+  r->compressed_output.clear();
+}
+
+Slice BlockBasedTableBuilder::CompressAndVerifyBlock(
+    const Slice& raw_block_contents, bool is_data_block,
+    CompressionContext& compression_ctx, UncompressionContext* verify_ctx,
+    std::string* compressed_output, CompressionType* type,
+    Status* status) const {
+  Rep* r = rep_;
+
+  *type = compression_ctx.type();
   Slice block_contents;
   bool abort_compression = false;
 
@@ -495,32 +627,32 @@ void BlockBasedTableBuilder::WriteBlock(const Slice& raw_block_contents,
   if (raw_block_contents.size() < kCompressionSizeLimit) {
     Slice compression_dict;
     if (is_data_block && r->compression_dict && r->compression_dict->size()) {
-      r->compression_ctx.dict() = *r->compression_dict;
+      compression_ctx.dict() = *r->compression_dict;
       if (r->table_options.verify_compression) {
-        assert(r->verify_ctx != nullptr);
-        r->verify_ctx->dict() = *r->compression_dict;
+        assert(verify_ctx != nullptr);
+        verify_ctx->dict() = *r->compression_dict;
       }
     } else {
       // Clear dictionary
-      r->compression_ctx.dict() = Slice();
+      compression_ctx.dict() = Slice();
       if (r->table_options.verify_compression) {
-        assert(r->verify_ctx != nullptr);
-        r->verify_ctx->dict() = Slice();
+        assert(verify_ctx != nullptr);
+        verify_ctx->dict() = Slice();
       }
     }
 
     block_contents =
-        CompressBlock(raw_block_contents, r->compression_ctx, &type,
-                      r->table_options.format_version, &r->compressed_output);
+        CompressBlock(raw_block_contents, compression_ctx, type,
+                      r->table_options.format_version, compressed_output);
 
     // Some of the compression algorithms are known to be unreliable. If
     // the verify_compression flag is set then try to de-compress the
     // compressed data and compare to the input.
-    if (type != kNoCompression && r->table_options.verify_compression) {
+    if (*type != kNoCompression && r->table_options.verify_compression) {
       // Retrieve the uncompressed contents into a new buffer
       BlockContents contents;
       Status stat = UncompressBlockContentsForCompressionType(
-          *r->verify_ctx, block_contents.data(), block_contents.size(),
+          *verify_ctx, block_contents.data(), block_contents.size(),
           &contents, r->table_options.format_version, r->ioptions);
 
       if (stat.ok()) {
@@ -530,12 +662,12 @@ void BlockBasedTableBuilder::WriteBlock(const Slice& raw_block_contents,
           abort_compression = true;
           ROCKS_LOG_ERROR(r->ioptions.info_log,
                           "Decompressed block did not match raw block");
-          r->status =
+          *status =
               Status::Corruption("Decompressed block did not match raw block");
         }
       } else {
         // Decompression reported an error. abort.
-        r->status = Status::Corruption("Could not decompress");
+        *status = Status::Corruption("Could not decompress");
         abort_compression = true;
       }
     }
@@ -548,9 +680,9 @@ void BlockBasedTableBuilder::WriteBlock(const Slice& raw_block_contents,
   // verification.
   if (abort_compression) {
     RecordTick(r->ioptions.statistics, NUMBER_BLOCK_NOT_COMPRESSED);
-    type = kNoCompression;
+    *type = kNoCompression;
     block_contents = raw_block_contents;
-  } else if (type != kNoCompression) {
+  } else if (*type != kNoCompression) {
     if (ShouldReportDetailedTime(r->ioptions.env, r->ioptions.statistics)) {
       MeasureTime(r->ioptions.statistics, COMPRESSION_TIMES_NANOS,
                   timer.ElapsedNanos());
@@ -559,15 +691,14 @@ void BlockBasedTableBuilder::WriteBlock(const Slice& raw_block_contents,
                 raw_block_contents.size());
     RecordTick(r->ioptions.statistics, NUMBER_BLOCK_COMPRESSED);
   }
-
-  WriteRawBlock(block_contents, type, handle, is_data_block);
-  r->compressed_output.clear();
+  return block_contents;
 }
 
 void BlockBasedTableBuilder::WriteRawBlock(const Slice& block_contents,
                                            CompressionType type,
                                            BlockHandle* handle,
-                                           bool is_data_block) {
+                                           bool is_data_block,
+                                           const char* trailer) {
   Rep* r = rep_;
   StopWatch sw(r->ioptions.env, r->ioptions.statistics, WRITE_RAW_BLOCK_MICROS);
   handle->set_offset(r->offset);
@@ -575,27 +706,11 @@ void BlockBasedTableBuilder::WriteRawBlock(const Slice& block_contents,
   assert(r->status.ok());
   r->status = r->file->Append(block_contents);
   if (r->status.ok()) {
-    char trailer[kBlockTrailerSize];
-    trailer[0] = type;
-    char* trailer_without_type = trailer + 1;
-    switch (r->table_options.checksum) {
-      case kNoChecksum:
-        EncodeFixed32(trailer_without_type, 0);
-        break;
-      case kCRC32c: {
-        auto crc = crc32c::Value(block_contents.data(), block_contents.size());
-        crc = crc32c::Extend(crc, trailer, 1);  // Extend to cover block type
-        EncodeFixed32(trailer_without_type, crc32c::Mask(crc));
-        break;
-      }
-      case kxxHash: {
-        void* xxh = XXH32_init(0);
-        XXH32_update(xxh, block_contents.data(),
-                     static_cast<uint32_t>(block_contents.size()));
-        XXH32_update(xxh, trailer, 1);  // Extend  to cover block type
-        EncodeFixed32(trailer_without_type, XXH32_digest(xxh));
-        break;
-      }
+    char computed_trailer[kBlockTrailerSize];
+    if (trailer == nullptr) {
+      ComputeBlockTrailer(block_contents, type, r->table_options.checksum,
+                          computed_trailer);
+      trailer = computed_trailer;
     }
 
     assert(r->status.ok());
@@ -619,6 +734,132 @@ void BlockBasedTableBuilder::WriteRawBlock(const Slice& block_contents,
   }
 }
 
+void BlockBasedTableBuilder::EnqueueDataBlock(const Slice* next_key) {
+  Rep* r = rep_;
+  ParallelCompressionRep* pc = r->pc_rep.get();
+  assert(pc != nullptr);
+  std::unique_ptr<ParallelCompressionRep::BlockRep> block(
+      new ParallelCompressionRep::BlockRep());
+  block->raw = r->data_block.Finish().ToString();
+  r->data_block.Reset();
+  block->last_key = r->last_key;
+  if (next_key != nullptr) {
+    block->next_key = next_key->ToString();
+    block->has_next_key = true;
+  }
+  pc->raw_bytes_queued += block->raw.size();
+  {
+    MutexLock lock(&pc->mu);
+    pc->to_compress.push_back(block.get());
+    pc->queue.push_back(std::move(block));
+    pc->work_cv.Signal();
+  }
+  WriteCompressedDataBlocks(false /* wait_for_all */);
+}
+
+void BlockBasedTableBuilder::WriteCompressedDataBlocks(bool wait_for_all) {
+  Rep* r = rep_;
+  ParallelCompressionRep* pc = r->pc_rep.get();
+  assert(pc != nullptr);
+  while (true) {
+    std::unique_ptr<ParallelCompressionRep::BlockRep> block;
+    {
+      MutexLock lock(&pc->mu);
+      if (pc->queue.empty()) {
+        return;
+      }
+      while (!pc->queue.front()->done) {
+        if (!wait_for_all && pc->queue.size() <= pc->max_queued_blocks) {
+          return;
+        }
+        pc->done_cv.Wait();
+      }
+      block = std::move(pc->queue.front());
+      pc->queue.pop_front();
+    }
+    pc->raw_bytes_queued -= block->raw.size();
+    if (!ok()) {
+      continue;
+    }
+    if (!block->status.ok()) {
+      r->status = block->status;
+      continue;
+    }
+    uint64_t offset = r->offset;
+    WriteRawBlock(block->contents, block->type, &r->pending_handle,
+                  true /* is_data_block */, block->trailer);
+    if (!ok()) {
+      continue;
+    }
+    pc->raw_bytes_written += block->raw.size();
+    pc->bytes_written += r->offset - offset;
+    if (r->filter_builder != nullptr) {
+      r->filter_builder->StartBlock(r->offset);
+    }
+    r->props.data_size = r->offset;
+    ++r->props.num_data_blocks;
+    Slice next_key(block->next_key);
+    r->index_builder->AddIndexEntry(&block->last_key,
+                                    block->has_next_key ? &next_key : nullptr,
+                                    r->pending_handle);
+  }
+}
+
+void BlockBasedTableBuilder::CompressionWorker() {
+  Rep* r = rep_;
+  ParallelCompressionRep* pc = r->pc_rep.get();
+  CompressionContext compression_ctx(r->compression_ctx.type(),
+                                     r->compression_opts);
+  std::unique_ptr<UncompressionContext> verify_ctx;
+  if (r->table_options.verify_compression) {
+    verify_ctx.reset(new UncompressionContext(UncompressionContext::NoCache(),
+                                              compression_ctx.type()));
+  }
+  while (true) {
+    ParallelCompressionRep::BlockRep* block;
+    {
+      MutexLock lock(&pc->mu);
+      while (pc->to_compress.empty() && !pc->stop) {
+        pc->work_cv.Wait();
+      }
+      if (pc->to_compress.empty()) {
+        return;
+      }
+      block = pc->to_compress.front();
+      pc->to_compress.pop_front();
+    }
+    block->contents = CompressAndVerifyBlock(
+        block->raw, true /* is_data_block */, compression_ctx,
+        verify_ctx.get(), &block->compressed_output, &block->type,
+        &block->status);
+    ComputeBlockTrailer(block->contents, block->type,
+                        r->table_options.checksum, block->trailer);
+    {
+      MutexLock lock(&pc->mu);
+      block->done = true;
+      pc->done_cv.SignalAll();
+    }
+  }
+}
+
+void BlockBasedTableBuilder::StopCompressionWorkers() {
+  ParallelCompressionRep* pc = rep_->pc_rep.get();
+  if (pc == nullptr) {
+    return;
+  }
+  {
+    MutexLock lock(&pc->mu);
+    pc->stop = true;
+    // Blocks that nobody is going to write are not worth compressing.
+    pc->to_compress.clear();
+    pc->work_cv.SignalAll();
+  }
+  for (auto& worker : pc->workers) {
+    worker.join();
+  }
+  pc->workers.clear();
+}
+
 Status BlockBasedTableBuilder::status() const {
   return rep_->status;
 }
@@ -840,15 +1081,25 @@ void BlockBasedTableBuilder::WriteRangeDelBlock(
 Status BlockBasedTableBuilder::Finish() {
   Rep* r = rep_;
   bool empty_data_block = r->data_block.empty();
-  Flush();
-  assert(!r->closed);
-  r->closed = true;
-
-  // To make sure properties block is able to keep the accurate size of index
-  // block, we will finish writing all index entries first.
-  if (ok() && !empty_data_block) {
-    r->index_builder->AddIndexEntry(
-        &r->last_key, nullptr /* no next data block */, r->pending_handle);
+  if (r->pc_rep != nullptr) {
+    if (ok() && !empty_data_block) {
+      EnqueueDataBlock(nullptr /* no next data block */);
+    }
+    WriteCompressedDataBlocks(true /* wait_for_all */);
+    StopCompressionWorkers();
+    assert(!r->closed);
+    r->closed = true;
+  } else {
+    Flush();
+    assert(!r->closed);
+    r->closed = true;
+
+    // To make sure properties block is able to keep the accurate size of
+    // index block, we will finish writing all index entries first.
+    if (ok() && !empty_data_block) {
+      r->index_builder->AddIndexEntry(
+          &r->last_key, nullptr /* no next data block */, r->pending_handle);
+    }
   }
 
   // Write meta blocks and metaindex block with the following order.
@@ -905,6 +1156,7 @@ Status BlockBasedTableBuilder::Finish() {
 void BlockBasedTableBuilder::Abandon() {
   Rep* r = rep_;
   assert(!r->closed);
+  StopCompressionWorkers();
   r->closed = true;
 }
 
@@ -913,7 +1165,18 @@ uint64_t BlockBasedTableBuilder::NumEntries() const {
 }
 
 uint64_t BlockBasedTableBuilder::FileSize() const {
-  return rep_->offset;
+  const ParallelCompressionRep* pc = rep_->pc_rep.get();
+  if (pc == nullptr || pc->raw_bytes_queued == 0) {
+    return rep_->offset;
+  }
+  // Count the blocks still being compressed at the compression ratio of the
+  // blocks written so far.
+  if (pc->raw_bytes_written == 0) {
+    return rep_->offset + pc->raw_bytes_queued;
+  }
+  return rep_->offset + static_cast<uint64_t>(
+                            static_cast<double>(pc->raw_bytes_queued) *
+                            pc->bytes_written / pc->raw_bytes_written);
 }
 
 bool BlockBasedTableBuilder::NeedCompact() const {
@@ -50,7 +50,9 @@ class BlockBasedTableBuilder : public TableBuilder {
       const CompressionOptions& compression_opts,
       const std::string* compression_dict, const bool skip_filters,
       const std::string& column_family_name, const uint64_t creation_time = 0,
-      const uint64_t oldest_key_time = 0);
+      const uint64_t oldest_key_time = 0, const int level_at_creation = -1,
+      const int base_level = -1,
+      const std::vector<uint64_t>* level_bytes = nullptr);
 
   // REQUIRES: Either Finish() or Abandon() has been called.
   ~BlockBasedTableBuilder();
@@ -101,9 +103,21 @@ class BlockBasedTableBuilder : public TableBuilder {
   // Compress and write block content to the file.
   void WriteBlock(const Slice& block_contents, BlockHandle* handle,
                   bool is_data_block);
-  // Directly write data to the file.
+  // Compress block content with compression_ctx, and check the result with
+  // verify_ctx if verify_compression is set. Returns the content to write,
+  // which is either raw_block_contents or in *compressed_output. Safe to call
+  // from several threads with different contexts and outputs.
+  Slice CompressAndVerifyBlock(const Slice& raw_block_contents,
+                               bool is_data_block,
+                               CompressionContext& compression_ctx,
+                               UncompressionContext* verify_ctx,
+                               std::string* compressed_output,
+                               CompressionType* type, Status* status) const;
+  // Directly write data to the file. trailer, if not nullptr, is the
+  // already computed block trailer.
   void WriteRawBlock(const Slice& data, CompressionType, BlockHandle* handle,
-                     bool is_data_block = false);
+                     bool is_data_block = false,
+                     const char* trailer = nullptr);
   Status InsertBlockInCache(const Slice& block_contents,
                             const CompressionType type,
                             const BlockHandle* handle);
@@ -115,7 +129,19 @@ class BlockBasedTableBuilder : public TableBuilder {
   void WriteCompressionDictBlock(MetaIndexBuilder* meta_index_builder);
   void WriteRangeDelBlock(MetaIndexBuilder* meta_index_builder);
 
+  // Hand the current data block to the compression threads. next_key is the
+  // first key of the following data block, or nullptr for the last one.
+  void EnqueueDataBlock(const Slice* next_key);
+  // Write out the data blocks at the front of the compression queue that are
+  // compressed, together with their index entries. Waits for more blocks to
+  // finish while the queue is full, or until it is empty if wait_for_all is
+  // set.
+  void WriteCompressedDataBlocks(bool wait_for_all);
+  void CompressionWorker();
+  void StopCompressionWorkers();
+
   struct Rep;
+  struct ParallelCompressionRep;
   class BlockBasedTablePropertiesCollectorFactory;
   class BlockBasedTablePropertiesCollector;
   Rep* rep_;
@@ -219,7 +219,8 @@ TableBuilder* BlockBasedTableFactory::NewTableBuilder(
       table_builder_options.skip_filters,
       table_builder_options.column_family_name,
       table_builder_options.creation_time,
-      table_builder_options.oldest_key_time);
+      table_builder_options.oldest_key_time, table_builder_options.level,
+      table_builder_options.base_level, &table_builder_options.level_bytes);
 
   return table_builder;
 }
@@ -376,6 +377,9 @@ std::string BlockBasedTableFactory::GetPrintableTableOptions() const {
   snprintf(buffer, kBufferSize, "  block_align: %d\n",
            table_options_.block_align);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  learned_index: %d\n",
+           table_options_.learned_index);
+  ret.append(buffer);
   return ret;
 }
 
@@ -472,7 +476,7 @@ std::string ParseBlockBasedTableOption(const std::string& name,
       return "";
     } else if (name == "filter_policy") {
       // Expect the following format
-      // bloomfilter:int:bool
+      // bloomfilter:int:bool[:bool]
       const std::string kName = "bloomfilter:";
       if (value.compare(0, kName.size(), kName) != 0) {
         return "Invalid filter policy name";
@@ -483,10 +487,18 @@ std::string ParseBlockBasedTableOption(const std::string& name,
       }
       int bits_per_key =
           ParseInt(trim(value.substr(kName.size(), pos - kName.size())));
-      bool use_block_based_builder =
-          ParseBoolean("use_block_based_builder", trim(value.substr(pos + 1)));
-      new_options->filter_policy.reset(
-          NewBloomFilterPolicy(bits_per_key, use_block_based_builder));
+      size_t split_block_pos = value.find(':', pos + 1);
+      bool use_block_based_builder = ParseBoolean(
+          "use_block_based_builder",
+          trim(value.substr(pos + 1, split_block_pos == std::string::npos
+                                         ? std::string::npos
+                                         : split_block_pos - pos - 1)));
+      bool use_split_block_filter =
+          split_block_pos != std::string::npos &&
+          ParseBoolean("use_split_block_filter",
+                       trim(value.substr(split_block_pos + 1)));
+      new_options->filter_policy.reset(NewBloomFilterPolicy(
+          bits_per_key, use_block_based_builder, use_split_block_filter));
       return "";
     }
   }
@@ -605,6 +617,7 @@ const std::string BlockBasedTablePropertyNames::kWholeKeyFiltering =
 const std::string BlockBasedTablePropertyNames::kPrefixFiltering =
     "rocksdb.block.based.table.prefix.filtering";
 const std::string kHashIndexPrefixesBlock = "rocksdb.hashindex.prefixes";
+const std::string kLearnedIndexBlock = "rocksdb.learned.index";
 const std::string kHashIndexPrefixesMetadataBlock =
     "rocksdb.hashindex.metadata";
 const std::string kPropTrue = "1";
@@ -84,6 +84,7 @@ class BlockBasedTableFactory : public TableFactory {
 };
 
 extern const std::string kHashIndexPrefixesBlock;
+extern const std::string kLearnedIndexBlock;
 extern const std::string kHashIndexPrefixesMetadataBlock;
 extern const std::string kPropTrue;
 extern const std::string kPropFalse;
@@ -180,6 +181,9 @@ static std::unordered_map<std::string, OptionTypeInfo>
         {"block_align",
          {offsetof(struct BlockBasedTableOptions, block_align),
           OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
+        {"learned_index",
+         {offsetof(struct BlockBasedTableOptions, learned_index),
+          OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
         {"pin_top_level_index_and_filter",
          {offsetof(struct BlockBasedTableOptions,
                    pin_top_level_index_and_filter),
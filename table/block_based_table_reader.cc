@@ -17,6 +17,7 @@
 
 #include "db/dbformat.h"
 #include "db/pinned_iterators_manager.h"
+#include "db/range_tombstone_fragmenter.h"
 
 #include "rocksdb/cache.h"
 #include "rocksdb/comparator.h"
@@ -55,6 +56,7 @@ namespace rocksdb {
 
 extern const uint64_t kBlockBasedTableMagicNumber;
 extern const std::string kHashIndexPrefixesBlock;
+extern const std::string kLearnedIndexBlock;
 extern const std::string kHashIndexPrefixesMetadataBlock;
 using std::unique_ptr;
 
@@ -404,7 +406,9 @@ class BinarySearchIndexReader : public IndexReader {
                        const InternalKeyComparator* icomparator,
                        IndexReader** index_reader,
                        const PersistentCacheOptions& cache_options,
-                       const bool index_key_includes_seq) {
+                       const bool index_key_includes_seq,
+                       const BlockHandle& learned_index_handle =
+                           BlockHandle::NullBlockHandle()) {
     std::unique_ptr<Block> index_block;
     auto s = ReadBlockFromFile(
         file, prefetch_buffer, footer, ReadOptions(), index_handle,
@@ -413,9 +417,27 @@ class BinarySearchIndexReader : public IndexReader {
         kDisableGlobalSequenceNumber, 0 /* read_amp_bytes_per_bit */);
 
     if (s.ok()) {
-      *index_reader = new BinarySearchIndexReader(
+      auto new_index_reader = new BinarySearchIndexReader(
           icomparator, std::move(index_block), ioptions.statistics,
           index_key_includes_seq);
+      *index_reader = new_index_reader;
+
+      // Failing to load the learned index is not an error; lookups then
+      // binary search the whole index block.
+      if (!learned_index_handle.IsNull()) {
+        BlockContents contents;
+        BlockFetcher block_fetcher(
+            file, prefetch_buffer, footer, ReadOptions(), learned_index_handle,
+            &contents, ioptions, true /* decompress */,
+            Slice() /*compression dict*/, cache_options);
+        std::unique_ptr<LearnedIndex> learned_index(new LearnedIndex());
+        if (block_fetcher.ReadBlockContents().ok() &&
+            learned_index->DecodeFrom(contents.data).ok() &&
+            learned_index->num_keys() ==
+                new_index_reader->index_block_->NumRestarts()) {
+          new_index_reader->learned_index_ = std::move(learned_index);
+        }
+      }
     }
 
     return s;
@@ -425,9 +447,13 @@ class BinarySearchIndexReader : public IndexReader {
                                         bool /*dont_care*/ = true,
                                         bool /*dont_care*/ = true) override {
     Statistics* kNullStats = nullptr;
-    return index_block_->NewIterator<IndexBlockIter>(
+    IndexBlockIter* index_iter = index_block_->NewIterator<IndexBlockIter>(
         icomparator_, icomparator_->user_comparator(), iter, kNullStats, true,
         index_key_includes_seq_);
+    if (learned_index_ != nullptr && index_iter->status().ok()) {
+      index_iter->SetLearnedIndex(learned_index_.get());
+    }
+    return index_iter;
   }
 
   virtual size_t size() const override { return index_block_->size(); }
@@ -443,6 +469,9 @@ class BinarySearchIndexReader : public IndexReader {
 #else
     usage += sizeof(*this);
 #endif  // ROCKSDB_MALLOC_USABLE_SIZE
+    if (learned_index_ != nullptr) {
+      usage += learned_index_->ApproximateMemoryUsage();
+    }
     return usage;
   }
 
@@ -457,6 +486,7 @@ class BinarySearchIndexReader : public IndexReader {
   }
   std::unique_ptr<Block> index_block_;
   const bool index_key_includes_seq_;
+  std::unique_ptr<LearnedIndex> learned_index_;
 };
 
 // Index that leverages an internal hash table to quicken the lookup for a given
@@ -991,6 +1021,13 @@ Status BlockBasedTable::Open(const ImmutableCFOptions& ioptions,
     }
   }
 
+  // The learned index, if any, is read along with the index block
+  if (!FindMetaBlock(meta_iter.get(), kLearnedIndexBlock,
+                     &rep->learned_index_handle)
+           .ok()) {
+    rep->learned_index_handle = BlockHandle::NullBlockHandle();
+  }
+
   bool need_upper_bound_check =
       PrefixExtractorChanged(rep->table_properties.get(), prefix_extractor);
 
@@ -1099,6 +1136,22 @@ Status BlockBasedTable::Open(const ImmutableCFOptions& ioptions,
     }
   }
 
+  if (s.ok() && !rep->range_del_handle.IsNull()) {
+    // Fragment the range deletions once for all point lookups. If that fails,
+    // they go through NewRangeTombstoneIterator(), which reports the error.
+    std::unique_ptr<InternalIterator> range_del_iter(
+        new_table->NewRangeTombstoneIterator(ReadOptions()));
+    Status fragment_status = FragmentedRangeTombstoneList::Create(
+        range_del_iter.get(), rep->internal_comparator.user_comparator(),
+        &rep->fragmented_range_dels);
+    if (!fragment_status.ok()) {
+      ROCKS_LOG_WARN(rep->ioptions.info_log,
+                     "Error when fragmenting range delete tombstones: %s",
+                     fragment_status.ToString().c_str());
+      rep->fragmented_range_dels.reset();
+    }
+  }
+
   if (s.ok()) {
     assert(prefetch_buffer.get() != nullptr);
     if (tail_prefetch_stats != nullptr) {
@@ -2123,6 +2176,16 @@ void BlockBasedTableIterator<TBlockIter>::Next() {
   FindKeyForward();
 }
 
+template <class TBlockIter>
+bool BlockBasedTableIterator<TBlockIter>::NextAndGetResult(Slice* ret_key) {
+  BlockBasedTableIterator::Next();
+  bool is_valid = BlockBasedTableIterator::Valid();
+  if (is_valid) {
+    *ret_key = BlockBasedTableIterator::key();
+  }
+  return is_valid;
+}
+
 template <class TBlockIter>
 void BlockBasedTableIterator<TBlockIter>::Prev() {
   assert(block_iter_points_to_real_block_);
@@ -2304,6 +2367,11 @@ InternalIterator* BlockBasedTable::NewRangeTombstoneIterator(
   return NewDataBlockIterator<DataBlockIter>(rep_, read_options, Slice(str));
 }
 
+std::shared_ptr<const FragmentedRangeTombstoneList>
+BlockBasedTable::GetFragmentedRangeTombstones() {
+  return rep_->fragmented_range_dels;
+}
+
 bool BlockBasedTable::FullFilterKeyMayMatch(
     const ReadOptions& read_options, FilterBlockReader* filter,
     const Slice& internal_key, const bool no_io,
@@ -2444,6 +2512,215 @@ Status BlockBasedTable::Get(const ReadOptions& read_options, const Slice& key,
   return s;
 }
 
+void BlockBasedTable::MultiGet(const ReadOptions& read_options,
+                               const std::vector<Slice>& keys,
+                               const std::vector<GetContext*>& get_contexts,
+                               const SliceTransform* prefix_extractor,
+                               std::vector<Status>* statuses,
+                               bool skip_filters) {
+  statuses->assign(keys.size(), Status::OK());
+  if (keys.empty()) {
+    return;
+  }
+  const bool no_io = read_options.read_tier == kBlockCacheTier;
+  CachableEntry<FilterBlockReader> filter_entry;
+  if (!skip_filters) {
+    filter_entry =
+        GetFilter(prefix_extractor, /*prefetch_buffer*/ nullptr,
+                  read_options.read_tier == kBlockCacheTier, get_contexts[0]);
+  }
+  FilterBlockReader* filter = filter_entry.value;
+
+  // Check the full filter for all keys first, so that only the keys that may
+  // be in the table search the index
+  autovector<size_t> may_match;
+  if (filter != nullptr && !filter->IsBlockBased() &&
+      filter->whole_key_filtering()) {
+    // Probe the filter for all keys together
+    std::vector<Slice> user_keys;
+    std::vector<Slice*> user_key_ptrs;
+    user_keys.reserve(keys.size());
+    user_key_ptrs.reserve(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+      assert(keys[i].size() >= 8);  // key must be internal key
+      user_keys.push_back(ExtractUserKey(keys[i]));
+      user_key_ptrs.push_back(&user_keys.back());
+    }
+    std::unique_ptr<bool[]> key_may_match(new bool[keys.size()]);
+    filter->MultiKeyMayMatch(static_cast<int>(keys.size()),
+                             user_key_ptrs.data(), keys.data(),
+                             prefix_extractor, no_io, key_may_match.get());
+    for (size_t i = 0; i < keys.size(); ++i) {
+      if (key_may_match[i]) {
+        RecordTick(rep_->ioptions.statistics, BLOOM_FILTER_FULL_POSITIVE);
+        may_match.push_back(i);
+      } else {
+        RecordTick(rep_->ioptions.statistics, BLOOM_FILTER_USEFUL);
+      }
+    }
+  } else {
+    for (size_t i = 0; i < keys.size(); ++i) {
+      assert(keys[i].size() >= 8);  // key must be internal key
+      if (!FullFilterKeyMayMatch(read_options, filter, keys[i], no_io,
+                                 prefix_extractor)) {
+        RecordTick(rep_->ioptions.statistics, BLOOM_FILTER_USEFUL);
+      } else {
+        may_match.push_back(i);
+      }
+    }
+  }
+
+  if (!may_match.empty()) {
+    IndexBlockIter iiter_on_stack;
+    // if prefix_extractor found in block differs from options, disable
+    // BlockPrefixIndex. Only do this check when index_type is kHashSearch.
+    bool need_upper_bound_check = false;
+    if (rep_->index_type == BlockBasedTableOptions::kHashSearch) {
+      need_upper_bound_check = PrefixExtractorChanged(
+          rep_->table_properties.get(), prefix_extractor);
+    }
+    auto iiter = NewIndexIterator(read_options, need_upper_bound_check,
+                                  &iiter_on_stack, /* index_entry */ nullptr,
+                                  get_contexts[may_match[0]]);
+    std::unique_ptr<InternalIterator> iiter_unique_ptr;
+    if (iiter != &iiter_on_stack) {
+      iiter_unique_ptr.reset(iiter);
+    }
+
+    // Read the data blocks the keys start in that are not in the block cache
+    // with a single MultiRead(), so that they can be in flight together.
+    std::unique_ptr<FilePrefetchBuffer> prefetch_buffer;
+    if (!no_io && may_match.size() > 1 &&
+        (filter == nullptr || !filter->IsBlockBased()) &&
+        rep_->table_options.block_cache_compressed == nullptr) {
+      Cache* block_cache = rep_->table_options.block_cache.get();
+      char cache_key[kMaxCacheKeyPrefixSize + kMaxVarint64Length];
+      std::vector<std::pair<uint64_t, size_t>> ranges;
+      bool has_last_offset = false;
+      uint64_t last_offset = 0;
+      for (size_t i : may_match) {
+        iiter->Seek(keys[i]);
+        if (!iiter->Valid()) {
+          continue;
+        }
+        Slice handle_value = iiter->value();
+        BlockHandle handle;
+        if (!handle.DecodeFrom(&handle_value).ok() ||
+            (has_last_offset && handle.offset() <= last_offset)) {
+          continue;
+        }
+        has_last_offset = true;
+        last_offset = handle.offset();
+        if (block_cache != nullptr) {
+          Slice key =
+              GetCacheKey(rep_->cache_key_prefix, rep_->cache_key_prefix_size,
+                          handle, cache_key);
+          Cache::Handle* cache_handle = block_cache->Lookup(key);
+          if (cache_handle != nullptr) {
+            block_cache->Release(cache_handle);
+            continue;
+          }
+        }
+        ranges.emplace_back(handle.offset(), static_cast<size_t>(handle.size()) +
+                                                 kBlockTrailerSize);
+      }
+      if (ranges.size() > 1) {
+        prefetch_buffer.reset(new FilePrefetchBuffer());
+        if (!prefetch_buffer->PrefetchRanges(rep_->file.get(), ranges).ok()) {
+          // The blocks are read one by one below
+          prefetch_buffer.reset();
+        }
+      }
+    }
+
+    // The last data block read. Keys are sorted, so the next key is often
+    // in it too.
+    std::unique_ptr<DataBlockIter> biter;
+    uint64_t biter_offset = 0;
+    for (size_t i : may_match) {
+      const Slice& key = keys[i];
+      GetContext* get_context = get_contexts[i];
+      Status& s = (*statuses)[i];
+      bool matched = false;  // if such user key mathced a key in SST
+      bool done = false;
+      for (iiter->Seek(key); iiter->Valid() && !done; iiter->Next()) {
+        Slice handle_value = iiter->value();
+        BlockHandle handle;
+        s = handle.DecodeFrom(&handle_value);
+        if (!s.ok()) {
+          break;
+        }
+
+        bool not_exist_in_filter =
+            filter != nullptr && filter->IsBlockBased() == true &&
+            !filter->KeyMayMatch(ExtractUserKey(key), prefix_extractor,
+                                 handle.offset(), no_io);
+        if (not_exist_in_filter) {
+          // Not found
+          RecordTick(rep_->ioptions.statistics, BLOOM_FILTER_USEFUL);
+          break;
+        }
+
+        if (biter == nullptr || biter_offset != handle.offset()) {
+          biter.reset(new DataBlockIter());
+          biter_offset = handle.offset();
+          NewDataBlockIterator<DataBlockIter>(
+              rep_, read_options, iiter->value(), biter.get(), false,
+              true /* key_includes_seq */, get_context,
+              prefetch_buffer.get());
+
+          if (no_io && biter->status().IsIncomplete()) {
+            // couldn't get block from block_cache
+            get_context->MarkKeyMayExist();
+            biter.reset();
+            break;
+          }
+          if (!biter->status().ok()) {
+            s = biter->status();
+            biter.reset();
+            break;
+          }
+        }
+
+        // Call the *saver function on each entry/block until it returns
+        // false. The block may be needed by the following keys, so its
+        // cleanup is not handed over to the value.
+        for (biter->Seek(key); biter->Valid(); biter->Next()) {
+          ParsedInternalKey parsed_key;
+          if (!ParseInternalKey(biter->key(), &parsed_key)) {
+            s = Status::Corruption(Slice());
+          }
+
+          if (!get_context->SaveValue(parsed_key, biter->value(), &matched,
+                                      nullptr /* value_pinner */)) {
+            done = true;
+            break;
+          }
+        }
+        s = biter->status();
+        if (!s.ok()) {
+          biter.reset();
+          break;
+        }
+      }
+      if (matched && filter != nullptr && !filter->IsBlockBased()) {
+        RecordTick(rep_->ioptions.statistics,
+                   BLOOM_FILTER_FULL_TRUE_POSITIVE);
+      }
+      if (s.ok()) {
+        s = iiter->status();
+      }
+    }
+  }
+
+  // if rep_->filter_entry is not set, we should call Release(); otherwise
+  // don't call, in this case we have a local copy in rep_->filter_entry,
+  // it's pinned to the cache and will be released in the destructor
+  if (!rep_->filter_entry.IsSet()) {
+    filter_entry.Release(rep_->table_options.block_cache.get());
+  }
+}
+
 Status BlockBasedTable::Prefetch(const Slice* const begin,
                                  const Slice* const end) {
   auto& comparator = rep_->internal_comparator;
@@ -2645,7 +2922,8 @@ Status BlockBasedTable::CreateIndexReader(
           file, prefetch_buffer, footer, footer.index_handle(), rep_->ioptions,
           icomparator, index_reader, rep_->persistent_cache_options,
           rep_->table_properties == nullptr ||
-              rep_->table_properties->index_key_is_user_key == 0);
+              rep_->table_properties->index_key_is_user_key == 0,
+          rep_->learned_index_handle);
     }
     case BlockBasedTableOptions::kHashSearch: {
       std::unique_ptr<Block> meta_guard;
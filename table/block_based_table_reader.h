@@ -116,11 +116,24 @@ class BlockBasedTable : public TableReader {
   InternalIterator* NewRangeTombstoneIterator(
       const ReadOptions& read_options) override;
 
+  std::shared_ptr<const FragmentedRangeTombstoneList>
+  GetFragmentedRangeTombstones() override;
+
   // @param skip_filters Disables loading/accessing the filter block
   Status Get(const ReadOptions& readOptions, const Slice& key,
              GetContext* get_context, const SliceTransform* prefix_extractor,
              bool skip_filters = false) override;
 
+  // The filter is fetched once and probed for all keys before the index is
+  // searched. A data block holding several of the keys is read once for
+  // all of them, so values are copied rather than pinned.
+  void MultiGet(const ReadOptions& readOptions,
+                const std::vector<Slice>& keys,
+                const std::vector<GetContext*>& get_contexts,
+                const SliceTransform* prefix_extractor,
+                std::vector<Status>* statuses,
+                bool skip_filters = false) override;
+
   // Pre-fetch the disk blocks that correspond to the key range specified by
   // (kbegin, kend). The call will return error status in the event of
   // IO or iteration error.
@@ -439,6 +452,7 @@ struct BlockBasedTable::Rep {
         whole_key_filtering(_table_opt.whole_key_filtering),
         prefix_filtering(true),
         range_del_handle(BlockHandle::NullBlockHandle()),
+        learned_index_handle(BlockHandle::NullBlockHandle()),
         global_seqno(kDisableGlobalSequenceNumber),
         immortal_table(_immortal_table) {}
 
@@ -505,6 +519,10 @@ struct BlockBasedTable::Rep {
   // cache is enabled.
   CachableEntry<Block> range_del_entry;
   BlockHandle range_del_handle;
+  // The range deletions of the range del block, fragmented for point lookups
+  std::shared_ptr<const FragmentedRangeTombstoneList> fragmented_range_dels;
+  // Model of the index block, if the table has one
+  BlockHandle learned_index_handle;
 
   // If global_seqno is used, all Keys in this file will have the same
   // seqno with value `global_seqno`.
@@ -552,6 +570,7 @@ class BlockBasedTableIterator : public InternalIterator {
   void SeekToFirst() override;
   void SeekToLast() override;
   void Next() override;
+  bool NextAndGetResult(Slice* ret_key) override;
   void Prev() override;
   bool Valid() const override {
     return !is_out_of_bound_ && block_iter_points_to_real_block_ &&
@@ -99,6 +99,20 @@ class FilterBlockReader {
                            const bool no_io = false,
                            const Slice* const const_ikey_ptr = nullptr) = 0;
 
+  /**
+   * Checks num_keys keys at once, as KeyMayMatch(*keys[i], prefix_extractor,
+   * kNotValid, no_io, &ikeys[i]), and stores the results in may_match[i].
+   * Full filters can overlap the memory accesses of the keys.
+   */
+  virtual void MultiKeyMayMatch(int num_keys, Slice** keys, const Slice* ikeys,
+                                const SliceTransform* prefix_extractor,
+                                const bool no_io, bool* may_match) {
+    for (int i = 0; i < num_keys; i++) {
+      may_match[i] =
+          KeyMayMatch(*keys[i], prefix_extractor, kNotValid, no_io, &ikeys[i]);
+    }
+  }
+
   /**
    * no_io and const_ikey_ptr here means the same as in KeyMayMatch
    */
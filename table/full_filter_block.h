@@ -103,6 +103,10 @@ class FullFilterBlockReader : public FilterBlockReader {
       uint64_t block_offset = kNotValid, const bool no_io = false,
       const Slice* const const_ikey_ptr = nullptr) override;
 
+  virtual void MultiKeyMayMatch(int num_keys, Slice** keys, const Slice* ikeys,
+                                const SliceTransform* prefix_extractor,
+                                const bool no_io, bool* may_match) override;
+
   virtual bool PrefixMayMatch(
       const Slice& prefix, const SliceTransform* prefix_extractor,
       uint64_t block_offset = kNotValid, const bool no_io = false,
@@ -18,20 +18,26 @@ namespace rocksdb {
 
 namespace {
 
-void appendToReplayLog(std::string* replay_log, ValueType type, Slice value) {
+void appendToReplayLog(std::string* replay_log, ValueType type,
+                       SequenceNumber seq, Slice value) {
 #ifndef ROCKSDB_LITE
   if (replay_log) {
     if (replay_log->empty()) {
       // Optimization: in the common case of only one operation in the
       // log, we allocate the exact amount of space needed.
-      replay_log->reserve(1 + VarintLength(value.size()) + value.size());
+      replay_log->reserve(1 + VarintLength(seq) + VarintLength(value.size()) +
+                          value.size());
     }
     replay_log->push_back(type);
+    // The sequence number is kept so that range tombstones of other files
+    // apply to replayed entries as they did to the original ones
+    PutVarint64(replay_log, seq);
     PutLengthPrefixedSlice(replay_log, value);
   }
 #else
   (void)replay_log;
   (void)type;
+  (void)seq;
   (void)value;
 #endif  // ROCKSDB_LITE
 }
@@ -81,9 +87,9 @@ void GetContext::MarkKeyMayExist() {
   }
 }
 
-void GetContext::SaveValue(const Slice& value, SequenceNumber /*seq*/) {
+void GetContext::SaveValue(const Slice& value, SequenceNumber seq) {
   assert(state_ == kNotFound);
-  appendToReplayLog(replay_log_, kTypeValue, value);
+  appendToReplayLog(replay_log_, kTypeValue, seq, value);
 
   state_ = kFound;
   if (LIKELY(pinnable_val_ != nullptr)) {
@@ -173,7 +179,8 @@ bool GetContext::SaveValue(const ParsedInternalKey& parsed_key,
       return true;  // to continue to the next seq
     }
 
-    appendToReplayLog(replay_log_, parsed_key.type, value);
+    appendToReplayLog(replay_log_, parsed_key.type, parsed_key.sequence,
+                      value);
 
     if (seq_ != nullptr) {
       // Set the sequence number if it is uninitialized
@@ -295,17 +302,15 @@ void replayGetContextLog(const Slice& replay_log, const Slice& user_key,
   while (s.size()) {
     auto type = static_cast<ValueType>(*s.data());
     s.remove_prefix(1);
+    SequenceNumber seq;
     Slice value;
-    bool ret = GetLengthPrefixedSlice(&s, &value);
+    bool ret = GetVarint64(&s, &seq) && GetLengthPrefixedSlice(&s, &value);
     assert(ret);
     (void)ret;
 
     bool dont_care __attribute__((__unused__));
-    // Since SequenceNumber is not stored and unknown, we will use
-    // kMaxSequenceNumber.
-    get_context->SaveValue(
-        ParsedInternalKey(user_key, kMaxSequenceNumber, type), value,
-        &dont_care, value_pinner);
+    get_context->SaveValue(ParsedInternalKey(user_key, seq, type), value,
+                           &dont_care, value_pinner);
   }
 #else   // ROCKSDB_LITE
   (void)replay_log;
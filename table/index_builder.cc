@@ -11,6 +11,7 @@
 #include <assert.h>
 #include <inttypes.h>
 
+#include <string.h>
 #include <list>
 #include <string>
 
@@ -31,9 +32,12 @@ IndexBuilder* IndexBuilder::CreateIndexBuilder(
   IndexBuilder* result = nullptr;
   switch (index_type) {
     case BlockBasedTableOptions::kBinarySearch: {
-      result = new ShortenedIndexBuilder(comparator,
-                                         table_opt.index_block_restart_interval,
-                                         table_opt.format_version);
+      result = new ShortenedIndexBuilder(
+          comparator, table_opt.index_block_restart_interval,
+          table_opt.format_version,
+          table_opt.learned_index &&
+              strcmp(comparator->user_comparator()->Name(),
+                     BytewiseComparator()->Name()) == 0);
     }
   break;
     case BlockBasedTableOptions::kHashSearch: {
@@ -20,6 +20,7 @@
 #include "table/block_based_table_factory.h"
 #include "table/block_builder.h"
 #include "table/format.h"
+#include "table/learned_index.h"
 
 namespace rocksdb {
 // The interface for building index.
@@ -118,12 +119,19 @@ class ShortenedIndexBuilder : public IndexBuilder {
  public:
   explicit ShortenedIndexBuilder(const InternalKeyComparator* comparator,
                                  int index_block_restart_interval,
-                                 uint32_t format_version)
+                                 uint32_t format_version,
+                                 bool learned_index = false)
       : IndexBuilder(comparator),
         index_block_builder_(index_block_restart_interval),
-        index_block_builder_without_seq_(index_block_restart_interval) {
+        index_block_builder_without_seq_(index_block_restart_interval),
+        index_block_restart_interval_(index_block_restart_interval),
+        num_entries_(0) {
     // Making the default true will disable the feature for old versions
     seperator_is_key_plus_seq_ = (format_version <= 2);
+    if (learned_index) {
+      learned_index_builder_.reset(
+          new LearnedIndex::Builder(kLearnedIndexMaxError));
+    }
   }
 
   virtual void AddIndexEntry(std::string* last_key_in_current_block,
@@ -150,6 +158,13 @@ class ShortenedIndexBuilder : public IndexBuilder {
       index_block_builder_without_seq_.Add(ExtractUserKey(sep),
                                            handle_encoding);
     }
+    // The model predicts restart points, which is where index lookups
+    // search.
+    if (learned_index_builder_ != nullptr &&
+        num_entries_ % index_block_restart_interval_ == 0) {
+      learned_index_builder_->Add(ExtractUserKey(sep));
+    }
+    ++num_entries_;
   }
 
   using IndexBuilder::Finish;
@@ -162,6 +177,11 @@ class ShortenedIndexBuilder : public IndexBuilder {
       index_blocks->index_block_contents =
           index_block_builder_without_seq_.Finish();
     }
+    if (learned_index_builder_ != nullptr &&
+        learned_index_builder_->Finish(&learned_index_block_)) {
+      index_blocks->meta_blocks.insert(
+          {kLearnedIndexBlock.c_str(), learned_index_block_});
+    }
     return Status::OK();
   }
 
@@ -180,9 +200,17 @@ class ShortenedIndexBuilder : public IndexBuilder {
   friend class PartitionedIndexBuilder;
 
  private:
+  // Lookups search this many restart points on either side of the one the
+  // model predicts, plus rounding
+  static const uint32_t kLearnedIndexMaxError = 4;
+
   BlockBuilder index_block_builder_;
   BlockBuilder index_block_builder_without_seq_;
   bool seperator_is_key_plus_seq_;
+  int index_block_restart_interval_;
+  uint32_t num_entries_;
+  std::unique_ptr<LearnedIndex::Builder> learned_index_builder_;
+  std::string learned_index_block_;
 };
 
 // HashIndexBuilder contains a binary-searchable primary index and the
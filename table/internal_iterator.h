@@ -51,6 +51,19 @@ class InternalIterator : public Cleanable {
   // REQUIRES: Valid()
   virtual void Next() = 0;
 
+  // Same as Next(), followed by Valid() and, if valid, key() into *ret_key,
+  // in a single virtual call. Iterators that sit below an IteratorWrapper on
+  // the scan path override it to save two virtual calls per entry.
+  // REQUIRES: Valid()
+  virtual bool NextAndGetResult(Slice* ret_key) {
+    Next();
+    bool is_valid = Valid();
+    if (is_valid) {
+      *ret_key = key();
+    }
+    return is_valid;
+  }
+
   // Moves to the previous entry in the source.  After this call, Valid() is
   // true iff the iterator was not positioned at the first entry in source.
   // REQUIRES: Valid()
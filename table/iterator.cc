@@ -95,6 +95,25 @@ void Cleanable::RegisterCleanup(CleanupFunction func, void* arg1, void* arg2) {
   c->arg2 = arg2;
 }
 
+size_t Iterator::NextBatch(
+    size_t max_entries, size_t max_bytes,
+    const std::function<bool(const Slice& key, const Slice& value)>&
+        callback) {
+  size_t num_entries = 0;
+  size_t num_bytes = 0;
+  while (num_entries < max_entries && num_bytes < max_bytes && Valid()) {
+    Slice k = key();
+    Slice v = value();
+    if (!callback(k, v)) {
+      break;
+    }
+    num_entries++;
+    num_bytes += k.size() + v.size();
+    Next();
+  }
+  return num_entries;
+}
+
 Status Iterator::GetProperty(std::string prop_name, std::string* prop) {
   if (prop == nullptr) {
     return Status::InvalidArgument("prop is nullptr");
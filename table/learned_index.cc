@@ -0,0 +1,208 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/learned_index.h"
+
+#include <assert.h>
+#include <string.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "port/port.h"
+#include "util/coding.h"
+
+namespace rocksdb {
+
+namespace {
+// The model is only kept if its segments cover this many keys on average
+const size_t kMinKeysPerSegment = 4;
+
+// Maps a key to the eight bytes after `prefix`, as a big-endian number.
+// Keys ordered before or after all keys with the prefix map to the smallest
+// or the largest number.
+uint64_t KeyToNumber(const Slice& prefix, const Slice& key) {
+  size_t n = std::min(prefix.size(), key.size());
+  int cmp = memcmp(key.data(), prefix.data(), n);
+  if (cmp < 0 || (cmp == 0 && key.size() < prefix.size())) {
+    return 0;
+  }
+  if (cmp > 0) {
+    return port::kMaxUint64;
+  }
+  uint64_t number = 0;
+  for (size_t i = prefix.size(); i < prefix.size() + sizeof(uint64_t); ++i) {
+    number <<= 8;
+    if (i < key.size()) {
+      number |= static_cast<unsigned char>(key[i]);
+    }
+  }
+  return number;
+}
+
+void PutDouble(std::string* dst, double value) {
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  PutFixed64(dst, bits);
+}
+
+bool GetDouble(Slice* input, double* value) {
+  uint64_t bits;
+  if (!GetFixed64(input, &bits)) {
+    return false;
+  }
+  memcpy(value, &bits, sizeof(bits));
+  return true;
+}
+}  // namespace
+
+// Each segment is grown for as long as there is a slope that keeps all of
+// its keys within max_error_ of their positions ("shrinking cone").
+bool LearnedIndex::Builder::Finish(std::string* dst) {
+  if (keys_.empty() ||
+      keys_.size() > std::numeric_limits<uint32_t>::max()) {
+    return false;
+  }
+  LearnedIndex model;
+  model.num_keys_ = static_cast<uint32_t>(keys_.size());
+  // The keys are sorted, so those in between share the prefix of the first
+  // and the last one.
+  const std::string& first_key = keys_.front();
+  const std::string& last_key = keys_.back();
+  size_t prefix_len = 0;
+  while (prefix_len < first_key.size() && prefix_len < last_key.size() &&
+         first_key[prefix_len] == last_key[prefix_len]) {
+    ++prefix_len;
+  }
+  model.prefix_ = first_key.substr(0, prefix_len);
+
+  std::vector<uint64_t> numbers(keys_.size());
+  for (size_t i = 0; i < keys_.size(); ++i) {
+    numbers[i] = KeyToNumber(model.prefix_, keys_[i]);
+    if (i > 0 && numbers[i] < numbers[i - 1]) {
+      // Not in bytewise order
+      return false;
+    }
+  }
+
+  const double kInfinity = std::numeric_limits<double>::infinity();
+  const double max_error = static_cast<double>(max_error_);
+  Segment segment = {numbers[0], 0, 0};
+  double min_slope = 0;
+  double max_slope = kInfinity;
+  for (size_t i = 1; i < numbers.size(); ++i) {
+    double pos = static_cast<double>(i - segment.first_position);
+    bool fits;
+    if (numbers[i] == segment.first_number) {
+      fits = pos <= max_error;
+    } else {
+      double dx = static_cast<double>(numbers[i] - segment.first_number);
+      double lo = std::max(min_slope, (pos - max_error) / dx);
+      double hi = std::min(max_slope, (pos + max_error) / dx);
+      fits = lo <= hi;
+      if (fits) {
+        min_slope = lo;
+        max_slope = hi;
+      }
+    }
+    if (!fits) {
+      segment.slope =
+          max_slope == kInfinity ? min_slope : (min_slope + max_slope) / 2;
+      model.segments_.push_back(segment);
+      segment = {numbers[i], static_cast<uint32_t>(i), 0};
+      min_slope = 0;
+      max_slope = kInfinity;
+    }
+  }
+  segment.slope =
+      max_slope == kInfinity ? min_slope : (min_slope + max_slope) / 2;
+  model.segments_.push_back(segment);
+  if (model.segments_.size() * kMinKeysPerSegment > keys_.size()) {
+    return false;
+  }
+
+  // Record the error the model actually has. Besides rounding, keys that
+  // map to the same number may be further apart than max_error_. One more
+  // covers keys that fall between two of the keys.
+  double actual_error = 0;
+  for (size_t i = 0; i < numbers.size(); ++i) {
+    actual_error =
+        std::max(actual_error, std::fabs(model.PredictPosition(numbers[i]) -
+                                         static_cast<double>(i)));
+  }
+  if (actual_error >= static_cast<double>(keys_.size())) {
+    return false;
+  }
+  model.max_error_ = static_cast<uint32_t>(std::ceil(actual_error)) + 1;
+
+  PutVarint32(dst, model.num_keys_);
+  PutVarint32(dst, model.max_error_);
+  PutLengthPrefixedSlice(dst, model.prefix_);
+  PutVarint32(dst, static_cast<uint32_t>(model.segments_.size()));
+  for (const auto& s : model.segments_) {
+    PutFixed64(dst, s.first_number);
+    PutVarint32(dst, s.first_position);
+    PutDouble(dst, s.slope);
+  }
+  return true;
+}
+
+Status LearnedIndex::DecodeFrom(const Slice& input) {
+  Slice in = input;
+  uint32_t num_keys = 0;
+  uint32_t max_error = 0;
+  Slice prefix;
+  uint32_t num_segments = 0;
+  if (!GetVarint32(&in, &num_keys) || !GetVarint32(&in, &max_error) ||
+      !GetLengthPrefixedSlice(&in, &prefix) ||
+      !GetVarint32(&in, &num_segments) || num_keys == 0 ||
+      num_segments == 0 || num_segments > num_keys) {
+    return Status::Corruption("bad learned index");
+  }
+  std::vector<Segment> segments(num_segments);
+  for (uint32_t i = 0; i < num_segments; ++i) {
+    Segment& s = segments[i];
+    if (!GetFixed64(&in, &s.first_number) ||
+        !GetVarint32(&in, &s.first_position) || !GetDouble(&in, &s.slope) ||
+        s.first_position >= num_keys ||
+        (i > 0 && (s.first_number < segments[i - 1].first_number ||
+                   s.first_position <= segments[i - 1].first_position))) {
+      return Status::Corruption("bad learned index segment");
+    }
+  }
+  num_keys_ = num_keys;
+  max_error_ = max_error;
+  prefix_ = prefix.ToString();
+  segments_ = std::move(segments);
+  return Status::OK();
+}
+
+double LearnedIndex::PredictPosition(uint64_t number) const {
+  // The last segment starting at or before the number
+  auto it = std::upper_bound(
+      segments_.begin(), segments_.end(), number,
+      [](uint64_t n, const Segment& s) { return n < s.first_number; });
+  if (it == segments_.begin()) {
+    return 0;
+  }
+  double end = it == segments_.end() ? static_cast<double>(num_keys_ - 1)
+                                     : static_cast<double>(it->first_position);
+  --it;
+  double pos =
+      it->first_position +
+      it->slope * static_cast<double>(number - it->first_number);
+  return std::min(pos, end);
+}
+
+void LearnedIndex::Predict(const Slice& key, uint32_t* first,
+                           uint32_t* last) const {
+  assert(num_keys_ > 0);
+  double pos = PredictPosition(KeyToNumber(prefix_, key));
+  double lo = std::floor(pos) - max_error_;
+  double hi = std::ceil(pos) + max_error_;
+  *first = lo <= 0 ? 0 : static_cast<uint32_t>(lo);
+  *last = hi >= num_keys_ - 1 ? num_keys_ - 1 : static_cast<uint32_t>(hi);
+}
+
+}  // namespace rocksdb
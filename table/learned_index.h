@@ -0,0 +1,83 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+
+namespace rocksdb {
+
+// A piecewise linear model of the positions of keys in a sorted list, for
+// lists of keys that are spread evenly, such as fixed-width sequential IDs.
+// A key is mapped to a number by the eight bytes that follow the prefix all
+// keys share, and every segment of the model maps numbers to positions with
+// a line. The predicted position of each key is within a known error of its
+// position, so looking a key up takes a search over a few positions around
+// the predicted one instead of over the whole list.
+//
+// The model relies on the keys being in bytewise order. For keys in another
+// order, predictions are wrong, which callers must detect by checking the
+// keys at the ends of the range they search.
+class LearnedIndex {
+ public:
+  class Builder {
+   public:
+    // Positions predicted for the keys added will be at most about
+    // max_error off.
+    explicit Builder(uint32_t max_error) : max_error_(max_error) {}
+
+    // Adds the key at the next position.
+    // REQUIRES: key is >= all keys added before in bytewise order.
+    void Add(const Slice& key) { keys_.emplace_back(key.data(), key.size()); }
+
+    // Appends the model of the keys added to *dst. Returns false and leaves
+    // *dst unchanged if the keys are too unevenly spread for the model to be
+    // much smaller than the keys.
+    bool Finish(std::string* dst);
+
+   private:
+    uint32_t max_error_;
+    std::vector<std::string> keys_;
+  };
+
+  LearnedIndex() : num_keys_(0), max_error_(0) {}
+
+  // Loads a model encoded by Builder::Finish().
+  Status DecodeFrom(const Slice& input);
+
+  // Sets [*first, *last] to the positions the first key >= `key` is
+  // predicted to be at, or near to if it is not within the error.
+  // REQUIRES: num_keys() > 0
+  void Predict(const Slice& key, uint32_t* first, uint32_t* last) const;
+
+  // Number of keys the model was built from, 0 if none was loaded.
+  uint32_t num_keys() const { return num_keys_; }
+
+  size_t ApproximateMemoryUsage() const {
+    return sizeof(*this) + prefix_.capacity() +
+           segments_.capacity() * sizeof(Segment);
+  }
+
+ private:
+  struct Segment {
+    // Number of the first key of the segment
+    uint64_t first_number;
+    // Position of the first key of the segment
+    uint32_t first_position;
+    double slope;
+  };
+
+  double PredictPosition(uint64_t number) const;
+
+  uint32_t num_keys_;
+  uint32_t max_error_;
+  std::string prefix_;
+  std::vector<Segment> segments_;
+};
+
+}  // namespace rocksdb
@@ -8,6 +8,7 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 
 #include "table/merging_iterator.h"
+#include <algorithm>
 #include <string>
 #include <vector>
 #include "db/dbformat.h"
@@ -21,15 +22,74 @@
 #include "table/iterator_wrapper.h"
 #include "util/arena.h"
 #include "util/autovector.h"
-#include "util/heap.h"
+#include "util/loser_tree.h"
 #include "util/stop_watch.h"
 #include "util/sync_point.h"
 
 namespace rocksdb {
 // Without anonymous namespace here, we fail the warning -Wmissing-prototypes
 namespace {
-typedef BinaryHeap<IteratorWrapper*, MaxIteratorComparator> MergerMaxIterHeap;
-typedef BinaryHeap<IteratorWrapper*, MinIteratorComparator> MergerMinIterHeap;
+// A child iterator in the loser trees of MergingIterator, with the first 8
+// bytes of its user key as a big-endian integer if user keys are ordered
+// bytewise, or 0 otherwise. The prefix is computed once each time the child
+// moves, and keys with different prefixes are then ordered without calling
+// the comparator in any of the matches the child plays.
+struct MergerEntry {
+  MergerEntry() : iter(nullptr), key_prefix(0) {}
+  MergerEntry(IteratorWrapper* _iter, uint64_t _key_prefix)
+      : iter(_iter), key_prefix(_key_prefix) {}
+
+  IteratorWrapper* iter;
+  uint64_t key_prefix;
+};
+
+class MergerMaxComparator {
+ public:
+  MergerMaxComparator(const InternalKeyComparator* comparator)
+      : cmp_(comparator) {}
+
+  bool operator()(const MergerEntry& a, const MergerEntry& b) const {
+    if (a.key_prefix != b.key_prefix) {
+      return a.key_prefix < b.key_prefix;
+    }
+    return cmp_(a.iter, b.iter);
+  }
+
+ private:
+  MaxIteratorComparator cmp_;
+};
+
+class MergerMinComparator {
+ public:
+  MergerMinComparator(const InternalKeyComparator* comparator)
+      : cmp_(comparator) {}
+
+  bool operator()(const MergerEntry& a, const MergerEntry& b) const {
+    if (a.key_prefix != b.key_prefix) {
+      return a.key_prefix > b.key_prefix;
+    }
+    return cmp_(a.iter, b.iter);
+  }
+
+ private:
+  MinIteratorComparator cmp_;
+};
+
+typedef LoserTree<MergerEntry, MergerMaxComparator> MergerMaxIterHeap;
+typedef LoserTree<MergerEntry, MergerMinComparator> MergerMinIterHeap;
+
+// Keys shorter than 8 bytes are padded with zeros, which keeps the order of
+// keys whose prefixes differ: a zero byte can only differ from a larger byte.
+uint64_t UserKeyPrefix(const Slice& internal_key) {
+  Slice user_key = ExtractUserKey(internal_key);
+  size_t n = std::min(user_key.size(), sizeof(uint64_t));
+  uint64_t prefix = 0;
+  for (size_t i = 0; i < n; i++) {
+    prefix |= static_cast<uint64_t>(static_cast<unsigned char>(user_key[i]))
+              << (56 - 8 * i);
+  }
+  return prefix;
+}
 }  // namespace
 
 const size_t kNumIterReserve = 4;
@@ -43,6 +103,7 @@ class MergingIterator : public InternalIterator {
         comparator_(comparator),
         current_(nullptr),
         direction_(kForward),
+        use_key_prefix_(comparator->user_comparator() == BytewiseComparator()),
         minHeap_(comparator_),
         prefix_seek_mode_(prefix_seek_mode),
         pinned_iters_mgr_(nullptr) {
@@ -53,7 +114,7 @@ class MergingIterator : public InternalIterator {
     for (auto& child : children_) {
       if (child.Valid()) {
         assert(child.status().ok());
-        minHeap_.push(&child);
+        minHeap_.push(Entry(&child));
       } else {
         considerStatus(child.status());
       }
@@ -73,14 +134,19 @@ class MergingIterator : public InternalIterator {
     if (pinned_iters_mgr_) {
       iter->SetPinnedItersMgr(pinned_iters_mgr_);
     }
-    auto new_wrapper = children_.back();
-    if (new_wrapper.Valid()) {
-      assert(new_wrapper.status().ok());
-      minHeap_.push(&new_wrapper);
-      current_ = CurrentForward();
-    } else {
-      considerStatus(new_wrapper.status());
+    // Growing children_ may move the wrappers already in the tree, so it is
+    // refilled rather than extended.
+    ClearHeaps();
+    for (auto& child : children_) {
+      if (child.Valid()) {
+        assert(child.status().ok());
+        minHeap_.push(Entry(&child));
+      }
+    }
+    if (!children_.back().Valid()) {
+      considerStatus(children_.back().status());
     }
+    current_ = CurrentForward();
   }
 
   virtual ~MergingIterator() {
@@ -102,7 +168,7 @@ class MergingIterator : public InternalIterator {
       child.SeekToFirst();
       if (child.Valid()) {
         assert(child.status().ok());
-        minHeap_.push(&child);
+        minHeap_.push(Entry(&child));
       } else {
         considerStatus(child.status());
       }
@@ -119,7 +185,7 @@ class MergingIterator : public InternalIterator {
       child.SeekToLast();
       if (child.Valid()) {
         assert(child.status().ok());
-        maxHeap_->push(&child);
+        maxHeap_->push(Entry(&child));
       } else {
         considerStatus(child.status());
       }
@@ -141,7 +207,7 @@ class MergingIterator : public InternalIterator {
       if (child.Valid()) {
         assert(child.status().ok());
         PERF_TIMER_GUARD(seek_min_heap_time);
-        minHeap_.push(&child);
+        minHeap_.push(Entry(&child));
       } else {
         considerStatus(child.status());
       }
@@ -168,7 +234,7 @@ class MergingIterator : public InternalIterator {
       if (child.Valid()) {
         assert(child.status().ok());
         PERF_TIMER_GUARD(seek_max_heap_time);
-        maxHeap_->push(&child);
+        maxHeap_->push(Entry(&child));
       } else {
         considerStatus(child.status());
       }
@@ -202,10 +268,9 @@ class MergingIterator : public InternalIterator {
     current_->Next();
     if (current_->Valid()) {
       // current is still valid after the Next() call above.  Call
-      // replace_top() to restore the heap property.  When the same child
-      // iterator yields a sequence of keys, this is cheap.
+      // replace_top() to replay its matches up to the root of the tree.
       assert(current_->status().ok());
-      minHeap_.replace_top(current_);
+      minHeap_.replace_top(Entry(current_));
     } else {
       // current stopped being valid, remove it from the heap.
       considerStatus(current_->status());
@@ -214,6 +279,15 @@ class MergingIterator : public InternalIterator {
     current_ = CurrentForward();
   }
 
+  virtual bool NextAndGetResult(Slice* ret_key) override {
+    MergingIterator::Next();
+    bool is_valid = MergingIterator::Valid();
+    if (is_valid) {
+      *ret_key = MergingIterator::key();
+    }
+    return is_valid;
+  }
+
   virtual void Prev() override {
     assert(Valid());
     // Ensure that all children are positioned before key().
@@ -238,7 +312,7 @@ class MergingIterator : public InternalIterator {
         }
         if (child.Valid()) {
           assert(child.status().ok());
-          maxHeap_->push(&child);
+          maxHeap_->push(Entry(&child));
         }
       }
       direction_ = kReverse;
@@ -261,10 +335,9 @@ class MergingIterator : public InternalIterator {
     current_->Prev();
     if (current_->Valid()) {
       // current is still valid after the Prev() call above.  Call
-      // replace_top() to restore the heap property.  When the same child
-      // iterator yields a sequence of keys, this is cheap.
+      // replace_top() to replay its matches up to the root of the tree.
       assert(current_->status().ok());
-      maxHeap_->replace_top(current_);
+      maxHeap_->replace_top(Entry(current_));
     } else {
       // current stopped being valid, remove it from the heap.
       considerStatus(current_->status());
@@ -326,6 +399,8 @@ class MergingIterator : public InternalIterator {
     kReverse
   };
   Direction direction_;
+  // Whether MergerEntry caches user key prefixes
+  const bool use_key_prefix_;
   MergerMinIterHeap minHeap_;
   bool prefix_seek_mode_;
 
@@ -336,15 +411,20 @@ class MergingIterator : public InternalIterator {
 
   void SwitchToForward();
 
+  MergerEntry Entry(IteratorWrapper* child) const {
+    return MergerEntry(child,
+                       use_key_prefix_ ? UserKeyPrefix(child->key()) : 0);
+  }
+
   IteratorWrapper* CurrentForward() const {
     assert(direction_ == kForward);
-    return !minHeap_.empty() ? minHeap_.top() : nullptr;
+    return !minHeap_.empty() ? minHeap_.top().iter : nullptr;
   }
 
   IteratorWrapper* CurrentReverse() const {
     assert(direction_ == kReverse);
     assert(maxHeap_);
-    return !maxHeap_->empty() ? maxHeap_->top() : nullptr;
+    return !maxHeap_->empty() ? maxHeap_->top().iter : nullptr;
   }
 };
 
@@ -363,7 +443,7 @@ void MergingIterator::SwitchToForward() {
       }
     }
     if (child.Valid()) {
-      minHeap_.push(&child);
+      minHeap_.push(Entry(&child));
     }
   }
   direction_ = kForward;
@@ -104,6 +104,11 @@ struct TableBuilderOptions {
   int level; // what level this table/file is on, -1 for "not set, don't know"
   const uint64_t creation_time;
   const int64_t oldest_key_time;
+  // The level L0 files are compacted to, and the total size in bytes of the
+  // files of every level, when the table is created. -1 and empty if
+  // unknown.
+  int base_level = -1;
+  std::vector<uint64_t> level_bytes;
 };
 
 // TableBuilder provides the interface used to build a Table
@@ -9,6 +9,7 @@
 
 #pragma once
 #include <memory>
+#include <vector>
 #include "rocksdb/slice_transform.h"
 #include "table/internal_iterator.h"
 
@@ -18,6 +19,7 @@ class Iterator;
 struct ParsedInternalKey;
 class Slice;
 class Arena;
+class FragmentedRangeTombstoneList;
 struct ReadOptions;
 struct TableProperties;
 class GetContext;
@@ -50,6 +52,14 @@ class TableReader {
     return nullptr;
   }
 
+  // Returns the range tombstones of the table, fragmented when the table was
+  // opened, or nullptr if the table reader does not keep them. Point lookups
+  // use them instead of NewRangeTombstoneIterator() when available.
+  virtual std::shared_ptr<const FragmentedRangeTombstoneList>
+  GetFragmentedRangeTombstones() {
+    return nullptr;
+  }
+
   // Given a key, return an approximate byte offset in the file where
   // the data for that key begins (or would begin if the key were
   // present in the file).  The returned value is in terms of file
@@ -86,6 +96,22 @@ class TableReader {
                      const SliceTransform* prefix_extractor,
                      bool skip_filters = false) = 0;
 
+  // Like calling Get() for each of keys, which must be sorted. The status
+  // of the lookup of keys[i] is stored in (*statuses)[i]. Table formats that
+  // can share work between the keys override it.
+  virtual void MultiGet(const ReadOptions& readOptions,
+                        const std::vector<Slice>& keys,
+                        const std::vector<GetContext*>& get_contexts,
+                        const SliceTransform* prefix_extractor,
+                        std::vector<Status>* statuses,
+                        bool skip_filters = false) {
+    statuses->resize(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+      (*statuses)[i] = Get(readOptions, keys[i], get_contexts[i],
+                           prefix_extractor, skip_filters);
+    }
+  }
+
   // Prefetch data corresponding to a give range of keys
   // Typically this functionality is required for table implementations that
   // persists the data on a non volatile storage medium like disk/SSD
@@ -1609,6 +1609,65 @@ TEST_P(BlockBasedTableTest, NoopTransformSeek) {
   }
 }
 
+TEST_P(BlockBasedTableTest, LearnedIndex) {
+  BlockBasedTableOptions table_options = GetBlockBasedTableOptions();
+  table_options.block_size = 64;
+  table_options.learned_index = true;
+
+  Options options;
+  options.comparator = BytewiseComparator();
+  options.compression = kNoCompression;
+  options.table_factory.reset(new BlockBasedTableFactory(table_options));
+
+  // Sequential 16-byte IDs, every third one
+  auto id_key = [](uint64_t id) {
+    std::string key(8, '\0');
+    for (int i = 0; i < 8; ++i) {
+      key.push_back(static_cast<char>(id >> (56 - 8 * i)));
+    }
+    return key;
+  };
+  const uint64_t kNumKeys = 3000;
+  TableConstructor c(options.comparator, true /* convert_to_internal_key_ */);
+  for (uint64_t i = 0; i < kNumKeys; ++i) {
+    c.Add(id_key(i * 3), "v" + ToString(i));
+  }
+  std::vector<std::string> keys;
+  stl_wrappers::KVMap kvmap;
+  const ImmutableCFOptions ioptions(options);
+  const MutableCFOptions moptions(options);
+  const InternalKeyComparator internal_comparator(options.comparator);
+  c.Finish(options, ioptions, moptions, table_options, internal_comparator,
+           &keys, &kvmap);
+
+  std::unique_ptr<RandomAccessFileReader> file_reader(
+      test::GetRandomAccessFileReader(new test::StringSource(
+          c.TEST_GetSink()->contents(), 0 /* unique_id */,
+          false /* allow_mmap_reads */)));
+  BlockHandle handle;
+  ASSERT_OK(FindMetaBlock(file_reader.get(),
+                          c.TEST_GetSink()->contents().size(),
+                          kBlockBasedTableMagicNumber, ioptions,
+                          kLearnedIndexBlock, &handle));
+
+  // Seek to every key and to every key in between
+  std::unique_ptr<InternalIterator> iter(c.GetTableReader()->NewIterator(
+      ReadOptions(), moptions.prefix_extractor.get()));
+  for (uint64_t id = 0; id < kNumKeys * 3 + 2; ++id) {
+    InternalKey target(id_key(id), kMaxSequenceNumber, kValueTypeForSeek);
+    iter->Seek(target.Encode());
+    ASSERT_OK(iter->status());
+    uint64_t expected = (id + 2) / 3;
+    if (expected >= kNumKeys) {
+      ASSERT_FALSE(iter->Valid());
+      continue;
+    }
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(id_key(expected * 3), ExtractUserKey(iter->key()).ToString());
+    ASSERT_EQ("v" + ToString(expected), iter->value().ToString());
+  }
+}
+
 TEST_P(BlockBasedTableTest, SkipPrefixBloomFilter) {
   // if DB is opened with a prefix extractor of a different name,
   // prefix bloom is skipped when read the file
@@ -3408,6 +3467,66 @@ TEST_P(BlockBasedTableTest, BlockAlignTest) {
   table_reader.reset();
 }
 
+TEST_P(BlockBasedTableTest, ParallelCompression) {
+  if (!Zlib_Supported()) {
+    fprintf(stderr, "zlib compression not supported, skip this test\n");
+    return;
+  }
+  BlockBasedTableOptions bbto = GetBlockBasedTableOptions();
+  bbto.block_size = 1024;
+  bbto.filter_policy.reset(NewBloomFilterPolicy(10, false));
+  bbto.verify_compression = true;
+  Options options;
+  options.table_factory.reset(NewBlockBasedTableFactory(bbto));
+  const ImmutableCFOptions ioptions(options);
+  const MutableCFOptions moptions(options);
+  InternalKeyComparator ikc(options.comparator);
+  std::vector<std::unique_ptr<IntTblPropCollectorFactory>>
+      int_tbl_prop_collector_factories;
+  std::string column_family_name;
+
+  Random rnd(301);
+  std::vector<std::pair<std::string, std::string>> kvs;
+  for (int i = 0; i < 20000; ++i) {
+    std::ostringstream ostr;
+    ostr << std::setfill('0') << std::setw(8) << i;
+    std::string value;
+    test::CompressibleString(&rnd, 0.5, 100, &value);
+    kvs.emplace_back(InternalKey(ostr.str(), 0, kTypeValue).Encode().ToString(),
+                     value);
+  }
+
+  // Files built with one and with several compression threads must be the
+  // same.
+  std::string contents[2];
+  for (int i = 0; i < 2; ++i) {
+    test::StringSink* sink = new test::StringSink();
+    unique_ptr<WritableFileWriter> file_writer(
+        test::GetWritableFileWriter(sink));
+    CompressionOptions compression_opts;
+    compression_opts.parallel_threads = i == 0 ? 1 : 4;
+    std::unique_ptr<TableBuilder> builder(
+        options.table_factory->NewTableBuilder(
+            TableBuilderOptions(ioptions, moptions, ikc,
+                                &int_tbl_prop_collector_factories,
+                                kZlibCompression, compression_opts,
+                                nullptr /* compression_dict */,
+                                false /* skip_filters */, column_family_name,
+                                -1),
+            TablePropertiesCollectorFactory::Context::kUnknownColumnFamily,
+            file_writer.get()));
+    for (const auto& kv : kvs) {
+      builder->Add(kv.first, kv.second);
+    }
+    ASSERT_OK(builder->Finish());
+    file_writer->Flush();
+    ASSERT_EQ(sink->contents().size(), builder->FileSize());
+    contents[i] = sink->contents();
+  }
+  ASSERT_GT(contents[1].size(), 0);
+  ASSERT_TRUE(contents[0] == contents[1]);
+}
+
 TEST_P(BlockBasedTableTest, PropertiesBlockRestartPointTest) {
   BlockBasedTableOptions bbto = GetBlockBasedTableOptions();
   bbto.block_align = true;
@@ -473,6 +473,10 @@ DEFINE_int64(row_cache_size, 0,
              "Number of bytes to use as a cache of individual rows"
              " (0 = disabled).");
 
+DEFINE_int64(hot_key_cache_size, 0,
+             "Number of bytes to use as a cache of the latest values of"
+             " recently read keys (0 = disabled).");
+
 DEFINE_int32(open_files, rocksdb::Options().max_open_files,
              "Maximum number of files to keep open at the same time"
              " (use default if == 0)");
@@ -781,6 +785,9 @@ DEFINE_int32(compression_zstd_max_train_bytes, 0,
              "Maximum size of training data passed to zstd's dictionary "
              "trainer.");
 
+DEFINE_int32(compression_parallel_threads, 1,
+             "Number of threads compressing the data blocks of an SST file.");
+
 static bool ValidateCompressionLevel(const char* flagname, int32_t value) {
   if (value < -1 || value > 9) {
     fprintf(stderr, "Invalid value for --%s: %d, must be between -1 and 9\n",
@@ -1074,6 +1081,15 @@ DEFINE_bool(use_hash_search, false, "if use kHashSearch "
 DEFINE_bool(use_block_based_filter, false, "if use kBlockBasedFilter "
             "instead of kFullFilter for filter block. "
             "This is valid if only we use BlockTable");
+DEFINE_bool(use_split_block_filter, false, "if use split block filters, "
+            "which set all bits of a key in one 32-byte block, instead of "
+            "full filters. This is valid if only we use BlockTable");
+DEFINE_bool(use_xor_filter, false, "if use NewXorFilterPolicy() with "
+            "bloom_bits bits per key instead of bloom filters. This is valid "
+            "if only we use BlockTable");
+DEFINE_bool(level_adaptive_bloom_filter, false, "if use "
+            "NewLevelAdaptiveBloomFilterPolicy() with bloom_bits bits per key "
+            "on average. This is valid if only we use BlockTable");
 DEFINE_string(merge_operator, "", "The merge operator to use with the database."
               "If a new merge operator is specified, be sure to use fresh"
               " database The possible merge operators are defined in"
@@ -2233,14 +2249,22 @@ class Benchmark {
     }
   }
 
+  const FilterPolicy* NewFilterPolicy() {
+    if (FLAGS_use_xor_filter) {
+      return NewXorFilterPolicy(FLAGS_bloom_bits);
+    }
+    if (FLAGS_level_adaptive_bloom_filter) {
+      return NewLevelAdaptiveBloomFilterPolicy(FLAGS_bloom_bits);
+    }
+    return NewBloomFilterPolicy(FLAGS_bloom_bits, FLAGS_use_block_based_filter,
+                                FLAGS_use_split_block_filter);
+  }
+
  public:
   Benchmark()
       : cache_(NewCache(FLAGS_cache_size)),
         compressed_cache_(NewCache(FLAGS_compressed_cache_size)),
-        filter_policy_(FLAGS_bloom_bits >= 0
-                           ? NewBloomFilterPolicy(FLAGS_bloom_bits,
-                                                  FLAGS_use_block_based_filter)
-                           : nullptr),
+        filter_policy_(FLAGS_bloom_bits >= 0 ? NewFilterPolicy() : nullptr),
         prefix_extractor_(NewFixedPrefixTransform(FLAGS_prefix_size)),
         num_(FLAGS_num),
         value_size_(FLAGS_value_size),
@@ -3439,6 +3463,8 @@ void VerifyDBFromDB(std::string& truth_db_name) {
     options.compression_opts.max_dict_bytes = FLAGS_compression_max_dict_bytes;
     options.compression_opts.zstd_max_train_bytes =
         FLAGS_compression_zstd_max_train_bytes;
+    options.compression_opts.parallel_threads =
+        FLAGS_compression_parallel_threads;
     // If this is a block based table, set some related options
     if (options.table_factory->Name() == BlockBasedTableFactory::kName &&
         options.table_factory->GetOptions() != nullptr) {
@@ -3449,8 +3475,7 @@ void VerifyDBFromDB(std::string& truth_db_name) {
         table_options->block_cache = cache_;
       }
       if (FLAGS_bloom_bits >= 0) {
-        table_options->filter_policy.reset(NewBloomFilterPolicy(
-            FLAGS_bloom_bits, FLAGS_use_block_based_filter));
+        table_options->filter_policy.reset(NewFilterPolicy());
       }
     }
     if (FLAGS_row_cache_size) {
@@ -3461,6 +3486,7 @@ void VerifyDBFromDB(std::string& truth_db_name) {
         options.row_cache = NewLRUCache(FLAGS_row_cache_size);
       }
     }
+    options.hot_key_cache_size = FLAGS_hot_key_cache_size;
     if (FLAGS_enable_io_prio) {
       FLAGS_env->LowerThreadPoolIOPriority(Env::LOW);
       FLAGS_env->LowerThreadPoolIOPriority(Env::HIGH);
@@ -18,6 +18,9 @@
 #ifndef OS_WIN
 #include <sys/mman.h>
 #endif
+#ifdef NUMA
+#include <numa.h>
+#endif
 #include <algorithm>
 #include "port/port.h"
 #include "rocksdb/env.h"
@@ -48,8 +51,11 @@ size_t OptimizeBlockSize(size_t block_size) {
   return block_size;
 }
 
-Arena::Arena(size_t block_size, AllocTracker* tracker, size_t huge_page_size)
-    : kBlockSize(OptimizeBlockSize(block_size)), tracker_(tracker) {
+Arena::Arena(size_t block_size, AllocTracker* tracker, size_t huge_page_size,
+             int numa_node)
+    : kBlockSize(OptimizeBlockSize(block_size)),
+      tracker_(tracker),
+      numa_node_(numa_node) {
   assert(kBlockSize >= kMinBlockSize && kBlockSize <= kMaxBlockSize &&
          kBlockSize % kAlignUnit == 0);
   TEST_SYNC_POINT_CALLBACK("Arena::Arena:0", const_cast<size_t*>(&kBlockSize));
@@ -90,6 +96,14 @@ Arena::~Arena() {
     }
   }
 #endif
+
+#ifdef NUMA
+  for (const auto& numa_block : numa_blocks_) {
+    if (numa_block.addr_ != nullptr) {
+      numa_free(numa_block.addr_, numa_block.length_);
+    }
+  }
+#endif
 }
 
 char* Arena::AllocateFallback(size_t bytes, bool aligned) {
@@ -147,6 +161,13 @@ char* Arena::AllocateFromHugePage(size_t bytes) {
   if (addr == MAP_FAILED) {
     return nullptr;
   }
+#ifdef NUMA
+  if (numa_node_ >= 0) {
+    // The pages are not faulted in yet, so binding them puts all of them on
+    // the node.
+    numa_tonode_memory(addr, bytes, numa_node_);
+  }
+#endif
   huge_blocks_.back() = MmapInfo(addr, bytes);
   blocks_memory_ += bytes;
   if (tracker_ != nullptr) {
@@ -205,6 +226,23 @@ char* Arena::AllocateAligned(size_t bytes, size_t huge_page_size,
 }
 
 char* Arena::AllocateNewBlock(size_t block_bytes) {
+#ifdef NUMA
+  if (numa_node_ >= 0) {
+    numa_blocks_.emplace_back(nullptr /* addr */, 0 /* length */);
+    void* addr = numa_alloc_onnode(block_bytes, numa_node_);
+    if (addr != nullptr) {
+      numa_blocks_.back() = MmapInfo(addr, block_bytes);
+      blocks_memory_ += block_bytes;
+      if (tracker_ != nullptr) {
+        tracker_->Allocate(block_bytes);
+      }
+      return reinterpret_cast<char*>(addr);
+    }
+    // fall back to malloc
+    numa_blocks_.pop_back();
+  }
+#endif
+
   // Reserve space in `blocks_` before allocating memory via new.
   // Use `emplace_back()` instead of `reserve()` to let std::vector manage its
   // own memory and do fewer reallocations.
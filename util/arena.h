@@ -38,8 +38,11 @@ class Arena : public Allocator {
   // huge_page_size: if 0, don't use huge page TLB. If > 0 (should set to the
   // supported hugepage size of the system), block allocation will try huge
   // page TLB first. If allocation fails, will fall back to normal case.
+  // numa_node: if >= 0 and RocksDB is built with NUMA support, blocks,
+  // including huge page blocks, are placed on memory of that NUMA node.
   explicit Arena(size_t block_size = kMinBlockSize,
-                 AllocTracker* tracker = nullptr, size_t huge_page_size = 0);
+                 AllocTracker* tracker = nullptr, size_t huge_page_size = 0,
+                 int numa_node = -1);
   ~Arena();
 
   char* Allocate(size_t bytes) override;
@@ -78,7 +81,7 @@ class Arena : public Allocator {
   size_t BlockSize() const override { return kBlockSize; }
 
   bool IsInInlineBlock() const {
-    return blocks_.empty();
+    return blocks_.empty() && numa_blocks_.empty();
   }
 
  private:
@@ -96,6 +99,8 @@ class Arena : public Allocator {
     MmapInfo(void* addr, size_t length) : addr_(addr), length_(length) {}
   };
   std::vector<MmapInfo> huge_blocks_;
+  // Blocks allocated on numa_node_, released with numa_free()
+  std::vector<MmapInfo> numa_blocks_;
   size_t irregular_block_num = 0;
 
   // Stats for current active block.
@@ -118,6 +123,7 @@ class Arena : public Allocator {
   // Bytes of memory in blocks allocated so far
   size_t blocks_memory_ = 0;
   AllocTracker* tracker_;
+  int numa_node_;
 };
 
 inline char* Arena::Allocate(size_t bytes) {
@@ -8,6 +8,9 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 
 #include "util/arena.h"
+#include <vector>
+#include "port/port.h"
+#include "util/concurrent_arena.h"
 #include "util/random.h"
 #include "util/testharness.h"
 
@@ -196,6 +199,42 @@ TEST_F(ArenaTest, Simple) {
   SimpleTest(0);
   SimpleTest(kHugePageSize);
 }
+
+TEST_F(ArenaTest, NumaAwareConcurrentArena) {
+  const int kThreads = 4;
+  const int kAllocations = 2000;
+  ConcurrentArena arena(64 * 1024, nullptr, 0, true /* numa_aware */);
+  std::vector<std::vector<std::pair<char*, size_t>>> allocated(kThreads);
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back([&, t]() {
+      Random rnd(301 + t);
+      for (int i = 0; i < kAllocations; i++) {
+        size_t s = 1 + rnd.Uniform(i % 100 == 0 ? 20000 : 100);
+        char* r = rnd.OneIn(2) ? arena.AllocateAligned(s) : arena.Allocate(s);
+        memset(r, t * kAllocations + i, s);
+        allocated[t].emplace_back(r, s);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  size_t bytes = 0;
+  for (int t = 0; t < kThreads; t++) {
+    for (int i = 0; i < kAllocations; i++) {
+      char* r = allocated[t][i].first;
+      size_t s = allocated[t][i].second;
+      for (size_t b = 0; b < s; b++) {
+        ASSERT_EQ(static_cast<int>(r[b]) & 0xff, (t * kAllocations + i) % 256);
+      }
+      bytes += s;
+    }
+  }
+  ASSERT_GE(arena.ApproximateMemoryUsage(), bytes);
+  ASSERT_GE(arena.MemoryAllocatedBytes(), arena.ApproximateMemoryUsage());
+}
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
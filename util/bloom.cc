@@ -9,6 +9,14 @@
 
 #include "rocksdb/filter_policy.h"
 
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
 #include "rocksdb/slice.h"
 #include "table/block_based_filter_block.h"
 #include "table/full_filter_bits_builder.h"
@@ -265,12 +273,181 @@ bool FullFilterBitsReader::HashMayMatch(const uint32_t& hash,
   return true;
 }
 
+// A split block bloom filter sets all bits of a key in a single 32-byte
+// block, one bit in each of its eight 32-bit words, so that a probe touches a
+// single cache line and, with AVX2, takes a handful of instructions instead
+// of num_probes dependent loads. It needs a few more bits per key than a full
+// filter for the same false positive rate.
+//
+// The filter is followed by the same 5 bytes of metadata as a full filter,
+// with num_lines set to 0, which older readers take as a filter that matches
+// every key, and num_probes set to kSplitBlockFilterMarker.
+const char kSplitBlockFilterMarker = static_cast<char>(0xff);
+const uint32_t kSplitBlockBytes = 32;
+const uint32_t kSplitBlockMetadataBytes = 5;
+
+// Every word of a block takes the bit for a key from the top five bits of the
+// hash multiplied by its own odd constant.
+const uint32_t kSplitBlockSalts[8] = {0x47b6137bU, 0x44974d91U, 0x8824ad5bU,
+                                      0xa2b7289dU, 0x705495c7U, 0x2df1424bU,
+                                      0x9efc4947U, 0x5c6bfb31U};
+
+// Returns the block of hash in a filter of num_blocks blocks
+inline uint32_t SplitBlockIndex(uint32_t hash, uint32_t num_blocks) {
+  // Use other bits of the hash than the bits within the block do
+  uint32_t block_hash = static_cast<uint32_t>(
+      (static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ULL) >> 32);
+  return static_cast<uint32_t>(
+      (static_cast<uint64_t>(block_hash) * num_blocks) >> 32);
+}
+
+inline void SplitBlockAddHash(uint32_t hash, char* block) {
+  for (int i = 0; i < 8; i++) {
+    char* word = block + i * 4;
+    EncodeFixed32(word, DecodeFixed32(word) |
+                            (1U << ((hash * kSplitBlockSalts[i]) >> 27)));
+  }
+}
+
+inline bool SplitBlockHashMayMatch(uint32_t hash, const char* block) {
+#ifdef __AVX2__
+  const __m256i salts = _mm256_loadu_si256(
+      reinterpret_cast<const __m256i*>(kSplitBlockSalts));
+  const __m256i shifts = _mm256_srli_epi32(
+      _mm256_mullo_epi32(_mm256_set1_epi32(static_cast<int>(hash)), salts),
+      27);
+  const __m256i mask = _mm256_sllv_epi32(_mm256_set1_epi32(1), shifts);
+  const __m256i bits =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+  // All bits of mask are set in bits
+  return _mm256_testc_si256(bits, mask) != 0;
+#else
+  for (int i = 0; i < 8; i++) {
+    if ((DecodeFixed32(block + i * 4) &
+         (1U << ((hash * kSplitBlockSalts[i]) >> 27))) == 0) {
+      return false;
+    }
+  }
+  return true;
+#endif
+}
+
+class SplitBlockBitsBuilder : public FilterBitsBuilder {
+ public:
+  explicit SplitBlockBitsBuilder(size_t bits_per_key)
+      : bits_per_key_(bits_per_key) {
+    assert(bits_per_key_);
+  }
+
+  virtual void AddKey(const Slice& key) override {
+    uint32_t hash = BloomHash(key);
+    if (hash_entries_.empty() || hash != hash_entries_.back()) {
+      hash_entries_.push_back(hash);
+    }
+  }
+
+  virtual Slice Finish(std::unique_ptr<const char[]>* buf) override {
+    const uint32_t num_blocks =
+        NumBlocks(static_cast<uint32_t>(hash_entries_.size()));
+    const uint32_t sz =
+        num_blocks * kSplitBlockBytes + kSplitBlockMetadataBytes;
+    char* data = new char[sz];
+    memset(data, 0, sz);
+    for (auto h : hash_entries_) {
+      SplitBlockAddHash(h, data + SplitBlockIndex(h, num_blocks) *
+                                      kSplitBlockBytes);
+    }
+    data[sz - kSplitBlockMetadataBytes] = kSplitBlockFilterMarker;
+    EncodeFixed32(data + sz - 4, 0 /* num_lines */);
+
+    buf->reset(data);
+    hash_entries_.clear();
+    return Slice(data, sz);
+  }
+
+  virtual int CalculateNumEntry(const uint32_t space) override {
+    if (space <= kSplitBlockMetadataBytes + kSplitBlockBytes) {
+      return 1;
+    }
+    uint64_t num_blocks =
+        (space - kSplitBlockMetadataBytes) / kSplitBlockBytes;
+    return static_cast<int>(
+        std::max<uint64_t>(num_blocks * kSplitBlockBytes * 8 / bits_per_key_,
+                           1));
+  }
+
+ private:
+  uint32_t NumBlocks(uint32_t num_entries) const {
+    if (num_entries == 0) {
+      return 0;
+    }
+    uint64_t total_bits = static_cast<uint64_t>(num_entries) * bits_per_key_;
+    return static_cast<uint32_t>((total_bits + kSplitBlockBytes * 8 - 1) /
+                                 (kSplitBlockBytes * 8));
+  }
+
+  size_t bits_per_key_;
+  std::vector<uint32_t> hash_entries_;
+};
+
+class SplitBlockBitsReader : public FilterBitsReader {
+ public:
+  // REQUIRES: contents is a split block filter with at least one block
+  explicit SplitBlockBitsReader(const Slice& contents)
+      : data_(contents.data()),
+        num_blocks_(static_cast<uint32_t>(
+            (contents.size() - kSplitBlockMetadataBytes) / kSplitBlockBytes)) {
+    assert(num_blocks_ > 0);
+  }
+
+  virtual bool MayMatch(const Slice& entry) override {
+    uint32_t hash = BloomHash(entry);
+    return SplitBlockHashMayMatch(
+        hash, data_ + SplitBlockIndex(hash, num_blocks_) * kSplitBlockBytes);
+  }
+
+  virtual void MultiMayMatch(int num_keys, Slice** keys,
+                             bool* may_match) override {
+    // Prefetch the blocks of a batch of keys before probing any of them, so
+    // that their cache misses overlap
+    const int kBatchSize = 32;
+    uint32_t hashes[kBatchSize];
+    const char* blocks[kBatchSize];
+    for (int start = 0; start < num_keys; start += kBatchSize) {
+      const int batch_size = std::min(num_keys - start, kBatchSize);
+      for (int i = 0; i < batch_size; i++) {
+        hashes[i] = BloomHash(*keys[start + i]);
+        blocks[i] = data_ + SplitBlockIndex(hashes[i], num_blocks_) *
+                                kSplitBlockBytes;
+        PREFETCH(blocks[i], 0 /* rw */, 1 /* locality */);
+      }
+      for (int i = 0; i < batch_size; i++) {
+        may_match[start + i] = SplitBlockHashMayMatch(hashes[i], blocks[i]);
+      }
+    }
+  }
+
+ private:
+  const char* data_;
+  uint32_t num_blocks_;
+};
+
+bool IsSplitBlockFilter(const Slice& contents) {
+  return contents.size() > kSplitBlockMetadataBytes &&
+         contents.data()[contents.size() - kSplitBlockMetadataBytes] ==
+             kSplitBlockFilterMarker &&
+         DecodeFixed32(contents.data() + contents.size() - 4) == 0 &&
+         (contents.size() - kSplitBlockMetadataBytes) % kSplitBlockBytes == 0;
+}
+
 // An implementation of filter policy
 class BloomFilterPolicy : public FilterPolicy {
  public:
-  explicit BloomFilterPolicy(int bits_per_key, bool use_block_based_builder)
+  explicit BloomFilterPolicy(int bits_per_key, bool use_block_based_builder,
+                             bool use_split_block_filter = false)
       : bits_per_key_(bits_per_key), hash_func_(BloomHash),
-        use_block_based_builder_(use_block_based_builder) {
+        use_block_based_builder_(use_block_based_builder),
+        use_split_block_filter_(use_split_block_filter) {
     initialize();
   }
 
@@ -342,11 +519,17 @@ class BloomFilterPolicy : public FilterPolicy {
       return nullptr;
     }
 
+    if (use_split_block_filter_) {
+      return new SplitBlockBitsBuilder(bits_per_key_);
+    }
     return new FullFilterBitsBuilder(bits_per_key_, num_probes_);
   }
 
   virtual FilterBitsReader* GetFilterBitsReader(const Slice& contents)
       const override {
+    if (IsSplitBlockFilter(contents)) {
+      return new SplitBlockBitsReader(contents);
+    }
     return new FullFilterBitsReader(contents);
   }
 
@@ -359,20 +542,114 @@ class BloomFilterPolicy : public FilterPolicy {
   uint32_t (*hash_func_)(const Slice& key);
 
   const bool use_block_based_builder_;
+  const bool use_split_block_filter_;
 
-  void initialize() {
+  void initialize() { num_probes_ = NumProbes(bits_per_key_); }
+
+ protected:
+  static size_t NumProbes(size_t bits_per_key) {
     // We intentionally round down to reduce probing cost a little bit
-    num_probes_ = static_cast<size_t>(bits_per_key_ * 0.69);  // 0.69 =~ ln(2)
-    if (num_probes_ < 1) num_probes_ = 1;
-    if (num_probes_ > 30) num_probes_ = 30;
+    size_t num_probes =
+        static_cast<size_t>(bits_per_key * 0.69);  // 0.69 =~ ln(2)
+    if (num_probes < 1) num_probes = 1;
+    if (num_probes > 30) num_probes = 30;
+    return num_probes;
   }
 };
 
+// Returns the bits per key of the filter of the file described by context,
+// see NewLevelAdaptiveBloomFilterPolicy().
+int LevelAdaptiveBitsPerKey(double bits_per_key,
+                            const FilterBuildingContext& context) {
+  // Cutting the false positive rate of a filter by a factor of x costs
+  // ln(x) / ln(2)^2 bits per key
+  const double ln2 = std::log(2.0);
+  const int level = context.level_at_creation;
+  const int num_level_bytes = static_cast<int>(context.level_bytes.size());
+  const uint64_t level_bytes =
+      level >= 0 && level < num_level_bytes ? context.level_bytes[level] : 0;
+  double bits = bits_per_key;
+  if (context.compaction_style == kCompactionStyleLevel && level >= 0 &&
+      level_bytes > 0) {
+    // The sum of the false positive rates for a given number of bits is the
+    // lowest when the rate of each level is proportional to its size. The
+    // bits of a level then differ from the average, weighted by size, by
+    // the log of its size relative to the weighted geometric mean.
+    double total_bytes = 0;
+    double weighted_log_bytes = 0;
+    for (uint64_t bytes : context.level_bytes) {
+      if (bytes > 0) {
+        total_bytes += static_cast<double>(bytes);
+        weighted_log_bytes +=
+            static_cast<double>(bytes) * std::log(static_cast<double>(bytes));
+      }
+    }
+    bits = bits_per_key + (weighted_log_bytes / total_bytes -
+                           std::log(static_cast<double>(level_bytes))) /
+                              (ln2 * ln2);
+  } else if (context.compaction_style == kCompactionStyleLevel &&
+             level >= 0 && context.num_levels > 1 &&
+             context.level_size_multiplier > 1) {
+    // The level has no data to weigh yet. Assume every level holds T times
+    // fewer keys than the level below it, down to the deepest level with
+    // data, so a key sits 1 / (T - 1) levels above it on average, and this
+    // is what that level gives up.
+    int last_level = context.num_levels - 1;
+    if (num_level_bytes > 0) {
+      last_level = level;
+      for (int i = num_level_bytes - 1; i > level; i--) {
+        if (context.level_bytes[i] > 0) {
+          last_level = i;
+          break;
+        }
+      }
+    }
+    int levels_above_last = std::max(last_level - level, 0);
+    if (level == 0 && context.base_level > 0) {
+      // L0 files are compacted to the base level, skipping the empty levels
+      // above it
+      levels_above_last = std::max(last_level - context.base_level + 1, 0);
+    }
+    const double bits_per_level =
+        std::log(context.level_size_multiplier) / (ln2 * ln2);
+    bits = bits_per_key -
+           bits_per_level / (context.level_size_multiplier - 1) +
+           levels_above_last * bits_per_level;
+  }
+  // A filter cannot use more than 30 probes, which is enough for ~44 bits
+  return static_cast<int>(std::min(std::max(bits + 0.5, 1.0), 44.0));
+}
+
+class LevelAdaptiveBloomFilterPolicy : public BloomFilterPolicy {
+ public:
+  explicit LevelAdaptiveBloomFilterPolicy(double bits_per_key)
+      : BloomFilterPolicy(LevelAdaptiveBitsPerKey(bits_per_key,
+                                                  FilterBuildingContext()),
+                          false /* use_block_based_builder */),
+        avg_bits_per_key_(bits_per_key) {}
+
+  virtual FilterBitsBuilder* GetBuilderWithContext(
+      const FilterBuildingContext& context) const override {
+    const int bits_per_key =
+        LevelAdaptiveBitsPerKey(avg_bits_per_key_, context);
+    return new FullFilterBitsBuilder(bits_per_key, NumProbes(bits_per_key));
+  }
+
+ private:
+  const double avg_bits_per_key_;
+};
+
 }  // namespace
 
 const FilterPolicy* NewBloomFilterPolicy(int bits_per_key,
-                                         bool use_block_based_builder) {
-  return new BloomFilterPolicy(bits_per_key, use_block_based_builder);
+                                         bool use_block_based_builder,
+                                         bool use_split_block_filter) {
+  return new BloomFilterPolicy(bits_per_key, use_block_based_builder,
+                               use_split_block_filter);
+}
+
+const FilterPolicy* NewLevelAdaptiveBloomFilterPolicy(double bits_per_key) {
+  return new LevelAdaptiveBloomFilterPolicy(bits_per_key);
 }
 
 }  // namespace rocksdb
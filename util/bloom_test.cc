@@ -309,6 +309,140 @@ TEST_F(FullBloomTest, FullVaryingLengths) {
   ASSERT_LE(mediocre_filters, good_filters/5);
 }
 
+TEST_F(FullBloomTest, SplitBlockFilter) {
+  std::unique_ptr<const FilterPolicy> policy(
+      NewBloomFilterPolicy(FLAGS_bits_per_key, false, true));
+  std::unique_ptr<const FilterPolicy> plain_policy(
+      NewBloomFilterPolicy(FLAGS_bits_per_key, false));
+  char buffer[sizeof(int)];
+
+  for (int length = 0; length <= 10000; length = NextLength(length)) {
+    std::unique_ptr<FilterBitsBuilder> builder(policy->GetFilterBitsBuilder());
+    for (int i = 0; i < length; i++) {
+      builder->AddKey(Key(i, buffer));
+    }
+    std::unique_ptr<const char[]> buf;
+    Slice filter = builder->Finish(&buf);
+    ASSERT_LE(filter.size(), (size_t)((length * 10 / 8) + 32 + 5)) << length;
+    // Either policy can read the filter
+    std::unique_ptr<FilterBitsReader> reader(
+        plain_policy->GetFilterBitsReader(filter));
+
+    std::vector<std::string> keys;
+    for (int i = 0; i < length; i++) {
+      keys.push_back(Key(i, buffer).ToString());
+    }
+    for (int i = 0; i < 10000; i++) {
+      keys.push_back(Key(i + 1000000000, buffer).ToString());
+    }
+    std::vector<Slice> key_slices(keys.begin(), keys.end());
+    std::vector<Slice*> key_ptrs;
+    for (auto& key : key_slices) {
+      key_ptrs.push_back(&key);
+    }
+    std::unique_ptr<bool[]> may_match(new bool[keys.size()]);
+    reader->MultiMayMatch(static_cast<int>(keys.size()), key_ptrs.data(),
+                          may_match.get());
+
+    int false_positives = 0;
+    for (size_t i = 0; i < keys.size(); i++) {
+      ASSERT_EQ(reader->MayMatch(key_slices[i]), may_match[i]);
+      if (i < static_cast<size_t>(length)) {
+        // All added keys must match
+        ASSERT_TRUE(may_match[i]) << "Length " << length << "; key " << i;
+      } else if (may_match[i]) {
+        false_positives++;
+      }
+    }
+    if (length == 0) {
+      ASSERT_EQ(0, false_positives);
+    } else if (length >= 1000) {
+      // A split block filter needs about a bit per key more than a full
+      // filter for the same false positive rate
+      ASSERT_LE(false_positives / 10000.0, 0.03) << length;
+    }
+  }
+}
+
+TEST_F(FullBloomTest, LevelAdaptive) {
+  std::unique_ptr<const FilterPolicy> policy(
+      NewLevelAdaptiveBloomFilterPolicy(FLAGS_bits_per_key));
+  std::unique_ptr<const FilterPolicy> plain_policy(
+      NewBloomFilterPolicy(FLAGS_bits_per_key, false));
+  char buffer[sizeof(int)];
+  const int kNumKeys = 10000;
+
+  // Builds a filter of kNumKeys keys for context, and returns its size and
+  // the number of false positives out of kNumKeys missing keys
+  auto build = [&](const FilterPolicy* builder_policy,
+                   const FilterBuildingContext& context, int* fps) -> size_t {
+    std::unique_ptr<FilterBitsBuilder> builder(
+        builder_policy->GetBuilderWithContext(context));
+    for (int i = 0; i < kNumKeys; i++) {
+      builder->AddKey(Key(i, buffer));
+    }
+    std::unique_ptr<const char[]> buf;
+    Slice filter = builder->Finish(&buf);
+    // The filters are readable by the plain bloom filter policy
+    std::unique_ptr<FilterBitsReader> reader(
+        plain_policy->GetFilterBitsReader(filter));
+    *fps = 0;
+    for (int i = 0; i < kNumKeys; i++) {
+      EXPECT_TRUE(reader->MayMatch(Key(i, buffer)));
+      if (reader->MayMatch(Key(i + 1000000000, buffer))) {
+        (*fps)++;
+      }
+    }
+    return filter.size();
+  };
+
+  FilterBuildingContext context;
+  int plain_fps;
+  size_t plain_size = build(plain_policy.get(), context, &plain_fps);
+  int fps;
+  // An unknown level gets bits_per_key bits per key
+  ASSERT_EQ(plain_size, build(policy.get(), context, &fps));
+
+  // The upper levels get larger filters with fewer false positives, the last
+  // level gets a smaller one.
+  context.num_levels = 7;
+  size_t prev_size = 0;
+  int prev_fps = kNumKeys;
+  for (int level = context.num_levels - 1; level >= 0; level--) {
+    context.level_at_creation = level;
+    size_t size = build(policy.get(), context, &fps);
+    if (level == context.num_levels - 1) {
+      ASSERT_LT(size, plain_size);
+      ASSERT_GE(fps, plain_fps);
+    }
+    ASSERT_GT(size, prev_size);
+    ASSERT_LE(fps, prev_fps);
+    prev_size = size;
+    prev_fps = fps;
+  }
+  ASSERT_EQ(0, prev_fps);
+  context.level_at_creation = 0;
+  size_t l0_size_all_levels = build(policy.get(), context, &fps);
+
+  // With the sizes of the levels, bits follow their actual ratios
+  context.level_bytes = {0, 0, 0, 0, 0, 300 << 20, 1000 << 20};
+  context.level_at_creation = 6;
+  size_t last_level_size = build(policy.get(), context, &fps);
+  ASSERT_LT(last_level_size, plain_size);
+  context.level_at_creation = 5;
+  ASSERT_GT(build(policy.get(), context, &fps), plain_size);
+  // The last level with data is 6, and L0 files go to the base level
+  context.level_at_creation = 0;
+  context.base_level = 5;
+  size_t l0_size = build(policy.get(), context, &fps);
+  ASSERT_GT(l0_size, plain_size);
+  ASSERT_LT(l0_size, l0_size_all_levels);
+
+  // Other compaction styles get bits_per_key bits per key at every level
+  context.compaction_style = kCompactionStyleUniversal;
+  ASSERT_EQ(plain_size, build(policy.get(), context, &fps));
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
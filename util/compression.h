@@ -1106,4 +1106,34 @@ inline std::string ZSTD_TrainDictionary(const std::string& samples,
 #endif  // ZSTD_VERSION_NUMBER >= 800
 }
 
+// Compresses the input with the compression type of ctx, using
+// compress_format_version for the types that are versioned. Returns false if
+// the type is not supported on this platform, or if compression failed.
+inline bool CompressData(const CompressionContext& ctx,
+                         uint32_t compress_format_version, const char* input,
+                         size_t length, ::std::string* output) {
+  switch (ctx.type()) {
+    case kSnappyCompression:
+      return Snappy_Compress(ctx, input, length, output);
+    case kZlibCompression:
+      return Zlib_Compress(ctx, compress_format_version, input, length,
+                           output);
+    case kBZip2Compression:
+      return BZip2_Compress(ctx, compress_format_version, input, length,
+                            output);
+    case kLZ4Compression:
+      return LZ4_Compress(ctx, compress_format_version, input, length, output);
+    case kLZ4HCCompression:
+      return LZ4HC_Compress(ctx, compress_format_version, input, length,
+                            output);
+    case kXpressCompression:
+      return XPRESS_Compress(input, length, output);
+    case kZSTD:
+    case kZSTDNotFinalCompression:
+      return ZSTD_Compress(ctx, input, length, output);
+    default:
+      return false;
+  }
+}
+
 }  // namespace rocksdb
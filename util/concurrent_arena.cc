@@ -8,6 +8,10 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 
 #include "util/concurrent_arena.h"
+#ifdef NUMA
+#include <numa.h>
+#include <sched.h>
+#endif
 #include <thread>
 #include "port/port.h"
 #include "util/random.h"
@@ -27,13 +31,41 @@ const size_t kMaxShardBlockSize = size_t{128 * 1024};
 }  // namespace
 
 ConcurrentArena::ConcurrentArena(size_t block_size, AllocTracker* tracker,
-                                 size_t huge_page_size)
+                                 size_t huge_page_size, bool numa_aware)
     : shard_block_size_(std::min(kMaxShardBlockSize, block_size / 8)),
       shards_(),
       arena_(block_size, tracker, huge_page_size) {
+#ifdef NUMA
+  if (numa_aware && numa_available() >= 0) {
+    for (int node = 0; node <= numa_max_node(); ++node) {
+      node_arenas_.emplace_back(
+          new Arena(block_size, tracker, huge_page_size, node));
+    }
+    for (int cpu = 0; cpu < numa_num_configured_cpus(); ++cpu) {
+      cpu_nodes_.push_back(numa_node_of_cpu(cpu));
+    }
+  }
+#else
+  (void)numa_aware;
+#endif
   Fixup();
 }
 
+Arena* ConcurrentArena::LocalArena() {
+#ifdef NUMA
+  if (!node_arenas_.empty()) {
+    int cpu = sched_getcpu();
+    if (cpu >= 0 && static_cast<size_t>(cpu) < cpu_nodes_.size()) {
+      int node = cpu_nodes_[cpu];
+      if (node >= 0 && static_cast<size_t>(node) < node_arenas_.size()) {
+        return node_arenas_[node].get();
+      }
+    }
+  }
+#endif
+  return &arena_;
+}
+
 ConcurrentArena::Shard* ConcurrentArena::Repick() {
   auto shard_and_index = shards_.AccessElementAndIndex();
 #ifdef ROCKSDB_SUPPORT_THREAD_LOCAL
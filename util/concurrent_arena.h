@@ -11,6 +11,7 @@
 #include <atomic>
 #include <memory>
 #include <utility>
+#include <vector>
 #include "port/likely.h"
 #include "util/allocator.h"
 #include "util/arena.h"
@@ -43,13 +44,16 @@ class ConcurrentArena : public Allocator {
   // in fact just passed to the constructor of arena_.  The core-local
   // shards compute their shard_block_size as a fraction of block_size
   // that varies according to the hardware concurrency level.
+  // If numa_aware is true and RocksDB is built with NUMA support, there is
+  // an additional Arena for each NUMA node, and memory is always taken from
+  // the one of the node the calling thread runs on.
   explicit ConcurrentArena(size_t block_size = Arena::kMinBlockSize,
                            AllocTracker* tracker = nullptr,
-                           size_t huge_page_size = 0);
+                           size_t huge_page_size = 0, bool numa_aware = false);
 
   char* Allocate(size_t bytes) override {
     return AllocateImpl(bytes, false /*force_arena*/,
-                        [=]() { return arena_.Allocate(bytes); });
+                        [=](Arena* arena) { return arena->Allocate(bytes); });
   }
 
   char* AllocateAligned(size_t bytes, size_t huge_page_size = 0,
@@ -58,15 +62,21 @@ class ConcurrentArena : public Allocator {
     assert(rounded_up >= bytes && rounded_up < bytes + sizeof(void*) &&
            (rounded_up % sizeof(void*)) == 0);
 
-    return AllocateImpl(rounded_up, huge_page_size != 0 /*force_arena*/, [=]() {
-      return arena_.AllocateAligned(rounded_up, huge_page_size, logger);
-    });
+    return AllocateImpl(rounded_up, huge_page_size != 0 /*force_arena*/,
+                        [=](Arena* arena) {
+                          return arena->AllocateAligned(rounded_up,
+                                                        huge_page_size, logger);
+                        });
   }
 
   size_t ApproximateMemoryUsage() const {
     std::unique_lock<SpinMutex> lock(arena_mutex_, std::defer_lock);
     lock.lock();
-    return arena_.ApproximateMemoryUsage() - ShardAllocatedAndUnused();
+    size_t usage = arena_.ApproximateMemoryUsage();
+    for (const auto& node_arena : node_arenas_) {
+      usage += node_arena->ApproximateMemoryUsage();
+    }
+    return usage - ShardAllocatedAndUnused();
   }
 
   size_t MemoryAllocatedBytes() const {
@@ -107,6 +117,11 @@ class ConcurrentArena : public Allocator {
   CoreLocalArray<Shard> shards_;
 
   Arena arena_;
+  // One arena per NUMA node if numa_aware, indexed by node. Protected by
+  // arena_mutex_ like arena_.
+  std::vector<std::unique_ptr<Arena>> node_arenas_;
+  // NUMA node of each CPU, for picking from node_arenas_
+  std::vector<int> cpu_nodes_;
   mutable SpinMutex arena_mutex_;
   std::atomic<size_t> arena_allocated_and_unused_;
   std::atomic<size_t> memory_allocated_bytes_;
@@ -116,6 +131,10 @@ class ConcurrentArena : public Allocator {
 
   Shard* Repick();
 
+  // Returns the arena to allocate from on the calling thread's CPU.
+  // REQUIRES: arena_mutex_ is held
+  Arena* LocalArena();
+
   size_t ShardAllocatedAndUnused() const {
     size_t total = 0;
     for (size_t i = 0; i < shards_.Size(); ++i) {
@@ -142,7 +161,7 @@ class ConcurrentArena : public Allocator {
       if (!arena_lock.owns_lock()) {
         arena_lock.lock();
       }
-      auto rv = func();
+      auto rv = func(LocalArena());
       Fixup();
       return rv;
     }
@@ -162,10 +181,10 @@ class ConcurrentArena : public Allocator {
 
       // If the arena's current block is within a factor of 2 of the right
       // size, we adjust our request to avoid arena waste.
-      auto exact = arena_allocated_and_unused_.load(std::memory_order_relaxed);
-      assert(exact == arena_.AllocatedAndUnused());
+      Arena* arena = LocalArena();
+      auto exact = arena->AllocatedAndUnused();
 
-      if (exact >= bytes && arena_.IsInInlineBlock()) {
+      if (exact >= bytes && arena->IsInInlineBlock()) {
         // If we haven't exhausted arena's inline block yet, allocate from arena
         // directly. This ensures that we'll do the first few small allocations
         // without allocating any blocks.
@@ -174,7 +193,7 @@ class ConcurrentArena : public Allocator {
         // the order of 1 KB of memory when created; we wouldn't want to
         // allocate a full arena block (typically a few megabytes) for that,
         // especially if there are thousands of empty memtables.
-        auto rv = func();
+        auto rv = func(arena);
         Fixup();
         return rv;
       }
@@ -182,7 +201,7 @@ class ConcurrentArena : public Allocator {
       avail = exact >= shard_block_size_ / 2 && exact < shard_block_size_ * 2
                   ? exact
                   : shard_block_size_;
-      s->free_begin_ = arena_.AllocateAligned(avail);
+      s->free_begin_ = arena->AllocateAligned(avail);
       Fixup();
     }
     s->allocated_and_unused_.store(avail - bytes, std::memory_order_relaxed);
@@ -200,12 +219,19 @@ class ConcurrentArena : public Allocator {
   }
 
   void Fixup() {
-    arena_allocated_and_unused_.store(arena_.AllocatedAndUnused(),
+    size_t allocated_and_unused = arena_.AllocatedAndUnused();
+    size_t memory_allocated_bytes = arena_.MemoryAllocatedBytes();
+    size_t irregular_block_num = arena_.IrregularBlockNum();
+    for (const auto& node_arena : node_arenas_) {
+      allocated_and_unused += node_arena->AllocatedAndUnused();
+      memory_allocated_bytes += node_arena->MemoryAllocatedBytes();
+      irregular_block_num += node_arena->IrregularBlockNum();
+    }
+    arena_allocated_and_unused_.store(allocated_and_unused,
                                       std::memory_order_relaxed);
-    memory_allocated_bytes_.store(arena_.MemoryAllocatedBytes(),
+    memory_allocated_bytes_.store(memory_allocated_bytes,
                                   std::memory_order_relaxed);
-    irregular_block_num_.store(arena_.IrregularBlockNum(),
-                               std::memory_order_relaxed);
+    irregular_block_num_.store(irregular_block_num, std::memory_order_relaxed);
   }
 
   ConcurrentArena(const ConcurrentArena&) = delete;
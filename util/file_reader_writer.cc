@@ -155,6 +155,35 @@ Status RandomAccessFileReader::Read(uint64_t offset, size_t n, Slice* result,
   return s;
 }
 
+Status RandomAccessFileReader::MultiRead(ReadRequest* read_reqs,
+                                         size_t num_reqs) const {
+  if (use_direct_io() || (for_compaction_ && rate_limiter_ != nullptr)) {
+    for (size_t i = 0; i < num_reqs; ++i) {
+      ReadRequest& req = read_reqs[i];
+      req.status = Read(req.offset, req.len, &req.result, req.scratch);
+    }
+    return Status::OK();
+  }
+  Status s;
+  uint64_t elapsed = 0;
+  {
+    StopWatch sw(env_, stats_, hist_type_,
+                 (stats_ != nullptr) ? &elapsed : nullptr, true /*overwrite*/,
+                 true /*delay_enabled*/);
+    IOSTATS_TIMER_GUARD(read_nanos);
+    s = file_->MultiRead(read_reqs, num_reqs);
+    for (size_t i = 0; s.ok() && i < num_reqs; ++i) {
+      if (read_reqs[i].status.ok()) {
+        IOSTATS_ADD_IF_POSITIVE(bytes_read, read_reqs[i].result.size());
+      }
+    }
+  }
+  if (stats_ != nullptr && file_read_hist_ != nullptr) {
+    file_read_hist_->Add(elapsed);
+  }
+  return s;
+}
+
 Status WritableFileWriter::Append(const Slice& data) {
   const char* src = data.data();
   size_t left = data.size();
@@ -712,12 +741,67 @@ Status FilePrefetchBuffer::Prefetch(RandomAccessFileReader* reader,
   return s;
 }
 
+Status FilePrefetchBuffer::PrefetchRanges(
+    RandomAccessFileReader* reader,
+    const std::vector<std::pair<uint64_t, size_t>>& ranges) {
+  ranges_.clear();
+  size_t total_len = 0;
+  for (const auto& range : ranges) {
+    total_len += range.second;
+  }
+  ranges_buffer_.reset(new char[total_len]);
+  std::vector<ReadRequest> reqs(ranges.size());
+  char* scratch = ranges_buffer_.get();
+  for (size_t i = 0; i < ranges.size(); ++i) {
+    assert(i == 0 || ranges[i - 1].first + ranges[i - 1].second <=
+                         ranges[i].first);
+    reqs[i].offset = ranges[i].first;
+    reqs[i].len = ranges[i].second;
+    reqs[i].scratch = scratch;
+    scratch += ranges[i].second;
+  }
+  Status s = reader->MultiRead(reqs.data(), reqs.size());
+  if (!s.ok()) {
+    return s;
+  }
+  for (auto& req : reqs) {
+    if (!req.status.ok()) {
+      continue;
+    }
+    if (req.result.data() != req.scratch) {
+      // e.g. reads of mmap'd files
+      memcpy(req.scratch, req.result.data(), req.result.size());
+    }
+    ranges_.emplace_back(req.offset, Slice(req.scratch, req.result.size()));
+  }
+  return Status::OK();
+}
+
 bool FilePrefetchBuffer::TryReadFromCache(uint64_t offset, size_t n,
                                           Slice* result) {
   if (track_min_offset_ && offset < min_offset_read_) {
     min_offset_read_ = offset;
   }
-  if (!enable_ || offset < buffer_offset_) {
+  if (!enable_) {
+    return false;
+  }
+  if (ranges_buffer_ != nullptr) {
+    auto it = std::upper_bound(
+        ranges_.begin(), ranges_.end(), offset,
+        [](uint64_t off, const std::pair<uint64_t, Slice>& range) {
+          return off < range.first;
+        });
+    if (it == ranges_.begin()) {
+      return false;
+    }
+    --it;
+    if (offset + n > it->first + it->second.size()) {
+      return false;
+    }
+    *result = Slice(it->second.data() + (offset - it->first), n);
+    return true;
+  }
+  if (offset < buffer_offset_) {
     return false;
   }
 
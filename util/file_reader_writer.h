@@ -9,6 +9,8 @@
 #pragma once
 #include <atomic>
 #include <string>
+#include <utility>
+#include <vector>
 #include "port/port.h"
 #include "rocksdb/env.h"
 #include "rocksdb/rate_limiter.h"
@@ -109,6 +111,10 @@ class RandomAccessFileReader {
 
   Status Read(uint64_t offset, size_t n, Slice* result, char* scratch) const;
 
+  // Issues the reads together with RandomAccessFile::MultiRead(). With
+  // direct I/O or rate limiting, they are done one by one with Read().
+  Status MultiRead(ReadRequest* reqs, size_t num_reqs) const;
+
   Status Prefetch(uint64_t offset, size_t n) const {
     return file_->Prefetch(offset, n);
   }
@@ -225,6 +231,12 @@ class FilePrefetchBuffer {
         enable_(enable),
         track_min_offset_(track_min_offset) {}
   Status Prefetch(RandomAccessFileReader* reader, uint64_t offset, size_t n);
+  // Reads several ranges of the file, given as offset and length sorted by
+  // offset, with a single RandomAccessFileReader::MultiRead(). From then on
+  // TryReadFromCache() only serves reads within one of them. Ranges that
+  // failed to read are left out.
+  Status PrefetchRanges(RandomAccessFileReader* reader,
+                        const std::vector<std::pair<uint64_t, size_t>>& ranges);
   bool TryReadFromCache(uint64_t offset, size_t n, Slice* result);
 
   // The minimum `offset` ever passed to TryReadFromCache(). Only be tracked
@@ -245,6 +257,10 @@ class FilePrefetchBuffer {
   // If true, track minimum `offset` ever passed to TryReadFromCache(), which
   // can be fetched from min_offset_read().
   bool track_min_offset_;
+  // Offsets and contents of the ranges read by PrefetchRanges(), pointing
+  // into ranges_buffer_
+  std::vector<std::pair<uint64_t, Slice>> ranges_;
+  std::unique_ptr<char[]> ranges_buffer_;
 };
 
 extern Status NewWritableFile(Env* env, const std::string& fname,
@@ -12,6 +12,7 @@
 #include <utility>
 
 #include "util/heap.h"
+#include "util/loser_tree.h"
 
 #ifndef GFLAGS
 const int64_t FLAGS_iters = 100000;
@@ -21,8 +22,9 @@ DEFINE_int64(iters, 100000, "number of pseudo-random operations in each test");
 #endif  // GFLAGS
 
 /*
- * Compares the custom heap implementation in util/heap.h against
- * std::priority_queue on a pseudo-random sequence of operations.
+ * Compares the custom heap implementations in util/heap.h and
+ * util/loser_tree.h against std::priority_queue on a pseudo-random sequence
+ * of operations.
  */
 
 namespace rocksdb {
@@ -31,11 +33,15 @@ using HeapTestValue = uint64_t;
 using Params = std::tuple<size_t, HeapTestValue, int64_t>;
 
 class HeapTest : public ::testing::TestWithParam<Params> {
+ protected:
+  template <typename Heap>
+  void RunTest();
 };
 
-TEST_P(HeapTest, Test) {
+template <typename Heap>
+void HeapTest::RunTest() {
   // This test performs the same pseudorandom sequence of operations on a
-  // BinaryHeap and an std::priority_queue, comparing output.  The three
+  // heap and an std::priority_queue, comparing output.  The three
   // possible operations are insert, replace top and pop.
   //
   // Insert is chosen slightly more often than the others so that the size of
@@ -47,7 +53,7 @@ TEST_P(HeapTest, Test) {
   const auto MAX_VALUE = std::get<1>(GetParam());
   const auto RNG_SEED = std::get<2>(GetParam());
 
-  BinaryHeap<HeapTestValue> heap;
+  Heap heap;
   std::priority_queue<HeapTestValue> ref;
 
   std::mt19937 rng(static_cast<unsigned int>(RNG_SEED));
@@ -102,6 +108,10 @@ TEST_P(HeapTest, Test) {
   ASSERT_TRUE(heap.empty());
 }
 
+TEST_P(HeapTest, Test) { RunTest<BinaryHeap<HeapTestValue>>(); }
+
+TEST_P(HeapTest, LoserTree) { RunTest<LoserTree<HeapTestValue>>(); }
+
 // Basic test, MAX_VALUE = 3*MAX_HEAP_SIZE (occasional duplicates)
 INSTANTIATE_TEST_CASE_P(
   Basic, HeapTest,
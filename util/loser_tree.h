@@ -0,0 +1,147 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include "util/autovector.h"
+
+namespace rocksdb {
+
+// Loser tree (tournament tree) for multi-way merges, with the same interface
+// and the same counterintuitive ordering as BinaryHeap: the comparison
+// operator provides the less-than relation and top() returns the maximum.
+//
+// Every leaf holds one input and every internal node holds the loser of the
+// match between the winners of its two subtrees. When the top is replaced or
+// popped, only the matches on the path from its leaf to the root are
+// replayed, which always takes exactly ceil(logN) comparisons. BinaryHeap's
+// downheap needs up to 2logN comparisons, so this wins for merges of many
+// inputs whose keys interleave, e.g. reads over a large number of L0 files.
+//
+// Popped leaves are kept as exhausted inputs that lose every match without a
+// comparison. push() drops them and appends a leaf, and the tree is rebuilt
+// in N - 1 comparisons on the next access, so a batch of pushes, as done by
+// the seeks of MergingIterator, builds the tree only once.
+template <typename T, typename Compare = std::less<T>>
+class LoserTree {
+ public:
+  LoserTree() {}
+  explicit LoserTree(Compare cmp) : cmp_(std::move(cmp)) {}
+
+  void push(const T& value) {
+    if (num_active_ < leaves_.size()) {
+      RemoveExhausted();
+    }
+    leaves_.push_back(value);
+    exhausted_.push_back(0);
+    num_active_++;
+    built_ = false;
+  }
+
+  const T& top() const {
+    assert(!empty());
+    MaybeBuild();
+    return leaves_[nodes_[0]];
+  }
+
+  void replace_top(const T& value) {
+    assert(!empty());
+    MaybeBuild();
+    leaves_[nodes_[0]] = value;
+    Replay(nodes_[0]);
+  }
+
+  void pop() {
+    assert(!empty());
+    MaybeBuild();
+    exhausted_[nodes_[0]] = 1;
+    num_active_--;
+    Replay(nodes_[0]);
+  }
+
+  void clear() {
+    leaves_.clear();
+    exhausted_.clear();
+    nodes_.clear();
+    num_active_ = 0;
+    built_ = true;
+  }
+
+  bool empty() const { return num_active_ == 0; }
+
+ private:
+  // Returns true if leaf a goes before leaf b
+  bool Wins(size_t a, size_t b) const {
+    if (exhausted_[a]) {
+      return false;
+    }
+    if (exhausted_[b]) {
+      return true;
+    }
+    return cmp_(leaves_[b], leaves_[a]);
+  }
+
+  // Leaf i is at node leaves_.size() + i and the children of node j are at
+  // 2j and 2j + 1, which gives a complete binary tree for any number of
+  // leaves. nodes_[j] is the loser of the match at node j for j > 0 and
+  // nodes_[0] is the overall winner.
+  void MaybeBuild() const {
+    if (built_) {
+      return;
+    }
+    const size_t n = leaves_.size();
+    nodes_.resize(n);
+    winners_.resize(n);
+    for (size_t j = n - 1; j > 0; j--) {
+      size_t left = 2 * j < n ? winners_[2 * j] : 2 * j - n;
+      size_t right = 2 * j + 1 < n ? winners_[2 * j + 1] : 2 * j + 1 - n;
+      if (Wins(right, left)) {
+        std::swap(left, right);
+      }
+      winners_[j] = left;
+      nodes_[j] = right;
+    }
+    nodes_[0] = n > 1 ? winners_[1] : 0;
+    built_ = true;
+  }
+
+  void RemoveExhausted() {
+    size_t n = 0;
+    for (size_t i = 0; i < leaves_.size(); i++) {
+      if (!exhausted_[i]) {
+        leaves_[n] = leaves_[i];
+        exhausted_[n] = 0;
+        n++;
+      }
+    }
+    leaves_.resize(n);
+    exhausted_.resize(n);
+  }
+
+  void Replay(size_t leaf) {
+    size_t winner = leaf;
+    for (size_t j = (leaves_.size() + leaf) / 2; j > 0; j /= 2) {
+      if (Wins(nodes_[j], winner)) {
+        std::swap(nodes_[j], winner);
+      }
+    }
+    nodes_[0] = winner;
+  }
+
+  Compare cmp_;
+  autovector<T> leaves_;
+  autovector<uint8_t> exhausted_;
+  size_t num_active_ = 0;
+  mutable autovector<size_t> nodes_;
+  // Scratch space of MaybeBuild()
+  mutable autovector<size_t> winners_;
+  mutable bool built_ = true;
+};
+
+}  // namespace rocksdb
@@ -308,6 +308,8 @@ void RandomInitCFOptions(ColumnFamilyOptions* cf_opt, Random* rnd) {
   cf_opt->paranoid_file_checks = rnd->Uniform(2);
   cf_opt->purge_redundant_kvs_while_flush = rnd->Uniform(2);
   cf_opt->force_consistency_checks = rnd->Uniform(2);
+  cf_opt->memtable_point_lookup_index = rnd->Uniform(2);
+  cf_opt->memtable_numa_aware_allocation = rnd->Uniform(2);
   cf_opt->compaction_options_fifo.allow_compaction = rnd->Uniform(2);
 
   // double options
@@ -339,6 +341,7 @@ void RandomInitCFOptions(ColumnFamilyOptions* cf_opt, Random* rnd) {
   cf_opt->inplace_update_num_locks = rnd->Uniform(10000);
   cf_opt->max_successive_merges = rnd->Uniform(10000);
   cf_opt->memtable_huge_page_size = rnd->Uniform(10000);
+  cf_opt->memtable_protection_bytes_per_key = rnd->Uniform(2) * 4;
   cf_opt->write_buffer_size = rnd->Uniform(10000);
 
   // uint32_t options
@@ -73,6 +73,9 @@ public:
   // Reset all thread local data to replacement, and return non-nullptr
   // data for all existing threads
   void Scrape(uint32_t id, autovector<void*>* ptrs, void* const replacement);
+  // Reset all non-nullptr thread local data to replacement, applying func
+  // on the data replaced
+  void Replace(uint32_t id, void* const replacement, ReplaceFunc func);
   // Update res by applying func on each thread-local value. Holds a lock that
   // prevents unref handler from running during this call, but clients must
   // still provide external synchronization since the owning thread can
@@ -450,6 +453,26 @@ void ThreadLocalPtr::StaticMeta::Scrape(uint32_t id, autovector<void*>* ptrs,
   }
 }
 
+void ThreadLocalPtr::StaticMeta::Replace(uint32_t id, void* const replacement,
+                                         ReplaceFunc func) {
+  MutexLock l(Mutex());
+  for (ThreadData* t = head_.next; t != &head_; t = t->next) {
+    if (id < t->entries.size()) {
+      void* ptr = t->entries[id].ptr.load(std::memory_order_acquire);
+      // The owning thread may change the data concurrently, but never back
+      // to nullptr
+      while (ptr != nullptr &&
+             !t->entries[id].ptr.compare_exchange_weak(
+                 ptr, replacement, std::memory_order_acq_rel,
+                 std::memory_order_acquire)) {
+      }
+      if (ptr != nullptr) {
+        func(ptr);
+      }
+    }
+  }
+}
+
 void ThreadLocalPtr::StaticMeta::Fold(uint32_t id, FoldFunc func, void* res) {
   MutexLock l(Mutex());
   for (ThreadData* t = head_.next; t != &head_; t = t->next) {
@@ -547,6 +570,10 @@ void ThreadLocalPtr::Scrape(autovector<void*>* ptrs, void* const replacement) {
   Instance()->Scrape(id_, ptrs, replacement);
 }
 
+void ThreadLocalPtr::Replace(void* const replacement, ReplaceFunc func) {
+  Instance()->Replace(id_, replacement, func);
+}
+
 void ThreadLocalPtr::Fold(FoldFunc func, void* res) {
   Instance()->Fold(id_, func, res);
 }
@@ -69,6 +69,14 @@ class ThreadLocalPtr {
   // data for all existing threads
   void Scrape(autovector<void*>* ptrs, void* const replacement);
 
+  typedef std::function<void(void*)> ReplaceFunc;
+  // Like Scrape(), but leaves threads without data (nullptr) alone, and
+  // applies func on the data of each thread it replaces instead of returning
+  // it. Holds a lock that prevents unref handler from running during this
+  // call, so func can also take the references the replacement needs before
+  // a thread can exit and drop them.
+  void Replace(void* const replacement, ReplaceFunc func);
+
   typedef std::function<void(void*, void*)> FoldFunc;
   // Update res by applying func on each thread-local value. Holds a lock that
   // prevents unref handler from running during this call, but clients must
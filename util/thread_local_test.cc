@@ -459,6 +459,55 @@ TEST_F(ThreadLocalTest, Scrape) {
   }
 }
 
+TEST_F(ThreadLocalTest, Replace) {
+  auto func = [](void* ptr) {
+    auto& p = *static_cast<Params*>(ptr);
+
+    p.mu->Lock();
+    // Half of the threads set data
+    if (p.started++ % 2 == 0) {
+      p.tls1.Reset(ptr);
+    }
+    ++(p.completed);
+    p.cv->SignalAll();
+
+    // Waiting for instruction to exit thread
+    while (p.completed != 0) {
+      p.cv->Wait();
+    }
+    p.mu->Unlock();
+
+    // The data was replaced
+    ASSERT_TRUE(p.tls1.Get() == nullptr || p.tls1.Get() == &p.total);
+  };
+
+  port::Mutex mu;
+  port::CondVar cv(&mu);
+  Params p(&mu, &cv, nullptr, 16);
+  for (int i = 0; i < p.total; ++i) {
+    env_->StartThread(func, static_cast<void*>(&p));
+  }
+  mu.Lock();
+  while (p.completed != p.total) {
+    cv.Wait();
+  }
+  mu.Unlock();
+
+  int replaced = 0;
+  p.tls1.Replace(&p.total, [&](void* ptr) {
+    ASSERT_EQ(&p, ptr);
+    ++replaced;
+  });
+  ASSERT_EQ(p.total / 2, replaced);
+
+  // Signal to exit
+  mu.Lock();
+  p.completed = 0;
+  cv.SignalAll();
+  mu.Unlock();
+  env_->WaitForJoin();
+}
+
 TEST_F(ThreadLocalTest, Fold) {
   auto unref = [](void* ptr) {
     delete static_cast<std::atomic<int64_t>*>(ptr);
@@ -9,6 +9,7 @@
 #include <sstream>
 #include <thread>
 #include "db/db_impl.h"
+#include "db/write_batch_internal.h"
 #include "rocksdb/slice.h"
 #include "rocksdb/write_batch.h"
 #include "util/coding.h"
@@ -40,7 +41,18 @@ Status Tracer::Write(WriteBatch* write_batch) {
   Trace trace;
   trace.ts = env_->NowMicros();
   trace.type = kTraceWrite;
-  trace.payload = write_batch->Data();
+  if (WriteBatchInternal::HasValueReferences(write_batch)) {
+    // Data() leaves out the values the batch references
+    std::vector<Slice> parts;
+    WriteBatchInternal::AppendContentParts(
+        write_batch, 0, WriteBatchInternal::Contents(write_batch).size(),
+        &parts);
+    for (const auto& part : parts) {
+      trace.payload.append(part.data(), part.size());
+    }
+  } else {
+    trace.payload = write_batch->Data();
+  }
   return WriteTrace(trace);
 }
 
@@ -0,0 +1,364 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// An xor filter (Graf and Lemire, "Xor Filters: Faster and Smaller Than
+// Bloom and Cuckoo Filters") stores an r-bit fingerprint of every key as the
+// xor of three slots of an array of 1.23 * n r-bit slots, one in each third
+// of the array. A key that was not added matches with probability 2^-r, so
+// the filter needs 1.23 * log2(1/fp_rate) bits per key where a bloom filter
+// needs 1.44 * log2(1/fp_rate), and more with cache-local probing. Unlike a
+// bloom filter it cannot be built incrementally, which SST filters never
+// need.
+//
+// The filter is laid out as
+//
+//     [fingerprints: 3 * block_length r-bit slots, packed]
+//     [seed: fixed64] [block_length: fixed32] [r: 1 byte]
+//
+// where block_length is 0 for a filter of no keys, and r is 0 for a filter
+// that matches every key, which is what the builder emits in the unlikely
+// case that it cannot find a seed for which the construction succeeds.
+
+#include <algorithm>
+#include <vector>
+
+#include "port/port.h"
+#include "rocksdb/filter_policy.h"
+#include "rocksdb/slice.h"
+#include "util/coding.h"
+#include "util/hash.h"
+
+namespace rocksdb {
+
+namespace {
+
+const size_t kXorFilterMetadataBytes = 8 + 4 + 1;
+const int kMaxFingerprintBits = 16;
+const int kMaxSeedAttempts = 100;
+
+// Returns the number of slots of each third of the fingerprint array for
+// num_keys keys
+uint32_t XorFilterBlockLength(uint32_t num_keys) {
+  if (num_keys == 0) {
+    return 0;
+  }
+  return static_cast<uint32_t>(32 + 1.23 * num_keys) / 3;
+}
+
+size_t XorFilterSize(uint32_t block_length, int fingerprint_bits) {
+  return (static_cast<uint64_t>(block_length) * 3 * fingerprint_bits + 7) / 8 +
+         kXorFilterMetadataBytes;
+}
+
+// The 64-bit finalizer of MurmurHash3, which mixes the seed into the key hash
+inline uint64_t XorFilterHash(uint32_t key_hash, uint64_t seed) {
+  uint64_t h = key_hash + seed;
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+// Returns the slots of hash in each third of the fingerprint array
+inline void XorFilterSlots(uint64_t hash, uint32_t block_length,
+                           uint32_t slots[3]) {
+  for (int i = 0; i < 3; i++) {
+    // The low 32 bits of hash rotated left by 0, 21 and 42 bits
+    uint32_t h = static_cast<uint32_t>(
+        i == 0 ? hash : (hash << (i * 21)) | (hash >> (64 - i * 21)));
+    slots[i] = static_cast<uint32_t>(
+                   (static_cast<uint64_t>(h) * block_length) >> 32) +
+               i * block_length;
+  }
+}
+
+inline uint32_t XorFilterFingerprint(uint64_t hash, uint32_t mask) {
+  return static_cast<uint32_t>(hash ^ (hash >> 32)) & mask;
+}
+
+// The fingerprint of slot, which is fingerprint_bits <= 16 bits wide, fits in
+// the 8 bytes from the byte it starts in. The metadata after the fingerprints
+// is long enough that these 8 bytes never run past the end of the filter.
+inline uint32_t GetFingerprint(const char* data, uint32_t slot,
+                               int fingerprint_bits, uint32_t mask) {
+  uint64_t bit = static_cast<uint64_t>(slot) * fingerprint_bits;
+  return static_cast<uint32_t>(DecodeFixed64(data + bit / 8) >> (bit % 8)) &
+         mask;
+}
+
+// REQUIRES: the fingerprint of slot is 0
+inline void SetFingerprint(char* data, uint32_t slot, int fingerprint_bits,
+                           uint32_t fingerprint) {
+  uint64_t bit = static_cast<uint64_t>(slot) * fingerprint_bits;
+  char* word = data + bit / 8;
+  EncodeFixed64(word, DecodeFixed64(word) |
+                          (static_cast<uint64_t>(fingerprint) << (bit % 8)));
+}
+
+class XorFilterBitsBuilder : public FilterBitsBuilder {
+ public:
+  explicit XorFilterBitsBuilder(int fingerprint_bits)
+      : fingerprint_bits_(fingerprint_bits) {
+    assert(fingerprint_bits_ > 0 && fingerprint_bits_ <= kMaxFingerprintBits);
+  }
+
+  virtual void AddKey(const Slice& key) override {
+    uint32_t hash = BloomHash(key);
+    if (hash_entries_.empty() || hash != hash_entries_.back()) {
+      hash_entries_.push_back(hash);
+    }
+  }
+
+  virtual Slice Finish(std::unique_ptr<const char[]>* buf) override {
+    // Keys with the same hash share their fingerprint, and would make the
+    // construction fail for every seed
+    std::sort(hash_entries_.begin(), hash_entries_.end());
+    hash_entries_.erase(
+        std::unique(hash_entries_.begin(), hash_entries_.end()),
+        hash_entries_.end());
+
+    const uint32_t block_length =
+        XorFilterBlockLength(static_cast<uint32_t>(hash_entries_.size()));
+    int fingerprint_bits = fingerprint_bits_;
+    uint64_t seed = 0;
+    std::vector<std::pair<uint64_t, uint32_t>> assignments;
+    if (block_length > 0 && !Construct(block_length, &seed, &assignments)) {
+      fingerprint_bits = 0;
+    }
+
+    const size_t sz = XorFilterSize(block_length, fingerprint_bits);
+    char* data = new char[sz];
+    memset(data, 0, sz);
+    const uint32_t mask = (1U << fingerprint_bits) - 1;
+    // The other slots of a key can only be the slots of keys assigned after
+    // it, so fill the slots in reverse order
+    for (auto it = assignments.rbegin(); it != assignments.rend(); ++it) {
+      if (fingerprint_bits == 0) {
+        break;
+      }
+      uint32_t slots[3];
+      XorFilterSlots(it->first, block_length, slots);
+      uint32_t fingerprint = XorFilterFingerprint(it->first, mask);
+      for (uint32_t slot : slots) {
+        if (slot != it->second) {
+          fingerprint ^= GetFingerprint(data, slot, fingerprint_bits, mask);
+        }
+      }
+      SetFingerprint(data, it->second, fingerprint_bits, fingerprint);
+    }
+    char* metadata = data + sz - kXorFilterMetadataBytes;
+    EncodeFixed64(metadata, seed);
+    EncodeFixed32(metadata + 8, block_length);
+    metadata[12] = static_cast<char>(fingerprint_bits);
+
+    buf->reset(data);
+    hash_entries_.clear();
+    return Slice(data, sz);
+  }
+
+  virtual int CalculateNumEntry(const uint32_t space) override {
+    if (space <= kXorFilterMetadataBytes) {
+      return 1;
+    }
+    int n = static_cast<int>(
+        ((space - kXorFilterMetadataBytes) * 8.0 / fingerprint_bits_ - 32) /
+        1.23);
+    while (n > 1 &&
+           XorFilterSize(XorFilterBlockLength(n), fingerprint_bits_) > space) {
+      n--;
+    }
+    return std::max(n, 1);
+  }
+
+ private:
+  // Finds a seed for which every key can be assigned a slot of its own among
+  // its three slots, by repeatedly assigning a key to a slot that no other
+  // unassigned key maps to. Stores the hashes of the keys and their slots in
+  // the order they were assigned in *assignments.
+  bool Construct(uint32_t block_length, uint64_t* seed,
+                 std::vector<std::pair<uint64_t, uint32_t>>* assignments) {
+    const uint32_t capacity = 3 * block_length;
+    std::vector<uint32_t> counts(capacity);
+    std::vector<uint64_t> hash_xors(capacity);
+    std::vector<uint32_t> single_slots;
+    for (int attempt = 0; attempt < kMaxSeedAttempts; attempt++) {
+      *seed = XorFilterHash(attempt, 0x9e3779b97f4a7c15ULL);
+      std::fill(counts.begin(), counts.end(), 0);
+      std::fill(hash_xors.begin(), hash_xors.end(), 0);
+      assignments->clear();
+      single_slots.clear();
+
+      uint32_t slots[3];
+      for (uint32_t key_hash : hash_entries_) {
+        uint64_t hash = XorFilterHash(key_hash, *seed);
+        XorFilterSlots(hash, block_length, slots);
+        for (uint32_t slot : slots) {
+          counts[slot]++;
+          hash_xors[slot] ^= hash;
+        }
+      }
+      for (uint32_t slot = 0; slot < capacity; slot++) {
+        if (counts[slot] == 1) {
+          single_slots.push_back(slot);
+        }
+      }
+      while (!single_slots.empty()) {
+        uint32_t single_slot = single_slots.back();
+        single_slots.pop_back();
+        if (counts[single_slot] != 1) {
+          continue;
+        }
+        // The only key left in single_slot is the xor of the keys there
+        uint64_t hash = hash_xors[single_slot];
+        assignments->emplace_back(hash, single_slot);
+        XorFilterSlots(hash, block_length, slots);
+        for (uint32_t slot : slots) {
+          counts[slot]--;
+          hash_xors[slot] ^= hash;
+          if (counts[slot] == 1) {
+            single_slots.push_back(slot);
+          }
+        }
+      }
+      if (assignments->size() == hash_entries_.size()) {
+        return true;
+      }
+    }
+    assignments->clear();
+    return false;
+  }
+
+  int fingerprint_bits_;
+  std::vector<uint32_t> hash_entries_;
+};
+
+class XorFilterBitsReader : public FilterBitsReader {
+ public:
+  explicit XorFilterBitsReader(const Slice& contents)
+      : data_(contents.data()),
+        seed_(0),
+        block_length_(0),
+        fingerprint_bits_(0),
+        mask_(0) {
+    if (contents.size() < kXorFilterMetadataBytes) {
+      // Broken filter, match every key
+      return;
+    }
+    const char* metadata =
+        contents.data() + contents.size() - kXorFilterMetadataBytes;
+    uint32_t block_length = DecodeFixed32(metadata + 8);
+    int fingerprint_bits = static_cast<unsigned char>(metadata[12]);
+    if (fingerprint_bits == 0 || fingerprint_bits > kMaxFingerprintBits ||
+        XorFilterSize(block_length, fingerprint_bits) != contents.size()) {
+      return;
+    }
+    seed_ = DecodeFixed64(metadata);
+    block_length_ = block_length;
+    fingerprint_bits_ = fingerprint_bits;
+    mask_ = (1U << fingerprint_bits) - 1;
+  }
+
+  virtual bool MayMatch(const Slice& entry) override {
+    if (fingerprint_bits_ == 0) {
+      return true;
+    }
+    if (block_length_ == 0) {
+      return false;
+    }
+    uint64_t hash = XorFilterHash(BloomHash(entry), seed_);
+    uint32_t slots[3];
+    XorFilterSlots(hash, block_length_, slots);
+    return HashMayMatch(hash, slots);
+  }
+
+  virtual void MultiMayMatch(int num_keys, Slice** keys,
+                             bool* may_match) override {
+    if (fingerprint_bits_ == 0 || block_length_ == 0) {
+      std::fill(may_match, may_match + num_keys, fingerprint_bits_ == 0);
+      return;
+    }
+    // Prefetch the slots of a batch of keys before probing any of them, so
+    // that their cache misses overlap
+    const int kBatchSize = 32;
+    uint64_t hashes[kBatchSize];
+    uint32_t slots[kBatchSize][3];
+    for (int start = 0; start < num_keys; start += kBatchSize) {
+      const int batch_size = std::min(num_keys - start, kBatchSize);
+      for (int i = 0; i < batch_size; i++) {
+        hashes[i] = XorFilterHash(BloomHash(*keys[start + i]), seed_);
+        XorFilterSlots(hashes[i], block_length_, slots[i]);
+        for (uint32_t slot : slots[i]) {
+          PREFETCH(data_ + static_cast<uint64_t>(slot) * fingerprint_bits_ / 8,
+                   0 /* rw */, 1 /* locality */);
+        }
+      }
+      for (int i = 0; i < batch_size; i++) {
+        may_match[start + i] = HashMayMatch(hashes[i], slots[i]);
+      }
+    }
+  }
+
+ private:
+  bool HashMayMatch(uint64_t hash, const uint32_t slots[3]) const {
+    return XorFilterFingerprint(hash, mask_) ==
+           (GetFingerprint(data_, slots[0], fingerprint_bits_, mask_) ^
+            GetFingerprint(data_, slots[1], fingerprint_bits_, mask_) ^
+            GetFingerprint(data_, slots[2], fingerprint_bits_, mask_));
+  }
+
+  const char* data_;
+  uint64_t seed_;
+  uint32_t block_length_;
+  int fingerprint_bits_;
+  uint32_t mask_;
+};
+
+class XorFilterPolicy : public FilterPolicy {
+ public:
+  explicit XorFilterPolicy(double bits_per_key)
+      : fingerprint_bits_(std::min(
+            std::max(static_cast<int>(bits_per_key / 1.23 + 0.5), 1),
+            kMaxFingerprintBits)) {}
+
+  virtual const char* Name() const override { return "rocksdb.XorFilter"; }
+
+  virtual void CreateFilter(const Slice* keys, int n,
+                            std::string* dst) const override {
+    XorFilterBitsBuilder builder(fingerprint_bits_);
+    for (int i = 0; i < n; i++) {
+      builder.AddKey(keys[i]);
+    }
+    std::unique_ptr<const char[]> buf;
+    Slice filter = builder.Finish(&buf);
+    dst->append(filter.data(), filter.size());
+  }
+
+  virtual bool KeyMayMatch(const Slice& key,
+                           const Slice& filter) const override {
+    return XorFilterBitsReader(filter).MayMatch(key);
+  }
+
+  virtual FilterBitsBuilder* GetFilterBitsBuilder() const override {
+    return new XorFilterBitsBuilder(fingerprint_bits_);
+  }
+
+  virtual FilterBitsReader* GetFilterBitsReader(
+      const Slice& contents) const override {
+    return new XorFilterBitsReader(contents);
+  }
+
+ private:
+  const int fingerprint_bits_;
+};
+
+}  // namespace
+
+const FilterPolicy* NewXorFilterPolicy(double bits_per_key) {
+  return new XorFilterPolicy(bits_per_key);
+}
+
+}  // namespace rocksdb
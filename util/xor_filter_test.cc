@@ -0,0 +1,215 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rocksdb/filter_policy.h"
+#include "util/coding.h"
+#include "util/testharness.h"
+
+namespace rocksdb {
+
+static Slice Key(int i, char* buffer) {
+  EncodeFixed32(buffer, i);
+  return Slice(buffer, sizeof(uint32_t));
+}
+
+static int NextLength(int length) {
+  if (length < 10) {
+    length += 1;
+  } else if (length < 100) {
+    length += 10;
+  } else if (length < 1000) {
+    length += 100;
+  } else {
+    length += 1000;
+  }
+  return length;
+}
+
+class XorFilterTest : public testing::Test {
+ public:
+  XorFilterTest() : policy_(NewXorFilterPolicy(10)) { Reset(); }
+
+  void Reset() {
+    bits_builder_.reset(policy_->GetFilterBitsBuilder());
+    bits_reader_.reset(nullptr);
+    buf_.reset(nullptr);
+    filter_size_ = 0;
+  }
+
+  void Add(const Slice& s) { bits_builder_->AddKey(s); }
+
+  void Build() {
+    Slice filter = bits_builder_->Finish(&buf_);
+    bits_reader_.reset(policy_->GetFilterBitsReader(filter));
+    filter_size_ = filter.size();
+  }
+
+  size_t FilterSize() const { return filter_size_; }
+
+  bool Matches(const Slice& s) {
+    if (bits_reader_ == nullptr) {
+      Build();
+    }
+    return bits_reader_->MayMatch(s);
+  }
+
+  double FalsePositiveRate() {
+    char buffer[sizeof(int)];
+    int result = 0;
+    for (int i = 0; i < 10000; i++) {
+      if (Matches(Key(i + 1000000000, buffer))) {
+        result++;
+      }
+    }
+    return result / 10000.0;
+  }
+
+ protected:
+  std::unique_ptr<const FilterPolicy> policy_;
+  std::unique_ptr<FilterBitsBuilder> bits_builder_;
+  std::unique_ptr<FilterBitsReader> bits_reader_;
+  std::unique_ptr<const char[]> buf_;
+  size_t filter_size_;
+};
+
+TEST_F(XorFilterTest, EmptyFilter) {
+  ASSERT_TRUE(!Matches("hello"));
+  ASSERT_TRUE(!Matches("world"));
+}
+
+TEST_F(XorFilterTest, Small) {
+  Add("hello");
+  Add("world");
+  ASSERT_TRUE(Matches("hello"));
+  ASSERT_TRUE(Matches("world"));
+  ASSERT_TRUE(!Matches("x"));
+  ASSERT_TRUE(!Matches("foo"));
+}
+
+TEST_F(XorFilterTest, DuplicateKeys) {
+  for (int i = 0; i < 3; i++) {
+    Add("hello");
+  }
+  Add("world");
+  Add("hello");
+  ASSERT_TRUE(Matches("hello"));
+  ASSERT_TRUE(Matches("world"));
+}
+
+TEST_F(XorFilterTest, VaryingLengths) {
+  char buffer[sizeof(int)];
+  for (int length = 1; length <= 10000; length = NextLength(length)) {
+    Reset();
+    for (int i = 0; i < length; i++) {
+      Add(Key(i, buffer));
+    }
+    Build();
+
+    // 8-bit fingerprints in 1.23 slots per key, plus 32 slots
+    ASSERT_LE(FilterSize(), static_cast<size_t>(length * 1.23 + 32 + 13))
+        << length;
+
+    // All added keys must match
+    for (int i = 0; i < length; i++) {
+      ASSERT_TRUE(Matches(Key(i, buffer)))
+          << "Length " << length << "; key " << i;
+    }
+
+    // 8-bit fingerprints match 1 / 256 of the missing keys
+    ASSERT_LE(FalsePositiveRate(), 0.01) << length;
+  }
+}
+
+TEST_F(XorFilterTest, MultiMayMatch) {
+  char buffer[sizeof(int)];
+  const int kNumKeys = 5000;
+  for (int i = 0; i < kNumKeys; i++) {
+    Add(Key(i, buffer));
+  }
+  Build();
+
+  std::vector<std::string> keys;
+  for (int i = 0; i < kNumKeys; i++) {
+    keys.push_back(Key(i * 2, buffer).ToString());
+  }
+  std::vector<Slice> key_slices(keys.begin(), keys.end());
+  std::vector<Slice*> key_ptrs;
+  for (auto& key : key_slices) {
+    key_ptrs.push_back(&key);
+  }
+  std::unique_ptr<bool[]> may_match(new bool[kNumKeys]);
+  bits_reader_->MultiMayMatch(kNumKeys, key_ptrs.data(), may_match.get());
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ(bits_reader_->MayMatch(key_slices[i]), may_match[i]);
+    if (i * 2 < kNumKeys) {
+      ASSERT_TRUE(may_match[i]);
+    }
+  }
+}
+
+TEST_F(XorFilterTest, FilterSize) {
+  for (uint32_t space = 1; space < 4096; space = space * 3 / 2 + 1) {
+    int n = bits_builder_->CalculateNumEntry(space);
+    ASSERT_GE(n, 1);
+    char buffer[sizeof(int)];
+    for (int i = 0; i < n; i++) {
+      Add(Key(i, buffer));
+    }
+    std::unique_ptr<const char[]> buf;
+    Slice filter = bits_builder_->Finish(&buf);
+    if (n > 1) {
+      ASSERT_LE(filter.size(), space);
+    }
+  }
+}
+
+TEST_F(XorFilterTest, CorruptedFilter) {
+  char buffer[sizeof(int)];
+  for (int i = 0; i < 100; i++) {
+    Add(Key(i, buffer));
+  }
+  std::unique_ptr<const char[]> buf;
+  Slice filter = bits_builder_->Finish(&buf);
+  // A filter that does not add up matches every key
+  std::unique_ptr<FilterBitsReader> reader(
+      policy_->GetFilterBitsReader(Slice(filter.data(), filter.size() - 1)));
+  for (int i = 0; i < 100; i++) {
+    ASSERT_TRUE(reader->MayMatch(Key(i + 1000000000, buffer)));
+  }
+}
+
+TEST_F(XorFilterTest, BlockBasedFilter) {
+  char buffer[sizeof(int)];
+  std::vector<std::string> keys;
+  for (int i = 0; i < 1000; i++) {
+    keys.push_back(Key(i, buffer).ToString());
+  }
+  std::vector<Slice> key_slices(keys.begin(), keys.end());
+  std::string filter = "prefix";
+  policy_->CreateFilter(key_slices.data(), static_cast<int>(key_slices.size()),
+                        &filter);
+  // The filter is appended to dst
+  ASSERT_EQ("prefix", filter.substr(0, 6));
+  std::string filter_data = filter.substr(6);
+  int false_positives = 0;
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_TRUE(policy_->KeyMayMatch(Key(i, buffer), filter_data));
+    if (policy_->KeyMayMatch(Key(i + 1000000000, buffer), filter_data)) {
+      false_positives++;
+    }
+  }
+  ASSERT_LE(false_positives, 10);
+}
+
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
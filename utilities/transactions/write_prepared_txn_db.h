@@ -112,6 +112,17 @@ class WritePreparedTxnDB : public PessimisticTransactionDB {
       const std::vector<ColumnFamilyHandle*>& column_families,
       std::vector<Iterator*>* iterators) override;
 
+  // The parts would need the read callback of the transactions
+  virtual Status NewParallelIterators(const ReadOptions& /*options*/,
+                                      ColumnFamilyHandle* /*column_family*/,
+                                      const RangePtr& /*range*/,
+                                      size_t /*num_iterators*/,
+                                      std::vector<Iterator*>* /*iterators*/)
+      override {
+    return Status::NotSupported(
+        "NewParallelIterators() is not supported by WritePreparedTxnDB.");
+  }
+
   virtual void ReleaseSnapshot(const Snapshot* snapshot) override;
 
   // Check whether the transaction that wrote the value with sequence number seq